@@ -21,16 +21,54 @@
 
 var common = require('../common.js');
 
-var bench = common.createBenchmark(main, {});
+// Throughput of the string <-> buffer conversions in MB/s. The utf8 cases
+// use ASCII text.
+var bench = common.createBenchmark(main, {
+  type: ['base64-encode', 'base64-decode', 'hex-encode', 'hex-decode',
+         'utf8-encode', 'utf8-decode'],
+  size: [64, 1024, 64 * 1024 * 1024]
+});
 
 function main(conf) {
-  var N = 64 * 1024 * 1024;
-  var b = Buffer(N);
-  var s = '';
-  for (var i = 0; i < 256; ++i) s += String.fromCharCode(i);
+  var size = +conf.size;
+  var total = 2 * 1024 * 1024 * 1024;
+  var n = Math.max(total / size, 4) | 0;
+  if (size < 1024)
+    n = (n / 16) | 0;  // call overhead dominates, don't wait forever
+
+  var b = Buffer(size);
+  for (var i = 0; i < size; i++)
+    b[i] = 32 + (i * 31) % 95;
+
+  var fn;
+  switch (conf.type) {
+    case 'base64-encode':
+      fn = function() { return b.toString('base64'); };
+      break;
+    case 'base64-decode':
+      var s = b.toString('base64');
+      fn = function() { return new Buffer(s, 'base64'); };
+      break;
+    case 'hex-encode':
+      fn = function() { return b.toString('hex'); };
+      break;
+    case 'hex-decode':
+      var s = b.toString('hex');
+      fn = function() { return new Buffer(s, 'hex'); };
+      break;
+    case 'utf8-encode':
+      fn = function() { return b.toString('utf8'); };
+      break;
+    case 'utf8-decode':
+      var s = b.toString('utf8');
+      fn = function() { return new Buffer(s, 'utf8'); };
+      break;
+    default:
+      throw new Error('unknown type ' + conf.type);
+  }
 
   bench.start();
-  for (var i = 0; i < N; i += 256) b.write(s, i, 256, 'ascii');
-  for (var i = 0; i < 32; ++i) b.toString('base64');
-  bench.end(64);
+  for (var i = 0; i < n; i++)
+    fn();
+  bench.end(n * size / (1024 * 1024));
 }
@@ -0,0 +1,46 @@
+// how responsive the event loop stays while large buffers are hashed.
+// keeps `len` byte updates going back to back for `dur` seconds and
+// reports the number of 1 ms timers that fired per second.  with the
+// legacy api every update blocks the loop, with the async api it runs on
+// the thread pool.
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  dur: [5],
+  algo: ['sha256'],
+  len: [1024 * 1024, 16 * 1024 * 1024],
+  api: ['legacy', 'async']
+});
+
+function main(conf) {
+  var dur = +conf.dur;
+  var async = conf.api === 'async';
+  var message = new Buffer(+conf.len);
+  message.fill('b');
+
+  var running = true;
+  var h = crypto.createHash(conf.algo);
+
+  function update() {
+    if (!running)
+      return;
+    if (async)
+      return h.update(message, update);
+    h.update(message);
+    setImmediate(update);
+  }
+
+  var ticks = 0;
+  var timer = setInterval(function() {
+    ticks++;
+  }, 1);
+
+  bench.start();
+  update();
+  setTimeout(function() {
+    running = false;
+    clearInterval(timer);
+    bench.end(ticks / dur);
+  }, dur * 1000);
+}
@@ -8,7 +8,7 @@ var bench = common.createBenchmark(main, {
   algo: [ 'sha256', 'md5' ],
   type: ['asc', 'utf', 'buf'],
   len: [2, 1024, 102400, 1024 * 1024],
-  api: ['legacy', 'stream']
+  api: ['legacy', 'stream', 'async']
 });
 
 function main(conf) {
@@ -41,7 +41,8 @@ function main(conf) {
       throw new Error('unknown message type: ' + conf.type);
   }
 
-  var fn = api === 'stream' ? streamWrite : legacyWrite;
+  var fn = api === 'stream' ? streamWrite :
+           api === 'async' ? asyncWrite : legacyWrite;
 
   bench.start();
   fn(conf.algo, message, encoding, conf.writes, conf.len);
@@ -75,3 +76,17 @@ function streamWrite(algo, message, encoding, writes, len) {
 
   bench.end(gbits);
 }
+
+function asyncWrite(algo, message, encoding, writes, len) {
+  var written = writes * len;
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
+  var h = crypto.createHash(algo);
+
+  while (writes-- > 0)
+    h.update(message, encoding, function() {});
+
+  h.digest(function() {
+    bench.end(gbits);
+  });
+}
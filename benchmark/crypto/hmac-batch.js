@@ -0,0 +1,38 @@
+// hmacs per second over many short messages, one Hmac object per message
+// versus a single crypto.hmacBatch() call.
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  n: [50000],
+  len: [32, 256, 1024],
+  keys: ['one', 'many'],
+  api: ['hmac', 'batch']
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var len = +conf.len;
+
+  var messages = [];
+  var keys = [];
+  for (var i = 0; i < n; i++) {
+    var message = new Buffer(len);
+    message.fill(i & 0xff);
+    messages.push(message);
+    keys.push(new Buffer('key' + i));
+  }
+  var key = conf.keys === 'one' ? keys[0] : keys;
+
+  bench.start();
+  if (conf.api === 'batch') {
+    crypto.hmacBatch('sha256', key, messages);
+  } else {
+    for (var i = 0; i < n; i++) {
+      var hmac = crypto.createHmac('sha256', conf.keys === 'one' ? key : key[i]);
+      hmac.update(messages[i]);
+      hmac.digest();
+    }
+  }
+  bench.end(n);
+}
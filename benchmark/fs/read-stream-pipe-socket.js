@@ -0,0 +1,71 @@
+// test the throughput of fs.ReadStream piped into a socket, the static file
+// server case.  'sendfile' is what readStream.pipe(socket) does, 'copy'
+// forces the data through the JS heap like before.
+
+var path = require('path');
+var common = require('../common.js');
+var filename = path.resolve(__dirname, '.removeme-benchmark-garbage');
+var fs = require('fs');
+var net = require('net');
+var stream = require('stream');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  type: ['sendfile', 'copy'],
+  size: [64 * 1024, 1024 * 1024, 64 * 1024 * 1024],
+  dur: [5]
+});
+
+var type, size, dur;
+
+function main(conf) {
+  type = conf.type;
+  size = +conf.size;
+  dur = +conf.dur;
+
+  var buf = new Buffer(size);
+  buf.fill('x');
+  fs.writeFileSync(filename, buf);
+
+  server();
+}
+
+function server() {
+  var bytes = 0;
+  var running = true;
+
+  // Every connection gets the whole file, the client asks for the next
+  // one when it is done.
+  var server = net.createServer(function(socket) {
+    var rs = fs.createReadStream(filename);
+    if (type === 'sendfile')
+      rs.pipe(socket);
+    else
+      stream.Readable.prototype.pipe.call(rs, socket);
+  });
+
+  server.listen(PORT, function() {
+    bench.start();
+    setTimeout(function() {
+      running = false;
+      try { fs.unlinkSync(filename); } catch (e) {}
+      // Gbits
+      bench.end(bytes * 8 / (1024 * 1024 * 1024));
+      process.exit(0);
+    }, dur * 1000);
+
+    for (var i = 0; i < 4; i++)
+      client();
+  });
+
+  function client() {
+    var socket = net.connect(PORT);
+    socket.on('data', function(chunk) {
+      bytes += chunk.length;
+    });
+    socket.on('end', function() {
+      if (running)
+        client();
+    });
+  }
+}
@@ -1,6 +1,13 @@
 // Call fs.readFile over and over again really fast.
 // Then see how many times it got called.
 // Yes, this is a silly benchmark.  Most benchmarks are silly.
+//
+// With high concurrency this mostly measures how fast requests get to the
+// kernel and back. Run it with UV_USE_IO_URING=0 to compare the io_uring
+// backend with the thread pool on Linux.
+//
+// api=loop hides the one-shot binding, so fs.readFile() falls back to the
+// open, fstat, read and close requests it makes on Windows.
 
 var path = require('path');
 var common = require('../common.js');
@@ -9,12 +16,15 @@ var fs = require('fs');
 
 var bench = common.createBenchmark(main, {
   dur: [5],
-  len: [1024, 16 * 1024 * 1024],
-  concurrent: [1, 10]
+  len: [1024, 64 * 1024, 1024 * 1024],
+  concurrent: [1, 10, 100, 1000],
+  api: ['oneshot', 'loop']
 });
 
 function main(conf) {
   var len = +conf.len;
+  if (conf.api === 'loop')
+    process.binding('fs').readFile = undefined;
   try { fs.unlinkSync(filename); } catch (e) {}
   var data = new Buffer(len);
   data.fill('x');
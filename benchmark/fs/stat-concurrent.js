@@ -0,0 +1,40 @@
+// Keep a number of fs.stat() calls in flight and see how many complete.
+// Every callback schedules a nextTick, like most stream and promise code
+// does, so the cost of processing the nextTick queue shows up as well.
+
+var common = require('../common.js');
+var fs = require('fs');
+
+var bench = common.createBenchmark(main, {
+  dur: [5],
+  concurrent: [1, 16, 256]
+});
+
+function main(conf) {
+  var stats = 0;
+  var ticks = 0;
+
+  bench.start();
+  setTimeout(function() {
+    bench.end(stats);
+  }, +conf.dur * 1000);
+
+  function stat() {
+    fs.stat(__filename, afterStat);
+  }
+
+  function afterStat(er) {
+    if (er)
+      throw er;
+    stats++;
+    process.nextTick(onTick);
+  }
+
+  function onTick() {
+    ticks++;
+    stat();
+  }
+
+  var cur = +conf.concurrent;
+  while (cur--) stat();
+}
@@ -0,0 +1,68 @@
+// the load that fs.watchFile() puts on the thread pool: watch a number of
+// files that don't change and see how many fs.stat() calls on another file
+// complete in the meantime, one at a time.
+var common = require('../common.js');
+var fs = require('fs');
+var path = require('path');
+
+var bench = common.createBenchmark(main, {
+  files: [0, 1000, 10000],
+  interval: [100, 1000],
+  dur: [5]
+});
+
+var dir = path.resolve(__dirname, '.removeme-benchmark-garbage-watch');
+
+function main(conf) {
+  var files = +conf.files;
+  var filenames = [];
+
+  cleanup();
+  fs.mkdirSync(dir);
+  for (var i = 0; i < files; i++) {
+    var filename = path.join(dir, 'file-' + i);
+    fs.writeFileSync(filename, '' + i);
+    fs.watchFile(filename, { interval: +conf.interval }, assert);
+    filenames.push(filename);
+  }
+
+  var stats = 0;
+  var running = true;
+
+  // Let the watchers settle into their polling rhythm first.
+  setTimeout(function() {
+    bench.start();
+    stat();
+    setTimeout(function() {
+      running = false;
+      filenames.forEach(function(filename) {
+        fs.unwatchFile(filename);
+      });
+      cleanup();
+      bench.end(stats);
+    }, +conf.dur * 1000);
+  }, +conf.interval);
+
+  function stat() {
+    fs.stat(__filename, function(er) {
+      if (er)
+        throw er;
+      stats++;
+      if (running)
+        stat();
+    });
+  }
+}
+
+function assert() {
+  throw new Error('nothing should change');
+}
+
+function cleanup() {
+  try {
+    fs.readdirSync(dir).forEach(function(name) {
+      fs.unlinkSync(path.join(dir, name));
+    });
+    fs.rmdirSync(dir);
+  } catch (e) {}
+}
@@ -0,0 +1,116 @@
+// watch a directory tree while files all over it are written to, the way a
+// build tool watches a source tree during a `git checkout`. compares one
+// fs.watch() per directory with a single recursive watcher. every round
+// writes to all files `writes` times and waits until a change was reported
+// for each of them. the result is the number of writes per second of time
+// spent waiting for and handling the events, the writes themselves aren't
+// counted.
+var common = require('../common.js');
+var fs = require('fs');
+var path = require('path');
+
+var bench = common.createBenchmark(main, {
+  mode: ['per-dir', 'recursive'],
+  dirs: [10, 100],
+  files: [10],
+  writes: [1, 10],
+  dur: [5]
+});
+
+var root = path.resolve(__dirname, '.removeme-benchmark-garbage-tree');
+
+function main(conf) {
+  var dirs = +conf.dirs;
+  var files = +conf.files;
+  var writes = +conf.writes;
+  var total = dirs * files;
+  var fds = [];
+  var watchers = [];
+
+  cleanup();
+  fs.mkdirSync(root);
+  for (var i = 0; i < dirs; i++) {
+    var dir = path.join(root, 'dir-' + i);
+    fs.mkdirSync(dir);
+    for (var j = 0; j < files; j++) {
+      fds.push(fs.openSync(path.join(dir, 'file-' + j), 'w'));
+    }
+  }
+
+  var chunk = new Buffer('x');
+  var seen = {};
+  var pending = 0;
+  var rounds = 0;
+  var running = true;
+  var start = null;
+  var elapsed = 0;
+
+  function onchange(filename) {
+    if (!running || seen[filename])
+      return;
+    seen[filename] = true;
+    if (--pending === 0)
+      setImmediate(round);
+  }
+
+  if (conf.mode === 'recursive') {
+    watchers.push(fs.watch(root, { recursive: true }, function(event, name) {
+      onchange(name);
+    }));
+  } else {
+    for (var i = 0; i < dirs; i++) {
+      (function(dir) {
+        watchers.push(fs.watch(path.join(root, dir), function(event, name) {
+          onchange(dir + '/' + name);
+        }));
+      })('dir-' + i);
+    }
+  }
+
+  function round() {
+    // All events of the last round have been handled by now.
+    if (start !== null) {
+      var t = process.hrtime(start);
+      elapsed += t[0] + t[1] / 1e9;
+      rounds++;
+    }
+    if (!running)
+      return;
+    seen = {};
+    pending = total;
+    // Pass over the files `writes` times, the kernel merges identical
+    // events only when they are back to back.
+    for (var i = 0; i < writes; i++) {
+      fds.forEach(function(fd) {
+        fs.writeSync(fd, chunk, 0, chunk.length);
+      });
+    }
+    start = process.hrtime();
+  }
+
+  round();
+  setTimeout(function() {
+    running = false;
+    watchers.forEach(function(watcher) {
+      watcher.close();
+    });
+    fds.forEach(function(fd) {
+      fs.closeSync(fd);
+    });
+    cleanup();
+    bench.report(rounds * total * writes / elapsed);
+  }, +conf.dur * 1000);
+}
+
+function cleanup() {
+  try {
+    fs.readdirSync(root).forEach(function(dir) {
+      dir = path.join(root, dir);
+      fs.readdirSync(dir).forEach(function(name) {
+        fs.unlinkSync(path.join(dir, name));
+      });
+      fs.rmdirSync(dir);
+    });
+    fs.rmdirSync(root);
+  } catch (e) {}
+}
@@ -1,4 +1,7 @@
 // test the througput of the fs.WriteStream class.
+//
+// writev=0 makes the stream write the chunks that were buffered during a
+// write one request at a time, instead of with a single fs.writev().
 
 var path = require('path');
 var common = require('../common.js');
@@ -8,7 +11,8 @@ var fs = require('fs');
 var bench = common.createBenchmark(main, {
   dur: [5],
   type: ['buf', 'asc', 'utf'],
-  size: [2, 1024, 65535, 1024 * 1024]
+  size: [2, 1024, 65535, 1024 * 1024],
+  writev: [0, 1]
 });
 
 function main(conf) {
@@ -46,6 +50,8 @@ function main(conf) {
   }, dur * 1000);
 
   var f = fs.createWriteStream(filename);
+  if (+conf.writev === 0)
+    f._writev = null;
   f.on('drain', write);
   f.on('open', write);
   f.on('close', done);
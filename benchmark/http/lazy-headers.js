@@ -0,0 +1,38 @@
+// the cost of parsing a request and looking at a couple of its headers, the
+// way a proxy routes on Host and one custom header. compares the default
+// parser mode with server.lazyHeaders.
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  lazy: [0, 1],
+  headers: [5, 20],
+  n: [2e5]
+});
+
+function main(conf) {
+  var lazy = +conf.lazy;
+  var n = +conf.n;
+
+  var lines = ['GET /some/path HTTP/1.1', 'Host: example.com'];
+  for (var i = 0; i < +conf.headers - 2; i++)
+    lines.push('X-Filler-' + i + ': some value that nobody looks at');
+  lines.push('X-Route: backend-3');
+  var request = new Buffer(lines.join('\r\n') + '\r\n\r\n');
+
+  var HTTPParser = process.binding('http_parser').HTTPParser;
+  var parser = require('_http_common').parsers.alloc();
+  parser.reinitialize(HTTPParser.REQUEST, lazy === 1);
+  parser.socket = { readable: false };
+  parser.maxHeaderPairs = 2000;
+
+  var routed = 0;
+  parser.onIncoming = function(req) {
+    if (req.getHeader('host') && req.getHeader('x-route'))
+      routed++;
+    return false;
+  };
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    parser.execute(request);
+  bench.end(routed);
+}
@@ -0,0 +1,79 @@
+// messages per second from the master to its workers, the way a master
+// pushes config updates and counters to every worker: small objects sent
+// to each of them in turn.  compares the IPC channel with the shared
+// memory rings (cluster.settings.ringSize).
+var common = require('../common.js');
+var cluster = require('cluster');
+
+if (cluster.isWorker) {
+  worker();
+} else {
+  var bench = common.createBenchmark(main, {
+    transport: ['pipe', 'ring'],
+    workers: [1, 4],
+    dur: [5]
+  });
+}
+
+function worker() {
+  var messages = 0;
+  process.on('message', function(message) {
+    if (message === 'count')
+      process.send(messages);
+    else
+      messages++;
+  });
+}
+
+function main(conf) {
+  var dur = +conf.dur;
+  var workers = [];
+
+  cluster.setupMaster({
+    ringSize: conf.transport === 'ring' ? 1024 * 1024 : 0
+  });
+  for (var i = 0; i < +conf.workers; i++)
+    workers.push(cluster.fork());
+
+  var online = 0;
+  cluster.on('online', function() {
+    if (++online === workers.length)
+      start();
+  });
+
+  function start() {
+    var message = { cmd: 'config', key: 'maxConnections', version: 0 };
+    var running = true;
+
+    function send() {
+      if (!running)
+        return;
+      var full = false;
+      for (var i = 0; i < 100 && !full; i++) {
+        message.version++;
+        for (var j = 0; j < workers.length; j++)
+          full = workers[j].send(message) === false || full;
+      }
+      setImmediate(send);
+    }
+
+    bench.start();
+    send();
+
+    setTimeout(function() {
+      running = false;
+      var total = 0;
+      var counted = 0;
+      workers.forEach(function(worker) {
+        worker.process.send('count');
+        worker.once('message', function(messages) {
+          total += messages;
+          if (++counted === workers.length) {
+            bench.end(total);
+            process.exit(0);
+          }
+        });
+      });
+    }, dur * 1000);
+  }
+}
@@ -0,0 +1,51 @@
+// messages per second from a forked worker to the master, the way cluster
+// workers report cache invalidations and metrics: many small objects.
+// compares the default JSON channel with the binary one.
+var common = require('../common.js');
+
+if (process.argv[2] === 'child') {
+  child(+process.argv[3]);
+} else {
+  var bench = common.createBenchmark(main, {
+    serialization: ['json', 'binary'],
+    len: [16, 256],
+    dur: [5]
+  });
+}
+
+function child(len) {
+  var message = {
+    cmd: 'invalidate',
+    key: new Array(len + 1).join('k'),
+    version: 0,
+    hits: [1, 2, 3]
+  };
+
+  function send() {
+    do {
+      message.version++;
+    } while (process.send(message));
+    setImmediate(send);
+  }
+  send();
+}
+
+function main(conf) {
+  var dur = +conf.dur;
+  var fork = require('child_process').fork;
+  var worker = fork(__filename, ['child', conf.len], {
+    serialization: conf.serialization
+  });
+
+  var messages = 0;
+  worker.once('message', function() {
+    bench.start();
+    setTimeout(function() {
+      worker.kill();
+      bench.end(messages);
+    }, dur * 1000);
+  });
+  worker.on('message', function() {
+    messages++;
+  });
+}
@@ -0,0 +1,51 @@
+// bytes per second of binary payloads sent from a forked worker to the
+// master.  the JSON channel can't carry buffers, so there the payload is
+// base64 encoded by the worker and decoded again by the master; the binary
+// channel sends the buffer as it is.  the result is in MB/s of payload.
+var common = require('../common.js');
+
+if (process.argv[2] === 'child') {
+  child(process.argv[3], +process.argv[4]);
+} else {
+  var bench = common.createBenchmark(main, {
+    serialization: ['json', 'binary'],
+    len: [1024, 64 * 1024, 1024 * 1024],
+    dur: [5]
+  });
+}
+
+function child(serialization, len) {
+  var payload = new Buffer(len);
+  payload.fill('b');
+
+  function send() {
+    do {
+      var data = serialization === 'json' ?
+          payload.toString('base64') : payload;
+    } while (process.send({ cmd: 'chunk', data: data }));
+    setImmediate(send);
+  }
+  send();
+}
+
+function main(conf) {
+  var dur = +conf.dur;
+  var binary = conf.serialization === 'binary';
+  var fork = require('child_process').fork;
+  var worker = fork(__filename, ['child', conf.serialization, conf.len], {
+    serialization: conf.serialization
+  });
+
+  var bytes = 0;
+  worker.once('message', function() {
+    bench.start();
+    setTimeout(function() {
+      worker.kill();
+      bench.end(bytes / (1024 * 1024));
+    }, dur * 1000);
+  });
+  worker.on('message', function(message) {
+    var data = binary ? message.data : new Buffer(message.data, 'base64');
+    bytes += data.length;
+  });
+}
@@ -1,12 +1,24 @@
+// spawn short-lived children one after the other. `heap` is the size in MB
+// of the memory the parent has touched before it starts spawning, the cost
+// of fork() grows with it.
 var common = require('../common.js');
 var bench = common.createBenchmark(main, {
-  thousands: [1]
+  thousands: [1],
+  heap: [0, 1024]
 });
 
 var spawn = require('child_process').spawn;
+var ballast = [];
+
 function main(conf) {
   var len = +conf.thousands * 1000;
 
+  for (var i = 0; i < +conf.heap; i++) {
+    var chunk = new Buffer(1024 * 1024);
+    chunk.fill(i & 0xff);
+    ballast.push(chunk);
+  }
+
   bench.start();
   go(len, len);
 }
@@ -0,0 +1,34 @@
+// socket idle timeouts: a lot of items with many different timeouts that
+// get pushed back over and over again, the way net.Socket does it on every
+// read and write.
+
+var common = require('../common.js');
+var timers = require('timers');
+
+var bench = common.createBenchmark(main, {
+  items: [1000, 100000],
+  durations: [1, 1000],
+  millions: [2]
+});
+
+function main(conf) {
+  var n = +conf.millions * 1e6;
+  var count = +conf.items;
+  var durations = +conf.durations;
+  var items = new Array(count);
+
+  for (var i = 0; i < count; i++) {
+    items[i] = { _onTimeout: ontimeout };
+    timers.enroll(items[i], 60000 + (i % durations) * 10);
+    timers._unrefActive(items[i]);
+  }
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    timers._unrefActive(items[(i * 7919) % count]);
+  bench.end(n / 1e6);
+
+  function ontimeout() {
+    throw new Error('should not time out');
+  }
+}
@@ -6,9 +6,14 @@ var PORT = common.PORT;
 // `num` is the number of send requests to queue up each time.
 // Keep it reasonably high (>10) otherwise you're benchmarking the speed of
 // event loop cycles more than anything else.
+//
+// `batch` switches to socket.sendBatch() for sending and reads up to that
+// many datagrams per system call with socket.setRecvBatch(). 0 sends and
+// receives datagrams one by one.
 var bench = common.createBenchmark(main, {
   len: [1, 64, 256, 1024],
   num: [100],
+  batch: [0, 64],
   type: ['send', 'recv'],
   dur: [5]
 });
@@ -16,16 +21,22 @@ var bench = common.createBenchmark(main, {
 var dur;
 var len;
 var num;
+var batch;
 var type;
 var chunk;
+var chunks;
 var encoding;
 
 function main(conf) {
   dur = +conf.dur;
   len = +conf.len;
   num = +conf.num;
+  batch = +conf.batch;
   type = conf.type;
   chunk = new Buffer(len);
+  chunks = [];
+  for (var i = 0; i < num; i++)
+    chunks.push(chunk);
   server();
 }
 
@@ -42,9 +53,21 @@ function server() {
         socket.send(chunk, 0, chunk.length, PORT, '127.0.0.1', onsend);
   }
 
+  function sendbatch() {
+    socket.sendBatch(chunks, PORT, '127.0.0.1', function() {
+      sent += num;
+      sendbatch();
+    });
+  }
+
   socket.on('listening', function() {
     bench.start();
-    onsend();
+    if (batch > 0) {
+      socket.setRecvBatch(batch, Math.max(len, 1));
+      sendbatch();
+    } else {
+      onsend();
+    }
 
     setTimeout(function() {
       var bytes = (type === 'send' ? sent : received) * chunk.length;
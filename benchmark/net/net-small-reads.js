@@ -0,0 +1,81 @@
+// test the cost of many small reads spread over many connections, the
+// typical keep-alive server workload.  every client writes a small
+// request and waits for the server to echo it back before sending the
+// next one, so every read on both ends is a small one.
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  len: [16, 256, 4096],
+  conns: [1, 100, 400],
+  dur: [5]
+});
+
+var dur;
+var len;
+var conns;
+var chunk;
+
+function main(conf) {
+  dur = +conf.dur;
+  len = +conf.len;
+  conns = +conf.conns;
+
+  chunk = new Buffer(len);
+  chunk.fill('x');
+
+  server();
+}
+
+var net = require('net');
+
+function server() {
+  var reads = 0;
+  var sockets = [];
+
+  var server = net.createServer(function(socket) {
+    socket.on('data', function(data) {
+      // Echo back, the client only sends the next request once the
+      // whole response arrived.
+      socket.write(data);
+    });
+    socket.on('error', function() {});
+  });
+
+  server.listen(PORT, function() {
+    var connected = 0;
+
+    for (var i = 0; i < conns; i++) {
+      var socket = net.connect(PORT);
+      sockets.push(socket);
+      socket.on('connect', onconnect);
+      socket.on('data', ondata);
+      socket.on('error', function() {});
+      socket.received = 0;
+    }
+
+    function onconnect() {
+      if (++connected !== conns)
+        return;
+
+      bench.start();
+      sockets.forEach(function(socket) {
+        socket.write(chunk);
+      });
+
+      setTimeout(function() {
+        bench.end(reads);
+      }, dur * 1000);
+    }
+
+    function ondata(data) {
+      reads++;
+      this.received += data.length;
+      if (this.received < len)
+        return;
+      this.received -= len;
+      this.write(chunk);
+    }
+  });
+}
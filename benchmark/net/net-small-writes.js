@@ -0,0 +1,89 @@
+// test the cost of many small writes issued in the same tick, the way a
+// RESP server or a template engine writes a reply piece by piece.  every
+// client sends a request and waits for the whole reply before sending the
+// next one.  compares one uv_write per socket.write() with the writes
+// coalesced into one writev per tick (socket.setCoalesceWrites()).  nagle
+// is disabled on both ends, otherwise the uncoalesced replies just measure
+// the delayed-ack timer.
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  writes: [1, 16, 64],
+  len: [16, 128],
+  type: ['buf', 'utf'],
+  coalesce: [0, 1],
+  conns: [1, 50],
+  dur: [5]
+});
+
+var net = require('net');
+
+function main(conf) {
+  var dur = +conf.dur;
+  var writes = +conf.writes;
+  var len = +conf.len;
+  var conns = +conf.conns;
+  var coalesce = +conf.coalesce === 1;
+
+  var piece;
+  if (conf.type === 'buf') {
+    piece = new Buffer(len);
+    piece.fill('x');
+  } else {
+    piece = new Array(len + 1).join('x');
+  }
+  var replyLength = writes * len;
+
+  var server = net.createServer(function(socket) {
+    socket.setNoDelay(true);
+    if (coalesce)
+      socket.setCoalesceWrites(true);
+    socket.on('data', function() {
+      for (var i = 0; i < writes; i++)
+        socket.write(piece);
+    });
+    socket.on('error', function() {});
+  });
+
+  server.listen(PORT, function() {
+    var replies = 0;
+    var connected = 0;
+    var sockets = [];
+
+    for (var i = 0; i < conns; i++) {
+      var socket = net.connect(PORT);
+      sockets.push(socket);
+      socket.received = 0;
+      socket.on('connect', onconnect);
+      socket.on('data', ondata);
+      socket.on('error', function() {});
+    }
+
+    function onconnect() {
+      this.setNoDelay(true);
+      if (++connected !== conns)
+        return;
+
+      bench.start();
+      sockets.forEach(function(socket) {
+        socket.write('?');
+      });
+
+      setTimeout(function() {
+        bench.end(replies / dur);
+        process.exit(0);
+      }, dur * 1000);
+    }
+
+    function ondata(data) {
+      this.received += data.length;
+      if (this.received < replyLength)
+        return;
+      this.received -= replyLength;
+      replies++;
+      this.write('?');
+    }
+  });
+}
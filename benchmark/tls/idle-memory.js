@@ -0,0 +1,55 @@
+// memory held by idle tls connections.  opens `conn` connections to a
+// local server, waits until they're all through the handshake and
+// reports the growth of the resident set size in KB per connection.
+// both ends of every connection live in this process.
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  conn: [1000, 5000]
+});
+
+var path = require('path');
+var fs = require('fs');
+var tls = require('tls');
+var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+
+function main(conf) {
+  var n = +conf.conn;
+  var options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+                  cert: fs.readFileSync(cert_dir + '/test_cert.pem') };
+  var connected = 0;
+  var clients = [];
+  var before;
+
+  var server = tls.createServer(options, function(conn) {
+    // Echo one byte, so both sides have been through a read and a write
+    conn.once('data', function(d) { conn.write(d); });
+  });
+
+  server.listen(common.PORT, function() {
+    // Warm up the session machinery and the heap before measuring
+    connect(function(c) {
+      c.destroy();
+      before = process.memoryUsage().rss;
+      for (var i = 0; i < n; i++)
+        connect(onConnected);
+    });
+  });
+
+  function connect(cb) {
+    var c = tls.connect({ port: common.PORT, rejectUnauthorized: false });
+    c.once('secureConnect', function() {
+      c.write('x');
+    });
+    c.once('data', function() {
+      cb(c);
+    });
+    clients.push(c);
+  }
+
+  function onConnected() {
+    if (++connected < n)
+      return;
+    var rss = process.memoryUsage().rss;
+    bench.report((rss - before) / n / 1024);
+  }
+}
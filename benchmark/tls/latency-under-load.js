@@ -0,0 +1,74 @@
+// measure how responsive a tls server stays while it is busy streaming
+// large writes to another client.  one connection pulls bulk data as
+// fast as it can, a second one does ping-pong round trips; the result is
+// the number of round trips completed per second.
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  dur: [5],
+  size: [64 * 1024, 1024 * 1024],
+  offload: [0, 1]
+});
+
+var path = require('path');
+var fs = require('fs');
+var tls = require('tls');
+var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+
+function main(conf) {
+  var dur = +conf.dur;
+  var size = +conf.size;
+  var offload = +conf.offload;
+
+  var chunk = new Buffer(size);
+  chunk.fill('b');
+
+  var options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+                  cert: fs.readFileSync(cert_dir + '/test_cert.pem') };
+  if (offload)
+    options.offloadThreshold = 64 * 1024;
+
+  var server = tls.createServer(options, function(conn) {
+    conn.once('data', function(data) {
+      if (data[0] === 0x42 /* 'B' */)
+        return bulk(conn);
+      conn.write(data);
+      conn.on('data', function(data) { conn.write(data); });
+    });
+    conn.on('error', function() {});
+  });
+
+  function bulk(conn) {
+    function write() {
+      while (false !== conn.write(chunk));
+    }
+    conn.on('drain', write);
+    write();
+  }
+
+  server.listen(common.PORT, function() {
+    var opt = { port: common.PORT, rejectUnauthorized: false };
+    var loader = tls.connect(opt, function() {
+      loader.write('B');
+      loader.on('data', function() {});
+
+      var pinger = tls.connect(opt, function() {
+        var pings = 0;
+        pinger.write('P');
+        pinger.on('data', function() {
+          pings++;
+          pinger.write('P');
+        });
+
+        bench.start();
+        setTimeout(function() {
+          bench.end(pings / dur);
+          loader.destroy();
+          pinger.destroy();
+          server.close();
+        }, dur * 1000);
+      });
+      pinger.on('error', function() {});
+    });
+    loader.on('error', function() {});
+  });
+}
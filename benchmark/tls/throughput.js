@@ -2,11 +2,12 @@ var common = require('../common.js');
 var bench = common.createBenchmark(main, {
   dur: [5],
   type: ['buf', 'asc', 'utf'],
-  size: [2, 1024, 1024 * 1024]
+  size: [2, 1024, 1024 * 1024],
+  offload: [0, 1]
 });
 
-var dur, type, encoding, size;
-var server;
+var dur, type, encoding, size, offload;
+var server, conn;
 
 var path = require('path');
 var fs = require('fs');
@@ -18,6 +19,7 @@ function main(conf) {
   dur = +conf.dur;
   type = conf.type;
   size = +conf.size;
+  offload = +conf.offload;
 
   var chunk;
   switch (type) {
@@ -45,7 +47,9 @@ function main(conf) {
   setTimeout(done, dur * 1000);
   server.listen(common.PORT, function() {
     var opt = { port: common.PORT, rejectUnauthorized: false };
-    var conn = tls.connect(opt, function() {
+    if (offload)
+      opt.offloadThreshold = 64 * 1024;
+    conn = tls.connect(opt, function() {
       bench.start();
       conn.on('drain', write);
       write();
@@ -71,6 +71,8 @@ test/benchmark-sizes.c
 test/benchmark-spawn.c
 test/benchmark-tcp-write-batch.c
 test/benchmark-thread.c
+test/benchmark-threadpool-mix.c
+test/benchmark-timer-churn.c
 test/benchmark-udp-pummel.c
 test/blackhole-server.c
 test/dns-server.c
@@ -140,6 +142,8 @@ test/test-tcp-connect6-error.c
 test/test-tcp-flags.c
 test/test-tcp-open.c
 test/test-tcp-read-stop.c
+test/test-tcp-reuseport.c
+test/test-tcp-sendfile.c
 test/test-tcp-shutdown-after-write.c
 test/test-tcp-unexpected-read.c
 test/test-tcp-write-error.c
@@ -157,6 +161,7 @@ test/test-udp-multicast-join.c
 test/test-udp-multicast-ttl.c
 test/test-udp-open.c
 test/test-udp-options.c
+test/test-udp-recv-batch.c
 test/test-udp-send-and-recv.c
 test/test-util.c
 test/test-walk-handles.c
@@ -96,6 +96,8 @@ struct uv__work {
   void (*done)(struct uv__work *w, int status);
   struct uv_loop_s* loop;
   void* wq[2];
+  unsigned int kind;
+  unsigned int worker;
 };
 
 #ifndef UV_PLATFORM_SEM_T
@@ -170,6 +172,7 @@ typedef struct {
   unsigned int nwatchers;                                                     \
   unsigned int nfds;                                                          \
   void* wq[2];                                                                \
+  unsigned int wq_next;                                                       \
   uv_mutex_t wq_mutex;                                                        \
   uv_async_t wq_async;                                                        \
   uv_handle_t* closing_handles;                                               \
@@ -179,10 +182,10 @@ typedef struct {
   void* idle_handles[2];                                                      \
   void* async_handles[2];                                                     \
   struct uv__async async_watcher;                                             \
-  /* RB_HEAD(uv__timers, uv_timer_s) */                                       \
-  struct uv__timers {                                                         \
-    struct uv_timer_s* rbh_root;                                              \
-  } timer_handles;                                                            \
+  /* Min heap of active timers, see src/unix/timer.c */                      \
+  struct uv__timer_heap_node* timer_heap;                                     \
+  unsigned int timer_heap_len;                                                \
+  unsigned int timer_heap_size;                                               \
   uint64_t time;                                                              \
   int signal_pipefd[2];                                                       \
   uv__io_t signal_io_watcher;                                                 \
@@ -204,6 +207,8 @@ typedef struct {
   int bufcnt;                                                                 \
   int error;                                                                  \
   uv_buf_t bufsml[4];                                                         \
+  int file;                                                                   \
+  off_t file_offset;                                                          \
 
 #define UV_CONNECT_PRIVATE_FIELDS                                             \
   void* queue[2];                                                             \
@@ -232,6 +237,7 @@ typedef struct {
   uv_connection_cb connection_cb;                                             \
   int delayed_error;                                                          \
   int accepted_fd;                                                            \
+  void* sendfile_warmup;                                                      \
   UV_STREAM_PRIVATE_PLATFORM_FIELDS                                           \
 
 #define UV_TCP_PRIVATE_FIELDS /* empty */
@@ -239,6 +245,7 @@ typedef struct {
 #define UV_UDP_PRIVATE_FIELDS                                                 \
   uv_alloc_cb alloc_cb;                                                       \
   uv_udp_recv_cb recv_cb;                                                     \
+  unsigned int recv_nmsgs;                                                    \
   uv__io_t io_watcher;                                                        \
   void* write_queue[2];                                                       \
   void* write_completed_queue[2];                                             \
@@ -267,13 +274,7 @@ typedef struct {
   int pending;                                                                \
 
 #define UV_TIMER_PRIVATE_FIELDS                                               \
-  /* RB_ENTRY(uv_timer_s) tree_entry; */                                      \
-  struct {                                                                    \
-    struct uv_timer_s* rbe_left;                                              \
-    struct uv_timer_s* rbe_right;                                             \
-    struct uv_timer_s* rbe_parent;                                            \
-    int rbe_color;                                                            \
-  } tree_entry;                                                               \
+  unsigned int heap_index;                                                    \
   uv_timer_cb timer_cb;                                                       \
   uint64_t timeout;                                                           \
   uint64_t repeat;                                                            \
@@ -305,6 +306,9 @@ typedef struct {
   double atime;                                                               \
   double mtime;                                                               \
   struct uv__work work_req;                                                   \
+  unsigned int nbufs;                                                         \
+  uv_buf_t* bufs;                                                             \
+  uv_buf_t bufsml[4];                                                         \
 
 #define UV_WORK_PRIVATE_FIELDS                                                \
   struct uv__work work_req;
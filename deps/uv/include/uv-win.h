@@ -552,6 +552,9 @@ RB_HEAD(uv_timer_tree_s, uv_timer_s);
       void* buf;                                                              \
       size_t length;                                                          \
       int64_t offset;                                                         \
+      unsigned int nbufs;                                                     \
+      uv_buf_t* bufs;                                                         \
+      uv_buf_t bufsml[4];                                                     \
     };                                                                        \
     struct {                                                                  \
       double atime;                                                           \
@@ -661,6 +661,23 @@ UV_EXTERN int uv_write(uv_write_t* req, uv_stream_t* handle,
 UV_EXTERN int uv_write2(uv_write_t* req, uv_stream_t* handle, uv_buf_t bufs[],
     int bufcnt, uv_stream_t* send_handle, uv_write_cb cb);
 
+/*
+ * Write `length` bytes of `file`, starting at `offset`, to the stream. The
+ * data goes straight from the page cache to the socket with sendfile(2) and
+ * is written in order with the requests made with uv_write(). The file
+ * position is not changed.
+ *
+ * sendfile(2) is called on the loop thread when the stream is writable, at
+ * most 1 MB at a time. When that part of the file is not in the page cache
+ * it is read in on the threadpool first, so a cold file doesn't block the
+ * loop. Blocking streams (e.g. stdio pipes) skip that step.
+ *
+ * The callback gets UV_EOF when the file is shorter than `offset + length`.
+ * Returns UV_ENOTSUP on platforms that don't support it (Windows).
+ */
+UV_EXTERN int uv_sendfile(uv_write_t* req, uv_stream_t* handle, uv_file file,
+    int64_t offset, size_t length, uv_write_cb cb);
+
 /* uv_write_t is a subclass of uv_req_t */
 struct uv_write_s {
   UV_REQ_FIELDS
@@ -753,6 +770,16 @@ UV_EXTERN int uv_tcp_keepalive(uv_tcp_t* handle,
  */
 UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
+/*
+ * Enable/disable SO_REUSEPORT. Lets several sockets, possibly in different
+ * processes, bind to and listen on the same address and port. On Linux the
+ * kernel balances incoming connections over the listening sockets.
+ *
+ * Call before uv_tcp_bind() or the option won't have effect. Returns
+ * UV_ENOTSUP when the platform or the kernel doesn't support it.
+ */
+UV_EXTERN int uv_tcp_reuseport(uv_tcp_t* handle, int enable);
+
 UV_EXTERN int uv_tcp_bind(uv_tcp_t* handle, struct sockaddr_in);
 UV_EXTERN int uv_tcp_bind6(uv_tcp_t* handle, struct sockaddr_in6);
 UV_EXTERN int uv_tcp_getsockname(uv_tcp_t* handle, struct sockaddr* name,
@@ -791,7 +818,13 @@ enum uv_udp_flags {
    * Indicates message was truncated because read buffer was too small. The
    * remainder was discarded by the OS. Used in uv_udp_recv_cb.
    */
-  UV_UDP_PARTIAL = 2
+  UV_UDP_PARTIAL = 2,
+  /*
+   * Indicates that the message was received as part of a batch started with
+   * uv_udp_recv_batch_start() and that buf points into the buffer that was
+   * allocated for the whole batch. Do not free it. Used in uv_udp_recv_cb.
+   */
+  UV_UDP_MMSG_CHUNK = 4
 };
 
 /*
@@ -812,7 +845,7 @@ typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
  *  addr    struct sockaddr_in or struct sockaddr_in6.
  *          Valid for the duration of the callback only.
  *  flags   One or more OR'ed UV_UDP_* constants.
- *          Right now only UV_UDP_PARTIAL is used.
+ *          Right now only UV_UDP_PARTIAL and UV_UDP_MMSG_CHUNK are used.
  */
 typedef void (*uv_udp_recv_cb)(uv_udp_t* handle, ssize_t nread, uv_buf_t buf,
     struct sockaddr* addr, unsigned flags);
@@ -1004,6 +1037,35 @@ UV_EXTERN int uv_udp_send6(uv_udp_send_t* req, uv_udp_t* handle,
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloc_cb,
     uv_udp_recv_cb recv_cb);
 
+/*
+ * Like uv_udp_recv_start() but reads up to `nmsgs` datagrams with a single
+ * system call (recvmmsg() where available) into a single buffer.
+ *
+ * alloc_cb is called once per batch. The buffer it returns is split into
+ * `nmsgs` slots of equal size; datagrams that don't fit in a slot are
+ * truncated and reported with UV_UDP_PARTIAL. Every datagram in the batch
+ * is reported with UV_UDP_MMSG_CHUNK set and `buf` pointing into its slot.
+ * When the batch is done, recv_cb is called one last time with nread == 0,
+ * addr == NULL and the complete buffer so it can be released or reused.
+ * Errors are reported like they are by uv_udp_recv_start(), also with the
+ * complete buffer.
+ *
+ * At most 64 datagrams are read per batch; larger values of `nmsgs` are
+ * capped. Platforms without batched reads fall back to reading one datagram
+ * per alloc_cb call; recv_cb then never sees UV_UDP_MMSG_CHUNK.
+ *
+ * Arguments:
+ *  handle    UDP handle. Should have been initialized with `uv_udp_init`.
+ *  nmsgs     Maximum number of datagrams to read per batch. Must be > 0.
+ *  alloc_cb  Callback to invoke when temporary storage is needed.
+ *  recv_cb   Callback to invoke with received data.
+ *
+ * Returns:
+ *  0 on success, or an error code < 0 on failure.
+ */
+UV_EXTERN int uv_udp_recv_batch_start(uv_udp_t* handle, unsigned int nmsgs,
+    uv_alloc_cb alloc_cb, uv_udp_recv_cb recv_cb);
+
 /*
  * Stop listening for incoming datagrams.
  *
@@ -1490,6 +1552,12 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop, uv_work_t* req,
 /* Cancel a pending request. Fails if the request is executing or has finished
  * executing.
  *
+ * On Linux, most uv_fs_t requests are executed by the kernel through
+ * io_uring. Those can be cancelled until the loop submits them, which it
+ * does right before it polls for I/O. Afterwards they count as executing and
+ * uv_cancel() returns UV_EBUSY: unlike a request waiting for the thread pool,
+ * one can't be cancelled anymore after a turn of the loop.
+ *
  * Returns 0 on success, or an error code < 0 on failure.
  *
  * Only cancellation of uv_fs_t, uv_getaddrinfo_t and uv_work_t requests is
@@ -1601,7 +1669,9 @@ typedef enum {
   UV_FS_SYMLINK,
   UV_FS_READLINK,
   UV_FS_CHOWN,
-  UV_FS_FCHOWN
+  UV_FS_FCHOWN,
+  UV_FS_READV,
+  UV_FS_WRITEV
 } uv_fs_type;
 
 /* uv_fs_t is a subclass of uv_req_t */
@@ -1634,6 +1704,19 @@ UV_EXTERN int uv_fs_unlink(uv_loop_t* loop, uv_fs_t* req, const char* path,
 UV_EXTERN int uv_fs_write(uv_loop_t* loop, uv_fs_t* req, uv_file file,
     const void* buf, size_t length, int64_t offset, uv_fs_cb cb);
 
+/*
+ * Scatter/gather versions of uv_fs_read() and uv_fs_write(). The bufs array
+ * is copied, the memory it points to must stay valid until the callback is
+ * made. The result is the total number of bytes read or written, which is
+ * less than the sum of the buffer lengths when the file ends or the disk is
+ * full. An offset of -1 uses the current file position.
+ */
+UV_EXTERN int uv_fs_readv(uv_loop_t* loop, uv_fs_t* req, uv_file file,
+    const uv_buf_t bufs[], unsigned int nbufs, int64_t offset, uv_fs_cb cb);
+
+UV_EXTERN int uv_fs_writev(uv_loop_t* loop, uv_fs_t* req, uv_file file,
+    const uv_buf_t bufs[], unsigned int nbufs, int64_t offset, uv_fs_cb cb);
+
 UV_EXTERN int uv_fs_mkdir(uv_loop_t* loop, uv_fs_t* req, const char* path,
     int mode, uv_fs_cb cb);
 
@@ -1745,6 +1828,13 @@ UV_EXTERN int uv_fs_poll_init(uv_loop_t* loop, uv_fs_poll_t* handle);
  *
  * For maximum portability, use multi-second intervals. Sub-second intervals
  * will not detect all changes on many file systems.
+ *
+ * On Linux, files on local file systems are watched with inotify and only
+ * stat()ed when the kernel reports a change, but not more often than every
+ * `interval` milliseconds. Renaming a parent directory or changing a
+ * symlink in `path` is not noticed until the file itself changes. The
+ * file system type is checked on the thread pool after the first successful
+ * stat(), the inotify watch is then added on the loop thread.
  */
 UV_EXTERN int uv_fs_poll_start(uv_fs_poll_t* handle,
                                uv_fs_poll_cb poll_cb,
@@ -23,12 +23,30 @@
 #include "uv-common.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* On Linux the path is watched with inotify when the file system supports it
+ * and only stat()ed when the kernel reports a change, the interval is then
+ * the minimum time between two stat() calls. Polling takes over when the
+ * file doesn't exist or can't be watched.
+ *
+ * The statfs() that decides whether inotify can be trusted runs on the
+ * threadpool, network file systems can take arbitrarily long to answer it.
+ * It is only tried after a successful stat(), the watch is then added from
+ * the loop thread. inotify_add_watch() does a path lookup too, but the
+ * stat() has just brought the path into the dentry cache.
+ */
+#if defined(__linux__)
+# include <sys/vfs.h>
+# define UV__FS_POLL_INOTIFY 1
+#endif
+
 struct poll_ctx {
   uv_fs_poll_t* parent_handle; /* NULL if parent has been stopped or closed */
   int busy_polling;
+  int stat_pending;
   unsigned int interval;
   uint64_t start_time;
   uv_loop_t* loop;
@@ -36,13 +54,40 @@ struct poll_ctx {
   uv_timer_t timer_handle;
   uv_fs_t fs_req; /* TODO(bnoordhuis) mark fs_req internal */
   uv_stat_t statbuf;
+#if defined(UV__FS_POLL_INOTIFY)
+  uv_fs_event_t* event_handle; /* NULL if the path isn't watched */
+  int event_unsupported; /* don't try to watch the path again */
+  int event_probe_pending; /* statfs() on the threadpool */
+  int event_probe_result;
+  int event_dirty; /* a change was reported while a stat() was running */
+  int event_bound; /* event_dev and event_ino are set */
+  uint64_t event_dev;
+  uint64_t event_ino;
+  uv_work_t event_probe_req;
+#endif
   char path[1]; /* variable length */
 };
 
 static int statbuf_eq(const uv_stat_t* a, const uv_stat_t* b);
+static void start_stat(struct poll_ctx* ctx);
 static void poll_cb(uv_fs_t* req);
 static void timer_cb(uv_timer_t* timer, int status);
 static void timer_close_cb(uv_handle_t* handle);
+static int close_pending(struct poll_ctx* ctx);
+
+#if defined(UV__FS_POLL_INOTIFY)
+static void event_probe(struct poll_ctx* ctx);
+static void event_probe_work(uv_work_t* req);
+static void event_probe_done(uv_work_t* req, int status);
+static void event_start(struct poll_ctx* ctx);
+static void event_stop(struct poll_ctx* ctx);
+static void event_schedule(struct poll_ctx* ctx);
+static void event_cb(uv_fs_event_t* handle,
+                     const char* filename,
+                     int events,
+                     int status);
+static void event_close_cb(uv_handle_t* handle);
+#endif
 
 static uv_stat_t zero_statbuf;
 
@@ -84,8 +129,7 @@ int uv_fs_poll_start(uv_fs_poll_t* handle,
   ctx->timer_handle.flags |= UV__HANDLE_INTERNAL;
   uv__handle_unref(&ctx->timer_handle);
 
-  if (uv_fs_stat(loop, &ctx->fs_req, ctx->path, poll_cb))
-    abort();
+  start_stat(ctx);
 
   handle->poll_ctx = ctx;
   uv__handle_start(handle);
@@ -106,10 +150,14 @@ int uv_fs_poll_stop(uv_fs_poll_t* handle) {
   ctx->parent_handle = NULL;
   handle->poll_ctx = NULL;
 
-  /* Close the timer if it's active. If it's inactive, there's a stat request
-   * in progress and poll_cb will take care of the cleanup.
+#if defined(UV__FS_POLL_INOTIFY)
+  event_stop(ctx);
+#endif
+
+  /* Close the timer unless there's a stat request or statfs() in progress,
+   * the last one to finish will take care of the cleanup then.
    */
-  if (uv__is_active(&ctx->timer_handle))
+  if (!close_pending(ctx))
     uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
 
   uv__handle_stop(handle);
@@ -123,16 +171,22 @@ void uv__fs_poll_close(uv_fs_poll_t* handle) {
 }
 
 
+static void start_stat(struct poll_ctx* ctx) {
+  ctx->start_time = uv_now(ctx->loop);
+  ctx->stat_pending = 1;
+
+  if (uv_fs_stat(ctx->loop, &ctx->fs_req, ctx->path, poll_cb))
+    abort();
+}
+
+
 static void timer_cb(uv_timer_t* timer, int status) {
   struct poll_ctx* ctx;
 
   ctx = container_of(timer, struct poll_ctx, timer_handle);
   assert(ctx->parent_handle != NULL);
   assert(ctx->parent_handle->poll_ctx == ctx);
-  ctx->start_time = uv_now(ctx->loop);
-
-  if (uv_fs_stat(ctx->loop, &ctx->fs_req, ctx->path, poll_cb))
-    abort();
+  start_stat(ctx);
 }
 
 
@@ -144,7 +198,9 @@ static void poll_cb(uv_fs_t* req) {
   ctx = container_of(req, struct poll_ctx, fs_req);
 
   if (ctx->parent_handle == NULL) { /* handle has been stopped or closed */
-    uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
+    ctx->stat_pending = 0;
+    if (!close_pending(ctx))
+      uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
     uv_fs_req_cleanup(req);
     return;
   }
@@ -171,12 +227,43 @@ static void poll_cb(uv_fs_t* req) {
 
 out:
   uv_fs_req_cleanup(req);
+  ctx->stat_pending = 0;
 
   if (ctx->parent_handle == NULL) { /* handle has been stopped by callback */
-    uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
+    if (!close_pending(ctx))
+      uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
     return;
   }
 
+#if defined(UV__FS_POLL_INOTIFY)
+  if (ctx->event_handle != NULL) {
+    /* The first stat() after the watch was added tells which file it is. */
+    if (req->result == 0 && !ctx->event_bound) {
+      ctx->event_dev = ctx->statbuf.st_dev;
+      ctx->event_ino = ctx->statbuf.st_ino;
+      ctx->event_bound = 1;
+    }
+
+    if (req->result == 0 &&
+        ctx->event_dev == ctx->statbuf.st_dev &&
+        ctx->event_ino == ctx->statbuf.st_ino) {
+      if (ctx->event_dirty) {
+        ctx->event_dirty = 0;
+        event_schedule(ctx);
+      }
+      return;
+    }
+
+    /* The path is gone or now points at another file. Poll until the next
+     * stat() can watch it again.
+     */
+    event_stop(ctx);
+  }
+
+  if (req->result == 0)
+    event_probe(ctx);
+#endif
+
   /* Reschedule timer, subtract the delay from doing the stat(). */
   interval = ctx->interval;
   interval -= (uv_now(ctx->loop) - ctx->start_time) % interval;
@@ -191,6 +278,184 @@ static void timer_close_cb(uv_handle_t* handle) {
 }
 
 
+/* Nonzero while a request still refers to the poll_ctx. */
+static int close_pending(struct poll_ctx* ctx) {
+#if defined(UV__FS_POLL_INOTIFY)
+  if (ctx->event_probe_pending)
+    return 1;
+#endif
+  return ctx->stat_pending;
+}
+
+
+#if defined(UV__FS_POLL_INOTIFY)
+
+/* inotify only sees changes made through the local kernel, network file
+ * systems and the like are polled.
+ */
+static int event_supported(const char* path) {
+  struct statfs s;
+
+  if (statfs(path, &s))
+    return -errno;
+
+  switch ((uint32_t) s.f_type) {
+    case 0x6969:      /* NFS */
+    case 0x517B:      /* SMB */
+    case 0xFF534D42:  /* CIFS */
+    case 0xFE534D42:  /* SMB2 */
+    case 0x73757245:  /* CODA */
+    case 0x5346414F:  /* AFS */
+    case 0x00C36400:  /* CEPH */
+    case 0x65735546:  /* FUSE */
+    case 0x01021997:  /* 9P */
+    case 0x9FA0:      /* PROC */
+    case 0x62656572:  /* SYSFS */
+      return 0;
+  }
+
+  return 1;
+}
+
+
+static void event_probe(struct poll_ctx* ctx) {
+  if (ctx->event_handle != NULL ||
+      ctx->event_unsupported ||
+      ctx->event_probe_pending) {
+    return;
+  }
+
+  ctx->event_probe_pending = 1;
+
+  if (uv_queue_work(ctx->loop,
+                    &ctx->event_probe_req,
+                    event_probe_work,
+                    event_probe_done)) {
+    abort();
+  }
+}
+
+
+static void event_probe_work(uv_work_t* req) {
+  struct poll_ctx* ctx;
+
+  ctx = container_of(req, struct poll_ctx, event_probe_req);
+  ctx->event_probe_result = event_supported(ctx->path);
+}
+
+
+static void event_probe_done(uv_work_t* req, int status) {
+  struct poll_ctx* ctx;
+
+  ctx = container_of(req, struct poll_ctx, event_probe_req);
+  ctx->event_probe_pending = 0;
+
+  if (ctx->parent_handle == NULL) { /* handle has been stopped or closed */
+    if (!close_pending(ctx))
+      uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
+    return;
+  }
+
+  if (ctx->event_probe_result < 0)
+    return; /* Gone again, try after the next successful poll. */
+
+  if (ctx->event_probe_result == 0) {
+    ctx->event_unsupported = 1;
+    return;
+  }
+
+  event_start(ctx);
+}
+
+
+/* Called after a stat() has succeeded. The path can have changed since, the
+ * timer that is already running stat()s it again and that stat() tells which
+ * file is watched.
+ */
+static void event_start(struct poll_ctx* ctx) {
+  uv_fs_event_t* handle;
+  int err;
+
+  if (ctx->event_handle != NULL)
+    return;
+
+  handle = malloc(sizeof(*handle));
+  if (handle == NULL)
+    return;
+
+  err = uv_fs_event_init(ctx->loop, handle, ctx->path, event_cb, 0);
+  if (err) {
+    free(handle);
+    /* Out of inotify watches, keep polling. */
+    if (err == -ENOSPC || err == -ENOMEM)
+      ctx->event_unsupported = 1;
+    return;
+  }
+
+  handle->flags |= UV__HANDLE_INTERNAL;
+  uv__handle_unref(handle);
+  handle->data = ctx;
+
+  ctx->event_handle = handle;
+  ctx->event_bound = 0;
+
+  /* A stat() that started before the watch was added can't bind it, have
+   * poll_cb schedule another one.
+   */
+  ctx->event_dirty = ctx->stat_pending;
+}
+
+
+static void event_stop(struct poll_ctx* ctx) {
+  if (ctx->event_handle == NULL)
+    return;
+
+  uv_close((uv_handle_t*)ctx->event_handle, event_close_cb);
+  ctx->event_handle = NULL;
+}
+
+
+/* stat() the path again, but not more often than every interval. */
+static void event_schedule(struct poll_ctx* ctx) {
+  uint64_t elapsed;
+  uint64_t delay;
+
+  if (ctx->stat_pending) {
+    ctx->event_dirty = 1;
+    return;
+  }
+
+  if (uv__is_active(&ctx->timer_handle))
+    return;
+
+  elapsed = uv_now(ctx->loop) - ctx->start_time;
+  delay = elapsed < ctx->interval ? ctx->interval - elapsed : 0;
+
+  if (uv_timer_start(&ctx->timer_handle, timer_cb, delay, 0))
+    abort();
+}
+
+
+static void event_cb(uv_fs_event_t* handle,
+                     const char* filename,
+                     int events,
+                     int status) {
+  struct poll_ctx* ctx;
+
+  ctx = handle->data;
+  assert(ctx->event_handle == handle);
+  assert(ctx->parent_handle != NULL);
+  event_schedule(ctx);
+}
+
+
+static void event_close_cb(uv_handle_t* handle) {
+  free(handle);
+}
+
+#endif /* UV__FS_POLL_INOTIFY */
+
+
 static int statbuf_eq(const uv_stat_t* a, const uv_stat_t* b) {
   return a->st_ctim.tv_nsec == b->st_ctim.tv_nsec
       && a->st_mtim.tv_nsec == b->st_mtim.tv_nsec
@@ -43,6 +43,7 @@
 #include <fcntl.h>
 #include <utime.h>
 #include <poll.h>
+#include <sys/uio.h>
 
 #if defined(__linux__) || defined(__sun)
 # include <sys/sendfile.h>
@@ -60,10 +61,25 @@
     (req)->loop = loop;                                                       \
     (req)->path = NULL;                                                       \
     (req)->new_path = NULL;                                                   \
+    (req)->bufs = NULL;                                                       \
     (req)->cb = (cb);                                                         \
   }                                                                           \
   while (0)
 
+#define BUFS                                                                  \
+  do {                                                                        \
+    (req)->nbufs = (nbufs);                                                   \
+    (req)->bufs = (req)->bufsml;                                              \
+    if ((nbufs) > ARRAY_SIZE((req)->bufsml))                                  \
+      (req)->bufs = malloc((nbufs) * sizeof(*(bufs)));                        \
+    if ((req)->bufs == NULL) {                                                \
+      uv__req_unregister((loop), (req));                                      \
+      return -ENOMEM;                                                         \
+    }                                                                         \
+    memcpy((req)->bufs, (bufs), (nbufs) * sizeof(*(bufs)));                   \
+  }                                                                           \
+  while (0)
+
 #define PATH                                                                  \
   do {                                                                        \
     (req)->path = strdup(path);                                               \
@@ -90,7 +106,13 @@
 #define POST                                                                  \
   do {                                                                        \
     if ((cb) != NULL) {                                                       \
-      uv__work_submit((loop), &(req)->work_req, uv__fs_work, uv__fs_done);    \
+      if (uv__iou_fs_submit((loop), (req), uv__fs_done) == 0)                 \
+        return 0;                                                             \
+      uv__work_submit((loop),                                                 \
+                      &(req)->work_req,                                       \
+                      uv__fs_work_kind((req)->fs_type),                       \
+                      uv__fs_work,                                            \
+                      uv__fs_done);                                           \
       return 0;                                                               \
     }                                                                         \
     else {                                                                    \
@@ -102,6 +124,25 @@
   while (0)
 
 
+/* Requests that move file data around can take a long time on a busy disk,
+ * the rest only touch metadata.
+ */
+static enum uv__work_kind uv__fs_work_kind(uv_fs_type fs_type) {
+  switch (fs_type) {
+  case UV_FS_READ:
+  case UV_FS_READV:
+  case UV_FS_WRITE:
+  case UV_FS_WRITEV:
+  case UV_FS_SENDFILE:
+  case UV_FS_FSYNC:
+  case UV_FS_FDATASYNC:
+    return UV__WORK_SLOW_FS;
+  default:
+    return UV__WORK_FAST_FS;
+  }
+}
+
+
 static ssize_t uv__fs_fdatasync(uv_fs_t* req) {
 #if defined(__linux__) || defined(__sun) || defined(__NetBSD__)
   return fdatasync(req->file);
@@ -192,6 +233,73 @@ static ssize_t uv__fs_read(uv_fs_t* req) {
 }
 
 
+/* Reads or writes the buffers uv__getiovmax() at a time. Stops early when
+ * the file ends or the disk fills up and returns what was transferred so
+ * far, an error is only reported when nothing was.
+ */
+static ssize_t uv__fs_rwv(uv_fs_t* req, int write) {
+  struct iovec* iov;
+  unsigned int iovmax;
+  unsigned int nbufs;
+  unsigned int n;
+  unsigned int i;
+  ssize_t total;
+  ssize_t want;
+  ssize_t r;
+
+  iov = (struct iovec*) req->bufs;
+  nbufs = req->nbufs;
+  iovmax = uv__getiovmax();
+  total = 0;
+
+  while (nbufs > 0) {
+    n = nbufs < iovmax ? nbufs : iovmax;
+    want = 0;
+    for (i = 0; i < n; i++)
+      want += iov[i].iov_len;
+
+    if (req->off < 0) {
+      if (write)
+        r = writev(req->file, iov, n);
+      else
+        r = readv(req->file, iov, n);
+    } else {
+#if defined(__linux__) || defined(__FreeBSD__)
+      if (write)
+        r = pwritev(req->file, iov, n, req->off + total);
+      else
+        r = preadv(req->file, iov, n, req->off + total);
+#else
+      /* No preadv() and pwritev(), do one buffer at a time. */
+      n = 1;
+      want = iov[0].iov_len;
+      if (write)
+        r = pwrite(req->file, iov[0].iov_base, want, req->off + total);
+      else
+        r = pread(req->file, iov[0].iov_base, want, req->off + total);
+#endif
+    }
+
+    if (r == -1)
+      return total > 0 ? total : -1;
+
+    total += r;
+    if (r < want)
+      break;
+
+    iov += n;
+    nbufs -= n;
+  }
+
+  return total;
+}
+
+
+static ssize_t uv__fs_readv(uv_fs_t* req) {
+  return uv__fs_rwv(req, 0);
+}
+
+
 static int uv__fs_readdir_filter(const struct dirent* dent) {
   return strcmp(dent->d_name, ".") != 0 && strcmp(dent->d_name, "..") != 0;
 }
@@ -505,6 +613,24 @@ static ssize_t uv__fs_write(uv_fs_t* req) {
   return r;
 }
 
+
+static ssize_t uv__fs_writev(uv_fs_t* req) {
+  ssize_t r;
+
+#if defined(__APPLE__)
+  static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_mutex_lock(&lock);
+#endif
+
+  r = uv__fs_rwv(req, 1);
+
+#if defined(__APPLE__)
+  pthread_mutex_unlock(&lock);
+#endif
+
+  return r;
+}
+
 static void uv__to_stat(struct stat* src, uv_stat_t* dst) {
   dst->st_dev = src->st_dev;
   dst->st_mode = src->st_mode;
@@ -623,6 +749,7 @@ static void uv__fs_work(struct uv__work* w) {
     X(MKDIR, mkdir(req->path, req->mode));
     X(OPEN, open(req->path, req->flags, req->mode));
     X(READ, uv__fs_read(req));
+    X(READV, uv__fs_readv(req));
     X(READDIR, uv__fs_readdir(req));
     X(READLINK, uv__fs_readlink(req));
     X(RENAME, rename(req->path, req->new_path));
@@ -633,6 +760,7 @@ static void uv__fs_work(struct uv__work* w) {
     X(UNLINK, unlink(req->path));
     X(UTIME, uv__fs_utime(req));
     X(WRITE, uv__fs_write(req));
+    X(WRITEV, uv__fs_writev(req));
     default: abort();
     }
 
@@ -659,6 +787,10 @@ static void uv__fs_done(struct uv__work* w, int status) {
   req = container_of(w, uv_fs_t, work_req);
   uv__req_unregister(req->loop, req);
 
+  if (req->bufs != req->bufsml)
+    free(req->bufs);
+  req->bufs = NULL;
+
   if (status == -ECANCELED) {
     assert(req->result == 0);
     req->result = -ECANCELED;
@@ -834,6 +966,21 @@ int uv_fs_read(uv_loop_t* loop, uv_fs_t* req,
 }
 
 
+int uv_fs_readv(uv_loop_t* loop,
+                uv_fs_t* req,
+                uv_file file,
+                const uv_buf_t bufs[],
+                unsigned int nbufs,
+                int64_t off,
+                uv_fs_cb cb) {
+  INIT(READV);
+  req->file = file;
+  req->off = off;
+  BUFS;
+  POST;
+}
+
+
 int uv_fs_readdir(uv_loop_t* loop,
                   uv_fs_t* req,
                   const char* path,
@@ -947,6 +1094,21 @@ int uv_fs_write(uv_loop_t* loop,
 }
 
 
+int uv_fs_writev(uv_loop_t* loop,
+                 uv_fs_t* req,
+                 uv_file file,
+                 const uv_buf_t bufs[],
+                 unsigned int nbufs,
+                 int64_t off,
+                 uv_fs_cb cb) {
+  INIT(WRITEV);
+  req->file = file;
+  req->off = off;
+  BUFS;
+  POST;
+}
+
+
 void uv_fs_req_cleanup(uv_fs_t* req) {
   free((void*) req->path);
   req->path = NULL;
@@ -111,7 +111,9 @@ enum {
   UV_STREAM_READ_EOF      = 0x200,  /* read(2) read EOF. */
   UV_TCP_NODELAY          = 0x400,  /* Disable Nagle. */
   UV_TCP_KEEPALIVE        = 0x800,  /* Turn on keep-alive. */
-  UV_TCP_SINGLE_ACCEPT    = 0x1000  /* Only accept() when idle. */
+  UV_TCP_SINGLE_ACCEPT    = 0x1000, /* Only accept() when idle. */
+  UV_TCP_REUSEPORT        = 0x10000, /* Set SO_REUSEPORT before bind(). */
+  UV_STREAM_SENDFILE_WARM = 0x20000  /* File read in, sendfile(2) right away. */
 };
 
 /* core */
@@ -119,6 +121,7 @@ int uv__nonblock(int fd, int set);
 int uv__cloexec(int fd, int set);
 int uv__socket(int domain, int type, int protocol);
 int uv__dup(int fd);
+int uv__getiovmax(void);
 void uv__make_close_pending(uv_handle_t* handle);
 
 void uv__io_init(uv__io_t* w, uv__io_cb cb, int fd);
@@ -157,6 +160,7 @@ int uv__accept(int sockfd);
 int uv_tcp_listen(uv_tcp_t* tcp, int backlog, uv_connection_cb cb);
 int uv__tcp_nodelay(int fd, int on);
 int uv__tcp_keepalive(int fd, int on, unsigned int delay);
+int uv__tcp_reuseport(int fd, int on);
 
 /* pipe */
 int uv_pipe_listen(uv_pipe_t* handle, int backlog, uv_connection_cb cb);
@@ -171,8 +175,22 @@ void uv__signal_global_once_init(void);
 void uv__signal_loop_cleanup(uv_loop_t* loop);
 
 /* thread pool */
+enum uv__work_kind {
+  UV__WORK_FAST_FS,
+  UV__WORK_SLOW_FS,
+  UV__WORK_DNS,
+  UV__WORK_CPU,
+  UV__WORK_NKINDS
+};
+
+/* Not a thread pool queue, marks fs requests that go to the kernel (io_uring
+ * on Linux). They can be cancelled until they are submitted.
+ */
+#define UV__WORK_KERNEL UV__WORK_NKINDS
+
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work *w,
+                     enum uv__work_kind kind,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 void uv__work_done(uv_async_t* handle, int status);
@@ -214,6 +232,18 @@ int uv___stream_fd(uv_stream_t* handle);
 int uv__make_socketpair(int fds[2], int flags);
 int uv__make_pipe(int fds[2], int flags);
 
+#if defined(__linux__)
+int uv__iou_fs_submit(uv_loop_t* loop,
+                      uv_fs_t* req,
+                      void (*done)(struct uv__work* w, int status));
+int uv__iou_fs_cancel(uv_loop_t* loop, uv_fs_t* req);
+int uv__iou_flush(uv_loop_t* loop);
+void uv__iou_delete(uv_loop_t* loop);
+#else
+# define uv__iou_fs_submit(loop, req, done) (-ENOSYS)
+# define uv__iou_fs_cancel(loop, req) (-EBUSY)
+#endif
+
 #if defined(__APPLE__)
 typedef void (*cf_loop_signal_cb)(void*);
 
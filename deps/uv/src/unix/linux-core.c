@@ -87,6 +87,7 @@ int uv__platform_loop_init(uv_loop_t* loop, int default_loop) {
   loop->backend_fd = fd;
   loop->inotify_fd = -1;
   loop->inotify_watchers = NULL;
+  loop->iou = NULL;
 
   if (fd == -1)
     return -errno;
@@ -96,6 +97,8 @@ int uv__platform_loop_init(uv_loop_t* loop, int default_loop) {
 
 
 void uv__platform_loop_delete(uv_loop_t* loop) {
+  uv__iou_delete(loop);
+
   if (loop->inotify_fd == -1) return;
   uv__io_stop(loop, &loop->inotify_read_watcher, UV__POLLIN);
   close(loop->inotify_fd);
@@ -163,6 +166,12 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   count = 48; /* Benchmarks suggest this gives the best throughput. */
 
   for (;;) {
+    /* Hand the fs requests queued since the last poll to the kernel. Don't
+     * block if some of them couldn't be submitted yet.
+     */
+    if (uv__iou_flush(loop))
+      timeout = 0;
+
     nfds = uv__epoll_wait(loop->backend_fd,
                           events,
                           ARRAY_SIZE(events),
@@ -0,0 +1,538 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Asynchronous fs requests go to the kernel through io_uring instead of the
+ * thread pool when the kernel supports it (Linux 5.6 and up). Submissions are
+ * collected while the loop runs callbacks and handed over in one
+ * io_uring_enter() call right before the loop polls for I/O. Completions are
+ * reaped when the ring's file descriptor becomes readable.
+ *
+ * Operations the ring doesn't handle, rings that can't be set up (old kernel,
+ * seccomp) and requests beyond the completion queue's capacity keep using the
+ * thread pool. UV_USE_IO_URING=0 in the environment turns the ring off.
+ *
+ * uv_cancel() works on requests that haven't been submitted yet.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/sysmacros.h>  /* makedev() */
+#include <unistd.h>
+
+#define UV__IOU_SQ_ENTRIES  256
+#define UV__IOU_CQ_ENTRIES  4096  /* Also caps the requests in flight. */
+
+/* Tags the user_data of a cancelled request, uv_fs_t pointers are aligned. */
+#define UV__IOU_CANCELLED   1
+
+#define UV__AT_FDCWD              -100
+#define UV__AT_SYMLINK_NOFOLLOW   0x100
+#define UV__AT_EMPTY_PATH         0x1000
+
+STATIC_ASSERT(64 == sizeof(struct uv__io_uring_sqe));
+STATIC_ASSERT(16 == sizeof(struct uv__io_uring_cqe));
+STATIC_ASSERT(120 == sizeof(struct uv__io_uring_params));
+STATIC_ASSERT(256 == sizeof(struct uv__statx));
+
+struct uv__iou {
+  uv__io_t watcher;
+  uint32_t* sqhead;
+  uint32_t* sqtail;
+  uint32_t sqmask;
+  uint32_t sqentries;
+  struct uv__io_uring_sqe* sqes;
+  uint32_t* cqhead;
+  uint32_t* cqtail;
+  uint32_t cqmask;
+  struct uv__io_uring_cqe* cqes;
+  char* ring;
+  size_t ringsize;
+  size_t sqessize;
+  uint32_t unsubmitted;
+  uint32_t in_flight;  /* Including the unsubmitted ones. */
+  uint32_t max_in_flight;
+};
+
+/* loop->iou after a failed setup, so it's only attempted once per loop. */
+static char uv__iou_unavailable;
+
+static void uv__iou_poll(uv_loop_t* loop, uv__io_t* w, unsigned int events);
+
+
+static struct uv__iou* uv__iou_init(uv_loop_t* loop) {
+  struct uv__io_uring_params params;
+  struct uv__iou* iou;
+  const char* val;
+  uint32_t required;
+  uint32_t* sqarray;
+  size_t sqsize;
+  size_t cqsize;
+  size_t ringsize;
+  size_t sqessize;
+  char* ring;
+  void* sqes;
+  uint32_t i;
+  int fd;
+
+  val = getenv("UV_USE_IO_URING");
+  if (val != NULL && atoi(val) == 0)
+    return NULL;
+
+  memset(&params, 0, sizeof(params));
+  params.flags = UV__IORING_SETUP_CQSIZE;
+  params.cq_entries = UV__IOU_CQ_ENTRIES;
+
+  fd = uv__io_uring_setup(UV__IOU_SQ_ENTRIES, &params);
+  if (fd == -1)
+    return NULL;
+
+  /* IORING_FEAT_RW_CUR_POS came with the open, close and statx operations
+   * in Linux 5.6.
+   */
+  required = UV__IORING_FEAT_SINGLE_MMAP |
+             UV__IORING_FEAT_NODROP |
+             UV__IORING_FEAT_RW_CUR_POS;
+  if ((params.features & required) != required)
+    goto fail_fd;
+
+  sqsize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cqsize = params.cq_off.cqes +
+           params.cq_entries * sizeof(struct uv__io_uring_cqe);
+  ringsize = sqsize > cqsize ? sqsize : cqsize;
+  sqessize = params.sq_entries * sizeof(struct uv__io_uring_sqe);
+
+  ring = mmap(NULL,
+              ringsize,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED,
+              fd,
+              UV__IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED)
+    goto fail_fd;
+
+  sqes = mmap(NULL,
+              sqessize,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED,
+              fd,
+              UV__IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    goto fail_ring;
+
+  iou = malloc(sizeof(*iou));
+  if (iou == NULL)
+    goto fail_sqes;
+
+  iou->sqhead = (uint32_t*) (ring + params.sq_off.head);
+  iou->sqtail = (uint32_t*) (ring + params.sq_off.tail);
+  iou->sqmask = *(uint32_t*) (ring + params.sq_off.ring_mask);
+  iou->sqentries = params.sq_entries;
+  iou->sqes = sqes;
+  iou->cqhead = (uint32_t*) (ring + params.cq_off.head);
+  iou->cqtail = (uint32_t*) (ring + params.cq_off.tail);
+  iou->cqmask = *(uint32_t*) (ring + params.cq_off.ring_mask);
+  iou->cqes = (struct uv__io_uring_cqe*) (ring + params.cq_off.cqes);
+  iou->ring = ring;
+  iou->ringsize = ringsize;
+  iou->sqessize = sqessize;
+  iou->unsubmitted = 0;
+  iou->in_flight = 0;
+  iou->max_in_flight = params.cq_entries;
+
+  /* SQEs are used in ring order, the index array never changes. */
+  sqarray = (uint32_t*) (ring + params.sq_off.array);
+  for (i = 0; i < params.sq_entries; i++)
+    sqarray[i] = i;
+
+  uv__io_init(&iou->watcher, uv__iou_poll, fd);
+  uv__io_start(loop, &iou->watcher, UV__POLLIN);
+
+  return iou;
+
+fail_sqes:
+  munmap(sqes, sqessize);
+fail_ring:
+  munmap(ring, ringsize);
+fail_fd:
+  close(fd);
+  return NULL;
+}
+
+
+static struct uv__iou* uv__iou_get(uv_loop_t* loop) {
+  if (loop->iou == NULL) {
+    loop->iou = uv__iou_init(loop);
+    if (loop->iou == NULL)
+      loop->iou = &uv__iou_unavailable;
+  }
+
+  if (loop->iou == &uv__iou_unavailable)
+    return NULL;
+
+  return loop->iou;
+}
+
+
+void uv__iou_delete(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  iou = loop->iou;
+  loop->iou = NULL;
+
+  if (iou == NULL || iou == (void*) &uv__iou_unavailable)
+    return;
+
+  uv__io_stop(loop, &iou->watcher, UV__POLLIN);
+  munmap(iou->sqes, iou->sqessize);
+  munmap(iou->ring, iou->ringsize);
+  close(iou->watcher.fd);
+  free(iou);
+}
+
+
+/* Returns 0 when everything was submitted. A nonzero return means some
+ * requests are still waiting for the kernel to accept them and the caller
+ * shouldn't block in the poll.
+ */
+int uv__iou_flush(uv_loop_t* loop) {
+  struct uv__iou* iou;
+  int rc;
+
+  iou = loop->iou;
+  if (iou == NULL || iou == (void*) &uv__iou_unavailable)
+    return 0;
+
+  if (iou->unsubmitted == 0)
+    return 0;
+
+  do
+    rc = uv__io_uring_enter(iou->watcher.fd, iou->unsubmitted, 0, 0);
+  while (rc == -1 && errno == EINTR);
+
+  if (rc == -1) {
+    /* Short on kernel memory, try again on the next poll. */
+    if (errno == EAGAIN || errno == EBUSY)
+      return -errno;
+    abort();
+  }
+
+  iou->unsubmitted -= rc;
+  if (iou->unsubmitted != 0)
+    return -EAGAIN;
+
+  return 0;
+}
+
+
+static int uv__iou_fs_prep(uv_loop_t* loop,
+                           struct uv__iou* iou,
+                           uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__statx* statxbuf;
+  uint32_t tail;
+
+  if (iou->in_flight == iou->max_in_flight)
+    return -EBUSY;
+
+  tail = *iou->sqtail;
+  if (tail - __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE) == iou->sqentries)
+    if (uv__iou_flush(loop))
+      return -EBUSY;
+
+  statxbuf = NULL;
+  if (req->fs_type == UV_FS_STAT ||
+      req->fs_type == UV_FS_LSTAT ||
+      req->fs_type == UV_FS_FSTAT) {
+    /* Still there when an interrupted request is retried. */
+    statxbuf = req->ptr;
+    if (statxbuf == NULL)
+      statxbuf = malloc(sizeof(*statxbuf));
+    if (statxbuf == NULL)
+      return -ENOMEM;
+  }
+
+  sqe = iou->sqes + (tail & iou->sqmask);
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = (uintptr_t) req;
+
+  switch (req->fs_type) {
+  case UV_FS_CLOSE:
+    sqe->opcode = UV__IORING_OP_CLOSE;
+    sqe->fd = req->file;
+    break;
+
+  case UV_FS_FDATASYNC:
+    sqe->op_flags = UV__IORING_FSYNC_DATASYNC;
+    /* Fall through. */
+  case UV_FS_FSYNC:
+    sqe->opcode = UV__IORING_OP_FSYNC;
+    sqe->fd = req->file;
+    break;
+
+  case UV_FS_OPEN:
+    sqe->opcode = UV__IORING_OP_OPENAT;
+    sqe->fd = UV__AT_FDCWD;
+    sqe->addr = (uintptr_t) req->path;
+    sqe->len = req->mode;
+    sqe->op_flags = req->flags;
+    break;
+
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (req->fs_type == UV_FS_READ)
+      sqe->opcode = UV__IORING_OP_READ;
+    else
+      sqe->opcode = UV__IORING_OP_WRITE;
+    sqe->fd = req->file;
+    sqe->addr = (uintptr_t) req->buf;
+    sqe->len = req->len;
+    /* An offset of -1 uses the file position, like read() and write(). */
+    sqe->off = req->off < 0 ? (uint64_t) -1 : (uint64_t) req->off;
+    break;
+
+  case UV_FS_READV:
+  case UV_FS_WRITEV:
+    if (req->fs_type == UV_FS_READV)
+      sqe->opcode = UV__IORING_OP_READV;
+    else
+      sqe->opcode = UV__IORING_OP_WRITEV;
+    sqe->fd = req->file;
+    sqe->addr = (uintptr_t) req->bufs;  /* uv_buf_t is a struct iovec. */
+    sqe->len = req->nbufs;
+    sqe->off = req->off < 0 ? (uint64_t) -1 : (uint64_t) req->off;
+    break;
+
+  case UV_FS_FSTAT:
+    sqe->fd = req->file;
+    sqe->addr = (uintptr_t) "";
+    sqe->op_flags = UV__AT_EMPTY_PATH;
+    goto statx;
+
+  case UV_FS_LSTAT:
+    sqe->op_flags = UV__AT_SYMLINK_NOFOLLOW;
+    /* Fall through. */
+  case UV_FS_STAT:
+    sqe->fd = UV__AT_FDCWD;
+    sqe->addr = (uintptr_t) req->path;
+  statx:
+    sqe->opcode = UV__IORING_OP_STATX;
+    sqe->len = UV__STATX_BASIC_STATS;
+    sqe->off = (uintptr_t) statxbuf;
+    req->ptr = statxbuf;
+    break;
+
+  default:
+    UNREACHABLE();
+  }
+
+  /* The position in the submission queue, for uv__iou_fs_cancel(). */
+  req->work_req.worker = tail;
+
+  __atomic_store_n(iou->sqtail, tail + 1, __ATOMIC_RELEASE);
+  iou->unsubmitted++;
+  iou->in_flight++;
+
+  return 0;
+}
+
+
+int uv__iou_fs_submit(uv_loop_t* loop,
+                      uv_fs_t* req,
+                      void (*done)(struct uv__work* w, int status)) {
+  struct uv__iou* iou;
+
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (req->len > INT32_MAX)
+      return -ENOSYS;
+    break;
+  case UV_FS_READV:
+  case UV_FS_WRITEV:
+    /* The thread pool splits up longer vectors. */
+    if (req->nbufs > (unsigned int) uv__getiovmax())
+      return -ENOSYS;
+    break;
+  case UV_FS_CLOSE:
+  case UV_FS_FDATASYNC:
+  case UV_FS_FSTAT:
+  case UV_FS_FSYNC:
+  case UV_FS_LSTAT:
+  case UV_FS_OPEN:
+  case UV_FS_STAT:
+    break;
+  default:
+    return -ENOSYS;
+  }
+
+  iou = uv__iou_get(loop);
+  if (iou == NULL)
+    return -ENOSYS;
+
+  /* Filled in like uv__work_submit() does, uv_cancel() looks at kind. */
+  req->work_req.loop = loop;
+  req->work_req.work = NULL;
+  req->work_req.done = done;
+  req->work_req.kind = UV__WORK_KERNEL;
+
+  return uv__iou_fs_prep(loop, iou, req);
+}
+
+
+/* A request can be taken back until io_uring_enter() has handed its SQE to
+ * the kernel. The SQE is turned into a no-op, its completion reports the
+ * cancellation like the thread pool does.
+ */
+int uv__iou_fs_cancel(uv_loop_t* loop, uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou* iou;
+  uint32_t head;
+  uint32_t pos;
+
+  iou = loop->iou;
+  pos = req->work_req.worker;
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+  if (pos - head >= *iou->sqtail - head)
+    return -EBUSY;  /* Submitted already. */
+
+  sqe = iou->sqes + (pos & iou->sqmask);
+  if (sqe->user_data != (uintptr_t) req)
+    return -EBUSY;  /* Cancelled already. */
+
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = UV__IORING_OP_NOP;
+  sqe->user_data = (uintptr_t) req | UV__IOU_CANCELLED;
+
+  return 0;
+}
+
+
+static void uv__iou_statx_to_stat(const struct uv__statx* src,
+                                  uv_stat_t* dst) {
+  dst->st_dev = makedev(src->stx_dev_major, src->stx_dev_minor);
+  dst->st_mode = src->stx_mode;
+  dst->st_nlink = src->stx_nlink;
+  dst->st_uid = src->stx_uid;
+  dst->st_gid = src->stx_gid;
+  dst->st_rdev = makedev(src->stx_rdev_major, src->stx_rdev_minor);
+  dst->st_ino = src->stx_ino;
+  dst->st_size = src->stx_size;
+  dst->st_blksize = src->stx_blksize;
+  dst->st_blocks = src->stx_blocks;
+  dst->st_atim.tv_sec = src->stx_atime.tv_sec;
+  dst->st_mtim.tv_sec = src->stx_mtime.tv_sec;
+  dst->st_ctim.tv_sec = src->stx_ctime.tv_sec;
+  /* Match uv__to_stat(), which only has nanoseconds when struct stat
+   * exposes them and uses the change time as the birth time.
+   */
+#if defined(_BSD_SOURCE) || defined(_SVID_SOURCE) || defined(_XOPEN_SOURCE)
+  dst->st_atim.tv_nsec = src->stx_atime.tv_nsec;
+  dst->st_mtim.tv_nsec = src->stx_mtime.tv_nsec;
+  dst->st_ctim.tv_nsec = src->stx_ctime.tv_nsec;
+#else
+  dst->st_atim.tv_nsec = 0;
+  dst->st_mtim.tv_nsec = 0;
+  dst->st_ctim.tv_nsec = 0;
+#endif
+  dst->st_birthtim = dst->st_ctim;
+  dst->st_flags = 0;
+  dst->st_gen = 0;
+}
+
+
+static void uv__iou_fs_complete(uv_loop_t* loop,
+                                struct uv__iou* iou,
+                                uv_fs_t* req,
+                                int res,
+                                int cancelled) {
+  struct uv__statx* statxbuf;
+
+  /* The thread pool retries interrupted calls too, except for close(). */
+  if (res == -EINTR && req->fs_type != UV_FS_CLOSE && !cancelled)
+    if (uv__iou_fs_prep(loop, iou, req) == 0)
+      return;
+
+  if (req->fs_type == UV_FS_STAT ||
+      req->fs_type == UV_FS_LSTAT ||
+      req->fs_type == UV_FS_FSTAT) {
+    statxbuf = req->ptr;
+    req->ptr = NULL;
+    if (res == 0 && !cancelled) {
+      uv__iou_statx_to_stat(statxbuf, &req->statbuf);
+      req->ptr = &req->statbuf;
+    }
+    free(statxbuf);
+  }
+
+  if (cancelled) {
+    req->work_req.done(&req->work_req, -ECANCELED);
+    return;
+  }
+
+  req->result = res;
+  req->work_req.done(&req->work_req, 0);
+}
+
+
+static void uv__iou_poll(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
+  struct uv__io_uring_cqe* cqe;
+  struct uv__iou* iou;
+  uv_fs_t* req;
+  uint64_t user_data;
+  uint32_t head;
+  uint32_t tail;
+  int res;
+
+  iou = container_of(w, struct uv__iou, watcher);
+
+  head = *iou->cqhead;
+  tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+
+  while (head != tail) {
+    cqe = iou->cqes + (head & iou->cqmask);
+    user_data = cqe->user_data;
+    req = (uv_fs_t*) (uintptr_t) (user_data & ~(uint64_t) UV__IOU_CANCELLED);
+    res = cqe->res;
+
+    /* Free the slot before the callback, it may queue more requests. */
+    head++;
+    __atomic_store_n(iou->cqhead, head, __ATOMIC_RELEASE);
+    iou->in_flight--;
+
+    uv__iou_fs_complete(loop,
+                        iou,
+                        req,
+                        res,
+                        (user_data & UV__IOU_CANCELLED) != 0);
+
+    if (head == tail)
+      tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+  }
+}
@@ -189,6 +189,22 @@
 # endif
 #endif /* __NR_sendmmsg */
 
+#ifndef __NR_io_uring_setup
+# if defined(__x86_64__) || defined(__i386__)
+#  define __NR_io_uring_setup 425
+# elif defined(__arm__)
+#  define __NR_io_uring_setup (UV_SYSCALL_BASE + 425)
+# endif
+#endif /* __NR_io_uring_setup */
+
+#ifndef __NR_io_uring_enter
+# if defined(__x86_64__) || defined(__i386__)
+#  define __NR_io_uring_enter 426
+# elif defined(__arm__)
+#  define __NR_io_uring_enter (UV_SYSCALL_BASE + 426)
+# endif
+#endif /* __NR_io_uring_enter */
+
 #ifndef __NR_utimensat
 # if defined(__x86_64__)
 #  define __NR_utimensat 280
@@ -341,6 +357,33 @@ int uv__inotify_rm_watch(int fd, int32_t wd) {
 }
 
 
+int uv__io_uring_setup(unsigned int entries, struct uv__io_uring_params* p) {
+#if defined(__NR_io_uring_setup)
+  return syscall(__NR_io_uring_setup, entries, p);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+int uv__io_uring_enter(int fd,
+                       unsigned int to_submit,
+                       unsigned int min_complete,
+                       unsigned int flags) {
+#if defined(__NR_io_uring_enter)
+  return syscall(__NR_io_uring_enter,
+                 fd,
+                 to_submit,
+                 min_complete,
+                 flags,
+                 NULL,
+                 0L);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
 int uv__pipe2(int pipefd[2], int flags) {
 #if defined(__NR_pipe2)
   return syscall(__NR_pipe2, pipefd, flags);
@@ -34,8 +34,11 @@ int uv__loop_init(uv_loop_t* loop, int default_loop) {
   uv__signal_global_once_init();
 
   memset(loop, 0, sizeof(*loop));
-  RB_INIT(&loop->timer_handles);
+  loop->timer_heap = NULL;
+  loop->timer_heap_len = 0;
+  loop->timer_heap_size = 0;
   QUEUE_INIT(&loop->wq);
+  loop->wq_next = 0;
   QUEUE_INIT(&loop->active_reqs);
   QUEUE_INIT(&loop->idle_handles);
   QUEUE_INIT(&loop->async_handles);
@@ -113,4 +116,9 @@ void uv__loop_delete(uv_loop_t* loop) {
   free(loop->watchers);
   loop->watchers = NULL;
   loop->nwatchers = 0;
+
+  free(loop->timer_heap);
+  loop->timer_heap = NULL;
+  loop->timer_heap_len = 0;
+  loop->timer_heap_size = 0;
 }
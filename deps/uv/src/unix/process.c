@@ -32,6 +32,8 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <signal.h>
+#include <pthread.h>
 
 #if defined(__APPLE__) && !TARGET_OS_IPHONE
 # include <crt_externs.h>
@@ -40,6 +42,18 @@
 extern char **environ;
 #endif
 
+/* vfork() doesn't copy the parent's page tables, which makes spawning from a
+ * process with a large heap a lot cheaper. The child runs in the parent's
+ * memory until it calls execve() though, so it can only use async signal
+ * safe functions that don't touch global state.
+ */
+#if defined(__linux__) && defined(__GLIBC__)
+# define UV__HAVE_VFORK 1
+# include <alloca.h>
+# include <limits.h>  /* PATH_MAX */
+# include <string.h>
+#endif
+
 
 static QUEUE* uv__process_queue(uv_loop_t* loop, int pid) {
   assert(pid > 0);
@@ -268,13 +282,166 @@ static void uv__write_int(int fd, int val) {
 }
 
 
+/* Reports errno to the parent and exits. perror() takes the stdio lock, a
+ * child started with vfork() leaves that to the parent.
+ */
+static void uv__process_child_error(int error_fd,
+                                    const char* msg,
+                                    int vforked) {
+  int err;
+
+  err = errno;
+  uv__write_int(error_fd, -err);
+
+  if (!vforked) {
+    errno = err;
+    perror(msg);
+  }
+
+  _exit(127);
+}
+
+
+#if defined(UV__HAVE_VFORK)
+/* What execvp() does with a file that isn't a binary and has no #! line. */
+static void uv__process_execve_script(const char* path,
+                                      char** argv,
+                                      char** envp) {
+  char** sh_argv;
+  int argc;
+
+  for (argc = 0; argv[argc] != NULL; argc++);
+
+  /* On the stack, the child can't call malloc(). */
+  sh_argv = alloca((argc + 2) * sizeof(*sh_argv));
+  sh_argv[0] = "/bin/sh";
+  sh_argv[1] = (char*) path;
+  memcpy(sh_argv + 2, argv + 1, argc * sizeof(*sh_argv));
+
+  execve("/bin/sh", sh_argv, envp);
+}
+
+
+/* Like execvpe() but `file` is looked up in the PATH of `envp` rather than in
+ * the one of the parent, which is what execvp() did after `environ = envp`.
+ * Assigning to environ isn't an option after vfork(), it's the parent's.
+ * Without PATH, the directories are the same as execvp()'s. Returns with
+ * errno set.
+ */
+static void uv__process_execvpe(const char* file, char** argv, char** envp) {
+  char buf[PATH_MAX];
+  const char* path;
+  const char* end;
+  size_t filelen;
+  size_t dirlen;
+  int eacces;
+  char** env;
+
+  if (strchr(file, '/') != NULL) {
+    execve(file, argv, envp);
+    if (errno == ENOEXEC)
+      uv__process_execve_script(file, argv, envp);
+    return;
+  }
+
+  path = "/bin:/usr/bin";
+  for (env = envp; *env != NULL; env++) {
+    if (strncmp(*env, "PATH=", 5) == 0) {
+      path = *env + 5;
+      break;
+    }
+  }
+
+  filelen = strlen(file);
+  eacces = 0;
+  errno = ENOENT;
+
+  for (;;) {
+    end = strchr(path, ':');
+    if (end == NULL)
+      end = path + strlen(path);
+    dirlen = end - path;
+
+    /* Entries that are too long are skipped. An empty one is the current
+     * directory.
+     */
+    if (dirlen + filelen + 2 <= sizeof(buf)) {
+      if (dirlen == 0) {
+        memcpy(buf, file, filelen + 1);
+      } else {
+        memcpy(buf, path, dirlen);
+        buf[dirlen] = '/';
+        memcpy(buf + dirlen + 1, file, filelen + 1);
+      }
+
+      execve(buf, argv, envp);
+
+      switch (errno) {
+      case EACCES:
+        eacces = 1;
+        break;
+      case ENOENT:
+      case ENOTDIR:
+      case ENODEV:
+      case ESTALE:
+      case ETIMEDOUT:
+        break;
+      case ENOEXEC:
+        uv__process_execve_script(buf, argv, envp);
+        return;
+      default:
+        return;
+      }
+    }
+
+    if (*end == '\0')
+      break;
+    path = end + 1;
+  }
+
+  if (eacces)
+    errno = EACCES;
+}
+#endif
+
+
+/* `sigmask` is the parent's signal mask if the child was started with
+ * vfork(), NULL if it was started with fork().
+ */
 static void uv__process_child_init(uv_process_options_t options,
                                    int stdio_count,
                                    int (*pipes)[2],
-                                   int error_fd) {
+                                   int error_fd,
+                                   const sigset_t* sigmask) {
+  struct sigaction sa;
   int close_fd;
   int use_fd;
+  int vforked;
   int fd;
+  int n;
+
+  vforked = (sigmask != NULL);
+
+  if (vforked) {
+    /* The parent blocked all signals before vfork(). Its handlers would run
+     * in its memory, reset them before the signals are unblocked again.
+     * Ignored signals stay ignored, like with fork() and execve().
+     */
+    for (n = 1; n < NSIG; n++) {
+      if (sigaction(n, NULL, &sa))
+        continue;
+
+      if (sa.sa_handler == SIG_DFL || sa.sa_handler == SIG_IGN)
+        continue;
+
+      sa.sa_handler = SIG_DFL;
+      sa.sa_flags = 0;
+      sigemptyset(&sa.sa_mask);
+      sigaction(n, &sa, NULL);
+    }
+
+    sigprocmask(SIG_SETMASK, sigmask, NULL);
+  }
 
   if (options.flags & UV_PROCESS_DETACHED)
     setsid();
@@ -293,11 +460,8 @@ static void uv__process_child_init(uv_process_options_t options,
        */
       use_fd = open("/dev/null", fd == 0 ? O_RDONLY : O_RDWR);
 
-      if (use_fd == -1) {
-        uv__write_int(error_fd, -errno);
-        perror("failed to open stdio");
-        _exit(127);
-      }
+      if (use_fd == -1)
+        uv__process_child_error(error_fd, "failed to open stdio", vforked);
     }
 
     if (fd == use_fd)
@@ -311,35 +475,54 @@ static void uv__process_child_init(uv_process_options_t options,
       uv__nonblock(fd, 0);
   }
 
-  if (options.cwd && chdir(options.cwd)) {
-    uv__write_int(error_fd, -errno);
-    perror("chdir()");
-    _exit(127);
-  }
+  if (options.cwd && chdir(options.cwd))
+    uv__process_child_error(error_fd, "chdir()", vforked);
 
-  if ((options.flags & UV_PROCESS_SETGID) && setgid(options.gid)) {
-    uv__write_int(error_fd, -errno);
-    perror("setgid()");
-    _exit(127);
-  }
+  if ((options.flags & UV_PROCESS_SETGID) && setgid(options.gid))
+    uv__process_child_error(error_fd, "setgid()", vforked);
 
-  if ((options.flags & UV_PROCESS_SETUID) && setuid(options.uid)) {
-    uv__write_int(error_fd, -errno);
-    perror("setuid()");
-    _exit(127);
-  }
+  if ((options.flags & UV_PROCESS_SETUID) && setuid(options.uid))
+    uv__process_child_error(error_fd, "setuid()", vforked);
 
+#if defined(UV__HAVE_VFORK)
+  /* Assigning to environ would change the parent's environment. */
+  uv__process_execvpe(options.file,
+                      options.args,
+                      options.env ? options.env : environ);
+#else
   if (options.env) {
     environ = options.env;
   }
 
   execvp(options.file, options.args);
-  uv__write_int(error_fd, -errno);
-  perror("execvp()");
-  _exit(127);
+#endif
+  uv__process_child_error(error_fd, "execvp()", vforked);
 }
 
 
+#if defined(UV__HAVE_VFORK)
+/* The child borrows the stack frame of the function that calls vfork() until
+ * it calls execve(). That's this one, which doesn't touch any of its
+ * variables afterwards, rather than uv_spawn().
+ */
+static pid_t uv__process_vfork(const uv_process_options_t* options,
+                               int stdio_count,
+                               int (*pipes)[2],
+                               int error_fd,
+                               const sigset_t* sigmask) {
+  pid_t pid;
+
+  pid = vfork();
+  if (pid == 0) {
+    uv__process_child_init(*options, stdio_count, pipes, error_fd, sigmask);
+    abort();
+  }
+
+  return pid;
+}
+#endif
+
+
 int uv_spawn(uv_loop_t* loop,
              uv_process_t* process,
              const uv_process_options_t options) {
@@ -351,6 +534,10 @@ int uv_spawn(uv_loop_t* loop,
   pid_t pid;
   int err;
   int i;
+#if defined(UV__HAVE_VFORK)
+  sigset_t sigmask_all;
+  sigset_t sigmask;
+#endif
 
   assert(options.file != NULL);
   assert(!(options.flags & ~(UV_PROCESS_DETACHED |
@@ -408,7 +595,36 @@ int uv_spawn(uv_loop_t* loop,
 
   uv_signal_start(&loop->child_watcher, uv__chld, SIGCHLD);
 
-  pid = fork();
+#if defined(UV__HAVE_VFORK)
+  /* glibc's setuid() and setgid() signal all threads of the process, in a
+   * vfork() child those are the parent's threads. Use fork() for those.
+   */
+  if (!(options.flags & (UV_PROCESS_SETUID | UV_PROCESS_SETGID))) {
+    /* Keep signal handlers from running in the child until it has reset
+     * them. The parent is suspended until the child calls execve() or
+     * exits, then it restores its mask.
+     */
+    sigfillset(&sigmask_all);
+    pthread_sigmask(SIG_SETMASK, &sigmask_all, &sigmask);
+    pid = uv__process_vfork(&options,
+                            stdio_count,
+                            pipes,
+                            signal_pipe[1],
+                            &sigmask);
+    pthread_sigmask(SIG_SETMASK, &sigmask, NULL);
+  } else
+#endif
+  {
+    pid = fork();
+    if (pid == 0) {
+      uv__process_child_init(options,
+                             stdio_count,
+                             pipes,
+                             signal_pipe[1],
+                             NULL);
+      abort();
+    }
+  }
 
   if (pid == -1) {
     err = -errno;
@@ -417,11 +633,6 @@ int uv_spawn(uv_loop_t* loop,
     goto error;
   }
 
-  if (pid == 0) {
-    uv__process_child_init(options, stdio_count, pipes, signal_pipe[1]);
-    abort();
-  }
-
   close(signal_pipe[1]);
 
   process->errorno = 0;
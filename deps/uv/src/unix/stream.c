@@ -32,9 +32,14 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 #include <sys/un.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <limits.h> /* IOV_MAX */
 
+#if defined(__linux__)
+# include <sys/sendfile.h>
+#endif
+
 #if defined(__APPLE__)
 # include <sys/event.h>
 # include <sys/time.h>
@@ -56,11 +61,28 @@ struct uv__stream_select_s {
 };
 #endif /* defined(__APPLE__) */
 
+/* A uv_sendfile() request sends at most this much in one go. It's also how
+ * much of the file is checked for, and read into, the page cache up front.
+ */
+#define UV__SENDFILE_MAX (1024 * 1024)
+
+/* Reads the next part of a uv_sendfile() request into the page cache. It's
+ * owned by the threadpool, `stream` is cleared when the stream is closed.
+ */
+struct uv__sendfile_warmup {
+  struct uv__work work_req;
+  uv_stream_t* stream;
+  int file;
+  off_t offset;
+  size_t len;
+};
+
 static void uv__stream_connect(uv_stream_t*);
 static void uv__write(uv_stream_t* stream);
 static void uv__read(uv_stream_t* stream);
 static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 static size_t uv__write_req_size(uv_write_t* req);
+static void uv__write_req_start(uv_write_t* req, int empty_queue);
 
 
 /* Used by the accept() EMFILE party trick. */
@@ -120,6 +142,7 @@ void uv__stream_init(uv_loop_t* loop,
   stream->shutdown_req = NULL;
   stream->accepted_fd = -1;
   stream->delayed_error = 0;
+  stream->sendfile_warmup = NULL;
   QUEUE_INIT(&stream->write_queue);
   QUEUE_INIT(&stream->write_completed_queue);
   stream->write_queue_size = 0;
@@ -704,19 +727,185 @@ static int uv__handle_fd(uv_handle_t* handle) {
   }
 }
 
-static int uv__getiovmax() {
-#if defined(IOV_MAX)
-  return IOV_MAX;
-#elif defined(_SC_IOV_MAX)
-  static int iovmax = -1;
-  if (iovmax == -1)
-    iovmax = sysconf(_SC_IOV_MAX);
-  return iovmax;
-#else
-  return 1024;
+/* Returns 0 when part of [offset, offset + len) is not in the page cache.
+ * That is when sendfile(2) would block the loop while it reads from disk.
+ */
+static int uv__file_cached(int fd, off_t offset, size_t len) {
+  unsigned char vec[UV__SENDFILE_MAX / 4096 + 1];
+  size_t pagesize;
+  size_t npages;
+  size_t i;
+  off_t start;
+  void* p;
+  int r;
+
+  pagesize = getpagesize();
+  start = offset - offset % pagesize;
+  len += offset - start;
+  npages = (len + pagesize - 1) / pagesize;
+  if (npages > ARRAY_SIZE(vec)) {
+    npages = ARRAY_SIZE(vec);
+    len = npages * pagesize;
+  }
+
+  /* Can't tell, e.g. for a file that can't be mapped. Assume the best. */
+  p = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, start);
+  if (p == MAP_FAILED)
+    return 1;
+
+  /* The type of `vec` differs between platforms. */
+  r = mincore(p, len, (void*) vec);
+  munmap(p, len);
+  if (r)
+    return 1;
+
+  for (i = 0; i < npages; i++)
+    if ((vec[i] & 1) == 0)
+      return 0;
+
+  return 1;
+}
+
+
+static void uv__sendfile_warmup_work(struct uv__work* w) {
+  struct uv__sendfile_warmup* wu;
+  char scratch[65536];
+  size_t len;
+  ssize_t n;
+
+  wu = container_of(w, struct uv__sendfile_warmup, work_req);
+
+  /* Reading it is the only portable way to know it's there afterwards. */
+  while (wu->len > 0) {
+    len = wu->len;
+    if (len > sizeof(scratch))
+      len = sizeof(scratch);
+
+    do
+      n = pread(wu->file, scratch, len, wu->offset);
+    while (n == -1 && errno == EINTR);
+
+    /* Errors and EOF are reported by the sendfile(2) that follows. */
+    if (n <= 0)
+      break;
+
+    wu->offset += n;
+    wu->len -= n;
+  }
+}
+
+
+static void uv__sendfile_warmup_done(struct uv__work* w, int status) {
+  struct uv__sendfile_warmup* wu;
+  uv_stream_t* stream;
+
+  wu = container_of(w, struct uv__sendfile_warmup, work_req);
+  stream = wu->stream;
+  free(wu);
+
+  /* Closed in the meantime. */
+  if (stream == NULL)
+    return;
+
+  /* Send it when the stream is writable, without checking again: under
+   * memory pressure the pages may be gone already and checking again could
+   * go on forever.
+   */
+  stream->sendfile_warmup = NULL;
+  stream->flags |= UV_STREAM_SENDFILE_WARM;
+  uv__io_start(stream->loop, &stream->io_watcher, UV__POLLOUT);
+}
+
+
+/* Returns 0 if the request has to wait for its file to be read in, the
+ * stream stops polling for POLLOUT until then.
+ */
+static int uv__sendfile_warmup(uv_stream_t* stream, uv_write_t* req) {
+  struct uv__sendfile_warmup* wu;
+  size_t len;
+
+  if (stream->sendfile_warmup != NULL)
+    goto wait;
+
+  /* Blocking streams block the loop either way. */
+  if (stream->flags & UV_STREAM_BLOCKING)
+    return -1;
+
+  if (stream->flags & UV_STREAM_SENDFILE_WARM) {
+    stream->flags &= ~UV_STREAM_SENDFILE_WARM;
+    return -1;
+  }
+
+  len = req->bufs[0].len;
+  if (len > UV__SENDFILE_MAX)
+    len = UV__SENDFILE_MAX;
+
+  if (uv__file_cached(req->file, req->file_offset, len))
+    return -1;
+
+  /* Out of memory, send it from the loop thread then. */
+  wu = malloc(sizeof(*wu));
+  if (wu == NULL)
+    return -1;
+
+  wu->stream = stream;
+  wu->file = req->file;
+  wu->offset = req->file_offset;
+  wu->len = len;
+  stream->sendfile_warmup = wu;
+  uv__work_submit(stream->loop,
+                  &wu->work_req,
+                  UV__WORK_SLOW_FS,
+                  uv__sendfile_warmup_work,
+                  uv__sendfile_warmup_done);
+
+wait:
+  uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLOUT);
+  return 0;
+}
+
+
+/* Sends the remainder of a uv_sendfile() request. Returns the number of bytes
+ * written, 0 when the file ends early or -1 and sets errno.
+ */
+static ssize_t uv__write_file(int fd, uv_write_t* req) {
+  char scratch[65536];
+  size_t len;
+  ssize_t n;
+
+  len = req->bufs[0].len;
+  if (len > UV__SENDFILE_MAX)
+    len = UV__SENDFILE_MAX;
+
+#if defined(__linux__)
+  {
+    off_t off;
+
+    off = req->file_offset;
+    n = sendfile(fd, req->file, &off, len);
+
+    /* EINVAL and ENOSYS mean that the file or stream doesn't support it,
+     * e.g. a file on a FUSE mount or a pipe on older kernels.
+     */
+    if (n != -1 || (errno != EINVAL && errno != ENOSYS))
+      return n;
+  }
 #endif
+
+  /* Other platforms go through a bounce buffer. Only the bytes that made it
+   * into the socket count, the rest is read again the next time around.
+   */
+  if (len > sizeof(scratch))
+    len = sizeof(scratch);
+
+  n = pread(req->file, scratch, len, req->file_offset);
+  if (n <= 0)
+    return n;
+
+  return write(fd, scratch, n);
 }
 
+
 static void uv__write(uv_stream_t* stream) {
   struct iovec* iov;
   QUEUE* q;
@@ -755,7 +944,13 @@ start:
    * inside the iov each time we write. So there is no need to offset it.
    */
 
-  if (req->send_handle) {
+  if (req->file != -1) {
+    if (uv__sendfile_warmup(stream, req) == 0)
+      return;
+    do
+      n = uv__write_file(uv__stream_fd(stream), req);
+    while (n == -1 && errno == EINTR);
+  } else if (req->send_handle) {
     struct msghdr msg;
     char scratch[64];
     struct cmsghdr *cmsg;
@@ -799,6 +994,20 @@ start:
     while (n == -1 && errno == EINTR);
   }
 
+  if (n == 0 && req->file != -1) {
+    /* The file is shorter than the caller said it was. That only fails this
+     * request, the ones queued after it still go out.
+     */
+    req->error = UV_EOF;
+    uv__write_req_finish(req);
+    if (!QUEUE_EMPTY(&stream->write_queue))
+      goto start;
+    uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLOUT);
+    if (!uv__io_active(&stream->io_watcher, UV__POLLIN))
+      uv__handle_stop(stream);
+    return;
+  }
+
   if (n < 0) {
     if (errno != EAGAIN && errno != EWOULDBLOCK) {
       /* Error */
@@ -822,7 +1031,10 @@ start:
       assert(req->write_index < req->bufcnt);
 
       if ((size_t)n < len) {
-        buf->base += n;
+        if (req->file != -1)
+          req->file_offset += n;
+        else
+          buf->base += n;
         buf->len -= n;
         stream->write_queue_size -= n;
         n = 0;
@@ -1248,6 +1460,7 @@ int uv_write2(uv_write_t* req,
   req->handle = stream;
   req->error = 0;
   req->send_handle = send_handle;
+  req->file = -1;
   QUEUE_INIT(&req->queue);
 
   if (bufcnt <= (int) ARRAY_SIZE(req->bufsml))
@@ -1260,6 +1473,69 @@ int uv_write2(uv_write_t* req,
   req->write_index = 0;
   stream->write_queue_size += uv__buf_count(bufs, bufcnt);
 
+  uv__write_req_start(req, empty_queue);
+  return 0;
+}
+
+
+/* The buffers to be written must remain valid until the callback is called.
+ * This is not required for the uv_buf_t array.
+ */
+int uv_write(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[], int bufcnt,
+    uv_write_cb cb) {
+  return uv_write2(req, stream, bufs, bufcnt, NULL, cb);
+}
+
+
+int uv_sendfile(uv_write_t* req,
+                uv_stream_t* stream,
+                uv_file file,
+                int64_t offset,
+                size_t length,
+                uv_write_cb cb) {
+  int empty_queue;
+
+  assert(length > 0);
+  assert((stream->type == UV_TCP ||
+          stream->type == UV_NAMED_PIPE ||
+          stream->type == UV_TTY) &&
+         "uv_sendfile (unix) does not yet support other types of streams");
+
+  if (uv__stream_fd(stream) < 0)
+    return -EBADF;
+
+  if (file < 0 || offset < 0)
+    return -EINVAL;
+
+  /* See uv_write2(). */
+  empty_queue = (stream->write_queue_size == 0);
+
+  uv__req_init(stream->loop, req, UV_WRITE);
+  req->cb = cb;
+  req->handle = stream;
+  req->error = 0;
+  req->send_handle = NULL;
+  req->file = file;
+  req->file_offset = offset;
+  QUEUE_INIT(&req->queue);
+
+  /* The one buffer keeps track of how much is left to send. Its base is
+   * never dereferenced.
+   */
+  req->bufs = req->bufsml;
+  req->bufs[0] = uv_buf_init(NULL, length);
+  req->bufcnt = 1;
+  req->write_index = 0;
+  stream->write_queue_size += length;
+
+  uv__write_req_start(req, empty_queue);
+  return 0;
+}
+
+
+static void uv__write_req_start(uv_write_t* req, int empty_queue) {
+  uv_stream_t* stream = req->handle;
+
   /* Append the request to write_queue. */
   QUEUE_INSERT_TAIL(&stream->write_queue, &req->queue);
 
@@ -1282,17 +1558,6 @@ int uv_write2(uv_write_t* req,
     assert(!(stream->flags & UV_STREAM_BLOCKING));
     uv__io_start(stream->loop, &stream->io_watcher, UV__POLLOUT);
   }
-
-  return 0;
-}
-
-
-/* The buffers to be written must remain valid until the callback is called.
- * This is not required for the uv_buf_t array.
- */
-int uv_write(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[], int bufcnt,
-    uv_write_cb cb) {
-  return uv_write2(req, stream, bufs, bufcnt, NULL, cb);
 }
 
 
@@ -1429,6 +1694,12 @@ void uv__stream_close(uv_stream_t* handle) {
   uv_read_stop(handle);
   uv__handle_stop(handle);
 
+  /* Let the threadpool finish reading it in, the stream doesn't care. */
+  if (handle->sendfile_warmup != NULL) {
+    ((struct uv__sendfile_warmup*) handle->sendfile_warmup)->stream = NULL;
+    handle->sendfile_warmup = NULL;
+  }
+
   close(handle->io_watcher.fd);
   handle->io_watcher.fd = -1;
 
@@ -27,6 +27,12 @@
 #include <assert.h>
 #include <errno.h>
 
+/* Linux has SO_REUSEPORT since 3.9 but older libc headers don't define it. */
+#if defined(__linux__) && !defined(SO_REUSEPORT) &&                           \
+    (defined(__i386__) || defined(__x86_64__) || defined(__arm__))
+# define SO_REUSEPORT 15
+#endif
+
 
 int uv_tcp_init(uv_loop_t* loop, uv_tcp_t* tcp) {
   uv__stream_init(loop, (uv_stream_t*)tcp, UV_TCP);
@@ -71,6 +77,12 @@ static int uv__bind(uv_tcp_t* tcp,
   if (setsockopt(tcp->io_watcher.fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)))
     return -errno;
 
+  if (tcp->flags & UV_TCP_REUSEPORT) {
+    err = uv__tcp_reuseport(tcp->io_watcher.fd, 1);
+    if (err)
+      return err;
+  }
+
   errno = 0;
   if (bind(tcp->io_watcher.fd, addr, addrsize) && errno != EADDRINUSE)
     return -errno;
@@ -315,6 +327,45 @@ int uv_tcp_keepalive(uv_tcp_t* handle, int on, unsigned int delay) {
 }
 
 
+int uv__tcp_reuseport(int fd, int on) {
+#if defined(SO_REUSEPORT)
+  if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == 0)
+    return 0;
+
+  /* Pre-3.9 Linux kernels. */
+  if (errno == ENOPROTOOPT)
+    return -ENOTSUP;
+
+  return -errno;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
+int uv_tcp_reuseport(uv_tcp_t* handle, int on) {
+  int err;
+
+  if (uv__stream_fd(handle) != -1) {
+    err = uv__tcp_reuseport(uv__stream_fd(handle), on);
+    if (err)
+      return err;
+  }
+#if !defined(SO_REUSEPORT)
+  else if (on) {
+    return -ENOTSUP;
+  }
+#endif
+
+  if (on)
+    handle->flags |= UV_TCP_REUSEPORT;
+  else
+    handle->flags &= ~UV_TCP_REUSEPORT;
+
+  return 0;
+}
+
+
 int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable) {
   if (enable)
     handle->flags &= ~UV_TCP_SINGLE_ACCEPT;
@@ -24,14 +24,43 @@
 
 #define MAX_THREADPOOL_SIZE 128
 
+/* Every worker thread has its own set of queues, one per kind of work. Work
+ * is handed out to the workers round-robin, a worker takes from its own
+ * queues first and steals from the other workers when they're empty.
+ *
+ * Which kind of work a thread runs next is decided up front, under the global
+ * mutex. The kinds take turns, so a backlog of one kind doesn't hold up the
+ * others: a stat() queued behind a hundred reads runs as soon as the next
+ * thread frees up. DNS lookups can moreover occupy at most half of the
+ * threads because they can block for seconds when a name server is slow.
+ *
+ * The global mutex only protects the counters, the queues are protected by
+ * the mutex of the worker they belong to. Lock order is global mutex, worker
+ * mutex, loop mutex.
+ */
+struct uv__worker {
+  uv_thread_t thread;
+  uv_mutex_t mutex;
+  QUEUE wq[UV__WORK_NKINDS];
+  unsigned int next_kind;
+};
+
 static uv_once_t once = UV_ONCE_INIT;
 static uv_cond_t cond;
+static uv_cond_t steal_cond;
 static uv_mutex_t mutex;
 static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static struct uv__worker* workers;
+static struct uv__worker default_workers[4];
+static unsigned int idle_threads;
+static unsigned int stealing_threads;
+/* Bumped by every post(), lets take() tell if it raced with one. */
+static unsigned int posted;
+/* Queued work that hasn't been claimed by a thread yet. */
+static unsigned int pending[UV__WORK_NKINDS];
+static unsigned int running[UV__WORK_NKINDS];
+static unsigned int limit[UV__WORK_NKINDS];
+static int exiting;
 static volatile int initialized;
 
 
@@ -40,62 +69,166 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
+/* Pick the kind of work this thread runs next and claim one request of that
+ * kind. Must be called with the global mutex held. Returns -1 if there is
+ * nothing the thread is allowed to run.
+ */
+static int claim(struct uv__worker* self) {
+  unsigned int kind;
+  unsigned int i;
+
+  for (i = 0; i < UV__WORK_NKINDS; i++) {
+    kind = (self->next_kind + i) % UV__WORK_NKINDS;
+    if (pending[kind] > 0 && running[kind] < limit[kind]) {
+      pending[kind]--;
+      running[kind]++;
+      self->next_kind = kind + 1;
+      return kind;
+    }
+  }
+
+  return -1;
+}
+
+
+/* Dequeue a request of a kind that has been claimed. Claims never outnumber
+ * the queued requests of a kind so one is bound to turn up, although another
+ * thread may beat us to the one we saw first. A pass over the queues can only
+ * come up empty when a post() raced with it; if none did the thread sleeps
+ * until the next one instead of spinning on the other workers' mutexes.
+ * `seen` is the value of `posted` when the request was claimed.
+ */
+static QUEUE* take(struct uv__worker* self,
+                   unsigned int kind,
+                   unsigned int seen) {
+  struct uv__worker* victim;
+  unsigned int i;
+  QUEUE* q;
+
+  for (;;) {
+    for (i = 0; i < nthreads; i++) {
+      victim = workers + (self - workers + i) % nthreads;
+      uv_mutex_lock(&victim->mutex);
+
+      if (!QUEUE_EMPTY(&victim->wq[kind])) {
+        q = QUEUE_HEAD(&victim->wq[kind]);
+        QUEUE_REMOVE(q);
+        QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
+                           executing. */
+        uv_mutex_unlock(&victim->mutex);
+        return q;
+      }
+
+      uv_mutex_unlock(&victim->mutex);
+    }
+
+    uv_mutex_lock(&mutex);
+    if (posted == seen) {
+      stealing_threads++;
+      uv_cond_wait(&steal_cond, &mutex);
+      stealing_threads--;
+    }
+    seen = posted;
+    uv_mutex_unlock(&mutex);
+  }
+}
+
+
+static int pending_work(void) {
+  unsigned int i;
+
+  for (i = 0; i < UV__WORK_NKINDS; i++)
+    if (pending[i] > 0)
+      return 1;
+
+  return 0;
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  struct uv__worker* self;
   struct uv__work* w;
+  unsigned int seen;
   QUEUE* q;
+  int notify;
+  int kind;
 
-  (void) arg;
+  self = arg;
 
-  for (;;) {
-    uv_mutex_lock(&mutex);
+  uv_mutex_lock(&mutex);
 
-    while (QUEUE_EMPTY(&wq))
-      uv_cond_wait(&cond, &mutex);
+  for (;;) {
+    kind = claim(self);
 
-    q = QUEUE_HEAD(&wq);
+    if (kind == -1) {
+      if (exiting && !pending_work())
+        break;
 
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
+      idle_threads++;
+      uv_cond_wait(&cond, &mutex);
+      idle_threads--;
+      continue;
     }
 
+    seen = posted;
     uv_mutex_unlock(&mutex);
 
-    if (q == &exit_message)
-      break;
-
+    q = take(self, kind, seen);
     w = QUEUE_DATA(q, struct uv__work, wq);
     w->work(w);
 
     uv_mutex_lock(&w->loop->wq_mutex);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
                         executing. */
+    /* uv__work_done() takes everything that's in the queue in one go, only
+     * the first request to finish after that needs to wake up the loop.
+     */
+    notify = QUEUE_EMPTY(&w->loop->wq);
     QUEUE_INSERT_TAIL(&w->loop->wq, &w->wq);
-    uv_async_send(&w->loop->wq_async);
+    if (notify)
+      uv_async_send(&w->loop->wq_async);
     uv_mutex_unlock(&w->loop->wq_mutex);
+
+    uv_mutex_lock(&mutex);
+    running[kind]--;
+
+    /* A thread may be waiting for this kind to drop below its limit. */
+    if (pending[kind] > 0 && idle_threads > 0)
+      uv_cond_signal(&cond);
   }
+
+  uv_mutex_unlock(&mutex);
 }
 
 
-static void post(QUEUE* q) {
+static void post(struct uv__work* w) {
+  struct uv__worker* owner;
+
+  owner = workers + w->worker;
+  uv_mutex_lock(&owner->mutex);
+  QUEUE_INSERT_TAIL(&owner->wq[w->kind], &w->wq);
+  uv_mutex_unlock(&owner->mutex);
+
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
-  uv_cond_signal(&cond);
+  pending[w->kind]++;
+  posted++;
+  if (idle_threads > 0)
+    uv_cond_signal(&cond);
+  if (stealing_threads > 0)
+    uv_cond_broadcast(&steal_cond);
   uv_mutex_unlock(&mutex);
 }
 
 
 static void init_once(void) {
   unsigned int i;
+  unsigned int j;
   const char* val;
 
-  nthreads = ARRAY_SIZE(default_threads);
+  nthreads = ARRAY_SIZE(default_workers);
   val = getenv("UV_THREADPOOL_SIZE");
   if (val != NULL)
     nthreads = atoi(val);
@@ -104,25 +237,38 @@ static void init_once(void) {
   if (nthreads > MAX_THREADPOOL_SIZE)
     nthreads = MAX_THREADPOOL_SIZE;
 
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
+  workers = default_workers;
+  if (nthreads > ARRAY_SIZE(default_workers)) {
+    workers = malloc(nthreads * sizeof(workers[0]));
+    if (workers == NULL) {
+      nthreads = ARRAY_SIZE(default_workers);
+      workers = default_workers;
     }
   }
 
+  for (i = 0; i < UV__WORK_NKINDS; i++)
+    limit[i] = nthreads;
+  limit[UV__WORK_DNS] = (nthreads + 1) / 2;
+
   if (uv_cond_init(&cond))
     abort();
 
+  if (uv_cond_init(&steal_cond))
+    abort();
+
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
+  for (i = 0; i < nthreads; i++) {
+    if (uv_mutex_init(&workers[i].mutex))
+      abort();
+    for (j = 0; j < UV__WORK_NKINDS; j++)
+      QUEUE_INIT(&workers[i].wq[j]);
+    workers[i].next_kind = 0;
+  }
 
   for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
+    if (uv_thread_create(&workers[i].thread, worker, workers + i))
       abort();
 
   initialized = 1;
@@ -137,20 +283,29 @@ static void cleanup(void) {
   if (initialized == 0)
     return;
 
-  post(&exit_message);
+  /* Let the threads finish the work that is still queued, then exit. */
+  uv_mutex_lock(&mutex);
+  exiting = 1;
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
 
   for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+    if (uv_thread_join(&workers[i].thread))
       abort();
 
-  if (threads != default_threads)
-    free(threads);
+  for (i = 0; i < nthreads; i++)
+    uv_mutex_destroy(&workers[i].mutex);
+
+  if (workers != default_workers)
+    free(workers);
 
   uv_mutex_destroy(&mutex);
   uv_cond_destroy(&cond);
+  uv_cond_destroy(&steal_cond);
 
-  threads = NULL;
+  workers = NULL;
   nthreads = 0;
+  exiting = 0;
   initialized = 0;
 }
 #endif
@@ -158,27 +313,42 @@ static void cleanup(void) {
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     enum uv__work_kind kind,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  w->kind = kind;
+  w->worker = loop->wq_next++ % nthreads;
+  post(w);
 }
 
 
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  struct uv__worker* owner;
   int cancelled;
 
+  if (w->kind == UV__WORK_KERNEL)
+    return uv__iou_fs_cancel(loop, (uv_fs_t*) req);
+
+  owner = workers + w->worker;
   uv_mutex_lock(&mutex);
+  uv_mutex_lock(&owner->mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
-  cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  /* A request that is still queued may already have been claimed by a
+   * thread. That's the case for all of them when none are pending.
+   */
+  cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL && pending[w->kind] > 0;
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+    pending[w->kind]--;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
+  uv_mutex_unlock(&owner->mutex);
   uv_mutex_unlock(&mutex);
 
   if (!cancelled)
@@ -253,7 +423,11 @@ int uv_queue_work(uv_loop_t* loop,
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  &req->work_req,
+                  UV__WORK_CPU,
+                  uv__queue_work,
+                  uv__queue_done);
   return 0;
 }
 
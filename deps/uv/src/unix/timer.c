@@ -22,26 +22,165 @@
 #include "internal.h"
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+
+/*
+ * Active timers are kept in a binary min heap that is ordered by timeout,
+ * then by start_id. The heap nodes carry a copy of the sort key so sifting
+ * only has to touch the handles that actually move, the handles store their
+ * current position in the heap. That makes the next timeout an O(1) lookup
+ * and start/stop/again O(log n) without any per-timer allocations.
+ */
+struct uv__timer_heap_node {
+  uint64_t timeout;
+  uint64_t start_id;
+  uv_timer_t* handle;
+};
 
+#define HEAP_ARITY 2
+#define HEAP_PARENT(i) (((i) - 1) / HEAP_ARITY)
+#define HEAP_CHILD(i) ((i) * HEAP_ARITY + 1)
 
-static int uv__timer_cmp(const uv_timer_t* a, const uv_timer_t* b) {
+
+static int uv__timer_less(const struct uv__timer_heap_node* a,
+                          const struct uv__timer_heap_node* b) {
   if (a->timeout < b->timeout)
-    return -1;
-  if (a->timeout > b->timeout)
     return 1;
+  if (a->timeout > b->timeout)
+    return 0;
   /*
    *  compare start_id when both has the same timeout. start_id is
    *  allocated with loop->timer_counter in uv_timer_start().
    */
-  if (a->start_id < b->start_id)
-    return -1;
-  if (a->start_id > b->start_id)
-    return 1;
-  return 0;
+  return a->start_id < b->start_id;
+}
+
+
+static void uv__timer_heap_set(uv_loop_t* loop,
+                               unsigned int index,
+                               const struct uv__timer_heap_node* node) {
+  loop->timer_heap[index] = *node;
+  node->handle->heap_index = index;
+}
+
+
+static void uv__timer_heap_sift_up(uv_loop_t* loop, unsigned int index) {
+  struct uv__timer_heap_node node;
+  unsigned int parent;
+
+  node = loop->timer_heap[index];
+
+  while (index > 0) {
+    parent = HEAP_PARENT(index);
+    if (!uv__timer_less(&node, loop->timer_heap + parent))
+      break;
+    uv__timer_heap_set(loop, index, loop->timer_heap + parent);
+    index = parent;
+  }
+
+  uv__timer_heap_set(loop, index, &node);
+}
+
+
+static void uv__timer_heap_sift_down(uv_loop_t* loop, unsigned int index) {
+  struct uv__timer_heap_node node;
+  unsigned int child;
+  unsigned int last;
+  unsigned int best;
+  unsigned int i;
+
+  node = loop->timer_heap[index];
+
+  for (;;) {
+    child = HEAP_CHILD(index);
+    if (child >= loop->timer_heap_len)
+      break;
+
+    last = child + HEAP_ARITY;
+    if (last > loop->timer_heap_len)
+      last = loop->timer_heap_len;
+
+    best = child;
+    for (i = child + 1; i < last; i++)
+      if (uv__timer_less(loop->timer_heap + i, loop->timer_heap + best))
+        best = i;
+
+    if (!uv__timer_less(loop->timer_heap + best, &node))
+      break;
+
+    uv__timer_heap_set(loop, index, loop->timer_heap + best);
+    index = best;
+  }
+
+  uv__timer_heap_set(loop, index, &node);
+}
+
+
+static void uv__timer_heap_insert(uv_loop_t* loop, uv_timer_t* handle) {
+  struct uv__timer_heap_node* heap;
+  unsigned int size;
+
+  if (loop->timer_heap_len == loop->timer_heap_size) {
+    size = loop->timer_heap_size ? 2 * loop->timer_heap_size : 16;
+    heap = realloc(loop->timer_heap, size * sizeof(loop->timer_heap[0]));
+
+    if (heap == NULL)
+      abort();
+
+    loop->timer_heap = heap;
+    loop->timer_heap_size = size;
+  }
+
+  handle->heap_index = loop->timer_heap_len++;
+  loop->timer_heap[handle->heap_index].timeout = handle->timeout;
+  loop->timer_heap[handle->heap_index].start_id = handle->start_id;
+  loop->timer_heap[handle->heap_index].handle = handle;
+  uv__timer_heap_sift_up(loop, handle->heap_index);
+}
+
+
+static void uv__timer_heap_remove(uv_loop_t* loop, uv_timer_t* handle) {
+  unsigned int index;
+
+  index = handle->heap_index;
+  assert(index < loop->timer_heap_len);
+  assert(loop->timer_heap[index].handle == handle);
+
+  loop->timer_heap_len--;
+  if (index == loop->timer_heap_len)
+    return;
+
+  /* Plug the hole with the last node and restore the heap property. */
+  uv__timer_heap_set(loop, index, loop->timer_heap + loop->timer_heap_len);
+
+  if (index > 0 &&
+      uv__timer_less(loop->timer_heap + index,
+                     loop->timer_heap + HEAP_PARENT(index))) {
+    uv__timer_heap_sift_up(loop, index);
+  } else {
+    uv__timer_heap_sift_down(loop, index);
+  }
 }
 
 
-RB_GENERATE_STATIC(uv__timers, uv_timer_s, tree_entry, uv__timer_cmp)
+/* Move an active timer to its new position after its key changed. */
+static void uv__timer_heap_update(uv_loop_t* loop, uv_timer_t* handle) {
+  struct uv__timer_heap_node* node;
+  uint64_t old_timeout;
+
+  node = loop->timer_heap + handle->heap_index;
+  assert(node->handle == handle);
+
+  old_timeout = node->timeout;
+  node->timeout = handle->timeout;
+  node->start_id = handle->start_id;
+
+  /* start_id only ever grows so an unchanged timeout moves the node down. */
+  if (handle->timeout < old_timeout)
+    uv__timer_heap_sift_up(loop, handle->heap_index);
+  else
+    uv__timer_heap_sift_down(loop, handle->heap_index);
+}
 
 
 int uv_timer_init(uv_loop_t* loop, uv_timer_t* handle) {
@@ -59,9 +198,6 @@ int uv_timer_start(uv_timer_t* handle,
                    uint64_t repeat) {
   uint64_t clamped_timeout;
 
-  if (uv__is_active(handle))
-    uv_timer_stop(handle);
-
   clamped_timeout = handle->loop->time + timeout;
   if (clamped_timeout < timeout)
     clamped_timeout = (uint64_t) -1;
@@ -69,10 +205,16 @@ int uv_timer_start(uv_timer_t* handle,
   handle->timer_cb = cb;
   handle->timeout = clamped_timeout;
   handle->repeat = repeat;
-  /* start_id is the second index to be compared in uv__timer_cmp() */
+  /* start_id is the second index to be compared in uv__timer_less() */
   handle->start_id = handle->loop->timer_counter++;
 
-  RB_INSERT(uv__timers, &handle->loop->timer_handles, handle);
+  /* Restarting an active timer is the common case, re-key it in place. */
+  if (uv__is_active(handle)) {
+    uv__timer_heap_update(handle->loop, handle);
+    return 0;
+  }
+
+  uv__timer_heap_insert(handle->loop, handle);
   uv__handle_start(handle);
 
   return 0;
@@ -83,7 +225,7 @@ int uv_timer_stop(uv_timer_t* handle) {
   if (!uv__is_active(handle))
     return 0;
 
-  RB_REMOVE(uv__timers, &handle->loop->timer_handles, handle);
+  uv__timer_heap_remove(handle->loop, handle);
   uv__handle_stop(handle);
 
   return 0;
@@ -94,10 +236,8 @@ int uv_timer_again(uv_timer_t* handle) {
   if (handle->timer_cb == NULL)
     return -EINVAL;
 
-  if (handle->repeat) {
-    uv_timer_stop(handle);
+  if (handle->repeat)
     uv_timer_start(handle, handle->timer_cb, handle->repeat, handle->repeat);
-  }
 
   return 0;
 }
@@ -114,19 +254,17 @@ uint64_t uv_timer_get_repeat(const uv_timer_t* handle) {
 
 
 int uv__next_timeout(const uv_loop_t* loop) {
-  const uv_timer_t* handle;
+  uint64_t timeout;
   uint64_t diff;
 
-  /* RB_MIN expects a non-const tree root. That's okay, it doesn't modify it. */
-  handle = RB_MIN(uv__timers, (struct uv__timers*) &loop->timer_handles);
-
-  if (handle == NULL)
+  if (loop->timer_heap_len == 0)
     return -1; /* block indefinitely */
 
-  if (handle->timeout <= loop->time)
+  timeout = loop->timer_heap[0].timeout;
+  if (timeout <= loop->time)
     return 0;
 
-  diff = handle->timeout - loop->time;
+  diff = timeout - loop->time;
   if (diff > INT_MAX)
     diff = INT_MAX;
 
@@ -137,10 +275,11 @@ int uv__next_timeout(const uv_loop_t* loop) {
 void uv__run_timers(uv_loop_t* loop) {
   uv_timer_t* handle;
 
-  while ((handle = RB_MIN(uv__timers, &loop->timer_handles))) {
-    if (handle->timeout > loop->time)
+  while (loop->timer_heap_len > 0) {
+    if (loop->timer_heap[0].timeout > loop->time)
       break;
 
+    handle = loop->timer_heap[0].handle;
     uv_timer_stop(handle);
     uv_timer_again(handle);
     handle->timer_cb(handle, 0);
@@ -28,6 +28,18 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+/* Maximum number of datagrams that are moved with a single recvmmsg() or
+ * sendmmsg() call. Bounds the amount of stack space the batches take up.
+ */
+#define UV__MMSG_MAXWIDTH 64
+
+#if !defined(__linux__)
+struct uv__mmsghdr {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+#endif
+
 
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_run_pending(uv_udp_t* handle);
@@ -83,12 +95,87 @@ void uv__udp_finish_close(uv_udp_t* handle) {
 }
 
 
+#if defined(__linux__)
+/* Writes out the pending queue with as few sendmmsg() calls as possible.
+ * Returns -ENOSYS if the kernel doesn't support it, 0 otherwise.
+ */
+static int uv__udp_sendmmsg(uv_udp_t* handle) {
+  uv_udp_send_t* reqs[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  uv_udp_send_t* req;
+  struct msghdr* h;
+  unsigned int nmsgs;
+  int i;
+  int r;
+  QUEUE* q;
+
+  while (!QUEUE_EMPTY(&handle->write_queue)) {
+    nmsgs = 0;
+    q = QUEUE_HEAD(&handle->write_queue);
+
+    do {
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      h = &msgs[nmsgs].msg_hdr;
+      memset(h, 0, sizeof(*h));
+      h->msg_name = &req->addr;
+      h->msg_namelen = (req->addr.sin6_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+      h->msg_iov = (struct iovec*) req->bufs;
+      h->msg_iovlen = req->bufcnt;
+      reqs[nmsgs++] = req;
+      q = (QUEUE*) QUEUE_NEXT(q);
+    }
+    while (q != &handle->write_queue && nmsgs < UV__MMSG_MAXWIDTH);
+
+    do {
+      r = uv__sendmmsg(handle->io_watcher.fd, msgs, nmsgs, 0);
+    }
+    while (r == -1 && errno == EINTR);
+
+    if (r == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+
+      if (errno == ENOSYS)
+        return -ENOSYS;
+
+      /* Only the first datagram failed, the next call picks up the rest. */
+      reqs[0]->status = -errno;
+      r = 1;
+    }
+    else {
+      for (i = 0; i < r; i++)
+        reqs[i]->status = msgs[i].msg_len;
+    }
+
+    /* Datagrams are sent atomically, see uv__udp_run_pending(). */
+    for (i = 0; i < r; i++) {
+      QUEUE_REMOVE(&reqs[i]->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &reqs[i]->queue);
+    }
+  }
+
+  return 0;
+}
+#endif
+
+
 static void uv__udp_run_pending(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
   struct msghdr h;
   ssize_t size;
 
+#if defined(__linux__)
+  static int no_sendmmsg;
+
+  if (no_sendmmsg == 0) {
+    if (uv__udp_sendmmsg(handle) == 0)
+      return;
+    no_sendmmsg = 1;
+  }
+#endif
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -178,6 +265,132 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+/* Reads up to vlen datagrams. Returns the number of datagrams read or -1 and
+ * sets errno when not even one datagram could be read.
+ */
+static int uv__udp_read_batch(int fd,
+                              struct uv__mmsghdr* msgs,
+                              unsigned int vlen) {
+  ssize_t nread;
+  unsigned int i;
+
+#if defined(__linux__)
+  static int no_recvmmsg;
+  int r;
+
+  if (no_recvmmsg == 0) {
+    do {
+      r = uv__recvmmsg(fd, msgs, vlen, 0, NULL);
+    }
+    while (r == -1 && errno == EINTR);
+
+    if (r != -1 || errno != ENOSYS)
+      return r;
+
+    no_recvmmsg = 1;
+  }
+#endif
+
+  for (i = 0; i < vlen; i++) {
+    do {
+      nread = recvmsg(fd, &msgs[i].msg_hdr, 0);
+    }
+    while (nread == -1 && errno == EINTR);
+
+    if (nread == -1)
+      break;
+
+    msgs[i].msg_len = nread;
+  }
+
+  /* If a read failed halfway, the error is reported by the next batch. */
+  if (i == 0)
+    return -1;
+
+  return i;
+}
+
+
+static void uv__udp_recvmmsg(uv_udp_t* handle) {
+  struct sockaddr_storage peers[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  uv_udp_recv_cb recv_cb;
+  unsigned int nmsgs;
+  unsigned int i;
+  size_t chunklen;
+  uv_buf_t buf;
+  int nread;
+  int flags;
+  int count;
+
+  /* Same starvation guard as uv__udp_recvmsg(), counted in batches. */
+  count = 32;
+
+  do {
+    nmsgs = handle->recv_nmsgs;
+    buf = handle->alloc_cb((uv_handle_t*) handle, nmsgs * 64 * 1024);
+    if (buf.len == 0) {
+      handle->recv_cb(handle, UV_ENOBUFS, buf, NULL, 0);
+      return;
+    }
+    assert(buf.base != NULL);
+
+    if (nmsgs > buf.len)
+      nmsgs = buf.len;
+    chunklen = buf.len / nmsgs;
+
+    for (i = 0; i < nmsgs; i++) {
+      iov[i].iov_base = buf.base + i * chunklen;
+      iov[i].iov_len = chunklen;
+      memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+      msgs[i].msg_hdr.msg_name = &peers[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    nread = uv__udp_read_batch(handle->io_watcher.fd, msgs, nmsgs);
+
+    if (nread == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        handle->recv_cb(handle, 0, buf, NULL, 0);
+      else
+        handle->recv_cb(handle, -errno, buf, NULL, 0);
+      return;
+    }
+
+    /* recv_cb may stop or close the handle. The rest of the batch is dropped
+     * when that happens but the buffer is always handed back.
+     */
+    recv_cb = handle->recv_cb;
+
+    for (i = 0; i < (unsigned int) nread; i++) {
+      if (handle->io_watcher.fd == -1 || handle->recv_cb == NULL)
+        break;
+
+      flags = UV_UDP_MMSG_CHUNK;
+      if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+        flags |= UV_UDP_PARTIAL;
+
+      handle->recv_cb(handle,
+                      msgs[i].msg_len,
+                      uv_buf_init(iov[i].iov_base, msgs[i].msg_len),
+                      (struct sockaddr*) &peers[i],
+                      flags);
+    }
+
+    recv_cb(handle, 0, buf, NULL, 0);
+  }
+  /* A short batch means the socket has been drained. */
+  while (nread == (int) nmsgs
+      && count-- > 0
+      && handle->io_watcher.fd != -1
+      && handle->recv_cb != NULL
+      && handle->recv_nmsgs != 0);
+}
+
+
 static void uv__udp_recvmsg(uv_loop_t* loop,
                             uv__io_t* w,
                             unsigned int revents) {
@@ -196,6 +409,11 @@ static void uv__udp_recvmsg(uv_loop_t* loop,
   assert(handle->recv_cb != NULL);
   assert(handle->alloc_cb != NULL);
 
+  if (handle->recv_nmsgs != 0) {
+    uv__udp_recvmmsg(handle);
+    return;
+  }
+
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
    * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
    */
@@ -438,6 +656,7 @@ int uv_udp_init(uv_loop_t* loop, uv_udp_t* handle) {
   uv__handle_init(loop, (uv_handle_t*)handle, UV_UDP);
   handle->alloc_cb = NULL;
   handle->recv_cb = NULL;
+  handle->recv_nmsgs = 0;
   uv__io_init(&handle->io_watcher, uv__udp_io, -1);
   QUEUE_INIT(&handle->write_queue);
   QUEUE_INIT(&handle->write_completed_queue);
@@ -650,6 +869,7 @@ int uv__udp_recv_start(uv_udp_t* handle,
 
   handle->alloc_cb = alloc_cb;
   handle->recv_cb = recv_cb;
+  handle->recv_nmsgs = 0;
 
   uv__io_start(handle->loop, &handle->io_watcher, UV__POLLIN);
   uv__handle_start(handle);
@@ -658,6 +878,24 @@ int uv__udp_recv_start(uv_udp_t* handle,
 }
 
 
+int uv__udp_recv_batch_start(uv_udp_t* handle,
+                             unsigned int nmsgs,
+                             uv_alloc_cb alloc_cb,
+                             uv_udp_recv_cb recv_cb) {
+  int err;
+
+  err = uv__udp_recv_start(handle, alloc_cb, recv_cb);
+  if (err)
+    return err;
+
+  if (nmsgs > UV__MMSG_MAXWIDTH)
+    nmsgs = UV__MMSG_MAXWIDTH;
+
+  handle->recv_nmsgs = nmsgs;
+  return 0;
+}
+
+
 int uv__udp_recv_stop(uv_udp_t* handle) {
   uv__io_stop(handle->loop, &handle->io_watcher, UV__POLLIN);
 
@@ -666,6 +904,7 @@ int uv__udp_recv_stop(uv_udp_t* handle) {
 
   handle->alloc_cb = NULL;
   handle->recv_cb = NULL;
+  handle->recv_nmsgs = 0;
 
   return 0;
 }
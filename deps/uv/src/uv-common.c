@@ -280,6 +280,18 @@ int uv_udp_recv_start(uv_udp_t* handle,
 }
 
 
+int uv_udp_recv_batch_start(uv_udp_t* handle,
+                            unsigned int nmsgs,
+                            uv_alloc_cb alloc_cb,
+                            uv_udp_recv_cb recv_cb) {
+  if (handle->type != UV_UDP || nmsgs == 0 || alloc_cb == NULL ||
+      recv_cb == NULL)
+    return UV_EINVAL;
+  else
+    return uv__udp_recv_batch_start(handle, nmsgs, alloc_cb, recv_cb);
+}
+
+
 int uv_udp_recv_stop(uv_udp_t* handle) {
   if (handle->type != UV_UDP)
     return UV_EINVAL;
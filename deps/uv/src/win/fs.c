@@ -614,6 +614,95 @@ void fs__write(uv_fs_t* req) {
 }
 
 
+/* Windows has no scatter/gather I/O for handles that aren't opened for
+ * overlapped, unbuffered I/O, do one buffer at a time.
+ */
+static void fs__rwv(uv_fs_t* req, int write) {
+  int fd = req->fd;
+  int64_t offset = req->offset;
+  HANDLE handle;
+  OVERLAPPED overlapped, *overlapped_ptr;
+  LARGE_INTEGER offset_;
+  DWORD bytes;
+  DWORD error;
+  int64_t total;
+  unsigned int i;
+  BOOL ok;
+
+  VERIFY_FD(fd, req);
+
+  handle = (HANDLE) _get_osfhandle(fd);
+  if (handle == INVALID_HANDLE_VALUE) {
+    SET_REQ_RESULT(req, -1);
+    return;
+  }
+
+  total = 0;
+  error = 0;
+
+  for (i = 0; i < req->nbufs; i++) {
+    if (offset != -1) {
+      memset(&overlapped, 0, sizeof overlapped);
+
+      offset_.QuadPart = offset + total;
+      overlapped.Offset = offset_.LowPart;
+      overlapped.OffsetHigh = offset_.HighPart;
+
+      overlapped_ptr = &overlapped;
+    } else {
+      overlapped_ptr = NULL;
+    }
+
+    bytes = 0;
+    if (write) {
+      ok = WriteFile(handle,
+                     req->bufs[i].base,
+                     req->bufs[i].len,
+                     &bytes,
+                     overlapped_ptr);
+    } else {
+      ok = ReadFile(handle,
+                    req->bufs[i].base,
+                    req->bufs[i].len,
+                    &bytes,
+                    overlapped_ptr);
+    }
+
+    if (!ok) {
+      error = GetLastError();
+      if (error == ERROR_HANDLE_EOF && !write)
+        error = 0;
+      break;
+    }
+
+    total += bytes;
+    if (bytes < req->bufs[i].len)
+      break;
+  }
+
+  if (error != 0 && total == 0)
+    SET_REQ_WIN32_ERROR(req, error);
+  else
+    SET_REQ_RESULT(req, total);
+}
+
+
+void fs__readv(uv_fs_t* req) {
+  fs__rwv(req, 0);
+  if (req->bufs != req->bufsml)
+    free(req->bufs);
+  req->bufs = NULL;
+}
+
+
+void fs__writev(uv_fs_t* req) {
+  fs__rwv(req, 1);
+  if (req->bufs != req->bufsml)
+    free(req->bufs);
+  req->bufs = NULL;
+}
+
+
 void fs__rmdir(uv_fs_t* req) {
   int result = _wrmdir(req->pathw);
   SET_REQ_RESULT(req, result);
@@ -1434,6 +1523,8 @@ static DWORD WINAPI uv_fs_thread_proc(void* parameter) {
     XX(CLOSE, close)
     XX(READ, read)
     XX(WRITE, write)
+    XX(READV, readv)
+    XX(WRITEV, writev)
     XX(SENDFILE, sendfile)
     XX(STAT, stat)
     XX(LSTAT, lstat)
@@ -1540,6 +1631,57 @@ int uv_fs_write(uv_loop_t* loop, uv_fs_t* req, uv_file fd, const void* buf,
 }
 
 
+INLINE static int fs__init_bufs(uv_fs_t* req, const uv_buf_t bufs[],
+    unsigned int nbufs) {
+  req->nbufs = nbufs;
+  req->bufs = req->bufsml;
+  if (nbufs > ARRAY_SIZE(req->bufsml))
+    req->bufs = malloc(nbufs * sizeof(*bufs));
+  if (req->bufs == NULL)
+    return UV_ENOMEM;
+  memcpy(req->bufs, bufs, nbufs * sizeof(*bufs));
+  return 0;
+}
+
+
+int uv_fs_readv(uv_loop_t* loop, uv_fs_t* req, uv_file fd,
+    const uv_buf_t bufs[], unsigned int nbufs, int64_t offset, uv_fs_cb cb) {
+  uv_fs_req_init(loop, req, UV_FS_READV, cb);
+
+  req->fd = fd;
+  req->offset = offset;
+  if (fs__init_bufs(req, bufs, nbufs))
+    return UV_ENOMEM;
+
+  if (cb) {
+    QUEUE_FS_TP_JOB(loop, req);
+    return 0;
+  } else {
+    fs__readv(req);
+    return req->result;
+  }
+}
+
+
+int uv_fs_writev(uv_loop_t* loop, uv_fs_t* req, uv_file fd,
+    const uv_buf_t bufs[], unsigned int nbufs, int64_t offset, uv_fs_cb cb) {
+  uv_fs_req_init(loop, req, UV_FS_WRITEV, cb);
+
+  req->fd = fd;
+  req->offset = offset;
+  if (fs__init_bufs(req, bufs, nbufs))
+    return UV_ENOMEM;
+
+  if (cb) {
+    QUEUE_FS_TP_JOB(loop, req);
+    return 0;
+  } else {
+    fs__writev(req);
+    return req->result;
+  }
+}
+
+
 int uv_fs_unlink(uv_loop_t* loop, uv_fs_t* req, const char* path,
     uv_fs_cb cb) {
   int err;
@@ -189,6 +189,12 @@ int uv_write2(uv_write_t* req, uv_stream_t* handle, uv_buf_t bufs[], int bufcnt,
 }
 
 
+int uv_sendfile(uv_write_t* req, uv_stream_t* handle, uv_file file,
+    int64_t offset, size_t length, uv_write_cb cb) {
+  return UV_ENOTSUP;
+}
+
+
 int uv_shutdown(uv_shutdown_t* req, uv_stream_t* handle, uv_shutdown_cb cb) {
   uv_loop_t* loop = handle->loop;
 
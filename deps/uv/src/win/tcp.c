@@ -1241,6 +1241,14 @@ int uv_tcp_duplicate_socket(uv_tcp_t* handle, int pid,
 }
 
 
+int uv_tcp_reuseport(uv_tcp_t* handle, int enable) {
+  /* SO_REUSEADDR already lets Windows sockets share a port but without
+   * balancing connections, which is what callers of this function want.
+   */
+  return enable ? UV_ENOTSUP : 0;
+}
+
+
 int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable) {
   if (handle->flags & UV_HANDLE_CONNECTION) {
     return UV_EINVAL;
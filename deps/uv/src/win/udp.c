@@ -376,6 +376,17 @@ int uv__udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloc_cb,
 }
 
 
+/* Windows has no batched receive. Read one datagram per allocation, callers
+ * can tell because recv_cb never sees UV_UDP_MMSG_CHUNK.
+ */
+int uv__udp_recv_batch_start(uv_udp_t* handle,
+                             unsigned int nmsgs,
+                             uv_alloc_cb alloc_cb,
+                             uv_udp_recv_cb recv_cb) {
+  return uv__udp_recv_start(handle, alloc_cb, recv_cb);
+}
+
+
 int uv__udp_recv_stop(uv_udp_t* handle) {
   if (handle->flags & UV_HANDLE_READING) {
     handle->flags &= ~UV_HANDLE_READING;
@@ -0,0 +1,149 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "task.h"
+#include "uv.h"
+
+#include <stdio.h>
+
+#define NUM_SLOW_JOBS   64
+#define SLOW_JOB_MS     10
+#define NUM_STATS       20000
+#define NUM_LOOKUPS     2000
+#define CONCURRENCY     4
+
+static uv_work_t slow_reqs[NUM_SLOW_JOBS];
+static uv_fs_t stat_reqs[CONCURRENCY];
+static uv_getaddrinfo_t lookup_reqs[CONCURRENCY];
+
+static int slow_done;
+static int stats_started;
+static int stats_done;
+static int lookups_started;
+static int lookups_done;
+
+static uint64_t start_time;
+static uint64_t slow_time;
+static uint64_t stats_time;
+static uint64_t lookups_time;
+static uint64_t first_stat_time;
+
+
+static void slow_work_cb(uv_work_t* req) {
+  uv_sleep(SLOW_JOB_MS);
+}
+
+
+static void slow_after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  if (++slow_done == NUM_SLOW_JOBS)
+    slow_time = uv_hrtime();
+}
+
+
+static void stat_cb(uv_fs_t* req) {
+  ASSERT(req->result == 0);
+  uv_fs_req_cleanup(req);
+
+  if (stats_done++ == 0)
+    first_stat_time = uv_hrtime();
+  if (stats_done == NUM_STATS)
+    stats_time = uv_hrtime();
+
+  if (stats_started < NUM_STATS) {
+    stats_started++;
+    ASSERT(0 == uv_fs_stat(uv_default_loop(), req, ".", stat_cb));
+  }
+}
+
+
+static void getaddrinfo_cb(uv_getaddrinfo_t* req,
+                           int status,
+                           struct addrinfo* res) {
+  ASSERT(status == 0);
+  uv_freeaddrinfo(res);
+
+  if (++lookups_done == NUM_LOOKUPS)
+    lookups_time = uv_hrtime();
+
+  if (lookups_started < NUM_LOOKUPS) {
+    lookups_started++;
+    ASSERT(0 == uv_getaddrinfo(uv_default_loop(),
+                               req,
+                               getaddrinfo_cb,
+                               "localhost",
+                               NULL,
+                               NULL));
+  }
+}
+
+
+/* A backlog of slow jobs, then a steady stream of stat() calls and DNS
+ * lookups on top of it. What matters is how long the quick requests are held
+ * up by the slow ones.
+ */
+BENCHMARK_IMPL(threadpool_mix) {
+  uv_loop_t* loop;
+  int i;
+
+  loop = uv_default_loop();
+  start_time = uv_hrtime();
+
+  for (i = 0; i < NUM_SLOW_JOBS; i++)
+    ASSERT(0 == uv_queue_work(loop,
+                              slow_reqs + i,
+                              slow_work_cb,
+                              slow_after_work_cb));
+
+  for (i = 0; i < CONCURRENCY; i++) {
+    stats_started++;
+    ASSERT(0 == uv_fs_stat(loop, stat_reqs + i, ".", stat_cb));
+
+    lookups_started++;
+    ASSERT(0 == uv_getaddrinfo(loop,
+                               lookup_reqs + i,
+                               getaddrinfo_cb,
+                               "localhost",
+                               NULL,
+                               NULL));
+  }
+
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  ASSERT(slow_done == NUM_SLOW_JOBS);
+  ASSERT(stats_done == NUM_STATS);
+  ASSERT(lookups_done == NUM_LOOKUPS);
+
+  LOGF("threadpool_mix: first stat after %.1f ms\n",
+       (first_stat_time - start_time) / 1e6);
+  LOGF("threadpool_mix: %d stats in %.1f ms\n",
+       NUM_STATS,
+       (stats_time - start_time) / 1e6);
+  LOGF("threadpool_mix: %d lookups in %.1f ms\n",
+       NUM_LOOKUPS,
+       (lookups_time - start_time) / 1e6);
+  LOGF("threadpool_mix: %d slow jobs in %.1f ms\n",
+       NUM_SLOW_JOBS,
+       (slow_time - start_time) / 1e6);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,101 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "task.h"
+#include "uv.h"
+
+#define NUM_TIMERS (100 * 1000)
+#define NUM_ROUNDS 20
+
+
+static void timer_cb(uv_timer_t* handle, int status) {
+  ASSERT(0 && "timer_cb should not be called");
+}
+
+
+/* Mimics idle timeouts on busy connections: every timer is re-armed over
+ * and over again while only a handful of them ever expire.
+ */
+BENCHMARK_IMPL(timer_churn) {
+  uv_timer_t* timers;
+  uv_loop_t* loop;
+  uint64_t before;
+  uint64_t after;
+  uint64_t ops;
+  int round;
+  int i;
+
+  timers = malloc(NUM_TIMERS * sizeof(timers[0]));
+  ASSERT(timers != NULL);
+
+  loop = uv_default_loop();
+  ops = 0;
+
+  for (i = 0; i < NUM_TIMERS; i++) {
+    ASSERT(0 == uv_timer_init(loop, timers + i));
+    ASSERT(0 == uv_timer_start(timers + i,
+                               timer_cb,
+                               60000 + i % 1000,
+                               60000 + i % 997));
+  }
+
+  before = uv_hrtime();
+
+  for (round = 0; round < NUM_ROUNDS; round++) {
+    for (i = 0; i < NUM_TIMERS; i++) {
+      switch ((i + round) % 3) {
+        case 0:
+          ASSERT(0 == uv_timer_again(timers + i));
+          break;
+        case 1:
+          ASSERT(0 == uv_timer_start(timers + i,
+                                     timer_cb,
+                                     60000 + (i * 7 + round) % 1000,
+                                     60000));
+          break;
+        case 2:
+          ASSERT(0 == uv_timer_stop(timers + i));
+          ASSERT(0 == uv_timer_start(timers + i, timer_cb, 90000, 60000));
+          break;
+      }
+      ops++;
+
+      /* The loop asks for the next timeout once per iteration. */
+      if (i % 64 == 0)
+        ASSERT(uv_backend_timeout(loop) > 0);
+    }
+  }
+
+  after = uv_hrtime();
+
+  for (i = 0; i < NUM_TIMERS; i++)
+    uv_close((uv_handle_t*) (timers + i), NULL);
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  free(timers);
+
+  LOGF("timer_churn: %d timers, %.0f ops/s\n",
+       NUM_TIMERS,
+       ops / ((after - before) / 1e9));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
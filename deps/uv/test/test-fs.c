@@ -1938,3 +1938,98 @@ TEST_IMPL(fs_read_file_eof) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+TEST_IMPL(fs_readv_writev) {
+  char data[] = "abcdefghijklmnopqrstuvwxyz";
+  char out[sizeof(data)];
+  uv_buf_t bufs[6];
+  unsigned int i;
+  int r;
+
+  /* Setup. */
+  unlink("test_file");
+
+  loop = uv_default_loop();
+
+  r = uv_fs_open(loop, &open_req1, "test_file", O_RDWR | O_CREAT,
+      S_IWUSR | S_IRUSR, NULL);
+  ASSERT(r >= 0);
+  ASSERT(open_req1.result >= 0);
+  uv_fs_req_cleanup(&open_req1);
+
+  /* More buffers than fit in req->bufsml. */
+  for (i = 0; i < ARRAY_SIZE(bufs); i++)
+    bufs[i] = uv_buf_init(data + i * 4, 4);
+
+  r = uv_fs_writev(loop, &write_req, open_req1.result, bufs,
+      ARRAY_SIZE(bufs), -1, NULL);
+  ASSERT(r == 24);
+  ASSERT(write_req.result == 24);
+  uv_fs_req_cleanup(&write_req);
+
+  /* offset == -1 continues at the current file position. */
+  bufs[0] = uv_buf_init(data + 24, 1);
+  bufs[1] = uv_buf_init(data + 25, 1);
+  r = uv_fs_writev(loop, &write_req, open_req1.result, bufs, 2, -1, NULL);
+  ASSERT(r == 2);
+  ASSERT(write_req.result == 2);
+  uv_fs_req_cleanup(&write_req);
+
+  memset(out, 0, sizeof(out));
+  for (i = 0; i < ARRAY_SIZE(bufs); i++)
+    bufs[i] = uv_buf_init(out + i * 4, 4);
+
+  r = uv_fs_readv(loop, &read_req, open_req1.result, bufs,
+      ARRAY_SIZE(bufs), 0, NULL);
+  ASSERT(r == 24);
+  ASSERT(read_req.result == 24);
+  ASSERT(memcmp(out, data, 24) == 0);
+  uv_fs_req_cleanup(&read_req);
+
+  /* Short read at EOF: only two bytes are left past offset 24. */
+  memset(out, 0, sizeof(out));
+  r = uv_fs_readv(loop, &read_req, open_req1.result, bufs,
+      ARRAY_SIZE(bufs), 24, NULL);
+  ASSERT(r == 2);
+  ASSERT(read_req.result == 2);
+  ASSERT(memcmp(out, "yz", 2) == 0);
+  uv_fs_req_cleanup(&read_req);
+
+  r = uv_fs_readv(loop, &read_req, open_req1.result, bufs,
+      ARRAY_SIZE(bufs), 26, NULL);
+  ASSERT(r == 0);
+  ASSERT(read_req.result == 0);
+  uv_fs_req_cleanup(&read_req);
+
+  /* offset == -1 reads from, and advances, the current file position. */
+  r = uv_fs_close(loop, &close_req, open_req1.result, NULL);
+  ASSERT(r == 0);
+  uv_fs_req_cleanup(&close_req);
+
+  r = uv_fs_open(loop, &open_req1, "test_file", O_RDONLY, 0, NULL);
+  ASSERT(r >= 0);
+  uv_fs_req_cleanup(&open_req1);
+
+  memset(out, 0, sizeof(out));
+  r = uv_fs_readv(loop, &read_req, open_req1.result, bufs, 2, -1, NULL);
+  ASSERT(r == 8);
+  ASSERT(memcmp(out, "abcdefgh", 8) == 0);
+  uv_fs_req_cleanup(&read_req);
+
+  r = uv_fs_readv(loop, &read_req, open_req1.result, bufs, 1, -1, NULL);
+  ASSERT(r == 4);
+  ASSERT(memcmp(out, "ijkl", 4) == 0);
+  uv_fs_req_cleanup(&read_req);
+
+  r = uv_fs_close(loop, &close_req, open_req1.result, NULL);
+  ASSERT(r == 0);
+  ASSERT(close_req.result == 0);
+  uv_fs_req_cleanup(&close_req);
+
+  /* Cleanup */
+  unlink("test_file");
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -442,6 +442,97 @@ TEST_IMPL(spawn_preserve_env) {
 }
 
 
+TEST_IMPL(spawn_custom_env) {
+  int r;
+  uv_pipe_t out;
+  uv_stdio_container_t stdio[2];
+  char* env[] = { "ENV_TEST=custom", NULL };
+
+  init_process_options("spawn_helper7", exit_cb);
+
+  uv_pipe_init(uv_default_loop(), &out, 0);
+  options.stdio = stdio;
+  options.stdio[0].flags = UV_IGNORE;
+  options.stdio[1].flags = UV_CREATE_PIPE | UV_WRITABLE_PIPE;
+  options.stdio[1].data.stream = (uv_stream_t*) &out;
+  options.stdio_count = 2;
+
+  r = putenv("ENV_TEST=testval");
+  ASSERT(r == 0);
+
+  options.env = env;
+
+  r = uv_spawn(uv_default_loop(), &process, options);
+  ASSERT(r == 0);
+
+  r = uv_read_start((uv_stream_t*) &out, on_alloc, on_read);
+  ASSERT(r == 0);
+
+  r = uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(r == 0);
+
+  ASSERT(exit_cb_called == 1);
+  ASSERT(close_cb_called == 2);
+
+  printf("output is: %s", output);
+  ASSERT(strcmp("custom", output) == 0);
+
+  /* The child's environment must not leak into the parent. */
+  ASSERT(strcmp("testval", getenv("ENV_TEST")) == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+#ifndef _WIN32
+TEST_IMPL(spawn_custom_path) {
+  int r;
+  uv_pipe_t out;
+  uv_stdio_container_t stdio[2];
+  char path[1100];
+  char* env[] = { path, "ENV_TEST=custom path", NULL };
+  char* name;
+
+  init_process_options("spawn_helper7", exit_cb);
+
+  /* Look the test runner up by name, in a PATH that only the child has. */
+  name = strrchr(exepath, '/');
+  ASSERT(name != NULL);
+  *name++ = '\0';
+  snprintf(path, sizeof(path), "PATH=/nonexistent:%s", exepath);
+  options.file = name;
+  args[0] = name;
+  options.env = env;
+
+  uv_pipe_init(uv_default_loop(), &out, 0);
+  options.stdio = stdio;
+  options.stdio[0].flags = UV_IGNORE;
+  options.stdio[1].flags = UV_CREATE_PIPE | UV_WRITABLE_PIPE;
+  options.stdio[1].data.stream = (uv_stream_t*) &out;
+  options.stdio_count = 2;
+
+  r = uv_spawn(uv_default_loop(), &process, options);
+  ASSERT(r == 0);
+
+  r = uv_read_start((uv_stream_t*) &out, on_alloc, on_read);
+  ASSERT(r == 0);
+
+  r = uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(r == 0);
+
+  ASSERT(exit_cb_called == 1);
+  ASSERT(close_cb_called == 2);
+
+  printf("output is: %s", output);
+  ASSERT(strcmp("custom path", output) == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+#endif
+
+
 TEST_IMPL(spawn_detached) {
   int r;
 
@@ -0,0 +1,137 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_CLIENTS 32
+
+static uv_tcp_t servers[2];
+static uv_tcp_t clients[NUM_CLIENTS];
+static uv_tcp_t accepted[NUM_CLIENTS];
+static uv_connect_t connect_reqs[NUM_CLIENTS];
+static int accepted_by[2];
+static int num_accepted;
+static int connect_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void maybe_close_all(void) {
+  int i;
+
+  if (num_accepted != NUM_CLIENTS || connect_cb_called != NUM_CLIENTS)
+    return;
+
+  for (i = 0; i < NUM_CLIENTS; i++) {
+    uv_close((uv_handle_t*) &clients[i], close_cb);
+    uv_close((uv_handle_t*) &accepted[i], close_cb);
+  }
+
+  uv_close((uv_handle_t*) &servers[0], close_cb);
+  uv_close((uv_handle_t*) &servers[1], close_cb);
+}
+
+
+static void connection_cb(uv_stream_t* server, int status) {
+  int r;
+
+  ASSERT(status == 0);
+  ASSERT(num_accepted < NUM_CLIENTS);
+
+  r = uv_tcp_init(server->loop, &accepted[num_accepted]);
+  ASSERT(r == 0);
+
+  r = uv_accept(server, (uv_stream_t*) &accepted[num_accepted]);
+  ASSERT(r == 0);
+
+  accepted_by[(uv_tcp_t*) server - servers]++;
+  num_accepted++;
+  maybe_close_all();
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  ASSERT(status == 0);
+  connect_cb_called++;
+  maybe_close_all();
+}
+
+
+TEST_IMPL(tcp_reuseport) {
+  struct sockaddr_in addr;
+  int r;
+  int i;
+
+  addr = uv_ip4_addr("127.0.0.1", TEST_PORT);
+
+  for (i = 0; i < 2; i++) {
+    r = uv_tcp_init(uv_default_loop(), &servers[i]);
+    ASSERT(r == 0);
+
+    r = uv_tcp_reuseport(&servers[i], 1);
+    if (r == UV_ENOTSUP)
+      RETURN_SKIP("SO_REUSEPORT is not supported.");
+    ASSERT(r == 0);
+
+    r = uv_tcp_bind(&servers[i], addr);
+    if (r == UV_ENOTSUP)
+      RETURN_SKIP("SO_REUSEPORT is not supported by the kernel.");
+    ASSERT(r == 0);
+
+    /* Would fail with UV_EADDRINUSE without SO_REUSEPORT. */
+    r = uv_listen((uv_stream_t*) &servers[i], 128, connection_cb);
+    ASSERT(r == 0);
+  }
+
+  for (i = 0; i < NUM_CLIENTS; i++) {
+    r = uv_tcp_init(uv_default_loop(), &clients[i]);
+    ASSERT(r == 0);
+
+    r = uv_tcp_connect(&connect_reqs[i], &clients[i], addr, connect_cb);
+    ASSERT(r == 0);
+  }
+
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(num_accepted == NUM_CLIENTS);
+  ASSERT(connect_cb_called == NUM_CLIENTS);
+  ASSERT(close_cb_called == 2 * NUM_CLIENTS + 2);
+
+#ifdef __linux__
+  /* The kernel hashes connections over the listeners. The odds of all of
+   * them ending up with one listener are 1 in 2^31.
+   */
+  ASSERT(accepted_by[0] > 0);
+  ASSERT(accepted_by[1] > 0);
+#endif
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
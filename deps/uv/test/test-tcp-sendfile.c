@@ -0,0 +1,251 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_SIZE (8 * 1024 * 1024)
+#define FILE_OFFSET 3
+#define TAIL_SIZE 10
+
+static uv_tcp_t tcp_server;
+static uv_tcp_t tcp_client;
+static uv_tcp_t tcp_peer; /* client socket as accept()-ed by server */
+static uv_connect_t connect_req;
+static uv_write_t write_reqs[5];
+static uv_file file;
+static char* expected;
+static size_t expected_size;
+static size_t nread_total;
+
+static int write_cb_called;
+static int eof_cb_called;
+static int last_cb_called;
+static int read_eof_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT(status == 0);
+  write_cb_called++;
+}
+
+
+/* Asks for more than there is in the file. */
+static void eof_cb(uv_write_t* req, int status) {
+  ASSERT(status == UV_EOF);
+  ASSERT(write_cb_called == 3);
+  eof_cb_called++;
+}
+
+
+/* Queued after the request that ran into EOF, still goes out. */
+static void last_cb(uv_write_t* req, int status) {
+  ASSERT(status == 0);
+  ASSERT(eof_cb_called == 1);
+  last_cb_called++;
+  uv_close((uv_handle_t*) &tcp_peer, close_cb);
+}
+
+
+static void connection_cb(uv_stream_t* server, int status) {
+  uv_buf_t buf;
+  int r;
+
+  ASSERT(status == 0);
+
+  r = uv_tcp_init(server->loop, &tcp_peer);
+  ASSERT(r == 0);
+
+  r = uv_accept(server, (uv_stream_t*) &tcp_peer);
+  ASSERT(r == 0);
+
+  buf = uv_buf_init("head", 4);
+  r = uv_write(&write_reqs[0], (uv_stream_t*) &tcp_peer, &buf, 1, write_cb);
+  ASSERT(r == 0);
+
+  r = uv_sendfile(&write_reqs[1],
+                  (uv_stream_t*) &tcp_peer,
+                  file,
+                  FILE_OFFSET,
+                  FILE_SIZE - FILE_OFFSET,
+                  write_cb);
+  ASSERT(r == 0);
+
+  buf = uv_buf_init("tail", 4);
+  r = uv_write(&write_reqs[2], (uv_stream_t*) &tcp_peer, &buf, 1, write_cb);
+  ASSERT(r == 0);
+
+  r = uv_sendfile(&write_reqs[3],
+                  (uv_stream_t*) &tcp_peer,
+                  file,
+                  FILE_SIZE - TAIL_SIZE,
+                  2 * TAIL_SIZE,
+                  eof_cb);
+  ASSERT(r == 0);
+
+  buf = uv_buf_init("last", 4);
+  r = uv_write(&write_reqs[4], (uv_stream_t*) &tcp_peer, &buf, 1, last_cb);
+  ASSERT(r == 0);
+
+  uv_close((uv_handle_t*) &tcp_server, close_cb);
+}
+
+
+static uv_buf_t alloc_cb(uv_handle_t* handle, size_t suggested_size) {
+  static char slab[65536];
+  return uv_buf_init(slab, sizeof slab);
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, uv_buf_t buf) {
+  if (nread < 0) {
+    ASSERT(nread == UV_EOF);
+    ASSERT(nread_total == expected_size);
+    read_eof_called++;
+    uv_close((uv_handle_t*) stream, close_cb);
+    return;
+  }
+
+  ASSERT(nread_total + nread <= expected_size);
+  ASSERT(memcmp(expected + nread_total, buf.base, nread) == 0);
+  nread_total += nread;
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  int r;
+
+  ASSERT(status == 0);
+
+  r = uv_read_start((uv_stream_t*) &tcp_client, alloc_cb, read_cb);
+  ASSERT(r == 0);
+}
+
+
+static void make_file(void) {
+  uv_fs_t req;
+  char* data;
+  char* p;
+  int r;
+  int i;
+
+  data = malloc(FILE_SIZE);
+  ASSERT(data != NULL);
+
+  for (i = 0; i < FILE_SIZE; i++)
+    data[i] = i % 251;
+
+  unlink("test_file");
+  r = uv_fs_open(uv_default_loop(), &req, "test_file",
+      O_RDWR | O_CREAT, S_IWUSR | S_IRUSR, NULL);
+  ASSERT(r >= 0);
+  file = r;
+  uv_fs_req_cleanup(&req);
+
+  r = uv_fs_write(uv_default_loop(), &req, file, data, FILE_SIZE, 0, NULL);
+  ASSERT(r == FILE_SIZE);
+  uv_fs_req_cleanup(&req);
+
+#if defined(__linux__)
+  /* Drop it from the page cache so it's read in on the threadpool. */
+  r = uv_fs_fsync(uv_default_loop(), &req, file, NULL);
+  ASSERT(r == 0);
+  uv_fs_req_cleanup(&req);
+  posix_fadvise(file, 0, FILE_SIZE, POSIX_FADV_DONTNEED);
+#endif
+
+  /* What the client should see: the head, the file, the tail, the bit of
+   * the file that is left and the last write.
+   */
+  expected_size = 4 + (FILE_SIZE - FILE_OFFSET) + 4 + TAIL_SIZE + 4;
+  expected = malloc(expected_size);
+  ASSERT(expected != NULL);
+
+  p = expected;
+  memcpy(p, "head", 4);
+  p += 4;
+  memcpy(p, data + FILE_OFFSET, FILE_SIZE - FILE_OFFSET);
+  p += FILE_SIZE - FILE_OFFSET;
+  memcpy(p, "tail", 4);
+  p += 4;
+  memcpy(p, data + FILE_SIZE - TAIL_SIZE, TAIL_SIZE);
+  p += TAIL_SIZE;
+  memcpy(p, "last", 4);
+
+  free(data);
+}
+
+
+TEST_IMPL(tcp_sendfile) {
+  struct sockaddr_in addr;
+  uv_fs_t req;
+  int r;
+
+#ifdef _WIN32
+  RETURN_SKIP("uv_sendfile() is not supported on Windows.");
+#endif
+
+  addr = uv_ip4_addr("127.0.0.1", TEST_PORT);
+
+  make_file();
+
+  r = uv_tcp_init(uv_default_loop(), &tcp_server);
+  ASSERT(r == 0);
+
+  r = uv_tcp_bind(&tcp_server, addr);
+  ASSERT(r == 0);
+
+  r = uv_listen((uv_stream_t*) &tcp_server, 1, connection_cb);
+  ASSERT(r == 0);
+
+  r = uv_tcp_init(uv_default_loop(), &tcp_client);
+  ASSERT(r == 0);
+
+  r = uv_tcp_connect(&connect_req, &tcp_client, addr, connect_cb);
+  ASSERT(r == 0);
+
+  r = uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(r == 0);
+
+  ASSERT(write_cb_called == 3);
+  ASSERT(eof_cb_called == 1);
+  ASSERT(last_cb_called == 1);
+  ASSERT(read_eof_called == 1);
+  ASSERT(nread_total == expected_size);
+
+  uv_fs_close(uv_default_loop(), &req, file, NULL);
+  uv_fs_req_cleanup(&req);
+  unlink("test_file");
+  free(expected);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
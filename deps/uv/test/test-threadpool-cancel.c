@@ -47,6 +47,8 @@ static unsigned done_cb_called;
 static unsigned done2_cb_called;
 static unsigned timer_cb_called;
 static unsigned getaddrinfo_cb_called;
+static unsigned stat_cb_called;
+static ssize_t stat_result;
 
 
 static void work_cb(uv_work_t* req) {
@@ -117,6 +119,13 @@ static void fs_cb(uv_fs_t* req) {
 }
 
 
+static void stat_cb(uv_fs_t* req) {
+  stat_result = req->result;
+  uv_fs_req_cleanup(req);
+  stat_cb_called++;
+}
+
+
 static void getaddrinfo_cb(uv_getaddrinfo_t* req,
                            int status,
                            struct addrinfo* res) {
@@ -232,6 +241,15 @@ TEST_IMPL(threadpool_cancel_fs) {
   uv_loop_t* loop;
   unsigned n;
 
+#if defined(__linux__)
+  /* timer_cb() cancels the requests after the loop has submitted them. By
+   * then requests that went to io_uring count as executing, this test is
+   * about the ones waiting for the thread pool. See
+   * threadpool_cancel_fs_iouring for the others.
+   */
+  ASSERT(0 == setenv("UV_USE_IO_URING", "0", 1));
+#endif
+
   INIT_CANCEL_INFO(&ci, reqs);
   loop = uv_default_loop();
   saturate_threadpool();
@@ -278,6 +296,48 @@ TEST_IMPL(threadpool_cancel_fs) {
 }
 
 
+TEST_IMPL(threadpool_cancel_fs_iouring) {
+#if !defined(__linux__)
+  RETURN_SKIP("io_uring is only available on Linux.");
+#else
+  struct cancel_info ci;
+  uv_fs_t reqs[2];
+  uv_loop_t* loop;
+  int r;
+
+  ci.nreqs = 0;  /* timer_cb() only unblocks the thread pool. */
+  loop = uv_default_loop();
+  saturate_threadpool();
+
+  /* Not submitted yet, it can be cancelled. */
+  ASSERT(0 == uv_fs_stat(loop, reqs + 0, "/", fs_cb));
+  ASSERT(0 == uv_cancel((uv_req_t*) (reqs + 0)));
+
+  /* One turn of the loop hands it to the kernel, after that it can't be
+   * cancelled anymore even though the thread pool is still saturated.
+   * Without io_uring (old kernel, seccomp) it is waiting for a thread.
+   */
+  ASSERT(0 == uv_fs_stat(loop, reqs + 1, "/", stat_cb));
+  uv_run(loop, UV_RUN_NOWAIT);
+  r = uv_cancel((uv_req_t*) (reqs + 1));
+  ASSERT(r == 0 || r == UV_EBUSY);
+
+  ASSERT(0 == uv_timer_init(loop, &ci.timer_handle));
+  ASSERT(0 == uv_timer_start(&ci.timer_handle, timer_cb, 10, 0));
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(1 == timer_cb_called);
+  ASSERT(1 == fs_cb_called);
+  ASSERT(1 == stat_cb_called);
+  ASSERT(stat_result == (r == 0 ? UV_ECANCELED : 0));
+
+  cleanup_threadpool();
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
+
+
 TEST_IMPL(threadpool_cancel_single) {
   uv_loop_t* loop;
   uv_work_t req;
@@ -24,6 +24,8 @@
 
 static int work_cb_count;
 static int after_work_cb_count;
+static int slow_work_done;
+static int slow_work_done_at_stat;
 static uv_work_t work_req;
 static char data;
 
@@ -74,3 +76,49 @@ TEST_IMPL(threadpool_queue_work_einval) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+static void slow_work_cb(uv_work_t* req) {
+  uv_sleep(200);
+}
+
+
+static void slow_after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  slow_work_done++;
+}
+
+
+static void stat_cb(uv_fs_t* req) {
+  ASSERT(req->result == 0);
+  slow_work_done_at_stat = slow_work_done;
+  uv_fs_req_cleanup(req);
+}
+
+
+TEST_IMPL(threadpool_kinds_take_turns) {
+  uv_work_t reqs[8];
+  uv_fs_t stat_req;
+  unsigned int i;
+
+  /* Twice as much slow work as there are threads in the default pool. The
+   * stat() that is queued last should get to run once the first round of
+   * slow work is done, not after all of it.
+   */
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    ASSERT(0 == uv_queue_work(uv_default_loop(),
+                              reqs + i,
+                              slow_work_cb,
+                              slow_after_work_cb));
+
+  slow_work_done_at_stat = -1;
+  ASSERT(0 == uv_fs_stat(uv_default_loop(), &stat_req, ".", stat_cb));
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(slow_work_done == ARRAY_SIZE(reqs));
+  ASSERT(slow_work_done_at_stat >= 0);
+  ASSERT(slow_work_done_at_stat < (int) ARRAY_SIZE(reqs));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
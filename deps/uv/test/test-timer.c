@@ -292,3 +292,78 @@ TEST_IMPL(timer_run_once) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+#define NUM_ORDER_TIMERS 64
+
+static uv_timer_t order_timers[NUM_ORDER_TIMERS];
+static uint64_t order_timeouts[NUM_ORDER_TIMERS];
+static int order_seqs[NUM_ORDER_TIMERS];
+static uint64_t order_last_timeout;
+static int order_last_seq;
+static int order_timers_called;
+
+
+static void order_timer_cb(uv_timer_t* handle, int status) {
+  int i;
+
+  i = handle - order_timers;
+  ASSERT(order_timeouts[i] >= order_last_timeout);
+  if (order_timeouts[i] == order_last_timeout)
+    ASSERT(order_seqs[i] > order_last_seq);
+
+  order_last_timeout = order_timeouts[i];
+  order_last_seq = order_seqs[i];
+  order_timers_called++;
+}
+
+
+/* Timers have to fire in timeout order, and in start order for equal
+ * timeouts, no matter how often they have been restarted or stopped.
+ */
+TEST_IMPL(timer_restart_order) {
+  uv_loop_t* loop;
+  int seq;
+  int i;
+
+  loop = uv_default_loop();
+  seq = 0;
+
+  for (i = 0; i < NUM_ORDER_TIMERS; i++) {
+    ASSERT(0 == uv_timer_init(loop, order_timers + i));
+    order_timeouts[i] = (i * 37) % 16;
+    order_seqs[i] = seq++;
+    ASSERT(0 == uv_timer_start(order_timers + i,
+                               order_timer_cb,
+                               order_timeouts[i],
+                               0));
+  }
+
+  /* Re-arm every third timer with a different timeout. */
+  for (i = 0; i < NUM_ORDER_TIMERS; i += 3) {
+    order_timeouts[i] = (i * 11) % 8;
+    order_seqs[i] = seq++;
+    ASSERT(0 == uv_timer_start(order_timers + i,
+                               order_timer_cb,
+                               order_timeouts[i],
+                               0));
+  }
+
+  /* Stop every seventh timer, restart every other one of those. */
+  for (i = 0; i < NUM_ORDER_TIMERS; i += 7) {
+    ASSERT(0 == uv_timer_stop(order_timers + i));
+    if (i % 2)
+      continue;
+    order_seqs[i] = seq++;
+    ASSERT(0 == uv_timer_start(order_timers + i,
+                               order_timer_cb,
+                               order_timeouts[i],
+                               0));
+  }
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(order_timers_called == NUM_ORDER_TIMERS - 5);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,159 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_DGRAMS 20
+#define NUM_SLOTS 8
+#define SLOT_SIZE 64
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_reqs[NUM_DGRAMS + 1];
+static char payloads[NUM_DGRAMS][5];
+static char oversized[SLOT_SIZE * 2];
+static char slab[NUM_SLOTS * SLOT_SIZE];
+
+static int send_cb_called;
+static int recv_cb_called;
+static int release_cb_called;
+static int partial_cb_called;
+static int close_cb_called;
+
+
+static uv_buf_t alloc_cb(uv_handle_t* handle, size_t suggested_size) {
+  ASSERT(handle == (uv_handle_t*) &server);
+  return uv_buf_init(slab, sizeof slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT(req->handle == &client);
+  ASSERT(status == 0);
+  send_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    uv_buf_t buf,
+                    struct sockaddr* addr,
+                    unsigned flags) {
+  char expected[5];
+
+  ASSERT(handle == &server);
+  ASSERT(nread >= 0);
+
+  if (addr == NULL) {
+    /* End of the batch, the whole buffer is handed back. */
+    ASSERT(nread == 0);
+    ASSERT(buf.base == slab);
+    ASSERT(buf.len == sizeof slab);
+    release_cb_called++;
+    return;
+  }
+
+#ifndef _WIN32
+  ASSERT(flags & UV_UDP_MMSG_CHUNK);
+  ASSERT(buf.base >= slab && buf.base + nread <= slab + sizeof slab);
+#endif
+
+  if (recv_cb_called == NUM_DGRAMS) {
+    ASSERT(flags & UV_UDP_PARTIAL);
+    ASSERT(nread <= (ssize_t) sizeof oversized);
+    partial_cb_called++;
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+    return;
+  }
+
+  snprintf(expected, sizeof expected, "%04d", recv_cb_called);
+  ASSERT(nread == 4);
+  ASSERT(memcmp(buf.base, expected, 4) == 0);
+  ASSERT((flags & UV_UDP_PARTIAL) == 0);
+
+  recv_cb_called++;
+}
+
+
+TEST_IMPL(udp_recv_batch) {
+  struct sockaddr_in addr;
+  uv_buf_t buf;
+  int r;
+  int i;
+
+  addr = uv_ip4_addr("0.0.0.0", TEST_PORT);
+
+  r = uv_udp_init(uv_default_loop(), &server);
+  ASSERT(r == 0);
+
+  r = uv_udp_bind(&server, addr, 0);
+  ASSERT(r == 0);
+
+  r = uv_udp_recv_batch_start(&server, 0, alloc_cb, recv_cb);
+  ASSERT(r == UV_EINVAL);
+
+  r = uv_udp_recv_batch_start(&server, NUM_SLOTS, alloc_cb, recv_cb);
+  ASSERT(r == 0);
+
+  r = uv_udp_init(uv_default_loop(), &client);
+  ASSERT(r == 0);
+
+  addr = uv_ip4_addr("127.0.0.1", TEST_PORT);
+
+  /* Queue everything up front so the datagrams go out in one batch. */
+  for (i = 0; i < NUM_DGRAMS; i++) {
+    snprintf(payloads[i], sizeof payloads[i], "%04d", i);
+    buf = uv_buf_init(payloads[i], 4);
+    r = uv_udp_send(&send_reqs[i], &client, &buf, 1, addr, send_cb);
+    ASSERT(r == 0);
+  }
+
+  /* Doesn't fit in a slot, gets truncated. */
+  memset(oversized, 'x', sizeof oversized);
+  buf = uv_buf_init(oversized, sizeof oversized);
+  r = uv_udp_send(&send_reqs[NUM_DGRAMS], &client, &buf, 1, addr, send_cb);
+  ASSERT(r == 0);
+
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(send_cb_called == NUM_DGRAMS + 1);
+  ASSERT(recv_cb_called == NUM_DGRAMS);
+  ASSERT(partial_cb_called == 1);
+  ASSERT(close_cb_called == 2);
+#ifndef _WIN32
+  ASSERT(release_cb_called > 0);
+  ASSERT(release_cb_called < NUM_DGRAMS);
+#endif
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -207,6 +207,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
           ],
@@ -218,6 +219,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
             'src/unix/pthread-fixes.c',
@@ -346,6 +348,8 @@
         'test/test-fs-poll.c',
         'test/test-stdio-over-pipes.c',
         'test/test-tcp-bind-error.c',
+        'test/test-tcp-reuseport.c',
+        'test/test-tcp-sendfile.c',
         'test/test-tcp-bind6-error.c',
         'test/test-tcp-close.c',
         'test/test-tcp-close-while-connecting.c',
@@ -375,6 +379,7 @@
         'test/test-udp-open.c',
         'test/test-udp-options.c',
         'test/test-udp-send-and-recv.c',
+        'test/test-udp-recv-batch.c',
         'test/test-udp-multicast-join.c',
         'test/test-dlerror.c',
         'test/test-udp-multicast-ttl.c',
@@ -434,6 +439,8 @@
         'test/benchmark-sizes.c',
         'test/benchmark-spawn.c',
         'test/benchmark-thread.c',
+        'test/benchmark-threadpool-mix.c',
+        'test/benchmark-timer-churn.c',
         'test/benchmark-tcp-write-batch.c',
         'test/benchmark-udp-pummel.c',
         'test/dns-server.c',
@@ -24,6 +24,7 @@ var HTTPParser = process.binding('http_parser').HTTPParser;
 
 var incoming = require('_http_incoming');
 var IncomingMessage = incoming.IncomingMessage;
+var LazyIncomingMessage = incoming.LazyIncomingMessage;
 var readStart = incoming.readStart;
 var readStop = incoming.readStop;
 
@@ -69,7 +70,14 @@ function parserOnHeadersComplete(info) {
         parser._url = '';
     }
 
-    parser.incoming = new IncomingMessage(parser.socket);
+    if (info.rawHeaders) {
+        // Lazy mode, the headers are only unpacked when they are used.
+        parser.incoming = new LazyIncomingMessage(parser.socket,
+                                                  info.rawHeaders,
+                                                  parser.maxHeaderPairs);
+    } else {
+        parser.incoming = new IncomingMessage(parser.socket);
+    }
     parser.incoming.httpVersionMajor = info.versionMajor;
     parser.incoming.httpVersionMinor = info.versionMinor;
     parser.incoming.httpVersion = info.versionMajor + '.' + info.versionMinor;
@@ -21,6 +21,7 @@
 
 var util = require('util');
 var Stream = require('stream');
+var binding = process.binding('http_parser');
 
 function readStart(socket) {
     if (!socket || !socket._handle || !socket._handle.readStart) return;
@@ -120,7 +121,11 @@ IncomingMessage.prototype.destroy = function (error) {
 // always joined.
 IncomingMessage.prototype._addHeaderLine = function (field, value) {
     var dest = this.complete ? this.trailers : this.headers;
+    addHeaderLine(dest, field, value);
+};
+
 
+function addHeaderLine(dest, field, value) {
     field = field.toLowerCase();
     switch (field) {
         // Array headers:
@@ -167,6 +172,77 @@ IncomingMessage.prototype._addHeaderLine = function (field, value) {
             }
             break;
     }
+}
+
+
+// Returns the value of the header with the given name, with repeated headers
+// merged the same way as in .headers.
+IncomingMessage.prototype.getHeader = function (name) {
+    if (arguments.length < 1) {
+        throw new Error('`name` is required for getHeader().');
+    }
+
+    return this.headers[name.toLowerCase()];
+};
+
+
+// An IncomingMessage that keeps its headers in the packed buffer the parser
+// hands out in lazy mode (see server.lazyHeaders). They are only turned into
+// the .headers object when that is first accessed, getHeader() looks up
+// single headers without doing so.
+function LazyIncomingMessage(socket, rawHeaders, maxHeaderPairs) {
+    // Goes through the .headers setter below.
+    IncomingMessage.call(this, socket);
+
+    this._rawHeaders = rawHeaders;
+    this._maxHeaderPairs = maxHeaderPairs;
+}
+util.inherits(LazyIncomingMessage, IncomingMessage);
+
+
+exports.LazyIncomingMessage = LazyIncomingMessage;
+
+
+Object.defineProperty(LazyIncomingMessage.prototype, 'headers', {
+    configurable: true,
+    enumerable: true,
+    get: function () {
+        if (this._rawHeaders !== null) {
+            var headers = binding.unpackHeaders(this._rawHeaders,
+                                                this._maxHeaderPairs);
+            this._rawHeaders = null;
+            for (var i = 0, n = headers.length; i < n; i += 2) {
+                addHeaderLine(this._parsedHeaders, headers[i], headers[i + 1]);
+            }
+        }
+        return this._parsedHeaders;
+    },
+    set: function (headers) {
+        this._rawHeaders = null;
+        this._parsedHeaders = headers;
+    }
+});
+
+
+LazyIncomingMessage.prototype.getHeader = function (name) {
+    if (arguments.length < 1) {
+        throw new Error('`name` is required for getHeader().');
+    }
+
+    if (this._rawHeaders === null)
+        return this._parsedHeaders[name.toLowerCase()];
+
+    var value = binding.findHeader(this._rawHeaders, name,
+                                   this._maxHeaderPairs);
+    if (!Array.isArray(value))
+        return value;
+
+    // Repeated header, merge the values like .headers would.
+    var dest = {};
+    for (var i = 0; i < value.length; i++) {
+        addHeaderLine(dest, name, value[i]);
+    }
+    return dest[name.toLowerCase()];
 };
 
 
@@ -25,6 +25,7 @@ var timers = require('timers');
 var util = require('util');
 
 var common = require('_http_common');
+var binding = process.binding('http_parser');
 
 var CRLF = common.CRLF;
 var chunkExpression = common.chunkExpression;
@@ -40,6 +41,30 @@ var dateExpression = /Date/i;
 var expectExpression = /Expect/i;
 
 
+// Header flags, keep in sync with src/node_http_parser.cc.
+var kLast = 0x01;
+var kChunkedEncoding = 0x02;
+var kShouldKeepAlive = 0x04;
+var kUseChunkedEncodingByDefault = 0x08;
+var kHasAgent = 0x10;
+var kHasBody = 0x20;
+var kSendDate = 0x40;
+var kNoContent = 0x80;
+var kSentExpect = 0x100;
+
+var headerState = binding.headerState;
+
+// Headers are serialized into slices of a shared pool, just like
+// fs.ReadStream does for the data it reads.
+var kHeaderPoolSize = 16 * 1024;
+var headerPool;
+
+function allocHeaderPool() {
+    headerPool = new Buffer(kHeaderPoolSize);
+    headerPool.used = 0;
+}
+
+
 var dateCache;
 function utcDate() {
     if (!dateCache) {
@@ -115,13 +140,31 @@ OutgoingMessage.prototype._send = function (data, encoding) {
     // the same packet. Future versions of Node are going to take care of
     // this at a lower level and in a more general way.
     if (!this._headerSent) {
-        if (typeof data === 'string') {
-            data = this._header + data;
+        var header = this._header;
+        this._headerSent = true;
+
+        if (typeof header === 'string') {
+            if (typeof data === 'string') {
+                data = header + data;
+            } else {
+                this.output.unshift(header);
+                this.outputEncodings.unshift('ascii');
+            }
+        } else if (data.length === 0) {
+            data = header;
         } else {
-            this.output.unshift(this._header);
-            this.outputEncodings.unshift('ascii');
+            // The header was serialized into a buffer. Cork the socket so it
+            // goes out in the same writev() as the first chunk of the body.
+            var conn = this.connection;
+            if (conn)
+                conn.cork();
+            this.output.unshift(header);
+            this.outputEncodings.unshift('buffer');
+            var ret = this._writeRaw(data, encoding);
+            if (conn)
+                conn.uncork();
+            return ret;
         }
-        this._headerSent = true;
     }
     return this._writeRaw(data, encoding);
 };
@@ -190,6 +233,77 @@ OutgoingMessage.prototype._buffer = function (data, encoding) {
 OutgoingMessage.prototype._storeHeader = function (firstLine, headers) {
     // firstLine in the case of request is: 'GET /index.html HTTP/1.1\r\n'
     // in the case of response it is: 'HTTP/1.1 200 OK\r\n'
+    var fields = [];
+    if (headers) {
+        var keys = Object.keys(headers);
+        var isArray = (Array.isArray(headers));
+        var field, value;
+
+        for (var i = 0, l = keys.length; i < l; i++) {
+            var key = keys[i];
+            if (isArray) {
+                field = headers[key][0];
+                value = headers[key][1];
+            } else {
+                field = key;
+                value = headers[key];
+            }
+
+            if (Array.isArray(value)) {
+                for (var j = 0; j < value.length; j++) {
+                    fields.push(field, value[j]);
+                }
+            } else {
+                fields.push(field, value);
+            }
+        }
+    }
+
+    var flags = 0;
+    if (this._last) flags |= kLast;
+    if (this.chunkedEncoding) flags |= kChunkedEncoding;
+    if (this.shouldKeepAlive) flags |= kShouldKeepAlive;
+    if (this.useChunkedEncodingByDefault) flags |= kUseChunkedEncodingByDefault;
+    if (this.agent) flags |= kHasAgent;
+    if (this._hasBody) flags |= kHasBody;
+    if (this.sendDate == true) flags |= kSendDate;
+    if (this.statusCode == 204 || this.statusCode === 304) flags |= kNoContent;
+
+    if (!headerPool) allocHeaderPool();
+    var start = headerPool.used;
+    var length = binding.storeHeader(headerPool, start, firstLine, fields,
+                                     flags);
+    if (length === 0) {
+        // Out of room, retry with a fresh pool. Huge headers that don't fit
+        // in an empty pool either take the slow path below.
+        allocHeaderPool();
+        start = 0;
+        length = binding.storeHeader(headerPool, start, firstLine, fields,
+                                     flags);
+    }
+
+    if (length <= 0)
+        return this._storeHeaderSlow(firstLine, headers);
+
+    headerPool.used += length;
+    flags = headerState[0];
+
+    this._last = !!(flags & kLast);
+    this.chunkedEncoding = !!(flags & kChunkedEncoding);
+    this.shouldKeepAlive = !!(flags & kShouldKeepAlive);
+
+    this._header = headerPool.slice(start, start + length);
+    this._headerSent = false;
+
+    // wait until the first body chunk, or close(), is sent to flush,
+    // UNLESS we're sending Expect: 100-continue.
+    if (flags & kSentExpect) this._send('');
+};
+
+
+// Serializes the header as a string. Used when the header contains non-ASCII
+// characters or is too big for the header pool.
+OutgoingMessage.prototype._storeHeaderSlow = function (firstLine, headers) {
     var state = {
         sentConnectionHeader: false,
         sentContentLengthHeader: false,
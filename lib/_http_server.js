@@ -105,7 +105,8 @@ function ServerResponse(req) {
     this.sendDate = true;
 
     if (req.httpVersionMajor < 1 || req.httpVersionMinor < 1) {
-        this.useChunkedEncodingByDefault = chunkExpression.test(req.headers.te);
+        this.useChunkedEncodingByDefault =
+            chunkExpression.test(req.getHeader('te'));
         this.shouldKeepAlive = false;
     }
 }
@@ -169,6 +170,9 @@ ServerResponse.prototype._implicitHeader = function () {
     this.writeHead(this.statusCode);
 };
 
+// Status lines for the standard reason phrases, built on first use.
+var statusLines = {};
+
 ServerResponse.prototype.writeHead = function (statusCode) {
     var reasonPhrase, headers, headerIndex;
 
@@ -215,8 +219,17 @@ ServerResponse.prototype.writeHead = function (statusCode) {
         headers = obj;
     }
 
-    var statusLine = 'HTTP/1.1 ' + statusCode.toString() + ' ' +
-        reasonPhrase + CRLF;
+    var statusLine;
+    if (headerIndex === 1 && STATUS_CODES.hasOwnProperty(statusCode)) {
+        statusLine = statusLines[statusCode];
+        if (statusLine === undefined) {
+            statusLine = statusLines[statusCode] = 'HTTP/1.1 ' +
+                statusCode.toString() + ' ' + reasonPhrase + CRLF;
+        }
+    } else {
+        statusLine = 'HTTP/1.1 ' + statusCode.toString() + ' ' +
+            reasonPhrase + CRLF;
+    }
 
     if (statusCode === 204 || statusCode === 304 ||
         (100 <= statusCode && statusCode <= 199)) {
@@ -267,6 +280,9 @@ function Server(requestListener) {
     });
 
     this.timeout = 2 * 60 * 1000;
+
+    // Keep request headers packed until they are used, see the docs.
+    this.lazyHeaders = false;
 }
 util.inherits(Server, net.Server);
 
@@ -325,7 +341,7 @@ function connectionListener(socket) {
     });
 
     var parser = parsers.alloc();
-    parser.reinitialize(HTTPParser.REQUEST);
+    parser.reinitialize(HTTPParser.REQUEST, self.lazyHeaders === true);
     parser.socket = socket;
     socket.parser = parser;
     parser.incoming = null;
@@ -441,9 +457,10 @@ function connectionListener(socket) {
             }
         });
 
-        if (req.headers.expect !== undefined &&
+        var expect = req.getHeader('expect');
+        if (expect !== undefined &&
             (req.httpVersionMajor == 1 && req.httpVersionMinor == 1) &&
-            continueExpression.test(req.headers['expect'])) {
+            continueExpression.test(expect)) {
             res._expect_continue = true;
             if (EventEmitter.listenerCount(self, 'checkContinue') > 0) {
                 self.emit('checkContinue', req, res);
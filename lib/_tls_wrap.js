@@ -176,6 +176,9 @@ TLSSocket.prototype._init = function () {
 
     if (process.features.tls_npn && options.NPNProtocols)
         this.ssl.setNPNProtocols(options.NPNProtocols);
+
+    if (options.offloadThreshold)
+        this.ssl.setOffloadThreshold(options.offloadThreshold);
 };
 
 TLSSocket.prototype._tlsError = function (err) {
@@ -372,7 +375,8 @@ function Server(/* [options], listener */) {
             requestCert: self.requestCert,
             rejectUnauthorized: self.rejectUnauthorized,
             NPNProtocols: self.NPNProtocols,
-            SNICallback: self.SNICallback
+            SNICallback: self.SNICallback,
+            offloadThreshold: self.offloadThreshold
         });
 
         function listener() {
@@ -444,6 +448,8 @@ Server.prototype.setOptions = function (options) {
     if (options.crl) this.crl = options.crl;
     if (options.ciphers) this.ciphers = options.ciphers;
     if (options.sessionTimeout) this.sessionTimeout = options.sessionTimeout;
+    if (options.offloadThreshold)
+        this.offloadThreshold = options.offloadThreshold;
     var secureOptions = options.secureOptions || 0;
     if (options.honorCipherOrder) {
         secureOptions |= constants.SSL_OP_CIPHER_SERVER_PREFERENCE;
@@ -538,7 +544,8 @@ exports.connect = function (/* [port, host], options, cb */) {
         isServer: false,
         requestCert: true,
         rejectUnauthorized: options.rejectUnauthorized,
-        NPNProtocols: NPN.NPNProtocols
+        NPNProtocols: NPN.NPNProtocols,
+        offloadThreshold: options.offloadThreshold
     });
 
     function onHandle() {
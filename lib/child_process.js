@@ -323,13 +323,23 @@ function handleMessage(target, message, handle) {
     target.emit(eventName, message, handle);
 }
 
-function setupChannel(target, channel) {
-    target._channel = channel;
-    target._handleQueue = null;
+// The messages on an IPC channel are either JSON, one message per line, or
+// with `serialization: 'binary'`, frames made by the serializer binding: a
+// 32 bits little endian length followed by the message in a binary encoding
+// that carries buffers as they are. The parent picks the format when it forks and tells
+// the child with NODE_CHANNEL_SERIALIZATION_MODE.
+function validateSerialization(serialization) {
+    if (serialization !== undefined &&
+        serialization !== 'json' &&
+        serialization !== 'binary') {
+        throw new TypeError('serialization must be "json" or "binary"');
+    }
+}
 
+function jsonChannel(target, channel) {
     var decoder = new StringDecoder('utf8');
     var jsonBuffer = '';
-    channel.buffering = false;
+
     channel.onread = function (nread, pool, recvHandle) {
         // TODO(bnoordhuis) Check that nread > 0.
         if (pool) {
@@ -356,13 +366,97 @@ function setupChannel(target, channel) {
             this.buffering = jsonBuffer.length !== 0;
 
         } else {
-            this.buffering = false;
-            target.disconnect();
-            channel.onread = nop;
-            channel.close();
-            maybeClose(target);
+            closeChannel(target, channel);
+        }
+    };
+
+    return function (req, message, handle) {
+        var string = JSON.stringify(message) + '\n';
+        return channel.writeUtf8String(req, string, handle);
+    };
+}
+
+function binaryChannel(target, channel) {
+    var serializer = process.binding('serializer');
+    var headerSize = serializer.headerSize;
+    // Data of a frame that hasn't been received completely yet. Nothing is
+    // concatenated until `needed` bytes are there, so that a big message
+    // that arrives in many reads is copied only once.
+    var chunks = [];
+    var chunksLength = 0;
+    var needed = headerSize;
+
+    channel.onread = function (nread, pool, recvHandle) {
+        if (!pool) {
+            chunks = [];
+            return closeChannel(target, channel);
+        }
+
+        chunks.push(pool);
+        chunksLength += pool.length;
+        if (chunksLength < needed) {
+            this.buffering = true;
+            return;
+        }
+
+        var buffer = chunks.length === 1 ?
+            chunks[0] : Buffer.concat(chunks, chunksLength);
+        var offset = 0;
+
+        while (buffer.length - offset >= headerSize) {
+            var size = buffer.readUInt32LE(offset, true);
+            if (buffer.length - offset - headerSize < size)
+                break;
+            var message = serializer.deserialize(buffer,
+                                                 offset + headerSize,
+                                                 size);
+            offset += headerSize + size;
+
+            // Keep `buffering` current for disconnect() calls from the
+            // message handlers.
+            this.buffering = offset !== buffer.length;
+
+            // At most one NODE_HANDLE message per read, see jsonChannel().
+            if (message && message.cmd === 'NODE_HANDLE')
+                handleMessage(target, message, recvHandle);
+            else
+                handleMessage(target, message, undefined);
+        }
+
+        if (offset === buffer.length) {
+            chunks = [];
+            chunksLength = 0;
+            needed = headerSize;
+        } else {
+            var rest = buffer.slice(offset);
+            chunks = [rest];
+            chunksLength = rest.length;
+            needed = rest.length >= headerSize ?
+                headerSize + rest.readUInt32LE(0, true) : headerSize;
         }
+        this.buffering = chunksLength !== 0;
+    };
+
+    return function (req, message, handle) {
+        return channel.writeMessage(req, message, handle);
     };
+}
+
+function closeChannel(target, channel) {
+    channel.buffering = false;
+    target.disconnect();
+    channel.onread = nop;
+    channel.close();
+    maybeClose(target);
+}
+
+function setupChannel(target, channel, serialization) {
+    target._channel = channel;
+    target._handleQueue = null;
+
+    channel.buffering = false;
+    var writeMessage = serialization === 'binary' ?
+        binaryChannel(target, channel) : jsonChannel(target, channel);
 
     // object where socket lists will live
     channel.sockets = { got: {}, send: {} };
@@ -455,8 +549,7 @@ function setupChannel(target, channel) {
         }
 
         var req = { oncomplete: nop };
-        var string = JSON.stringify(message) + '\n';
-        var err = channel.writeUtf8String(req, string, handle);
+        var err = writeMessage(req, message, handle);
 
         if (err) {
             this.emit('error', errnoException(err, 'write'));
@@ -528,9 +621,12 @@ exports.fork = function (modulePath /*, args, options*/) {
     args = execArgv.concat([modulePath], args);
 
     // Leave stdin open for the IPC channel. stdout and stderr should be the
-    // same as the parent's if silent isn't set.
-    options.stdio = options.silent ? ['pipe', 'pipe', 'pipe', 'ipc'] :
-        [0, 1, 2, 'ipc'];
+    // same as the parent's if silent isn't set. A stdio array of its own,
+    // e.g. to pass extra file descriptors, has to include the channel.
+    if (!Array.isArray(options.stdio) || options.stdio.indexOf('ipc') === -1) {
+        options.stdio = options.silent ? ['pipe', 'pipe', 'pipe', 'ipc'] :
+            [0, 1, 2, 'ipc'];
+    }
 
     options.execPath = options.execPath || process.execPath;
 
@@ -538,12 +634,12 @@ exports.fork = function (modulePath /*, args, options*/) {
 };
 
 
-exports._forkChild = function (fd) {
+exports._forkChild = function (fd, serialization) {
     // set process.send()
     var p = createPipe(true);
     p.open(fd);
     p.unref();
-    setupChannel(process, p);
+    setupChannel(process, p, serialization);
 
     var refs = 0;
     process.on('newListener', function (name) {
@@ -709,6 +805,8 @@ var spawn = exports.spawn = function (file, args, options) {
         envPairs.push(key + '=' + env[key]);
     }
 
+    validateSerialization(options ? options.serialization : undefined);
+
     var child = new ChildProcess();
     if (options && options.customFds && !options.stdio) {
         options.stdio = options.customFds.map(function (fd) {
@@ -725,7 +823,8 @@ var spawn = exports.spawn = function (file, args, options) {
         envPairs: envPairs,
         stdio: options ? options.stdio : null,
         uid: options ? options.uid : null,
-        gid: options ? options.gid : null
+        gid: options ? options.gid : null,
+        serialization: options ? options.serialization : undefined
     });
 
     return child;
@@ -920,6 +1019,8 @@ ChildProcess.prototype.spawn = function (options) {
         // Let child process know about opened IPC channel
         options.envPairs = options.envPairs || [];
         options.envPairs.push('NODE_CHANNEL_FD=' + ipcFd);
+        if (options.serialization === 'binary')
+            options.envPairs.push('NODE_CHANNEL_SERIALIZATION_MODE=binary');
     }
 
     var err = this._handle.spawn(options);
@@ -973,7 +1074,7 @@ ChildProcess.prototype.spawn = function (options) {
     });
 
     // Add .send() method and start listening for IPC data
-    if (ipc !== undefined) setupChannel(this, ipc);
+    if (ipc !== undefined) setupChannel(this, ipc, options.serialization);
 
     return err;
 };
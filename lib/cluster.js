@@ -25,8 +25,11 @@ var dgram = require('dgram');
 var fork = require('child_process').fork;
 var net = require('net');
 var util = require('util');
+var uv = process.binding('uv');
+var Ring = process.binding('ring_wrap').Ring;
 var SCHED_NONE = 1;
 var SCHED_RR = 2;
+var SCHED_REUSEPORT = 3;
 
 var cluster = new EventEmitter;
 module.exports = cluster;
@@ -41,6 +44,7 @@ function Worker() {
     this.suicide = undefined;
     this.state = 'none';
     this.id = 0;
+    this._ring = null;
 }
 util.inherits(Worker, EventEmitter);
 
@@ -48,10 +52,59 @@ Worker.prototype.kill = function () {
     this.destroy.apply(this, arguments);
 };
 
-Worker.prototype.send = function () {
-    this.process.send.apply(this.process, arguments);
+Worker.prototype.send = function (message, handle) {
+    // Messages without a handle take the shared memory ring if there is one.
+    // They can overtake messages that go through the IPC channel.
+    if (this._ring !== null &&
+        typeof message !== 'undefined' &&
+        typeof handle === 'undefined' &&
+        this.process.connected) {
+        return this._ring.writeMessage(message);
+    }
+    return this.process.send.apply(this.process, arguments);
 };
 
+// Messages from the ring are emitted by the process object, like the ones
+// from the IPC channel. See handleMessage() in lib/child_process.js.
+function setupRing(worker, ring) {
+    var proc = worker.process;
+    worker._ring = ring;
+    ring.onmessage = function (messages) {
+        for (var i = 0; i < messages.length && worker._ring === ring; i++) {
+            var message = messages[i];
+            if (message !== null &&
+                typeof message === 'object' &&
+                typeof message.cmd === 'string' &&
+                message.cmd.length > 'NODE_'.length &&
+                message.cmd.slice(0, 'NODE_'.length) === 'NODE_') {
+                proc.emit('internalMessage', message);
+            } else {
+                proc.emit('message', message);
+            }
+        }
+    };
+    // A message that can't be decoded. The ones before it have been emitted,
+    // both sides go back to the IPC channel from here on.
+    ring.onerror = function (err) {
+        closeRing(worker);
+        if (proc.connected)
+            sendHelper(proc, { act: 'ringclose' });
+        worker.emit('error', err);
+    };
+    ring.readStart();
+}
+
+// Emits what the peer put in the ring before it went away.
+function drainRing(worker) {
+    if (worker._ring !== null) worker._ring.drain();
+}
+
+function closeRing(worker) {
+    if (worker._ring === null) return;
+    worker._ring.close();
+    worker._ring = null;
+}
+
 // Master/worker specific methods are defined in the *Init() functions.
 
 function SharedHandle(key, address, port, addressType, backlog, fd) {
@@ -91,6 +144,57 @@ SharedHandle.prototype.remove = function (worker) {
 };
 
 
+// Every worker binds and listens on a socket of its own with SO_REUSEPORT
+// set and the kernel balances connections over them. The master binds a
+// socket to the same address without listening on it. That pins down the
+// port when a random one is requested and catches bind errors early.
+function ReusePortHandle(key, address, port, addressType, backlog, fd) {
+    this.key = key;
+    this.workers = [];
+    this.handle = null;
+    this.errno = 0;
+    this.sockname = null;
+
+    var rval = net._createServerHandle(address, port, addressType, fd, true);
+    if (typeof rval === 'number') {
+        this.errno = rval;
+        return;
+    }
+
+    // EADDRINUSE is reported by listen() on some platforms, see listen() in
+    // lib/net.js. Check that we got the port we asked for.
+    var out = {};
+    var err = rval.getsockname(out);
+    if (err === 0 && port && port !== out.port)
+        err = uv.UV_EADDRINUSE;
+
+    if (err) {
+        rval.close();
+        this.errno = err;
+        return;
+    }
+
+    this.handle = rval;
+    this.sockname = out;
+}
+
+ReusePortHandle.prototype.add = function (worker, send) {
+    assert(this.workers.indexOf(worker) === -1);
+    this.workers.push(worker);
+    send(this.errno, { reuseport: true, sockname: this.sockname }, null);
+};
+
+ReusePortHandle.prototype.remove = function (worker) {
+    var index = this.workers.indexOf(worker);
+    if (index === -1) return false;
+    this.workers.splice(index, 1);
+    if (this.workers.length !== 0) return false;
+    if (this.handle) this.handle.close();
+    this.handle = null;
+    return true;
+};
+
+
 // Start a round-robin server. Master accepts connections and distributes
 // them over the workers.
 function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
@@ -216,14 +320,16 @@ function masterInit() {
         args: process.argv.slice(2),
         exec: process.argv[1],
         execArgv: process.execArgv,
-        silent: false
+        silent: false,
+        ringSize: 0
     };
     cluster.settings = settings;
 
     // XXX(bnoordhuis) Fold cluster.schedulingPolicy into cluster.settings?
     var schedulingPolicy = {
         'none': SCHED_NONE,
-        'rr': SCHED_RR
+        'rr': SCHED_RR,
+        'reuseport': SCHED_REUSEPORT
     }[process.env.NODE_CLUSTER_SCHED_POLICY];
 
     if (typeof schedulingPolicy === 'undefined') {
@@ -235,6 +341,7 @@ function masterInit() {
     cluster.schedulingPolicy = schedulingPolicy;
     cluster.SCHED_NONE = SCHED_NONE;  // Leave it to the operating system.
     cluster.SCHED_RR = SCHED_RR;      // Master distributes connections.
+    cluster.SCHED_REUSEPORT = SCHED_REUSEPORT;  // Kernel distributes them.
 
     // Keyed on address:port:etc. When a worker dies, we walk over the handles
     // and remove() the worker from each one. remove() may do a linear scan
@@ -258,7 +365,9 @@ function masterInit() {
             settings.execArgv = settings.execArgv.concat(['--logfile=v8-%p.log']);
         }
         schedulingPolicy = cluster.schedulingPolicy;  // Freeze policy.
-        assert(schedulingPolicy === SCHED_NONE || schedulingPolicy === SCHED_RR,
+        assert(schedulingPolicy === SCHED_NONE ||
+               schedulingPolicy === SCHED_RR ||
+               schedulingPolicy === SCHED_REUSEPORT,
             'Bad cluster.schedulingPolicy: ' + schedulingPolicy);
         cluster.settings = settings;
 
@@ -279,12 +388,35 @@ function masterInit() {
         var workerEnv = util._extend({}, process.env);
         workerEnv = util._extend(workerEnv, env);
         workerEnv.NODE_UNIQUE_ID = '' + worker.id;
+        var stdio = settings.silent ? ['pipe', 'pipe', 'pipe', 'ipc'] :
+            [0, 1, 2, 'ipc'];
+        var ring = null;
+        if (settings.ringSize > 0) {
+            // Falls back to the IPC channel where shared memory isn't
+            // supported.
+            var fds = [];
+            ring = new Ring();
+            if (ring.create(settings.ringSize, fds) === 0) {
+                workerEnv.NODE_CLUSTER_RING_FD = '' + stdio.length;
+                stdio = stdio.concat(fds);
+            } else {
+                ring.close();
+                ring = null;
+            }
+        }
         worker.process = fork(settings.exec, settings.args, {
             env: workerEnv,
-            silent: settings.silent,
-            execArgv: createWorkerExecArgv(settings.execArgv, worker)
+            stdio: stdio,
+            execArgv: createWorkerExecArgv(settings.execArgv, worker),
+            serialization: settings.serialization
         });
+        if (ring !== null) {
+            ring.closeChildFds();
+            setupRing(worker, ring);
+        }
         worker.process.once('exit', function (exitCode, signalCode) {
+            drainRing(worker);
+            closeRing(worker);
             worker.suicide = !!worker.suicide;
             worker.state = 'dead';
             worker.emit('exit', exitCode, signalCode);
@@ -292,6 +424,7 @@ function masterInit() {
             delete cluster.workers[worker.id];
         });
         worker.process.once('disconnect', function () {
+            drainRing(worker);
             worker.suicide = !!worker.suicide;
             worker.state = 'disconnected';
             worker.emit('disconnect');
@@ -329,6 +462,12 @@ function masterInit() {
 
     Worker.prototype.disconnect = function () {
         this.suicide = true;
+        // Through the ring if there is one, so that it doesn't overtake the
+        // messages that went before it.
+        if (this._ring !== null && this.process.connected) {
+            this._ring.writeMessage({ cmd: 'NODE_CLUSTER', act: 'disconnect' });
+            return;
+        }
         send(this, { act: 'disconnect' });
     };
 
@@ -355,6 +494,8 @@ function masterInit() {
             worker.suicide = true;
         else if (message.act === 'close')
             close(worker, message);
+        else if (message.act === 'ringclose')
+            closeRing(worker);
     }
 
     function online(worker) {
@@ -375,17 +516,35 @@ function masterInit() {
             // UDP is exempt from round-robin connection balancing for what should
             // be obvious reasons: it's connectionless. There is nothing to send to
             // the workers except raw datagrams and that's pointless.
-            if (schedulingPolicy !== SCHED_RR ||
+            if (schedulingPolicy === SCHED_NONE ||
                 message.addressType === 'udp4' ||
                 message.addressType === 'udp6') {
                 constructor = SharedHandle;
             }
-            handles[key] = handle = new constructor(key,
+            // Pipes and inherited file descriptors can't be shared with
+            // SO_REUSEPORT, those are distributed round-robin instead.
+            else if (schedulingPolicy === SCHED_REUSEPORT &&
+                     (message.addressType === 4 || message.addressType === 6) &&
+                     !(message.fd >= 0)) {
+                constructor = ReusePortHandle;
+            }
+            handle = new constructor(key,
                 message.address,
                 message.port,
                 message.addressType,
                 message.backlog,
                 message.fd);
+            // Same when the kernel doesn't support it.
+            if (constructor === ReusePortHandle &&
+                handle.errno === uv.UV_ENOTSUP) {
+                handle = new RoundRobinHandle(key,
+                    message.address,
+                    message.port,
+                    message.addressType,
+                    message.backlog,
+                    message.fd);
+            }
+            handles[key] = handle;
         }
         handle.add(worker, function (errno, reply, handle) {
             reply = util._extend({ ack: message.seq, key: key }, reply);
@@ -409,11 +568,12 @@ function masterInit() {
         cluster.emit('listening', worker, info);
     }
 
-    // Round-robin only. Server in worker is closing, remove from list.
+    // Round-robin and SO_REUSEPORT only. Server in worker is closing, remove
+    // from list.
     function close(worker, message) {
         var key = message.key;
         var handle = handles[key];
-        if (handle.remove(worker)) delete handles[key];
+        if (handle && handle.remove(worker)) delete handles[key];
     }
 
     function send(worker, message, handle, cb) {
@@ -432,6 +592,15 @@ function workerInit() {
         worker.id = +process.env.NODE_UNIQUE_ID | 0;
         worker.state = 'online';
         worker.process = process;
+        if ('NODE_CLUSTER_RING_FD' in process.env) {
+            var fd = +process.env.NODE_CLUSTER_RING_FD;
+            delete process.env.NODE_CLUSTER_RING_FD;
+            var ring = new Ring();
+            if (ring.open(fd, fd + 1, fd + 2) === 0)
+                setupRing(worker, ring);
+            else
+                ring.close();
+        }
         process.once('disconnect', process.exit.bind(null, 0));
         process.on('internalMessage', internal(worker, onmessage));
         send({ act: 'online' });
@@ -440,6 +609,8 @@ function workerInit() {
                 onconnection(message, handle);
             else if (message.act === 'disconnect')
                 worker.disconnect();
+            else if (message.act === 'ringclose')
+                closeRing(worker);
         }
     };
 
@@ -455,6 +626,8 @@ function workerInit() {
         send(message, function (reply, handle) {
             if (handle)
                 shared(reply, handle, cb);  // Shared listen socket.
+            else if (reply.reuseport)
+                reuseport(reply, address, addressType, cb);  // Own socket.
             else
                 rr(reply, cb);              // Round-robin.
         });
@@ -482,6 +655,49 @@ function workerInit() {
         cb(handle);
     }
 
+    // SO_REUSEPORT. The worker listens on a socket of its own, bound to the
+    // port that the master reserved.
+    function reuseport(message, address, addressType, cb) {
+        var key = message.key;
+        var errno = message.errno;
+        var handle = null;
+
+        if (!errno) {
+            var rval = net._createServerHandle(address,
+                                               message.sockname.port,
+                                               addressType,
+                                               -1,
+                                               true);
+            if (typeof rval === 'number')
+                errno = rval;
+            else
+                handle = rval;
+        }
+
+        if (errno) {
+            // Faux handle, lib/net.js reports the error when it calls listen().
+            return cb({
+                close: function () {},
+                listen: function () { return errno; }
+            });
+        }
+
+        // Let the master know when we stop listening so that it can release
+        // the port once all workers are done with it.
+        var close = handle.close;
+        handle.close = function () {
+            if (typeof key !== 'undefined') {
+                send({ act: 'close', key: key });
+                delete handles[key];
+                key = undefined;
+            }
+            return close.apply(this, arguments);
+        };
+        assert(typeof handles[key] === 'undefined');
+        handles[key] = handle;
+        cb(handle);
+    }
+
     // Round-robin. Master distributes handles across workers.
     function rr(message, cb) {
         if (message.errno)
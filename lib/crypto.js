@@ -180,37 +180,158 @@ function Hash(algorithm, options) {
     if (!(this instanceof Hash))
         return new Hash(algorithm, options);
     this._binding = new binding.Hash(algorithm);
+    initAsync(this, options);
     LazyTransform.call(this, options);
 }
 
 util.inherits(Hash, LazyTransform);
 
 Hash.prototype._transform = function (chunk, encoding, callback) {
+    if (this._async)
+        return this.update(chunk, encoding, callback);
     this._binding.update(chunk, encoding);
     callback();
 };
 
 Hash.prototype._flush = function (callback) {
+    var self = this;
     var encoding = this._readableState.encoding || 'buffer';
-    this.push(this._binding.digest(encoding), encoding);
-    callback();
+    if (!this._async) {
+        this.push(this._binding.digest(encoding), encoding);
+        return callback();
+    }
+    this.digest(encoding, function (err, digest) {
+        if (!err)
+            self.push(digest, encoding);
+        callback(err);
+    });
 };
 
-Hash.prototype.update = function (data, encoding) {
+Hash.prototype.update = function (data, encoding, callback) {
+    if (typeof encoding === 'function') {
+        callback = encoding;
+        encoding = null;
+    }
     encoding = encoding || exports.DEFAULT_ENCODING;
     if (encoding === 'buffer' && typeof data === 'string')
         encoding = 'binary';
+    if (typeof callback === 'function')
+        return queueAsync(this, toBuf(data, encoding), null, callback);
+    if (this._asyncQueue !== null)
+        throw new Error('Asynchronous update in progress');
     this._binding.update(data, encoding);
     return this;
 };
 
 
-Hash.prototype.digest = function (outputEncoding) {
+Hash.prototype.digest = function (outputEncoding, callback) {
+    if (typeof outputEncoding === 'function') {
+        callback = outputEncoding;
+        outputEncoding = null;
+    }
     outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+    if (typeof callback === 'function')
+        return queueAsync(this, null, outputEncoding, callback);
+    if (this._asyncQueue !== null)
+        throw new Error('Asynchronous update in progress');
     return this._binding.digest(outputEncoding);
 };
 
 
+// Updates with a callback are hashed on the thread pool.  Whatever is
+// queued up while a batch is running goes out as the next batch, so a
+// stream of small writes doesn't turn into one work request per write.
+// Digests wait for the updates in front of them.
+function initAsync(self, options) {
+    self._async = !!(options && options.async);
+    self._asyncQueue = null;
+    self._asyncBusy = false;
+}
+
+
+function queueAsync(self, data, encoding, callback) {
+    if (self._asyncQueue === null)
+        self._asyncQueue = [];
+    self._asyncQueue.push({
+        data: data,
+        encoding: encoding,
+        callback: callback
+    });
+    if (!self._asyncBusy)
+        runAsync(self);
+    return self;
+}
+
+
+function runAsync(self) {
+    var queue = self._asyncQueue;
+
+    while (queue.length > 0 && queue[0].data === null) {
+        var req = queue.shift();
+        var err = null;
+        var digest;
+        try {
+            digest = self._binding.digest(req.encoding);
+        } catch (e) {
+            err = e;
+        }
+        process.nextTick(req.callback.bind(null, err, digest));
+    }
+
+    if (queue.length === 0) {
+        self._asyncQueue = null;
+        self._asyncBusy = false;
+        return;
+    }
+
+    var buffers = [];
+    var callbacks = [];
+    while (queue.length > 0 && queue[0].data !== null) {
+        var next = queue.shift();
+        buffers.push(next.data);
+        callbacks.push(next.callback);
+    }
+
+    self._asyncBusy = true;
+    self._binding.updateAsync(buffers, function (err) {
+        // The callbacks may use the hash synchronously if nothing else is
+        // queued up
+        self._asyncBusy = false;
+        if (self._asyncQueue.length === 0)
+            self._asyncQueue = null;
+        for (var i = 0; i < callbacks.length; i++)
+            callbacks[i](err);
+        if (self._asyncQueue !== null && !self._asyncBusy)
+            runAsync(self);
+    });
+}
+
+
+// Hashes `data`, a buffer, a string or an array of those, on the thread
+// pool and passes the digest to `callback`.
+exports.hash = function (algorithm, data, outputEncoding, callback) {
+    if (typeof outputEncoding === 'function') {
+        callback = outputEncoding;
+        outputEncoding = null;
+    }
+    if (typeof callback !== 'function')
+        throw new Error('No callback provided to hash');
+
+    outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+    if (!Array.isArray(data))
+        data = [data];
+
+    var h = new binding.Hash(algorithm);
+    h.updateAsync(data.map(function (chunk) {
+        return toBuf(chunk);
+    }), function (err) {
+        if (err)
+            return callback(err);
+        callback(null, h.digest(outputEncoding));
+    });
+};
+
+
 exports.createHmac = exports.Hmac = Hmac;
 
 function Hmac(hmac, key, options) {
@@ -218,6 +339,7 @@ function Hmac(hmac, key, options) {
         return new Hmac(hmac, key, options);
     this._binding = new binding.Hmac();
     this._binding.init(hmac, toBuf(key));
+    initAsync(this, options);
     LazyTransform.call(this, options);
 }
 
@@ -229,6 +351,19 @@ Hmac.prototype._flush = Hash.prototype._flush;
 Hmac.prototype._transform = Hash.prototype._transform;
 
 
+// Computes the HMAC of every message in `messages` in one call.  `keys`
+// is a single key or an array of keys, one per message.  Strings are
+// binary encoded, like in update().
+exports.hmacBatch = function (algorithm, keys, messages, outputEncoding) {
+    outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+    if (Array.isArray(keys))
+        keys = keys.map(function (key) { return toBuf(key); });
+    else
+        keys = toBuf(keys);
+    return binding.hmacBatch(algorithm, keys, messages, outputEncoding);
+};
+
+
 function getDecoder(decoder, encoding) {
     if (encoding === 'utf-8') encoding = 'utf8';  // Normalize encoding.
     decoder = decoder || new StringDecoder(encoding);
@@ -376,7 +511,13 @@ Sign.prototype._write = function (chunk, encoding, callback) {
     callback();
 };
 
-Sign.prototype.update = Hash.prototype.update;
+Sign.prototype.update = function (data, encoding) {
+    encoding = encoding || exports.DEFAULT_ENCODING;
+    if (encoding === 'buffer' && typeof data === 'string')
+        encoding = 'binary';
+    this._binding.update(data, encoding);
+    return this;
+};
 
 Sign.prototype.sign = function (key, encoding) {
     encoding = encoding || exports.DEFAULT_ENCODING;
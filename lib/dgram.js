@@ -79,6 +79,7 @@ function newHandle(type) {
         handle.lookup = lookup6;
         handle.bind = handle.bind6;
         handle.send = handle.send6;
+        handle.sendBatch = handle.sendBatch6;
         return handle;
     }
 
@@ -115,6 +116,8 @@ function Socket(type, listener) {
 
     this._handle = handle;
     this._receiving = false;
+    this._recvBatch = 0;
+    this._recvSlotSize = 0;
     this._bindState = BIND_STATE_UNBOUND;
     this.type = type;
     this.fd = null; // compatibility hack
@@ -133,8 +136,9 @@ exports.createSocket = function (type, listener) {
 
 function startListening(socket) {
     socket._handle.onmessage = onMessage;
+    socket._handle.onmessages = onMessages;
     // Todo: handle errors
-    socket._handle.recvStart();
+    socket._handle.recvStart(socket._recvBatch, socket._recvSlotSize);
     socket._receiving = true;
     socket._bindState = BIND_STATE_BOUND;
     socket.fd = -42; // compatibility hack
@@ -148,6 +152,7 @@ function replaceHandle(self, newHandle) {
     newHandle.lookup = self._handle.lookup;
     newHandle.bind = self._handle.bind;
     newHandle.send = self._handle.send;
+    newHandle.sendBatch = self._handle.sendBatch;
     newHandle.owner = self;
 
     // Replace the existing handle by the handle we got from master.
@@ -252,18 +257,8 @@ Socket.prototype.send = function (buffer, offset, length, port, address, callbac
     // If the socket hasn't been bound yet, push the outbound packet onto the
     // send queue and send after binding is complete.
     if (self._bindState != BIND_STATE_BOUND) {
-        // If the send queue hasn't been initialized yet, do it, and install an
-        // event handler that flushes the send queue after binding is done.
-        if (!self._sendQueue) {
-            self._sendQueue = [];
-            self.once('listening', function () {
-                // Flush the send queue.
-                for (var i = 0; i < self._sendQueue.length; i++)
-                    self.send.apply(self, self._sendQueue[i]);
-                self._sendQueue = undefined;
-            });
-        }
-        self._sendQueue.push([buffer, offset, length, port, address, callback]);
+        enqueueSend(self, self.send,
+                    [buffer, offset, length, port, address, callback]);
         return;
     }
 
@@ -273,7 +268,7 @@ Socket.prototype.send = function (buffer, offset, length, port, address, callbac
             self.emit('error', ex);
         }
         else if (self._handle) {
-            var req = { cb: callback, oncomplete: afterSend };
+            var req = { cb: callback, oncomplete: afterSend, length: length };
             var err = self._handle.send(req, buffer, offset, length, port, ip);
             if (err) {
                 // don't emit as error, dgram_legacy.js compatibility
@@ -286,11 +281,86 @@ Socket.prototype.send = function (buffer, offset, length, port, address, callbac
 };
 
 
-function afterSend(status, handle, req, buffer) {
-    var self = handle.owner;
+// Send every buffer in `buffers` as a datagram of its own. The datagrams go
+// out with as few system calls as the platform allows, the callback runs
+// once after all of them have been sent.
+Socket.prototype.sendBatch = function (buffers, port, address, callback) {
+    var self = this;
+
+    if (!Array.isArray(buffers))
+        throw new TypeError('First argument must be an array of buffers.');
+
+    // Copy, the binding holds on to the buffers until they have been sent.
+    buffers = buffers.slice();
+
+    var length = 0;
+    for (var i = 0; i < buffers.length; i++) {
+        if (!Buffer.isBuffer(buffers[i]))
+            throw new TypeError('First argument must be an array of buffers.');
+        length += buffers[i].length;
+    }
+
+    callback = callback || noop;
+
+    self._healthCheck();
+
+    if (buffers.length === 0) {
+        process.nextTick(function () {
+            callback(null, 0);
+        });
+        return;
+    }
+
+    if (self._bindState == BIND_STATE_UNBOUND)
+        self.bind(0, null);
+
+    if (self._bindState != BIND_STATE_BOUND) {
+        enqueueSend(self, self.sendBatch, [buffers, port, address, callback]);
+        return;
+    }
+
+    self._handle.lookup(address, function (ex, ip) {
+        if (ex) {
+            callback(ex);
+            self.emit('error', ex);
+        }
+        else if (self._handle) {
+            var req = { cb: callback, oncomplete: afterSend, length: length };
+            var err = self._handle.sendBatch(req, buffers, port, ip);
+            if (err) {
+                process.nextTick(function () {
+                    callback(errnoException(err, 'send'));
+                });
+            }
+        }
+    });
+};
+
+
+function enqueueSend(self, method, args) {
+    // If the send queue hasn't been initialized yet, do it, and install an
+    // event handler that flushes the send queue after binding is done.
+    if (!self._sendQueue) {
+        self._sendQueue = [];
+        self.once('listening', function () {
+            // Flush the send queue.
+            for (var i = 0; i < self._sendQueue.length; i++)
+                self._sendQueue[i][0].apply(self, self._sendQueue[i][1]);
+            self._sendQueue = undefined;
+        });
+    }
+    self._sendQueue.push([method, args]);
+}
+
+
+function afterSend(status) {
+    if (!this.cb)
+        return;
 
-    if (req.cb)
-        req.cb(null, buffer.length); // compatibility with dgram_legacy.js
+    if (status < 0)
+        this.cb(errnoException(status, 'send'));
+    else
+        this.cb(null, this.length); // compatibility with dgram_legacy.js
 }
 
 
@@ -396,6 +466,32 @@ Socket.prototype._healthCheck = function () {
 };
 
 
+// Read up to `nmsgs` datagrams per system call and deliver them to JS in one
+// go. Every datagram gets a slot of `size` bytes (default 64 kB), larger
+// datagrams are truncated. 'message' listeners still see one event per
+// datagram, 'messages' listeners get the whole batch as (msgs, rinfos).
+// Pass 0 to go back to reading datagrams one by one. libuv reads at most 64
+// datagrams per system call.
+Socket.prototype.setRecvBatch = function (nmsgs, size) {
+    if (typeof nmsgs !== 'number' || nmsgs < 0 || nmsgs > 64)
+        throw new RangeError('nmsgs must be a number between 0 and 64');
+
+    if (size !== undefined && (typeof size !== 'number' || size < 1 ||
+                               size > 65536))
+        throw new RangeError('size must be a number between 1 and 65536');
+
+    this._recvBatch = nmsgs >>> 0;
+    this._recvSlotSize = size >>> 0;
+
+    if (this._receiving) {
+        this._handle.recvStop();
+        var err = this._handle.recvStart(this._recvBatch, this._recvSlotSize);
+        if (err)
+            throw errnoException(err, 'recvStart');
+    }
+};
+
+
 Socket.prototype._stopReceiving = function () {
     if (!this._receiving)
         return;
@@ -416,6 +512,29 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+function onMessages(nmsgs, handle, buf, lengths, rinfos) {
+    var self = handle.owner;
+    var msgs = new Array(nmsgs);
+    var offset = 0;
+    var i;
+
+    for (i = 0; i < nmsgs; i++) {
+        msgs[i] = buf.slice(offset, offset + lengths[i]);
+        rinfos[i].size = lengths[i]; // compatibility
+        offset += lengths[i];
+    }
+
+    self.emit('messages', msgs, rinfos);
+
+    if (events.EventEmitter.listenerCount(self, 'message') === 0)
+        return;
+
+    // Stop when a listener closes the socket or turns off receiving.
+    for (i = 0; i < nmsgs && self._receiving; i++)
+        self.emit('message', msgs[i], rinfos[i]);
+}
+
+
 Socket.prototype.ref = function () {
     if (this._handle)
         this._handle.ref();
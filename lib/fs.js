@@ -38,6 +38,7 @@ var Readable = Stream.Readable;
 var Writable = Stream.Writable;
 
 var kMinPoolSpace = 128;
+var kSendFileChunk = 1024 * 1024;
 
 var O_APPEND = constants.O_APPEND || 0;
 var O_CREAT = constants.O_CREAT || 0;
@@ -184,6 +185,24 @@ fs.readFile = function (path, options, callback_) {
     var encoding = options.encoding;
     assertEncoding(encoding);
 
+    var flag = options.flag || 'r';
+
+    if (binding.readFile) {
+        // open, fstat, read and close in one go in the thread pool.
+        if (!nullCheck(path, callback)) return;
+        binding.readFile(pathModule._makeLong(path),
+            stringToFlags(flag),
+            438 /*=0666*/,
+            encoding,
+            function (er, data) {
+                // The file doesn't fit in a Buffer. new Buffer(size) throws
+                // in that case in the code below, keep doing the same.
+                if (er instanceof RangeError) throw er;
+                callback(er, data);
+            });
+        return;
+    }
+
     // first, stat the file, so we know the size.
     var size;
     var buffer; // single buffer with file data
@@ -191,7 +210,6 @@ fs.readFile = function (path, options, callback_) {
     var pos = 0;
     var fd;
 
-    var flag = options.flag || 'r';
     fs.open(path, flag, 438 /*=0666*/, function (er, fd_) {
         if (er) return callback(er);
         fd = fd_;
@@ -525,6 +543,48 @@ fs.writeSync = function (fd, buffer, offset, length, position) {
     return binding.write(fd, buffer, offset, length, position);
 };
 
+// Writes an array of buffers with a single request. The buffers must not
+// be modified until the callback has been called.
+fs.writev = function (fd, buffers, position, callback) {
+    if (typeof position === 'function') {
+        callback = position;
+        position = null;
+    }
+    callback = maybeCallback(callback);
+
+    function wrapper(err, written) {
+        // Retain a reference to buffers so that they can't be GC'ed too soon.
+        callback(err, written || 0, buffers);
+    }
+
+    binding.writeBuffers(fd, buffers, position, wrapper);
+};
+
+fs.writevSync = function (fd, buffers, position) {
+    return binding.writeBuffers(fd, buffers, position);
+};
+
+// Reads into an array of buffers with a single request, filling them one
+// after the other.
+fs.readv = function (fd, buffers, position, callback) {
+    if (typeof position === 'function') {
+        callback = position;
+        position = null;
+    }
+    callback = maybeCallback(callback);
+
+    function wrapper(err, bytesRead) {
+        // Retain a reference to buffers so that they can't be GC'ed too soon.
+        callback(err, bytesRead || 0, buffers);
+    }
+
+    binding.readBuffers(fd, buffers, position, wrapper);
+};
+
+fs.readvSync = function (fd, buffers, position) {
+    return binding.readBuffers(fd, buffers, position);
+};
+
 fs.rename = function (oldPath, newPath, callback) {
     callback = makeCallback(callback);
     if (!nullCheck(oldPath, callback)) return;
@@ -936,7 +996,20 @@ fs.writeFile = function (path, data, options, callback) {
     assertEncoding(options.encoding);
 
     var flag = options.flag || 'w';
-    fs.open(path, options.flag || 'w', options.mode, function (openErr, fd) {
+
+    if (binding.writeFile) {
+        if (!nullCheck(path, callback)) return;
+        binding.writeFile(pathModule._makeLong(path),
+            stringToFlags(flag),
+            modeNum(options.mode, 438 /*=0666*/),
+            Buffer.isBuffer(data) ? data : '' + data,
+            options.encoding || 'utf8',
+            /a/.test(flag),
+            callback);
+        return;
+    }
+
+    fs.open(path, flag, options.mode, function (openErr, fd) {
         if (openErr) {
             if (callback) callback(openErr);
         } else {
@@ -1009,22 +1082,49 @@ fs.appendFileSync = function (path, data, options) {
     fs.writeFileSync(path, data, options);
 };
 
-function FSWatcher() {
+function FSWatcher(recursive) {
     EventEmitter.call(this);
 
     var self = this;
-    var FSEvent = process.binding('fs_event_wrap').FSEvent;
-    this._handle = new FSEvent();
+    var fsEvent = process.binding('fs_event_wrap');
+    this._closed = false;
+
+    if (recursive) {
+        this._handle = new fsEvent.FSTreeEvent();
+        this._handle.onchange = onTreeChange;
+    } else {
+        this._handle = new fsEvent.FSEvent();
+        this._handle.onchange = function (status, event, filename) {
+            if (status < 0) {
+                self.close();
+                self.emit('error', errnoException(status, 'watch'));
+            } else {
+                self.emit('change', event, filename);
+            }
+        };
+    }
     this._handle.owner = this;
 
-    this._handle.onchange = function (status, event, filename) {
-        if (status < 0) {
-            self._handle.close();
+    // The changes in the tree since the last call, merged per file. `list`
+    // holds the event names and the file names in turns.
+    function onTreeChange(status, list) {
+        var i;
+
+        if (EventEmitter.listenerCount(self, 'changes') > 0) {
+            var changes = [];
+            for (i = 0; i < list.length; i += 2)
+                changes.push({ event: list[i], filename: list[i + 1] });
+            self.emit('changes', changes);
+        }
+
+        for (i = 0; i < list.length && !self._closed; i += 2)
+            self.emit('change', list[i], list[i + 1]);
+
+        if (status < 0 && !self._closed) {
+            self.close();
             self.emit('error', errnoException(status, 'watch'));
-        } else {
-            self.emit('change', event, filename);
         }
-    };
+    }
 }
 util.inherits(FSWatcher, EventEmitter);
 
@@ -1038,6 +1138,7 @@ FSWatcher.prototype.start = function (filename, persistent) {
 };
 
 FSWatcher.prototype.close = function () {
+    this._closed = true;
     this._handle.close();
 };
 
@@ -1057,7 +1158,7 @@ fs.watch = function (filename) {
 
     if (options.persistent === undefined) options.persistent = true;
 
-    watcher = new FSWatcher();
+    watcher = new FSWatcher(!!options.recursive);
     watcher.start(filename, options.persistent);
 
     if (listener) {
@@ -1501,6 +1602,13 @@ ReadStream.prototype._read = function (n) {
     if (this.destroyed)
         return;
 
+    // Piping into a socket, see sendFile(). Hold on to the read in case we
+    // have to fall back to a regular pipe.
+    if (this._sendFile) {
+        this._sendFile.read = n;
+        return;
+    }
+
     if (!pool || pool.length - pool.used < kMinPoolSpace) {
         // discard the old pool.
         pool = null;
@@ -1548,6 +1656,147 @@ ReadStream.prototype._read = function (n) {
 };
 
 
+// Files that are piped into a socket skip the JS heap, the data goes from the
+// page cache to the socket with sendfile(2). That only works when nothing has
+// been read yet and the data isn't decoded.
+ReadStream.prototype.pipe = function (dest, pipeOpts) {
+    var state = this._readableState;
+
+    if (typeof dest._sendFile !== 'function' ||
+        this.destroyed ||
+        state.decoder ||
+        state.pipesCount !== 0 ||
+        state.flowing ||
+        state.reading ||
+        state.ended ||
+        state.length !== 0 ||
+        this.listeners('data').length !== 0 ||
+        // Reading from the current position of an fd we didn't open.
+        (this.pos === undefined && typeof this.fd === 'number')) {
+        return Readable.prototype.pipe.call(this, dest, pipeOpts);
+    }
+
+    this._sendFile = {
+        dest: dest,
+        end: !pipeOpts || pipeOpts.end !== false,
+        pipeOpts: pipeOpts,
+        offset: this.pos === undefined ? 0 : this.pos,
+        piped: false,
+        read: -1
+    };
+
+    if (typeof this.fd === 'number')
+        sendFile(this);
+    else
+        this.once('open', function () {
+            sendFile(this);
+        });
+
+    return dest;
+};
+
+
+// The chunks are sent one at a time so unpipe() can stop in between. libuv
+// reads cold parts of the file in on the threadpool before it sends them.
+function sendFile(self) {
+    var job = self._sendFile;
+    var dest = job.dest;
+    var state = dest._writableState;
+
+    fs.fstat(self.fd, function (er, st) {
+        // Destroyed or unpiped in the meantime.
+        if (self.destroyed || self._sendFile !== job)
+            return;
+
+        var offset = job.offset;
+        var end = st ? st.size : 0;
+        if (self.pos !== undefined)
+            end = Math.min(end, self.end + 1);
+
+        // Writes that are still buffered would end up after the file.
+        if (er ||
+            !st.isFile() ||
+            state.buffer.length !== 0 ||
+            state.ended) {
+            return fallback(offset);
+        }
+
+        job.piped = true;
+        dest.emit('pipe', self);
+        if (self._sendFile === job)
+            next();
+
+        function next() {
+            var length = Math.min(end - offset, kSendFileChunk);
+
+            if (length <= 0)
+                return done();
+
+            if (!dest._sendFile(self.fd, offset, length, after))
+                return fallback(offset);
+
+            offset += length;
+            job.offset = offset;
+        }
+
+        function after(er) {
+            if (self._sendFile !== job)
+                return;
+            if (er) {
+                // The socket emits the error.
+                self._sendFile = null;
+                if (self.autoClose)
+                    self.destroy();
+                return;
+            }
+            if (!self.destroyed)
+                next();
+        }
+
+        function done() {
+            self._sendFile = null;
+            self.push(null);
+            self.read(0);
+            if (job.end)
+                dest.end();
+        }
+    });
+
+    // Read the rest the regular way.
+    function fallback(offset) {
+        self._sendFile = null;
+        if (self.pos === undefined) {
+            self.end = Infinity;
+        }
+        self.pos = offset;
+        Readable.prototype.pipe.call(self, dest, job.pipeOpts);
+        if (job.read !== -1)
+            self._read(job.read);
+    }
+}
+
+
+// Stops sending the file. The chunk that is in flight still goes out, the
+// stream picks up after it.
+ReadStream.prototype.unpipe = function (dest) {
+    var job = this._sendFile;
+
+    if (!job || (dest && dest !== job.dest))
+        return Readable.prototype.unpipe.call(this, dest);
+
+    this._sendFile = null;
+    if (this.pos === undefined)
+        this.end = Infinity;
+    this.pos = job.offset;
+    if (job.piped)
+        job.dest.emit('unpipe', this);
+    if (job.read !== -1)
+        this._read(job.read);
+
+    return this;
+};
+
+
 ReadStream.prototype.destroy = function () {
     if (this.destroyed)
         return;
@@ -1669,6 +1918,39 @@ WriteStream.prototype._write = function (data, encoding, cb) {
 };
 
 
+// Everything that was written while a write was in progress goes out with
+// one writev request.
+WriteStream.prototype._writev = function (chunks, cb) {
+    if (typeof this.fd !== 'number')
+        return this.once('open', function () {
+            this._writev(chunks, cb);
+        });
+
+    var buffers = new Array(chunks.length);
+    var size = 0;
+    for (var i = 0; i < chunks.length; i++) {
+        var chunk = chunks[i].chunk;
+        if (!Buffer.isBuffer(chunk))
+            return this.emit('error', new Error('Invalid data'));
+        buffers[i] = chunk;
+        size += chunk.length;
+    }
+
+    var self = this;
+    fs.writev(this.fd, buffers, this.pos, function (er, bytes) {
+        if (er) {
+            self.destroy();
+            return cb(er);
+        }
+        self.bytesWritten += bytes;
+        cb();
+    });
+
+    if (this.pos !== undefined)
+        this.pos += size;
+};
+
+
 WriteStream.prototype.destroy = ReadStream.prototype.destroy;
 WriteStream.prototype.close = ReadStream.prototype.close;
 
@@ -126,6 +126,9 @@ function initSocketHandle(self) {
         // If handle doesn't support writev - neither do we
         if (!self._handle.writev)
             self._writev = null;
+
+        if (self._coalesceWrites && self._handle.setCoalesceWrites)
+            self._handle.setCoalesceWrites(true);
     }
 }
 
@@ -135,6 +138,8 @@ function Socket(options) {
     this._connecting = false;
     this._hadError = false;
     this._handle = null;
+    this._coalesceWrites = false;
+    this._flushScheduled = false;
 
     switch (typeof options) {
         case 'number':
@@ -331,6 +336,30 @@ Socket.prototype.setNoDelay = function (enable) {
 };
 
 
+Socket.prototype.setCoalesceWrites = function (enable) {
+    // like setNoDelay(), assume true when `enable` is omitted
+    this._coalesceWrites = typeof enable === 'undefined' ? true : !!enable;
+    if (this._handle && this._handle.setCoalesceWrites) {
+        // Turning it off flushes whatever is queued.
+        var err = this._handle.setCoalesceWrites(this._coalesceWrites);
+        if (err)
+            this._destroy(errnoException(err, 'write'));
+    }
+    return this;
+};
+
+
+// Hands the writes queued during this tick to the handle as one writev.
+function flushWrites(self) {
+    self._flushScheduled = false;
+    if (!self._handle)
+        return;
+    var err = self._handle.flushWrites();
+    if (err)
+        self._destroy(errnoException(err, 'write'));
+}
+
+
 Socket.prototype.setKeepAlive = function (setting, msecs) {
     if (this._handle && this._handle.setKeepAlive)
         this._handle.setKeepAlive(setting, ~~(msecs / 1000));
@@ -455,6 +484,10 @@ Socket.prototype._destroy = function (exception, cb) {
     if (this._handle) {
         if (this !== process.stderr)
             debug('close handle');
+        // Coalesced writes go out before the handle is closed, same as
+        // writes that were handed to libuv directly.
+        if (this._coalesceWrites && this._handle.flushWrites)
+            this._handle.flushWrites();
         var isException = exception ? true : false;
         this._handle.close(function () {
             debug('emit close');
@@ -630,6 +663,7 @@ Socket.prototype._writeGeneric = function (writev, data, encoding, cb) {
         return false;
     }
 
+    var self = this;
     var req = { oncomplete: afterWrite };
     var err;
 
@@ -656,9 +690,21 @@ Socket.prototype._writeGeneric = function (writev, data, encoding, cb) {
 
     this._bytesDispatched += req.bytes;
 
+    if (this._coalesceWrites && !this._flushScheduled) {
+        this._flushScheduled = true;
+        process.nextTick(function () {
+            flushWrites(self);
+        });
+    }
+
     // If it was entirely flushed, we can write some more right now.
     // However, if more is left in the queue, then wait until that clears.
-    if (this._handle.writeQueueSize === 0)
+    // Coalesced writes are still queued at this point, they only hold up
+    // the next write once a high water mark's worth has piled up.
+    var queued = this._handle.writeQueueSize;
+    if (queued === 0 ||
+        (this._coalesceWrites &&
+         queued < this._writableState.highWaterMark))
         cb();
     else
         req.cb = cb;
@@ -670,6 +716,54 @@ Socket.prototype._writev = function (chunks, cb) {
 };
 
 
+// Writes `length` bytes of file `fd`, starting at `offset`, with sendfile(2).
+// It skips the Writable buffer, the caller has to make sure that nothing is
+// buffered; see ReadStream#pipe() in lib/fs.js. Returns false when the
+// socket can't do it, e.g. TLS sockets, and true when `cb` will be called.
+Socket.prototype._sendFile = function (fd, offset, length, cb) {
+    if (this._connecting || !this._handle || !this._handle.sendFile)
+        return false;
+
+    timers._unrefActive(this);
+
+    var req = { oncomplete: afterSendFile, cb: cb };
+    var err = this._handle.sendFile(req, fd, offset, length);
+
+    if (err === uv.UV_ENOTSUP)
+        return false;
+
+    if (err) {
+        var ex = errnoException(err, 'sendfile');
+        this._destroy(ex);
+        process.nextTick(function () {
+            cb(ex);
+        });
+        return true;
+    }
+
+    this._bytesDispatched += req.bytes;
+    return true;
+};
+
+
+function afterSendFile(status, handle, req) {
+    var self = handle.owner;
+    var ex = null;
+
+    if (status < 0) {
+        ex = errnoException(status, 'sendfile');
+        debug('sendfile failure', ex);
+        // The socket may have been destroyed already, that cancels the write.
+        if (!self.destroyed)
+            self._destroy(ex);
+    } else {
+        timers._unrefActive(self);
+    }
+
+    req.cb(ex);
+}
+
+
 Socket.prototype._write = function (data, encoding, cb) {
     this._writeGeneric(false, data, encoding, cb);
 };
@@ -990,8 +1084,10 @@ function toNumber(x) {
 }
 
 
+// `reusePort` sets SO_REUSEPORT on TCP handles before binding them, see the
+// SCHED_REUSEPORT scheduling policy in lib/cluster.js.
 var createServerHandle = exports._createServerHandle =
-    function (address, port, addressType, fd) {
+    function (address, port, addressType, fd, reusePort) {
         var err = 0;
         // assign handle in listen, and clean up if bind or listen fails
         var handle;
@@ -1020,9 +1116,11 @@ var createServerHandle = exports._createServerHandle =
             }
         } else {
             handle = createTCP();
+            if (reusePort)
+                err = handle.setReusePort(true);
         }
 
-        if (address || port) {
+        if (!err && (address || port)) {
             debug('bind to ' + address);
             if (addressType == 6) {
                 err = handle.bind6(address, port);
@@ -125,6 +125,7 @@ function listOnTimeout() {
 
 var unenroll = exports.unenroll = function (item) {
     L.remove(item);
+    unrefRemove(item);
 
     var list = lists[item._idleTimeout];
     // if empty then stop the watcher
@@ -143,7 +144,7 @@ var unenroll = exports.unenroll = function (item) {
 exports.enroll = function (item, msecs) {
     // if this item was already in a list somewhere
     // then we should unenroll it from that
-    if (item._idleNext) unenroll(item);
+    if (item._idleNext || item._unrefId >= 0) unenroll(item);
 
     // Ensure that msecs fits into signed int32
     if (msecs > 0x7fffffff) {
@@ -378,28 +379,44 @@ exports.clearImmediate = function (immediate) {
 
 // Internal APIs that need timeouts should use timers._unrefActive isntead of
 // timers.active as internal timeouts shouldn't hold the loop open
+//
+// Those are mostly socket idle timeouts. There can be a great many of them,
+// with all kinds of durations, and they get pushed back on every read and
+// write. They are kept in a native timing wheel that needs just one uv timer
+// and makes starting, restarting and expiring a timeout O(1). The wheel knows
+// timeouts by id, item._unrefId, unrefItems maps the ids back to the items.
 
-var unrefList, unrefTimer;
+var TimerWheel = process.binding('timer_wrap').TimerWheel;
 
+// item._unrefId values that aren't wheel ids.
+var UNREF_NONE = -1;
+var UNREF_EXPIRED = -2;
 
-function unrefTimeout() {
-    var now = Timer.now();
+var unrefWheel, unrefItems;
 
-    debug('unrefTimer fired');
 
-    var first;
-    while (first = L.peek(unrefList)) {
-        var diff = now - first._idleStart;
+function unrefTimeout(ids) {
+    debug('unrefWheel fired, %d expired', ids.length);
 
-        if (diff < first._idleTimeout) {
-            diff = first._idleTimeout - diff;
-            unrefTimer.start(diff, 0);
-            unrefTimer.when = now + diff;
-            debug('unrefTimer rescheudling for later');
-            return;
-        }
+    var expired = new Array(ids.length);
+    for (var i = 0; i < ids.length; i++) {
+        var item = unrefItems[ids[i]];
+        unrefItems[ids[i]] = undefined;
+        item._unrefId = UNREF_EXPIRED;
+        expired[i] = item;
+    }
+
+    runUnrefTimeouts(expired, 0);
+}
 
-        L.remove(first);
+
+function runUnrefTimeouts(expired, start) {
+    for (var i = start; i < expired.length; i++) {
+        var first = expired[i];
+
+        // Restarted or cancelled by one of the timeouts that ran before it.
+        if (first._unrefId !== UNREF_EXPIRED) continue;
+        first._unrefId = UNREF_NONE;
 
         var domain = first.domain;
 
@@ -414,12 +431,24 @@ function unrefTimeout() {
             threw = false;
             if (domain) domain.exit();
         } finally {
-            if (threw) process.nextTick(unrefTimeout);
+            if (threw) {
+                process.nextTick(function() {
+                    runUnrefTimeouts(expired, i + 1);
+                });
+            }
         }
     }
+}
 
-    debug('unrefList is empty');
-    unrefTimer.when = -1;
+
+function unrefRemove(item) {
+    if (item._unrefId === undefined) return;
+
+    if (item._unrefId >= 0) {
+        unrefWheel.remove(item._unrefId);
+        unrefItems[item._unrefId] = undefined;
+    }
+    item._unrefId = UNREF_NONE;
 }
 
 
@@ -430,55 +459,20 @@ exports._unrefActive = function (item) {
 
     L.remove(item);
 
-    if (!unrefList) {
-        debug('unrefList initialized');
-        unrefList = {};
-        L.init(unrefList);
-
-        debug('unrefTimer initialized');
-        unrefTimer = new Timer();
-        unrefTimer.unref();
-        unrefTimer.when = -1;
-        unrefTimer.ontimeout = unrefTimeout;
+    if (!unrefWheel) {
+        debug('unrefWheel initialized');
+        unrefWheel = new TimerWheel();
+        unrefWheel.unref();
+        unrefWheel.ontimeout = unrefTimeout;
+        unrefItems = [];
     }
 
-    var now = Timer.now();
-    item._idleStart = now;
-
-    if (L.isEmpty(unrefList)) {
-        debug('unrefList empty');
-        L.append(unrefList, item);
-
-        unrefTimer.start(msecs, 0);
-        unrefTimer.when = now + msecs;
-        debug('unrefTimer scheduled');
-        return;
-    }
-
-    var when = now + msecs;
-
-    debug('unrefList find where we can insert');
-
-    var cur, them;
-
-    for (cur = unrefList._idlePrev; cur != unrefList; cur = cur._idlePrev) {
-        them = cur._idleStart + cur._idleTimeout;
-
-        if (when < them) {
-            debug('unrefList inserting into middle of list');
-
-            L.append(cur, item);
-
-            if (unrefTimer.when > when) {
-                debug('unrefTimer is scheduled to fire too late, reschedule');
-                unrefTimer.start(msecs, 0);
-                unrefTimer.when = when;
-            }
+    item._idleStart = Timer.now();
 
-            return;
-        }
+    if (item._unrefId >= 0) {
+        unrefWheel.refresh(item._unrefId, msecs);
+    } else {
+        item._unrefId = unrefWheel.add(msecs);
+        unrefItems[item._unrefId] = item;
     }
-
-    debug('unrefList append to end');
-    L.append(unrefList, item);
 };
@@ -100,15 +100,19 @@
         'src/node_main.cc',
         'src/node_os.cc',
         'src/node_script.cc',
+        'src/node_serializer.cc',
         'src/node_stat_watcher.cc',
         'src/node_watchdog.cc',
         'src/node_zlib.cc',
         'src/pipe_wrap.cc',
+        'src/ring_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/smalloc.cc',
         'src/string_bytes.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
+        'src/timer_wheel.cc',
         'src/timer_wrap.cc',
         'src/tty_wrap.cc',
         'src/process_wrap.cc',
@@ -126,11 +130,14 @@
         'src/node_os.h',
         'src/node_root_certs.h',
         'src/node_script.h',
+        'src/node_serializer.h',
         'src/node_version.h',
         'src/node_watchdog.h',
         'src/node_wrap.h',
         'src/pipe_wrap.h',
         'src/queue.h',
+        'src/slab_allocator.h',
+        'src/timer_wheel.h',
         'src/smalloc.h',
         'src/tty_wrap.h',
         'src/tcp_wrap.h',
@@ -21,17 +21,29 @@
 
 #include "node.h"
 #include "handle_wrap.h"
+#include "tree.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <errno.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace node {
 
+using v8::Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::Null;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -59,6 +71,62 @@ class FSEventWrap: public HandleWrap {
 };
 
 
+// A watched directory, `path` is relative to the root of the tree and empty
+// for the root itself.
+struct tree_dir {
+  RB_ENTRY(tree_dir) node;
+  int wd;
+  char* path;
+};
+
+// The events seen for a path since the last callback.
+struct tree_change {
+  RB_ENTRY(tree_change) node;
+  int events;
+  char* path;
+};
+
+RB_HEAD(tree_dir_list, tree_dir);
+RB_HEAD(tree_change_list, tree_change);
+
+
+// Recursive directory watcher. inotify watches single directories, so
+// FSTreeEventWrap keeps a watch for every directory of the tree on an inotify
+// instance of its own. It adds watches for directories that are created in
+// or moved into the tree and drops the ones that are moved out. The events
+// that are read in one go, i.e. in one loop iteration, are merged per path
+// and passed to JS in a single callback.
+class FSTreeEventWrap: public HandleWrap {
+ public:
+  static void Initialize(Handle<Object> target);
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Start(const FunctionCallbackInfo<Value>& args);
+  static void Close(const FunctionCallbackInfo<Value>& args);
+
+ private:
+  explicit FSTreeEventWrap(Handle<Object> object);
+  virtual ~FSTreeEventWrap();
+
+  void Release();
+  char* FullPath(const char* path);
+  void AddChange(const char* path, int events);
+  void Flush(int status);
+#if defined(__linux__)
+  int AddTree(const char* path, bool report);
+  void RemoveTree(const char* path);
+  int HandleEvent(const struct inotify_event* e);
+  static void OnPoll(uv_poll_t* handle, int status, int events);
+#endif
+
+  uv_poll_t handle_;
+  bool initialized_;
+  int fd_;
+  char* root_;
+  tree_dir_list dirs_;
+  tree_change_list changes_;
+};
+
+
 FSEventWrap::FSEventWrap(Handle<Object> object)
     : HandleWrap(object, reinterpret_cast<uv_handle_t*>(&handle_)) {
   initialized_ = false;
@@ -87,6 +155,8 @@ void FSEventWrap::Initialize(Handle<Object> target) {
   change_sym = String::New("change");
   onchange_sym = String::New("onchange");
   rename_sym = String::New("rename");
+
+  FSTreeEventWrap::Initialize(target);
 }
 
 
@@ -187,6 +257,390 @@ void FSEventWrap::Close(const FunctionCallbackInfo<Value>& args) {
   HandleWrap::Close(args);
 }
 
+
+static int cmp_tree_dirs(const tree_dir* a, const tree_dir* b) {
+  if (a->wd < b->wd) return -1;
+  if (a->wd > b->wd) return 1;
+  return 0;
+}
+
+
+static int cmp_tree_changes(const tree_change* a, const tree_change* b) {
+  return strcmp(a->path, b->path);
+}
+
+
+RB_GENERATE_STATIC(tree_dir_list, tree_dir, node, cmp_tree_dirs)
+RB_GENERATE_STATIC(tree_change_list, tree_change, node, cmp_tree_changes)
+
+
+// Joins two relative paths, either of which can be empty.
+static char* JoinPath(const char* dir, const char* name) {
+  size_t dir_len = strlen(dir);
+  size_t name_len = strlen(name);
+  char* path = static_cast<char*>(malloc(dir_len + name_len + 2));
+  if (path == NULL)
+    abort();
+  memcpy(path, dir, dir_len);
+  size_t len = dir_len;
+  if (dir_len > 0 && name_len > 0)
+    path[len++] = '/';
+  memcpy(path + len, name, name_len + 1);
+  return path;
+}
+
+
+FSTreeEventWrap::FSTreeEventWrap(Handle<Object> object)
+    : HandleWrap(object, reinterpret_cast<uv_handle_t*>(&handle_)),
+      initialized_(false),
+      fd_(-1),
+      root_(NULL) {
+  RB_INIT(&dirs_);
+  RB_INIT(&changes_);
+}
+
+
+FSTreeEventWrap::~FSTreeEventWrap() {
+  assert(initialized_ == false);
+  Release();
+}
+
+
+void FSTreeEventWrap::Initialize(Handle<Object> target) {
+  HandleScope scope(node_isolate);
+
+  Local<FunctionTemplate> t = FunctionTemplate::New(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(String::NewSymbol("FSTreeEvent"));
+
+  NODE_SET_PROTOTYPE_METHOD(t, "start", Start);
+  NODE_SET_PROTOTYPE_METHOD(t, "close", Close);
+
+  target->Set(String::New("FSTreeEvent"), t->GetFunction());
+}
+
+
+void FSTreeEventWrap::New(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+  assert(args.IsConstructCall());
+  new FSTreeEventWrap(args.This());
+}
+
+
+// Drops the watches and the pending changes.
+void FSTreeEventWrap::Release() {
+  while (!RB_EMPTY(&dirs_)) {
+    tree_dir* dir = RB_MIN(tree_dir_list, &dirs_);
+    RB_REMOVE(tree_dir_list, &dirs_, dir);
+    free(dir->path);
+    delete dir;
+  }
+  while (!RB_EMPTY(&changes_)) {
+    tree_change* change = RB_MIN(tree_change_list, &changes_);
+    RB_REMOVE(tree_change_list, &changes_, change);
+    free(change->path);
+    delete change;
+  }
+#if defined(__linux__)
+  if (fd_ != -1)
+    close(fd_);
+#endif
+  fd_ = -1;
+  free(root_);
+  root_ = NULL;
+}
+
+
+char* FSTreeEventWrap::FullPath(const char* path) {
+  return JoinPath(root_, path);
+}
+
+
+void FSTreeEventWrap::AddChange(const char* path, int events) {
+  tree_change lookup;
+  lookup.path = const_cast<char*>(path);
+  tree_change* change = RB_FIND(tree_change_list, &changes_, &lookup);
+  if (change != NULL) {
+    change->events |= events;
+    return;
+  }
+  change = new tree_change;
+  change->events = events;
+  change->path = JoinPath(path, "");
+  RB_INSERT(tree_change_list, &changes_, change);
+}
+
+
+// Calls onchange(status, changes) where changes is a flat array of event
+// names and file names. The file name of a change to the root itself, or of
+// events that the kernel dropped, is null.
+void FSTreeEventWrap::Flush(int status) {
+  if (RB_EMPTY(&changes_) && status == 0)
+    return;
+
+  HandleScope scope(node_isolate);
+  Local<Array> list = Array::New();
+  uint32_t i = 0;
+
+  while (!RB_EMPTY(&changes_)) {
+    tree_change* change = RB_MIN(tree_change_list, &changes_);
+    RB_REMOVE(tree_change_list, &changes_, change);
+    // Same as FSEventWrap::OnEvent(), a rename wins over a change.
+    if (change->events & UV_RENAME)
+      list->Set(i++, rename_sym);
+    else
+      list->Set(i++, change_sym);
+    if (change->path[0] == '\0')
+      list->Set(i++, Null(node_isolate));
+    else
+      list->Set(i++, String::New(change->path));
+    free(change->path);
+    delete change;
+  }
+
+  Local<Value> argv[2] = {
+    Integer::New(status, node_isolate),
+    list
+  };
+  MakeCallback(object(), onchange_sym, ARRAY_SIZE(argv), argv);
+}
+
+
+#if defined(__linux__)
+
+static const uint32_t kTreeEvents = IN_ATTRIB
+                                  | IN_CREATE
+                                  | IN_MODIFY
+                                  | IN_DELETE
+                                  | IN_DELETE_SELF
+                                  | IN_MOVE_SELF
+                                  | IN_MOVED_FROM
+                                  | IN_MOVED_TO
+                                  | IN_DONT_FOLLOW
+                                  | IN_ONLYDIR;
+
+
+// Watches the directory `path` and everything below it. Directories that
+// show up while the tree is being watched are reported with their contents
+// because inotify didn't see those get created. Subdirectories that can't be
+// read are skipped, but running out of watches is an error.
+int FSTreeEventWrap::AddTree(const char* path, bool report) {
+  char* full = FullPath(path);
+  int wd = inotify_add_watch(fd_, full, kTreeEvents);
+  if (wd == -1) {
+    int err = -errno;
+    free(full);
+    return err;
+  }
+
+  tree_dir lookup;
+  lookup.wd = wd;
+  tree_dir* dir = RB_FIND(tree_dir_list, &dirs_, &lookup);
+  if (dir == NULL) {
+    dir = new tree_dir;
+    dir->wd = wd;
+    RB_INSERT(tree_dir_list, &dirs_, dir);
+  } else {
+    free(dir->path);
+  }
+  dir->path = JoinPath(path, "");
+
+  int err = 0;
+  DIR* d = opendir(full);
+  if (d != NULL) {
+    struct dirent* ent;
+    while (err == 0 && (ent = readdir(d)) != NULL) {  // NOLINT
+      if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+        continue;
+
+      char* child = JoinPath(path, ent->d_name);
+      if (report)
+        AddChange(child, UV_RENAME);
+
+      bool is_dir = ent->d_type == DT_DIR;
+      if (ent->d_type == DT_UNKNOWN) {
+        char* child_full = FullPath(child);
+        struct stat s;
+        is_dir = lstat(child_full, &s) == 0 && S_ISDIR(s.st_mode);
+        free(child_full);
+      }
+
+      if (is_dir) {
+        err = AddTree(child, report);
+        if (err != UV_ENOSPC)
+          err = 0;
+      }
+      free(child);
+    }
+    closedir(d);
+  }
+
+  free(full);
+  return err;
+}
+
+
+// Drops the watches of `path` and everything below it.
+void FSTreeEventWrap::RemoveTree(const char* path) {
+  size_t len = strlen(path);
+  tree_dir* dir = RB_MIN(tree_dir_list, &dirs_);
+  while (dir != NULL) {
+    tree_dir* next = RB_NEXT(tree_dir_list, &dirs_, dir);
+    if (strncmp(dir->path, path, len) == 0 &&
+        (dir->path[len] == '\0' || dir->path[len] == '/')) {
+      inotify_rm_watch(fd_, dir->wd);
+      RB_REMOVE(tree_dir_list, &dirs_, dir);
+      free(dir->path);
+      delete dir;
+    }
+    dir = next;
+  }
+}
+
+
+int FSTreeEventWrap::HandleEvent(const struct inotify_event* e) {
+  if (e->mask & IN_Q_OVERFLOW) {
+    AddChange("", UV_RENAME);
+    return 0;
+  }
+
+  tree_dir lookup;
+  lookup.wd = e->wd;
+  tree_dir* dir = RB_FIND(tree_dir_list, &dirs_, &lookup);
+  if (dir == NULL)
+    return 0;  // Stale event, the watch has been dropped.
+
+  if (e->mask & IN_IGNORED) {
+    RB_REMOVE(tree_dir_list, &dirs_, dir);
+    free(dir->path);
+    delete dir;
+    return 0;
+  }
+
+  int events = 0;
+  if (e->mask & (IN_ATTRIB | IN_MODIFY))
+    events |= UV_CHANGE;
+  if (e->mask & ~(IN_ATTRIB | IN_MODIFY | IN_ISDIR))
+    events |= UV_RENAME;
+
+  // Events for a directory itself are reported by its parent as well,
+  // except for the root.
+  if (e->len == 0) {
+    if (dir->path[0] == '\0')
+      AddChange("", events);
+    return 0;
+  }
+
+  int err = 0;
+  char* path = JoinPath(dir->path, e->name);
+  AddChange(path, events);
+  if (e->mask & IN_ISDIR) {
+    if (e->mask & (IN_CREATE | IN_MOVED_TO))
+      err = AddTree(path, true);
+    else if (e->mask & IN_MOVED_FROM)
+      RemoveTree(path);
+  }
+  free(path);
+
+  // The directory may be gone again already.
+  return err == UV_ENOSPC ? err : 0;
+}
+
+
+void FSTreeEventWrap::OnPoll(uv_poll_t* handle, int status, int events) {
+  FSTreeEventWrap* wrap = static_cast<FSTreeEventWrap*>(handle->data);
+  assert(wrap->persistent().IsEmpty() == false);
+
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+  while (status == 0) {
+    ssize_t size;
+    do
+      size = read(wrap->fd_, buf, sizeof(buf));
+    while (size == -1 && errno == EINTR);
+
+    if (size == -1) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        status = -errno;
+      break;
+    }
+
+    const char* p = buf;
+    while (p < buf + size && status == 0) {
+      const struct inotify_event* e =
+          reinterpret_cast<const struct inotify_event*>(p);
+      status = wrap->HandleEvent(e);
+      p += sizeof(*e) + e->len;
+    }
+  }
+
+  wrap->Flush(status);
+}
+
+#endif  // defined(__linux__)
+
+
+// start(path, persistent) watches the directory `path` and everything below
+// it.
+void FSTreeEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(FSTreeEventWrap)
+
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    return ThrowTypeError("Bad arguments");
+  }
+
+#if defined(__linux__)
+  String::Utf8Value path(args[0]);
+
+  int err = 0;
+  wrap->fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (wrap->fd_ == -1)
+    err = -errno;
+
+  if (err == 0) {
+    wrap->root_ = JoinPath(*path, "");
+    size_t len = strlen(wrap->root_);
+    while (len > 1 && wrap->root_[len - 1] == '/')
+      wrap->root_[--len] = '\0';
+    err = wrap->AddTree("", false);
+  }
+
+  if (err == 0)
+    err = uv_poll_init(uv_default_loop(), &wrap->handle_, wrap->fd_);
+
+  if (err == 0) {
+    wrap->initialized_ = true;
+    if (!args[1]->IsTrue())
+      uv_unref(reinterpret_cast<uv_handle_t*>(&wrap->handle_));
+    err = uv_poll_start(&wrap->handle_, UV_READABLE, OnPoll);
+  } else {
+    wrap->Release();
+  }
+
+  args.GetReturnValue().Set(err);
+#else
+  args.GetReturnValue().Set(UV_ENOSYS);
+#endif
+}
+
+
+void FSTreeEventWrap::Close(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  // Unwrap manually, see FSEventWrap::Close().
+  assert(!args.This().IsEmpty());
+  assert(args.This()->InternalFieldCount() > 0);
+  void* ptr = args.This()->GetAlignedPointerFromInternalField(0);
+  FSTreeEventWrap* wrap = static_cast<FSTreeEventWrap*>(ptr);
+
+  if (wrap == NULL || wrap->initialized_ == false) return;
+  wrap->initialized_ = false;
+
+  HandleWrap::Close(args);
+}
+
 }  // namespace node
 
 NODE_MODULE(node_fs_event_wrap, node::FSEventWrap::Initialize)
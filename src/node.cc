@@ -183,6 +183,22 @@ static struct {
   uint32_t last_threw;
 } tick_infobox;
 
+// Callbacks made with MakeBatchedCallback() share a single pass over the
+// nextTick queue. The batch ends with the next regular callback or in the
+// check phase, whichever comes first.
+static uv_check_t callback_batch_watcher;
+static uint32_t callback_batch_size;
+static bool in_batched_callback;
+static bool ticks_deferred;
+
+// for quick ref to callback batch stats
+static struct {
+  uint32_t batches;
+  uint32_t callbacks;
+  uint32_t last_size;
+  uint32_t max_size;
+} batch_infobox;
+
 #ifdef OPENSSL_NPN_NEGOTIATED
 static bool use_npn = true;
 #else
@@ -913,6 +929,48 @@ void SetupDomainUse(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static void EndCallbackBatch() {
+  uint32_t size = callback_batch_size;
+
+  callback_batch_size = 0;
+  uv_check_stop(&callback_batch_watcher);
+
+  batch_infobox.batches++;
+  batch_infobox.callbacks += size;
+  batch_infobox.last_size = size;
+  if (size > batch_infobox.max_size)
+    batch_infobox.max_size = size;
+
+  if (!ticks_deferred)
+    return;
+  ticks_deferred = false;
+
+  if (tick_infobox.in_tick == 1)
+    return;
+
+  if (tick_infobox.length == 0) {
+    tick_infobox.index = 0;
+    return;
+  }
+
+  HandleScope scope(node_isolate);
+  TryCatch try_catch;
+  try_catch.SetVerbose(true);
+
+  // process nextTicks for the whole batch
+  Local<Object> process = PersistentToLocal(process_p);
+  Local<Function> fn = PersistentToLocal(process_tickCallback);
+  fn->Call(process, 0, NULL);
+}
+
+
+static void CallbackBatchCheck(uv_check_t* handle, int status) {
+  assert(handle == &callback_batch_watcher);
+  assert(status == 0);
+  EndCallbackBatch();
+}
+
+
 Handle<Value>
 MakeDomainCallback(const Handle<Object> object,
                    const Handle<Function> callback,
@@ -920,6 +978,9 @@ MakeDomainCallback(const Handle<Object> object,
                    Handle<Value> argv[]) {
   // TODO(trevnorris) Hook for long stack traces to be made here.
 
+  if (callback_batch_size > 0 && !in_batched_callback)
+    EndCallbackBatch();
+
   // lazy load domain specific symbols
   if (enter_symbol.IsEmpty()) {
     enter_symbol = String::New("enter");
@@ -982,6 +1043,11 @@ MakeDomainCallback(const Handle<Object> object,
     return ret;
   }
 
+  if (in_batched_callback) {
+    ticks_deferred = true;
+    return ret;
+  }
+
   // process nextTicks after call
   Local<Object> process = PersistentToLocal(process_p);
   Local<Function> fn = PersistentToLocal(process_tickCallback);
@@ -1006,6 +1072,9 @@ MakeCallback(const Handle<Object> object,
   if (using_domains)
     return MakeDomainCallback(object, callback, argc, argv);
 
+  if (callback_batch_size > 0 && !in_batched_callback)
+    EndCallbackBatch();
+
   // lazy load no domain next tick callbacks
   if (process_tickCallback.IsEmpty()) {
     Local<Value> cb_v = process->Get(String::New("_tickCallback"));
@@ -1034,6 +1103,11 @@ MakeCallback(const Handle<Object> object,
     return ret;
   }
 
+  if (in_batched_callback) {
+    ticks_deferred = true;
+    return ret;
+  }
+
   // process nextTicks after call
   Local<Function> fn = PersistentToLocal(process_tickCallback);
   fn->Call(process, 0, NULL);
@@ -1076,6 +1150,25 @@ MakeCallback(const Handle<Object> object,
 }
 
 
+Handle<Value>
+MakeBatchedCallback(const Handle<Object> object,
+                    const Handle<String> symbol,
+                    int argc,
+                    Handle<Value> argv[]) {
+  HandleScope scope(node_isolate);
+
+  if (callback_batch_size++ == 0)
+    uv_check_start(&callback_batch_watcher, CallbackBatchCheck);
+
+  bool was_batched = in_batched_callback;
+  in_batched_callback = true;
+  Handle<Value> ret = MakeCallback(object, symbol, argc, argv);
+  in_batched_callback = was_batched;
+
+  return scope.Close(ret);
+}
+
+
 enum encoding ParseEncoding(Handle<Value> encoding_v, enum encoding _default) {
   HandleScope scope(node_isolate);
 
@@ -2400,6 +2493,12 @@ Handle<Object> SetupProcessObject(int argc, char *argv[]) {
   info_box->SetIndexedPropertiesToExternalArrayData(&tick_infobox, kExternalUnsignedIntArray, 4);
   process->Set(String::NewSymbol("_tickInfoBox"), info_box);
 
+  // callback batch stats: [batches, callbacks, lastSize, maxSize]
+  Local<Object> batch_info_box = Object::New();
+  batch_info_box->SetIndexedPropertiesToExternalArrayData(
+      &batch_infobox, kExternalUnsignedIntArray, 4);
+  process->Set(String::NewSymbol("_batchInfoBox"), batch_info_box);
+
   // pre-set _events object for faster emit checks
   process->Set(String::NewSymbol("_events"), Object::New());
 
@@ -2540,6 +2639,8 @@ static void PrintHelp() {
          "NODE_MODULE_CONTEXTS   Set to 1 to load modules in their own\n"
          "                       global contexts.\n"
          "NODE_DISABLE_COLORS    Set to 1 to disable colors in the REPL\n"
+         "NODE_SIMD              Set to ssse3 or none to limit the vector\n"
+         "                       instructions used to encode strings.\n"
          "\n"
          "Documentation can be found at http://nodejs.org/\n");
 }
@@ -2950,6 +3051,9 @@ char** Init(int argc, char *argv[]) {
   uv_unref(reinterpret_cast<uv_handle_t*>(&check_immediate_watcher));
   uv_idle_init(uv_default_loop(), &idle_immediate_dummy);
 
+  uv_check_init(uv_default_loop(), &callback_batch_watcher);
+  uv_unref(reinterpret_cast<uv_handle_t*>(&callback_batch_watcher));
+
   V8::SetFatalErrorHandler(node::OnFatalError);
   V8::AddMessageListener(OnMessage);
 
@@ -703,8 +703,11 @@
             var fd = parseInt(process.env.NODE_CHANNEL_FD, 10);
             assert(fd >= 0);
 
+            var serialization = process.env.NODE_CHANNEL_SERIALIZATION_MODE;
+
             // Make sure it's not accidentally inherited by child processes.
             delete process.env.NODE_CHANNEL_FD;
+            delete process.env.NODE_CHANNEL_SERIALIZATION_MODE;
 
             var cp = NativeModule.require('child_process');
 
@@ -713,7 +716,7 @@
             // FIXME is this really necessary?
             process.binding('tcp_wrap');
 
-            cp._forkChild(fd);
+            cp._forkChild(fd, serialization);
             assert(process.send);
         }
     }
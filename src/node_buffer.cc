@@ -70,6 +70,7 @@ using v8::Undefined;
 using v8::Value;
 
 static Persistent<Function> p_buffer_fn;
+static Cached<String> parent_sym;
 
 
 bool HasInstance(Handle<Value> val) {
@@ -228,6 +229,36 @@ Local<Object> Use(char* data, uint32_t length) {
 }
 
 
+Local<Object> Slice(Handle<Object> parent, size_t start, size_t end) {
+  HandleScope scope(node_isolate);
+
+  assert(parent->HasIndexedPropertiesInExternalArrayData());
+  assert(start <= end);
+  assert(end <= static_cast<size_t>(
+      parent->GetIndexedPropertiesExternalArrayDataLength()));
+
+  size_t length = end - start;
+
+  Handle<Value> argv[2];
+  // this is safe b/c Undefined and length fits in an SMI, so there's no risk
+  // of GC reclaiming the values prematurely.
+  argv[0] = Undefined(node_isolate);
+  argv[1] = Uint32::New(length, node_isolate);
+  Local<Object> obj = NewInstance(p_buffer_fn, ARRAY_SIZE(argv), argv);
+
+  char* data = static_cast<char*>(
+      parent->GetIndexedPropertiesExternalArrayData());
+  obj->SetIndexedPropertiesToExternalArrayData(data + start,
+                                               v8::kExternalUnsignedByteArray,
+                                               length);
+  // mirrors what lib/buffer.js does for pooled buffers
+  if (length > 0)
+    obj->Set(parent_sym, parent);
+
+  return scope.Close(obj);
+}
+
+
 template <encoding encoding>
 void StringSlice(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(node_isolate);
@@ -559,6 +590,7 @@ void SetupBufferJS(const FunctionCallbackInfo<Value>& args) {
 
   Local<Function> bv = args[0].As<Function>();
   p_buffer_fn.Reset(node_isolate, bv);
+  parent_sym = String::New("parent");
   Local<Value> proto_v = bv->Get(String::New("prototype"));
 
   assert(proto_v->IsObject());
@@ -56,6 +56,12 @@ NODE_EXTERN v8::Local<v8::Object> New(char* data,
 // TODO(trevnorris): should be New() for consistency
 NODE_EXTERN v8::Local<v8::Object> Use(char* data, uint32_t len);
 
+// public constructor - returns a Buffer that views |parent|'s external data
+// from |start| to |end|. |parent| is kept alive for as long as the slice is.
+NODE_EXTERN v8::Local<v8::Object> Slice(v8::Handle<v8::Object> parent,
+                                        size_t start,
+                                        size_t end);
+
 }  // namespace Buffer
 }  // namespace node
 
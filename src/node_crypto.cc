@@ -2320,6 +2320,92 @@ void CipherBase::Final(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+struct HashUpdateRequest {
+  ~HashUpdateRequest();
+  Persistent<Object> obj_;
+  uv_work_t work_req_;
+  void* hash_;
+  uv_buf_t* bufs_;
+  uint32_t count_;
+  bool ok_;
+};
+
+
+HashUpdateRequest::~HashUpdateRequest() {
+  obj_.Dispose();
+  delete[] bufs_;
+}
+
+
+template <class T, bool (T::*Update)(const char* data, int len)>
+void HashUpdateWork(uv_work_t* work_req) {
+  HashUpdateRequest* req = container_of(work_req,
+                                        HashUpdateRequest,
+                                        work_req_);
+  T* hash = static_cast<T*>(req->hash_);
+
+  req->ok_ = true;
+  for (uint32_t i = 0; i < req->count_ && req->ok_; i++)
+    req->ok_ = (hash->*Update)(req->bufs_[i].base, req->bufs_[i].len);
+}
+
+
+void HashUpdateAfter(uv_work_t* work_req, int status) {
+  assert(status == 0);
+  HashUpdateRequest* req = container_of(work_req,
+                                        HashUpdateRequest,
+                                        work_req_);
+  HandleScope scope(node_isolate);
+  Local<Value> arg = Null(node_isolate);
+  if (!req->ok_)
+    arg = Exception::TypeError(String::New("HashUpdate fail"));
+  MakeCallback(req->obj_, "ondone", 1, &arg);
+  delete req;
+}
+
+
+// updateAsync(buffers, callback) feeds an array of buffers into a Hash or
+// Hmac on the threadpool. The JS side doesn't touch the object until the
+// callback has run, the buffers are kept alive by the request object.
+template <class T, bool (T::*Update)(const char* data, int len)>
+void HashUpdateAsync(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  if (!args[0]->IsArray() || !args[1]->IsFunction())
+    return ThrowTypeError("Must give an array of buffers and a callback");
+
+  Local<Array> buffers = args[0].As<Array>();
+  uint32_t count = buffers->Length();
+  uv_buf_t* bufs = new uv_buf_t[count];
+
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> buf = buffers->Get(i);
+    if (!Buffer::HasInstance(buf)) {
+      delete[] bufs;
+      return ThrowTypeError("Not a buffer");
+    }
+    bufs[i] = uv_buf_init(Buffer::Data(buf), Buffer::Length(buf));
+  }
+
+  Local<Object> obj = Object::New();
+  obj->Set(String::New("ondone"), args[1]);
+  obj->Set(String::New("buffers"), buffers);
+  obj->Set(String::New("hash"), args.This());
+
+  HashUpdateRequest* req = new HashUpdateRequest();
+  req->obj_.Reset(node_isolate, obj);
+  req->hash_ = ObjectWrap::Unwrap<T>(args.This());
+  req->bufs_ = bufs;
+  req->count_ = count;
+  req->ok_ = false;
+
+  uv_queue_work(uv_default_loop(),
+                &req->work_req_,
+                HashUpdateWork<T, Update>,
+                HashUpdateAfter);
+}
+
+
 void Hmac::Initialize(v8::Handle<v8::Object> target) {
   HandleScope scope(node_isolate);
 
@@ -2329,6 +2415,9 @@ void Hmac::Initialize(v8::Handle<v8::Object> target) {
 
   NODE_SET_PROTOTYPE_METHOD(t, "init", HmacInit);
   NODE_SET_PROTOTYPE_METHOD(t, "update", HmacUpdate);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "updateAsync",
+                            HashUpdateAsync<Hmac, &Hmac::HmacUpdate>);
   NODE_SET_PROTOTYPE_METHOD(t, "digest", HmacDigest);
 
   target->Set(String::NewSymbol("Hmac"), t->GetFunction());
@@ -2452,6 +2541,113 @@ void Hmac::HmacDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// hmacBatch(algorithm, keys, messages, encoding) computes the HMAC of every
+// message in one call and returns an array of digests. keys is either one
+// key for all messages or an array with one key per message. The HMAC
+// context is reused, and with a single key the key setup is done only once.
+void HmacBatch(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  if (!args[0]->IsString() || !args[2]->IsArray())
+    return ThrowTypeError("Must give hashtype string, keys and messages");
+
+  const String::Utf8Value hash_type(args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*hash_type);
+  if (md == NULL)
+    return ThrowError("Unknown message digest");
+
+  Local<Array> messages = args[2].As<Array>();
+  uint32_t count = messages->Length();
+
+  Local<Array> keys;
+  bool single_key = Buffer::HasInstance(args[1]);
+  if (!single_key) {
+    if (!args[1]->IsArray() || args[1].As<Array>()->Length() != count)
+      return ThrowTypeError("Must give one key or one key per message");
+    keys = args[1].As<Array>();
+  }
+
+  enum encoding encoding = ParseEncoding(args[3], BUFFER);
+  unsigned int md_size = EVP_MD_size(md);
+
+  // With a buffer result all digests share one allocation
+  Local<Object> pool;
+  if (encoding == BUFFER)
+    pool = Buffer::New(count * md_size);
+
+  // Scratch space for messages passed as strings
+  char stack_buf[1024];
+  char* buf = stack_buf;
+  size_t buf_size = sizeof(stack_buf);
+
+  HMAC_CTX ctx;
+  HMAC_CTX_init(&ctx);
+
+  Local<Array> digests = Array::New(count);
+  for (uint32_t i = 0; i < count; i++) {
+    if (i == 0 || !single_key) {
+      Local<Value> key = single_key ? args[1] : keys->Get(i);
+      if (!Buffer::HasInstance(key)) {
+        HMAC_CTX_cleanup(&ctx);
+        if (buf != stack_buf)
+          delete[] buf;
+        return ThrowTypeError("Not a buffer");
+      }
+      // A NULL key means "keep the old one", pass "" for empty keys
+      if (Buffer::Length(key) == 0)
+        HMAC_Init_ex(&ctx, "", 0, md, NULL);
+      else
+        HMAC_Init_ex(&ctx, Buffer::Data(key), Buffer::Length(key), md, NULL);
+    } else {
+      // Same key, start over from the precomputed pads
+      HMAC_Init_ex(&ctx, NULL, 0, NULL, NULL);
+    }
+
+    Local<Value> message = messages->Get(i);
+    if (Buffer::HasInstance(message)) {
+      HMAC_Update(&ctx,
+                  reinterpret_cast<unsigned char*>(Buffer::Data(message)),
+                  Buffer::Length(message));
+    } else if (message->IsString()) {
+      Local<String> string = message.As<String>();
+      size_t size = StringBytes::StorageSize(string, BINARY);
+      if (size > buf_size) {
+        if (buf != stack_buf)
+          delete[] buf;
+        buf = new char[size];
+        buf_size = size;
+      }
+      size_t written = StringBytes::Write(buf, buf_size, string, BINARY);
+      HMAC_Update(&ctx, reinterpret_cast<unsigned char*>(buf), written);
+    } else {
+      HMAC_CTX_cleanup(&ctx);
+      if (buf != stack_buf)
+        delete[] buf;
+      return ThrowTypeError("Not a string or buffer");
+    }
+
+    unsigned char md_value[EVP_MAX_MD_SIZE];
+    unsigned int md_len;
+    HMAC_Final(&ctx, md_value, &md_len);
+    assert(md_len == md_size);
+
+    if (encoding == BUFFER) {
+      memcpy(Buffer::Data(pool) + i * md_size, md_value, md_len);
+      digests->Set(i, Buffer::Slice(pool, i * md_size, (i + 1) * md_size));
+    } else {
+      digests->Set(i, StringBytes::Encode(
+          reinterpret_cast<const char*>(md_value), md_len, encoding));
+    }
+  }
+
+  HMAC_CTX_cleanup(&ctx);
+  if (buf != stack_buf)
+    delete[] buf;
+
+  args.GetReturnValue().Set(digests);
+}
+
+
 void Hash::Initialize(v8::Handle<v8::Object> target) {
   HandleScope scope(node_isolate);
 
@@ -2460,6 +2656,9 @@ void Hash::Initialize(v8::Handle<v8::Object> target) {
   t->InstanceTemplate()->SetInternalFieldCount(1);
 
   NODE_SET_PROTOTYPE_METHOD(t, "update", HashUpdate);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "updateAsync",
+                            HashUpdateAsync<Hash, &Hash::HashUpdate>);
   NODE_SET_PROTOTYPE_METHOD(t, "digest", HashDigest);
 
   target->Set(String::NewSymbol("Hash"), t->GetFunction());
@@ -3623,6 +3822,7 @@ void InitCrypto(Handle<Object> target) {
   Sign::Initialize(target);
   Verify::Initialize(target);
 
+  NODE_SET_METHOD(target, "hmacBatch", HmacBatch);
   NODE_SET_METHOD(target, "PBKDF2", PBKDF2);
   NODE_SET_METHOD(target, "randomBytes", RandomBytes<false>);
   NODE_SET_METHOD(target, "pseudoRandomBytes", RandomBytes<true>);
@@ -337,9 +337,10 @@ class Hmac : public ObjectWrap {
  public:
   static void Initialize(v8::Handle<v8::Object> target);
 
+  bool HmacUpdate(const char* data, int len);
+
  protected:
   void HmacInit(const char* hash_type, const char* key, int key_len);
-  bool HmacUpdate(const char* data, int len);
   bool HmacDigest(unsigned char** md_value, unsigned int* md_len);
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -38,6 +38,52 @@ BIO_METHOD NodeBIO::method_ = {
   NULL
 };
 
+uv_once_t NodeBIO::pool_once_ = UV_ONCE_INIT;
+uv_mutex_t NodeBIO::pool_mutex_;
+NodeBIO::Buffer* NodeBIO::pool_head_ = NULL;
+size_t NodeBIO::pool_size_ = 0;
+
+
+void NodeBIO::InitPool() {
+  if (uv_mutex_init(&pool_mutex_))
+    abort();
+}
+
+
+NodeBIO::Buffer* NodeBIO::AllocBuffer() {
+  uv_once(&pool_once_, InitPool);
+
+  uv_mutex_lock(&pool_mutex_);
+  Buffer* buffer = pool_head_;
+  if (buffer != NULL) {
+    pool_head_ = buffer->next_;
+    pool_size_--;
+  }
+  uv_mutex_unlock(&pool_mutex_);
+
+  if (buffer == NULL)
+    return new Buffer();
+
+  buffer->read_pos_ = 0;
+  buffer->write_pos_ = 0;
+  buffer->next_ = NULL;
+  return buffer;
+}
+
+
+void NodeBIO::FreeBuffer(Buffer* buffer) {
+  uv_mutex_lock(&pool_mutex_);
+  if (pool_size_ < kMaxPooledBuffers) {
+    buffer->next_ = pool_head_;
+    pool_head_ = buffer;
+    pool_size_++;
+    buffer = NULL;
+  }
+  uv_mutex_unlock(&pool_mutex_);
+
+  delete buffer;
+}
+
 
 int NodeBIO::New(BIO* bio) {
   bio->ptr = new NodeBIO();
@@ -83,6 +129,11 @@ int NodeBIO::Read(BIO* bio, char* out, int len) {
 
 
 char* NodeBIO::Peek(size_t* size) {
+  if (read_head_ == NULL) {
+    *size = 0;
+    return NULL;
+  }
+
   *size = read_head_->write_pos_ - read_head_->read_pos_;
   return read_head_->data_ + read_head_->read_pos_;
 }
@@ -217,6 +268,12 @@ size_t NodeBIO::Read(char* out, size_t size) {
   assert(expected == bytes_read);
   length_ -= bytes_read;
 
+  // Give everything back when drained, idle connections don't need buffers
+  if (length_ == 0) {
+    Reset();
+    return bytes_read;
+  }
+
   // Free all empty buffers, but write_head's child
   FreeEmpty();
 
@@ -233,17 +290,12 @@ void NodeBIO::FreeEmpty() {
     return;
 
   while (cur != read_head_) {
-    // Skip embedded buffer
-    if (cur == &head_) {
-      cur = head_.next_;
-      continue;
-    }
     assert(cur != write_head_);
     assert(cur->write_pos_ == cur->read_pos_);
 
     Buffer* next = cur->next_;
     child->next_ = next;
-    delete cur;
+    FreeBuffer(cur);
 
     cur = next;
   }
@@ -294,6 +346,9 @@ void NodeBIO::Write(const char* data, size_t size) {
   size_t offset = 0;
   size_t left = size;
   while (left > 0) {
+    if (write_head_ == NULL)
+      TryAllocateForWrite();
+
     size_t to_write = left;
     assert(write_head_->write_pos_ <= kBufferLength);
     size_t avail = kBufferLength - write_head_->write_pos_;
@@ -325,6 +380,9 @@ void NodeBIO::Write(const char* data, size_t size) {
 
 
 char* NodeBIO::PeekWritable(size_t* size) {
+  if (write_head_ == NULL)
+    TryAllocateForWrite();
+
   size_t available = kBufferLength - write_head_->write_pos_;
   if (*size != 0 && available > *size)
     available = *size;
@@ -340,6 +398,12 @@ void NodeBIO::Commit(size_t size) {
   length_ += size;
   assert(write_head_->write_pos_ <= kBufferLength);
 
+  // Nothing was written into the reserved space after all
+  if (length_ == 0) {
+    Reset();
+    return;
+  }
+
   // Allocate new buffer if write head is full,
   // and there're no other place to go
   TryAllocateForWrite();
@@ -349,11 +413,19 @@ void NodeBIO::Commit(size_t size) {
 
 
 void NodeBIO::TryAllocateForWrite() {
+  if (write_head_ == NULL) {
+    Buffer* buffer = AllocBuffer();
+    buffer->next_ = buffer;
+    read_head_ = buffer;
+    write_head_ = buffer;
+    return;
+  }
+
   // If write head is full, next buffer is either read head or not empty.
   if (write_head_->write_pos_ == kBufferLength &&
       (write_head_->next_ == read_head_ ||
        write_head_->next_->write_pos_ != 0)) {
-    Buffer* next = new Buffer();
+    Buffer* next = AllocBuffer();
     next->next_ = write_head_->next_;
     write_head_->next_ = next;
   }
@@ -361,30 +433,25 @@ void NodeBIO::TryAllocateForWrite() {
 
 
 void NodeBIO::Reset() {
-  while (read_head_->read_pos_ != read_head_->write_pos_) {
-    assert(read_head_->write_pos_ > read_head_->read_pos_);
-
-    length_ -= read_head_->write_pos_ - read_head_->read_pos_;
-    read_head_->write_pos_ = 0;
-    read_head_->read_pos_ = 0;
-
-    read_head_ = read_head_->next_;
-  }
-  write_head_ = read_head_;
-  assert(length_ == 0);
-}
-
+  length_ = 0;
+  if (write_head_ == NULL)
+    return;
 
-NodeBIO::~NodeBIO() {
-  Buffer* current = head_.next_;
-  while (current != &head_) {
+  Buffer* current = write_head_->next_;
+  while (current != write_head_) {
     Buffer* next = current->next_;
-    delete current;
+    FreeBuffer(current);
     current = next;
   }
+  FreeBuffer(write_head_);
 
   read_head_ = NULL;
   write_head_ = NULL;
 }
 
+
+NodeBIO::~NodeBIO() {
+  Reset();
+}
+
 }  // namespace node
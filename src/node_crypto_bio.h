@@ -23,6 +23,7 @@
 #define SRC_NODE_CRYPTO_BIO_H_
 
 #include "openssl/bio.h"
+#include "uv.h"
 #include <assert.h>
 
 namespace node {
@@ -33,9 +34,9 @@ class NodeBIO {
     return &method_;
   }
 
-  NodeBIO() : length_(0), read_head_(&head_), write_head_(&head_) {
-    // Loop head
-    head_.next_ = &head_;
+  // Starts out without any buffers, they're taken from a process-wide pool
+  // on the first write and returned once the BIO is drained.
+  NodeBIO() : length_(0), read_head_(NULL), write_head_(NULL) {
   }
 
   ~NodeBIO();
@@ -66,7 +67,7 @@ class NodeBIO {
   // wasn't found.
   size_t IndexOf(char delim, size_t limit);
 
-  // Discard all available data
+  // Discard all available data and return the buffers to the pool
   void Reset();
 
   // Put `len` bytes from `data` into buffer
@@ -105,12 +106,25 @@ class NodeBIO {
     char data_[kBufferLength];
   };
 
+  // Keep at most this many free buffers around, ~4 MB
+  static const size_t kMaxPooledBuffers = 256;
+
+  static Buffer* AllocBuffer();
+  static void FreeBuffer(Buffer* buffer);
+  static void InitPool();
+
   size_t length_;
-  Buffer head_;
   Buffer* read_head_;
   Buffer* write_head_;
 
   static BIO_METHOD method_;
+
+  // Buffers are allocated and freed from the threadpool too, see
+  // TLSCallbacks::EncryptWork()
+  static uv_once_t pool_once_;
+  static uv_mutex_t pool_mutex_;
+  static Buffer* pool_head_;
+  static size_t pool_size_;
 };
 
 }  // namespace node
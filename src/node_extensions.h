@@ -38,6 +38,7 @@
     ITEM(node_fs)                                                             \
     ITEM(node_http_parser)                                                    \
     ITEM(node_os)                                                             \
+    ITEM(node_serializer)                                                     \
     ITEM(node_smalloc)                                                        \
     ITEM(node_zlib)                                                           \
                                                                               \
@@ -51,6 +52,7 @@
     ITEM(node_process_wrap)                                                   \
     ITEM(node_fs_event_wrap)                                                  \
     ITEM(node_signal_wrap)                                                    \
+    ITEM(node_ring_wrap)                                                      \
                                                                               \
     END                                                                       \
 
@@ -37,11 +37,14 @@
 
 #if defined(__MINGW32__) || defined(_MSC_VER)
 # include <io.h>
+#else
+# include <unistd.h>
 #endif
 
 namespace node {
 
 using v8::Array;
+using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -177,6 +180,11 @@ static void After(uv_fs_t *req) {
         argv[1] = Integer::New(req->result, node_isolate);
         break;
 
+      case UV_FS_READV:
+      case UV_FS_WRITEV:
+        argv[1] = Number::New(req->result);
+        break;
+
       case UV_FS_READDIR:
         {
           char *namebuf = static_cast<char*>(req->ptr);
@@ -208,7 +216,7 @@ static void After(uv_fs_t *req) {
   if (oncomplete_sym.IsEmpty()) {
     oncomplete_sym = String::New("oncomplete");
   }
-  MakeCallback(req_wrap->object(), oncomplete_sym, argc, argv);
+  MakeBatchedCallback(req_wrap->object(), oncomplete_sym, argc, argv);
 
   uv_fs_req_cleanup(&req_wrap->req_);
   delete req_wrap;
@@ -766,6 +774,78 @@ static void WriteString(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// writeBuffers(fd, buffers, position, callback)
+// readBuffers(fd, buffers, position, callback)
+//
+// Vectored versions of writeBuffer() and read(): one request for a whole
+// array of buffers. The result is the total number of bytes, a short count
+// means that the file ended or the disk is full. The caller keeps the
+// buffers alive until the callback has run.
+static void ReadWriteBuffers(const FunctionCallbackInfo<Value>& args,
+                             bool write) {
+  HandleScope scope(node_isolate);
+
+  if (!args[0]->IsInt32())
+    return TYPE_ERROR("fd must be a file descriptor");
+  if (!args[1]->IsArray())
+    return TYPE_ERROR("buffers must be an array");
+
+  int fd = args[0]->Int32Value();
+  Local<Array> buffers = args[1].As<Array>();
+  int64_t pos = GET_OFFSET(args[2]);
+  Local<Value> cb = args[3];
+
+  uint32_t count = buffers->Length();
+  uv_buf_t* bufs = new uv_buf_t[count];
+
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> buf = buffers->Get(i);
+    if (!Buffer::HasInstance(buf)) {
+      delete[] bufs;
+      return TYPE_ERROR("buffers must be an array of buffers");
+    }
+    bufs[i] = uv_buf_init(Buffer::Data(buf), Buffer::Length(buf));
+  }
+
+  // libuv copies the uv_buf_t array.
+  if (cb->IsFunction()) {
+    if (write) {
+      ASYNC_CALL(writev, cb, fd, bufs, count, pos)
+    } else {
+      ASYNC_CALL(readv, cb, fd, bufs, count, pos)
+    }
+    delete[] bufs;
+    return;
+  }
+
+  int err;
+  if (write) {
+    fs_req_wrap req_wrap;
+    err = uv_fs_writev(uv_default_loop(), &req_wrap.req, fd, bufs, count, pos,
+                       NULL);
+  } else {
+    fs_req_wrap req_wrap;
+    err = uv_fs_readv(uv_default_loop(), &req_wrap.req, fd, bufs, count, pos,
+                      NULL);
+  }
+  delete[] bufs;
+
+  if (err < 0)
+    return ThrowUVException(err, write ? "writev" : "readv");
+  args.GetReturnValue().Set(static_cast<double>(err));
+}
+
+
+static void WriteBuffers(const FunctionCallbackInfo<Value>& args) {
+  ReadWriteBuffers(args, true);
+}
+
+
+static void ReadBuffers(const FunctionCallbackInfo<Value>& args) {
+  ReadWriteBuffers(args, false);
+}
+
+
 /*
  * Wrapper for read(2).
  *
@@ -964,6 +1044,312 @@ static void FUTimes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+#ifndef _WIN32
+// One-shot fs.readFile() and fs.writeFile(): open, size, read or write and
+// close the file in a single thread pool job instead of one round trip to
+// the loop per step. The job makes plain system calls, the uv_fs_*() sync
+// functions register the request with the loop and must not be called off
+// the loop thread. Windows keeps the JS implementation.
+//
+// Files larger than kReadFileInline are read in two jobs, the loop thread
+// allocates the buffer in between. Memory that is malloc'd in a pool thread
+// comes from that thread's arena, and handing megabytes of it to the loop
+// thread to free defeats the allocator's reuse of large blocks: every read
+// then pays for faulting in fresh pages.
+static const size_t kReadFileInline = 16 * 1024;
+
+class FileReqWrap: public ReqWrap<uv_work_t> {
+ public:
+  FileReqWrap() : path_(NULL),
+                  fd_(-1),
+                  data_(NULL),
+                  size_(0),
+                  capacity_(0),
+                  owns_data_(false),
+                  append_(false),
+                  too_large_(false),
+                  err_(0),
+                  syscall_(NULL) {
+  }
+
+  ~FileReqWrap() {
+    free(path_);
+    if (owns_data_)
+      free(data_);
+  }
+
+  char* path_;
+  int flags_;
+  int mode_;
+  int fd_;
+  char* data_;
+  size_t size_;
+  size_t capacity_;
+  bool owns_data_;
+  bool append_;
+  bool too_large_;  // Doesn't fit in a Buffer.
+  enum encoding encoding_;
+  int err_;
+  const char* syscall_;
+};
+
+
+static int OpenFile(FileReqWrap* req) {
+  int fd;
+  do
+    fd = open(req->path_, req->flags_ | O_CLOEXEC, req->mode_);
+  while (fd == -1 && errno == EINTR);
+  if (fd == -1) {
+    req->err_ = -errno;
+    req->syscall_ = "open";
+  }
+  return fd;
+}
+
+
+static void CloseFile(FileReqWrap* req, int fd) {
+  // Don't retry on EINTR, the descriptor is gone either way.
+  if (close(fd) == 0 || req->err_ != 0 || errno == EINTR)
+    return;
+  req->err_ = -errno;
+  req->syscall_ = "close";
+}
+
+
+// Reads until EOF, or until a file of known size has been read completely,
+// then closes the file.
+static void ReadFileData(FileReqWrap* req, int fd, bool sized) {
+  size_t capacity = req->capacity_;
+  ssize_t n;
+
+  for (;;) {
+    if (req->size_ == capacity) {
+      if (sized)
+        break;
+      if (capacity == Buffer::kMaxLength) {
+        req->too_large_ = true;
+        break;
+      }
+      capacity = capacity * 2 < Buffer::kMaxLength ? capacity * 2
+                                                  : Buffer::kMaxLength;
+      char* data = static_cast<char*>(realloc(req->data_, capacity));
+      if (data == NULL) {
+        req->err_ = UV_ENOMEM;
+        req->syscall_ = "read";
+        break;
+      }
+      req->data_ = data;
+    }
+
+    do
+      n = read(fd, req->data_ + req->size_, capacity - req->size_);
+    while (n == -1 && errno == EINTR);
+
+    if (n == -1) {
+      req->err_ = -errno;
+      req->syscall_ = "read";
+      break;
+    }
+    if (n == 0)
+      break;
+    req->size_ += n;
+  }
+
+  CloseFile(req, fd);
+}
+
+
+static void ReadFileWork(uv_work_t* work_req) {
+  FileReqWrap* req = static_cast<FileReqWrap*>(work_req->data);
+  struct stat s;
+  int fd;
+
+  if (req->fd_ != -1) {
+    // Second job, FileAfter() has allocated the buffer.
+    fd = req->fd_;
+    req->fd_ = -1;
+    return ReadFileData(req, fd, true);
+  }
+
+  fd = OpenFile(req);
+  if (fd == -1)
+    return;
+
+  if (fstat(fd, &s)) {
+    req->err_ = -errno;
+    req->syscall_ = "fstat";
+    return CloseFile(req, fd);
+  }
+
+  if (s.st_size > static_cast<off_t>(Buffer::kMaxLength)) {
+    req->too_large_ = true;
+    return CloseFile(req, fd);
+  }
+
+  // The kernel reports a size of zero for many files that aren't, read
+  // those until EOF.
+  req->capacity_ = s.st_size > 0 ? s.st_size : 8192;
+  if (s.st_size > static_cast<off_t>(kReadFileInline)) {
+    req->fd_ = fd;
+    return;
+  }
+
+  req->data_ = static_cast<char*>(malloc(req->capacity_));
+  req->owns_data_ = true;
+  if (req->data_ == NULL) {
+    req->err_ = UV_ENOMEM;
+    req->syscall_ = "read";
+    return CloseFile(req, fd);
+  }
+
+  ReadFileData(req, fd, s.st_size > 0);
+}
+
+
+static void WriteFileWork(uv_work_t* work_req) {
+  FileReqWrap* req = static_cast<FileReqWrap*>(work_req->data);
+  size_t written;
+  ssize_t n;
+  int fd;
+
+  fd = OpenFile(req);
+  if (fd == -1)
+    return;
+
+  for (written = 0; written < req->size_; written += n) {
+    do {
+      if (req->append_)
+        n = write(fd, req->data_ + written, req->size_ - written);
+      else
+        n = pwrite(fd, req->data_ + written, req->size_ - written, written);
+    } while (n == -1 && errno == EINTR);
+
+    if (n == -1) {
+      req->err_ = -errno;
+      req->syscall_ = "write";
+      break;
+    }
+  }
+
+  CloseFile(req, fd);
+}
+
+
+static void FileAfter(uv_work_t* work_req, int status) {
+  assert(status == 0);
+  FileReqWrap* req = static_cast<FileReqWrap*>(work_req->data);
+  HandleScope scope(node_isolate);
+  Local<Value> argv[2];
+  int argc = 1;
+
+  if (req->fd_ != -1) {
+    req->data_ = static_cast<char*>(malloc(req->capacity_));
+    req->owns_data_ = true;
+    if (req->data_ != NULL) {
+      uv_queue_work(uv_default_loop(), &req->req_, ReadFileWork, FileAfter);
+      return;
+    }
+    close(req->fd_);
+    req->err_ = UV_ENOMEM;
+    req->syscall_ = "read";
+  }
+
+  if (req->err_ != 0) {
+    argv[0] = UVException(req->err_, NULL, req->syscall_, req->path_);
+  } else if (req->too_large_) {
+    // Same as new Buffer(size) in the JS implementation, fs.js throws it.
+    argv[0] = Exception::RangeError(String::New("length > kMaxLength"));
+  } else {
+    argv[0] = Null(node_isolate);
+    if (req->req_.work_cb == ReadFileWork) {
+      argc = 2;
+      if (req->encoding_ != BUFFER) {
+        argv[1] = StringBytes::Encode(req->data_, req->size_, req->encoding_);
+      } else if (req->size_ == 0) {
+        argv[1] = Buffer::New(0);
+      } else {
+        // The buffer takes ownership of the data.
+        argv[1] = Buffer::Use(req->data_, req->size_);
+        req->owns_data_ = false;
+      }
+    }
+  }
+
+  MakeBatchedCallback(req->object(), oncomplete_sym, argc, argv);
+  delete req;
+}
+
+
+static FileReqWrap* NewFileReqWrap(const FunctionCallbackInfo<Value>& args,
+                                   Local<Value> callback) {
+  FileReqWrap* req = new FileReqWrap();
+  String::Utf8Value path(args[0]);
+  req->path_ = strdup(*path);
+  req->flags_ = args[1]->Int32Value();
+  req->mode_ = static_cast<int>(args[2]->Int32Value());
+  req->object()->Set(oncomplete_sym, callback);
+  // The work callbacks find the request through req_.data, set it before
+  // the request is queued.
+  req->Dispatched();
+  return req;
+}
+
+
+// readFile(path, flags, mode, encoding, callback)
+static void ReadFile(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  if (args.Length() < 5) return THROW_BAD_ARGS;
+  if (!args[0]->IsString()) return TYPE_ERROR("path must be a string");
+  if (!args[1]->IsInt32()) return TYPE_ERROR("flags must be an int");
+  if (!args[2]->IsInt32()) return TYPE_ERROR("mode must be an int");
+  if (!args[4]->IsFunction()) return TYPE_ERROR("callback must be a function");
+
+  FileReqWrap* req = NewFileReqWrap(args, args[4]);
+  req->encoding_ = ParseEncoding(args[3], BUFFER);
+
+  uv_queue_work(uv_default_loop(), &req->req_, ReadFileWork, FileAfter);
+  args.GetReturnValue().Set(req->persistent());
+}
+
+
+// writeFile(path, flags, mode, data, encoding, append, callback)
+static void WriteFile(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  if (args.Length() < 7) return THROW_BAD_ARGS;
+  if (!args[0]->IsString()) return TYPE_ERROR("path must be a string");
+  if (!args[1]->IsInt32()) return TYPE_ERROR("flags must be an int");
+  if (!args[2]->IsInt32()) return TYPE_ERROR("mode must be an int");
+  if (!args[6]->IsFunction()) return TYPE_ERROR("callback must be a function");
+
+  FileReqWrap* req = NewFileReqWrap(args, args[6]);
+  req->append_ = args[5]->IsTrue();
+
+  Local<Value> data = args[3];
+  if (Buffer::HasInstance(data)) {
+    // Keep the buffer alive until the request is done.
+    req->object()->Set(String::New("buffer"), data);
+    req->data_ = Buffer::Data(data);
+    req->size_ = Buffer::Length(data);
+  } else {
+    enum encoding enc = ParseEncoding(args[4], UTF8);
+    size_t len = StringBytes::StorageSize(data, enc);
+    req->data_ = static_cast<char*>(malloc(len > 0 ? len : 1));
+    req->owns_data_ = true;
+    if (req->data_ == NULL) {
+      delete req;
+      return ThrowError("Out of memory");
+    }
+    req->size_ = StringBytes::Write(req->data_, len, data, enc);
+  }
+
+  uv_queue_work(uv_default_loop(), &req->req_, WriteFileWork, FileAfter);
+  args.GetReturnValue().Set(req->persistent());
+}
+#endif  // _WIN32
+
+
 void File::Initialize(Handle<Object> target) {
   HandleScope scope(node_isolate);
 
@@ -986,6 +1372,8 @@ void File::Initialize(Handle<Object> target) {
   NODE_SET_METHOD(target, "unlink", Unlink);
   NODE_SET_METHOD(target, "writeBuffer", WriteBuffer);
   NODE_SET_METHOD(target, "writeString", WriteString);
+  NODE_SET_METHOD(target, "writeBuffers", WriteBuffers);
+  NODE_SET_METHOD(target, "readBuffers", ReadBuffers);
 
   NODE_SET_METHOD(target, "chmod", Chmod);
   NODE_SET_METHOD(target, "fchmod", FChmod);
@@ -997,6 +1385,11 @@ void File::Initialize(Handle<Object> target) {
 
   NODE_SET_METHOD(target, "utimes", UTimes);
   NODE_SET_METHOD(target, "futimes", FUTimes);
+
+#ifndef _WIN32
+  NODE_SET_METHOD(target, "readFile", ReadFile);
+  NODE_SET_METHOD(target, "writeFile", WriteFile);
+#endif
 }
 
 void InitFs(Handle<Object> target) {
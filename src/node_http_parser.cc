@@ -24,13 +24,16 @@
 #include "node_http_parser.h"
 #include "v8.h"
 
+#include <stdio.h>  // snprintf()
 #include <stdlib.h>  // free()
 #include <string.h>  // strdup()
+#include <time.h>  // time(), gmtime_r()
 
 #if defined(_MSC_VER)
 #define strcasecmp _stricmp
+#define strncasecmp _strnicmp
 #else
-#include <strings.h>  // strcasecmp()
+#include <strings.h>  // strcasecmp(), strncasecmp()
 #endif
 
 // This is a binding to http_parser (https://github.com/joyent/http-parser)
@@ -55,8 +58,10 @@ using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::kExternalUnsignedIntArray;
 using v8::Local;
 using v8::Object;
+using v8::Persistent;
 using v8::String;
 using v8::Value;
 
@@ -73,6 +78,7 @@ static Cached<String> version_minor_sym;
 static Cached<String> should_keep_alive_sym;
 static Cached<String> upgrade_sym;
 static Cached<String> headers_sym;
+static Cached<String> raw_headers_sym;
 static Cached<String> url_sym;
 
 static Cached<String> unknown_method_sym;
@@ -119,25 +125,123 @@ method_to_str(unsigned short m) {
 }
 
 
-// helper class for the Parser
-struct StringPtr {
-  StringPtr() {
-    on_heap_ = false;
-    Reset();
+// Bump allocator for header and URL data that has to outlive the buffer it
+// was parsed from. Everything is released at once when the next message
+// starts; the chunks are kept around so keep-alive connections don't go
+// back to the system allocator for every request.
+class Arena {
+ public:
+  Arena() : head_(NULL), current_(NULL) {
+  }
+
+
+  ~Arena() {
+    while (head_ != NULL) {
+      Chunk* next = head_->next_;
+      free(head_);
+      head_ = next;
+    }
+  }
+
+
+  char* Allocate(size_t size) {
+    if (current_ == NULL || current_->size_ - current_->used_ < size)
+      NextChunk(size);
+    char* data = current_->data_ + current_->used_;
+    current_->used_ += size;
+    return data;
   }
 
 
-  ~StringPtr() {
+  // Grow the most recent allocation in place, if there is room for it.
+  bool Extend(const char* data, size_t size, size_t extra) {
+    if (current_ == NULL)
+      return false;
+    if (data + size != current_->data_ + current_->used_)
+      return false;
+    if (current_->size_ - current_->used_ < extra)
+      return false;
+    current_->used_ += extra;
+    return true;
+  }
+
+
+  // Oversized chunks are released, a single large header shouldn't make a
+  // pooled parser hold on to that much memory for good.
+  void Reset() {
+    Chunk** link = &head_;
+    while (*link != NULL) {
+      Chunk* chunk = *link;
+      if (chunk->size_ > kChunkSize) {
+        *link = chunk->next_;
+        free(chunk);
+      } else {
+        chunk->used_ = 0;
+        link = &chunk->next_;
+      }
+    }
+    current_ = head_;
+  }
+
+
+ private:
+  static const size_t kChunkSize = 4096;
+
+  struct Chunk {
+    Chunk* next_;
+    size_t size_;
+    size_t used_;
+    char data_[1];
+  };
+
+
+  void NextChunk(size_t size) {
+    // Reuse the chunks that are left over from previous messages first.
+    Chunk** link = current_ ? &current_->next_ : &head_;
+    while (*link != NULL) {
+      if ((*link)->size_ >= size) {
+        current_ = *link;
+        current_->used_ = 0;
+        return;
+      }
+      link = &(*link)->next_;
+    }
+
+    // Leave room to grow an oversized value in place, see Extend(). Doubling
+    // keeps the copying linear when a value arrives in many small pieces.
+    if (size <= kChunkSize)
+      size = kChunkSize;
+    else
+      size *= 2;
+    Chunk* chunk = static_cast<Chunk*>(malloc(offset_of(Chunk, data_) + size));
+    if (chunk == NULL)
+      FatalError("node::Arena::NextChunk(size_t)", "Out Of Memory");
+    chunk->next_ = NULL;
+    chunk->size_ = size;
+    chunk->used_ = 0;
+    *link = chunk;
+    current_ = chunk;
+  }
+
+
+  Chunk* head_;
+  Chunk* current_;
+};
+
+
+// helper class for the Parser
+struct StringPtr {
+  StringPtr() {
     Reset();
   }
 
 
-  // If str_ does not point to a heap string yet, this function makes it do
+  // If str_ does not point to arena memory yet, this function makes it do
   // so. This is called at the end of each http_parser_execute() so as not
   // to leak references. See issue #2438 and test-http-parser-bad-ref.js.
-  void Save() {
+  void Save(Arena* arena) {
     if (!on_heap_ && size_ > 0) {
-      char* s = new char[size_];
+      char* s = arena->Allocate(size_);
       memcpy(s, str_, size_);
       str_ = s;
       on_heap_ = true;
@@ -145,33 +249,27 @@ struct StringPtr {
   }
 
 
+  // The memory is owned by the parser's arena, nothing to free here.
   void Reset() {
-    if (on_heap_) {
-      delete[] str_;
-      on_heap_ = false;
-    }
-
+    on_heap_ = false;
     str_ = NULL;
     size_ = 0;
   }
 
 
-  void Update(const char* str, size_t size) {
-    if (str_ == NULL)
+  void Update(const char* str, size_t size, Arena* arena) {
+    if (str_ == NULL) {
       str_ = str;
-    else if (on_heap_ || str_ + size_ != str) {
-      // Non-consecutive input, make a copy on the heap.
-      // TODO(bnoordhuis) Use slab allocation, O(n) allocs is bad.
-      char* s = new char[size_ + size];
+    } else if (on_heap_ && arena->Extend(str_, size_, size)) {
+      // Top of the arena, append in place.
+      memcpy(const_cast<char*>(str_) + size_, str, size);
+    } else if (on_heap_ || str_ + size_ != str) {
+      // Non-consecutive input, make a copy in the arena.
+      char* s = arena->Allocate(size_ + size);
       memcpy(s, str_, size_);
       memcpy(s + size_, str, size);
-
-      if (on_heap_)
-        delete[] str_;
-      else
-        on_heap_ = true;
-
       str_ = s;
+      on_heap_ = true;
     }
     size_ += size;
   }
@@ -191,6 +289,69 @@ struct StringPtr {
 };
 
 
+// In lazy mode the parser hands the headers to JS as one buffer instead of
+// an array of strings. The buffer starts with the number of headers and a
+// table of (name offset, name length, value offset, value length) entries,
+// followed by the header bytes themselves. Strings are only created for the
+// headers that are looked up, see FindHeader() and UnpackHeaders().
+class PackedHeaders {
+ public:
+  static size_t TableSize(uint32_t count) {
+    return sizeof(uint32_t) * (1 + 4 * count);
+  }
+
+
+  // |limit| is the maximum number of names and values to look at, like
+  // parser.maxHeaderPairs. 0 means no limit.
+  PackedHeaders(Handle<Value> buf, uint32_t limit)
+      : data_(NULL),
+        count_(0) {
+    if (!Buffer::HasInstance(buf))
+      return;
+    size_t length = Buffer::Length(buf);
+    if (length < TableSize(0))
+      return;
+    const uint32_t* table =
+        reinterpret_cast<const uint32_t*>(Buffer::Data(buf));
+    uint32_t count = table[0];
+    // Not length < TableSize(count), that can overflow a 32 bits size_t.
+    if (count > (length - TableSize(0)) / (4 * sizeof(uint32_t)))
+      return;
+    if (limit > 0 && count > limit / 2)
+      count = limit / 2;
+    // The buffer can come from JS, every entry has to point into it.
+    for (uint32_t i = 0; i < count; i++) {
+      const uint32_t* entry = table + 1 + 4 * i;
+      if (entry[0] > length || entry[1] > length - entry[0] ||
+          entry[2] > length || entry[3] > length - entry[2]) {
+        return;
+      }
+    }
+    data_ = Buffer::Data(buf);
+    count_ = count;
+  }
+
+
+  bool IsValid() const { return data_ != NULL; }
+  uint32_t Count() const { return count_; }
+
+  const char* Name(uint32_t i, size_t* len) const { return Get(i, 0, len); }
+  const char* Value(uint32_t i, size_t* len) const { return Get(i, 2, len); }
+
+
+ private:
+  const char* Get(uint32_t i, int field, size_t* len) const {
+    const uint32_t* table = reinterpret_cast<const uint32_t*>(data_);
+    const uint32_t* entry = table + 1 + 4 * i;
+    *len = entry[field + 1];
+    return data_ + entry[field];
+  }
+
+  const char* data_;
+  uint32_t count_;
+};
+
+
 class Parser : public ObjectWrap {
  public:
   explicit Parser(enum http_parser_type type) : ObjectWrap() {
@@ -205,12 +366,13 @@ class Parser : public ObjectWrap {
   HTTP_CB(on_message_begin) {
     num_fields_ = num_values_ = 0;
     url_.Reset();
+    arena_.Reset();
     return 0;
   }
 
 
   HTTP_DATA_CB(on_url) {
-    url_.Update(at, length);
+    url_.Update(at, length, &arena_);
     return 0;
   }
 
@@ -231,7 +393,7 @@ class Parser : public ObjectWrap {
     assert(num_fields_ < static_cast<int>(ARRAY_SIZE(fields_)));
     assert(num_fields_ == num_values_ + 1);
 
-    fields_[num_fields_ - 1].Update(at, length);
+    fields_[num_fields_ - 1].Update(at, length, &arena_);
 
     return 0;
   }
@@ -247,7 +409,7 @@ class Parser : public ObjectWrap {
     assert(num_values_ < static_cast<int>(ARRAY_SIZE(values_)));
     assert(num_values_ == num_fields_);
 
-    values_[num_values_ - 1].Update(at, length);
+    values_[num_values_ - 1].Update(at, length, &arena_);
 
     return 0;
   }
@@ -267,7 +429,10 @@ class Parser : public ObjectWrap {
       Flush();
     } else {
       // Fast case, pass headers and URL to JS land.
-      message_info->Set(headers_sym, CreateHeaders());
+      if (lazy_headers_)
+        message_info->Set(raw_headers_sym, PackHeaders());
+      else
+        message_info->Set(headers_sym, CreateHeaders());
       if (parser_.type == HTTP_REQUEST)
         message_info->Set(url_sym, url_.ToString());
     }
@@ -372,16 +537,22 @@ class Parser : public ObjectWrap {
   }
 
 
+  // The string that is still being parsed is saved last, that puts it at
+  // the top of the arena where the next chunk can be appended in place.
   void Save() {
-    url_.Save();
+    if (num_fields_ > 0)
+      url_.Save(&arena_);
 
-    for (int i = 0; i < num_fields_; i++) {
-      fields_[i].Save();
+    if (num_fields_ == num_values_) {
+      SaveStrings(fields_, num_fields_);
+      SaveStrings(values_, num_values_);
+    } else {
+      SaveStrings(values_, num_values_);
+      SaveStrings(fields_, num_fields_);
     }
 
-    for (int i = 0; i < num_values_; i++) {
-      values_[i].Save();
-    }
+    if (num_fields_ == 0)
+      url_.Save(&arena_);
   }
 
 
@@ -477,11 +648,19 @@ class Parser : public ObjectWrap {
     assert(type == HTTP_REQUEST || type == HTTP_RESPONSE);
     Parser* parser = ObjectWrap::Unwrap<Parser>(args.This());
     parser->Init(type);
+    parser->lazy_headers_ = args[1]->IsTrue();
   }
 
 
  private:
 
+  void SaveStrings(StringPtr* strings, int count) {
+    for (int i = 0; i < count; i++) {
+      strings[i].Save(&arena_);
+    }
+  }
+
+
   Local<Array> CreateHeaders() {
     // num_values_ is either -1 or the entry # of the last header
     // so num_values_ == 0 means there's a single header
@@ -496,6 +675,33 @@ class Parser : public ObjectWrap {
   }
 
 
+  // Copy the headers into a single buffer, see PackedHeaders below.
+  Local<Object> PackHeaders() {
+    size_t size = PackedHeaders::TableSize(num_values_);
+    for (int i = 0; i < num_values_; ++i)
+      size += fields_[i].size_ + values_[i].size_;
+
+    Local<Object> buf = Buffer::New(size);
+    uint32_t* table = reinterpret_cast<uint32_t*>(Buffer::Data(buf));
+    uint32_t offset = PackedHeaders::TableSize(num_values_);
+
+    table[0] = num_values_;
+    for (int i = 0; i < num_values_; ++i) {
+      uint32_t* entry = table + 1 + 4 * i;
+      entry[0] = offset;
+      entry[1] = fields_[i].size_;
+      memcpy(Buffer::Data(buf) + offset, fields_[i].str_, fields_[i].size_);
+      offset += fields_[i].size_;
+      entry[2] = offset;
+      entry[3] = values_[i].size_;
+      memcpy(Buffer::Data(buf) + offset, values_[i].str_, values_[i].size_);
+      offset += values_[i].size_;
+    }
+
+    return buf;
+  }
+
+
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope(node_isolate);
@@ -524,10 +730,12 @@ class Parser : public ObjectWrap {
   void Init(enum http_parser_type type) {
     http_parser_init(&parser_, type);
     url_.Reset();
+    arena_.Reset();
     num_fields_ = 0;
     num_values_ = 0;
     have_flushed_ = false;
     got_exception_ = false;
+    lazy_headers_ = false;
   }
 
 
@@ -535,13 +743,501 @@ class Parser : public ObjectWrap {
   StringPtr fields_[32];  // header fields
   StringPtr values_[32];  // header values
   StringPtr url_;
+  Arena arena_;  // backing store for fields_, values_ and url_
   int num_fields_;
   int num_values_;
   bool have_flushed_;
   bool got_exception_;
+  bool lazy_headers_;  // Hand out PackedHeaders instead of strings.
 };
 
 
+// var value = findHeader(packedHeaders, name, limit);
+//
+// Case-insensitive lookup of |name| in a PackedHeaders buffer. Returns the
+// value if the header appears once, an array of values if it is repeated and
+// undefined if it is not there. Merging repeated headers is left to JS.
+static void FindHeader(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  PackedHeaders headers(args[0], args[2]->Uint32Value());
+  if (!headers.IsValid() || !args[1]->IsString())
+    return ThrowTypeError("Bad arguments");
+
+  Local<String> name_str = args[1].As<String>();
+  if (!name_str->IsOneByte() && !name_str->ContainsOnlyOneByte())
+    return;  // Header names are always ASCII.
+
+  char stack_name[256];
+  char* name = stack_name;
+  size_t name_len = name_str->Length();
+  if (name_len > sizeof(stack_name))
+    name = new char[name_len];
+  name_str->WriteOneByte(reinterpret_cast<uint8_t*>(name),
+                         0,
+                         name_len,
+                         String::NO_NULL_TERMINATION);
+
+  Local<Value> result;
+  Local<Array> values;
+  for (uint32_t i = 0; i < headers.Count(); i++) {
+    size_t len;
+    const char* s = headers.Name(i, &len);
+    if (len != name_len || strncasecmp(s, name, len) != 0)
+      continue;
+
+    s = headers.Value(i, &len);
+    Local<String> value = String::New(s, len);
+    if (result.IsEmpty()) {
+      result = value;
+    } else {
+      if (values.IsEmpty()) {
+        values = Array::New();
+        values->Set(0, result);
+        result = values;
+      }
+      values->Set(values->Length(), value);
+    }
+  }
+
+  if (name != stack_name)
+    delete[] name;
+
+  if (!result.IsEmpty())
+    args.GetReturnValue().Set(result);
+}
+
+
+// var headers = unpackHeaders(packedHeaders, limit);
+//
+// Turns a PackedHeaders buffer into the [name, value, ...] array that the
+// parser would have passed in eager mode.
+static void UnpackHeaders(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  PackedHeaders headers(args[0], args[1]->Uint32Value());
+  if (!headers.IsValid())
+    return ThrowTypeError("Bad arguments");
+
+  Local<Array> result = Array::New(2 * headers.Count());
+  for (uint32_t i = 0; i < headers.Count(); i++) {
+    size_t len;
+    const char* s = headers.Name(i, &len);
+    result->Set(2 * i, String::New(s, len));
+    s = headers.Value(i, &len);
+    result->Set(2 * i + 1, String::New(s, len));
+  }
+
+  args.GetReturnValue().Set(result);
+}
+
+
+// Flags shared with OutgoingMessage.prototype._storeHeader() in
+// lib/_http_outgoing.js, keep the two in sync. kLast, kChunkedEncoding and
+// kShouldKeepAlive mirror the message properties of the same name and are
+// updated in place, the others are inputs except for kSentExpect.
+enum HeaderFlags {
+  kLast = 0x01,
+  kChunkedEncoding = 0x02,
+  kShouldKeepAlive = 0x04,
+  kUseChunkedEncodingByDefault = 0x08,
+  kHasAgent = 0x10,
+  kHasBody = 0x20,
+  kSendDate = 0x40,
+  kNoContent = 0x80,
+  kSentExpect = 0x100
+};
+
+// header_state[0] holds the flags after a call to StoreHeader().
+static uint32_t header_state[1];
+
+
+// The Date header only changes once per second, format it once per second.
+static const char* FormatDate(size_t* len) {
+  static const char days[][4] = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+  };
+  static const char months[][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+  static char date_line[64];
+  static size_t date_line_len;
+  static time_t date_line_time = -1;
+
+  time_t now = time(NULL);
+  if (now != date_line_time) {
+    struct tm tm;
+#ifdef _WIN32
+    gmtime_s(&tm, &now);
+#else
+    gmtime_r(&now, &tm);
+#endif
+    date_line_len = snprintf(date_line,
+                             sizeof(date_line),
+                             "Date: %s, %02d %s %d %02d:%02d:%02d GMT\r\n",
+                             days[tm.tm_wday],
+                             tm.tm_mday,
+                             months[tm.tm_mon],
+                             tm.tm_year + 1900,
+                             tm.tm_hour,
+                             tm.tm_min,
+                             tm.tm_sec);
+    date_line_time = now;
+  }
+
+  *len = date_line_len;
+  return date_line;
+}
+
+
+// Case-insensitive substring search, |token| must be lower case. This is
+// what the /Connection/i and friends regular expressions used to do.
+static bool ContainsToken(const char* s, size_t len, const char* token) {
+  size_t token_len = strlen(token);
+  if (len < token_len)
+    return false;
+
+  for (size_t i = 0; i <= len - token_len; i++) {
+    size_t k = 0;
+    while (k < token_len && (s[i + k] | 0x20) == token[k])
+      k++;
+    if (k == token_len)
+      return true;
+  }
+
+  return false;
+}
+
+
+// What StoreHeader() has to know about a header besides its bytes.
+enum HeaderKind {
+  kOtherHeader,
+  kConnectionHeader,
+  kTransferEncodingHeader,
+  kContentLengthHeader,
+  kDateHeader,
+  kExpectHeader
+};
+
+
+static HeaderKind ClassifyHeader(const char* name, size_t len) {
+  if (ContainsToken(name, len, "connection"))
+    return kConnectionHeader;
+  if (ContainsToken(name, len, "transfer-encoding"))
+    return kTransferEncodingHeader;
+  if (ContainsToken(name, len, "content-length"))
+    return kContentLengthHeader;
+  if (ContainsToken(name, len, "date"))
+    return kDateHeader;
+  if (ContainsToken(name, len, "expect"))
+    return kExpectHeader;
+  return kOtherHeader;
+}
+
+
+// Header names that most messages carry, as they are usually spelled. Names
+// that come from string literals or object keys in JS are internalized, so
+// they are the very same strings as the symbols created from this table in
+// InitHttpParser(). Those are copied without looking at their characters.
+// Other spellings go through the generic path, which gives the same result.
+#define COMMON_HEADER(name, kind) { name, sizeof(name) - 1, kind }
+static const struct {
+  const char* name;
+  int len;
+  HeaderKind kind;
+} common_headers[] = {
+  COMMON_HEADER("Content-Type", kOtherHeader),
+  COMMON_HEADER("content-type", kOtherHeader),
+  COMMON_HEADER("Content-Length", kContentLengthHeader),
+  COMMON_HEADER("content-length", kContentLengthHeader),
+  COMMON_HEADER("Connection", kConnectionHeader),
+  COMMON_HEADER("connection", kConnectionHeader),
+  COMMON_HEADER("Transfer-Encoding", kTransferEncodingHeader),
+  COMMON_HEADER("transfer-encoding", kTransferEncodingHeader),
+  COMMON_HEADER("Date", kDateHeader),
+  COMMON_HEADER("date", kDateHeader),
+  COMMON_HEADER("Expect", kExpectHeader),
+  COMMON_HEADER("expect", kExpectHeader),
+  COMMON_HEADER("Host", kOtherHeader),
+  COMMON_HEADER("host", kOtherHeader),
+  COMMON_HEADER("Cache-Control", kOtherHeader),
+  COMMON_HEADER("cache-control", kOtherHeader),
+  COMMON_HEADER("Content-Encoding", kOtherHeader),
+  COMMON_HEADER("content-encoding", kOtherHeader),
+  COMMON_HEADER("ETag", kOtherHeader),
+  COMMON_HEADER("etag", kOtherHeader),
+  COMMON_HEADER("Last-Modified", kOtherHeader),
+  COMMON_HEADER("last-modified", kOtherHeader),
+  COMMON_HEADER("Location", kOtherHeader),
+  COMMON_HEADER("location", kOtherHeader),
+  COMMON_HEADER("Server", kOtherHeader),
+  COMMON_HEADER("server", kOtherHeader),
+  COMMON_HEADER("Set-Cookie", kOtherHeader),
+  COMMON_HEADER("set-cookie", kOtherHeader),
+  COMMON_HEADER("Vary", kOtherHeader),
+  COMMON_HEADER("vary", kOtherHeader)
+};
+#undef COMMON_HEADER
+
+static Persistent<String> common_header_syms[ARRAY_SIZE(common_headers)];
+
+
+// Index into common_headers or -1 if |name| isn't one of them.
+static int FindCommonHeader(Handle<String> name) {
+  int len = name->Length();
+  for (size_t i = 0; i < ARRAY_SIZE(common_headers); i++) {
+    if (common_headers[i].len == len && name == common_header_syms[i])
+      return i;
+  }
+  return -1;
+}
+
+
+// Appends header lines to a slice of the header pool. Errors are sticky so
+// the caller only has to check once at the end.
+class HeaderWriter {
+ public:
+  HeaderWriter(char* data, size_t size)
+      : data_(data),
+        size_(size),
+        used_(0),
+        error_(0) {
+  }
+
+
+  void Append(const char* s, size_t len) {
+    if (error_ != 0)
+      return;
+    if (size_ - used_ < len) {
+      error_ = kNoRoom;
+      return;
+    }
+    memcpy(data_ + used_, s, len);
+    used_ += len;
+  }
+
+
+  // Append a header name or value and return where it was written so the
+  // caller can look at it. Values get CR and LF stripped from them to
+  // protect against response splitting.
+  const char* Append(Handle<String> s, bool is_value, size_t* len) {
+    *len = 0;
+    if (error_ != 0)
+      return NULL;
+
+    if (!s->IsOneByte() && !s->ContainsOnlyOneByte()) {
+      error_ = kNotAscii;
+      return NULL;
+    }
+
+    size_t length = s->Length();
+    if (size_ - used_ < length) {
+      error_ = kNoRoom;
+      return NULL;
+    }
+
+    uint8_t* start = reinterpret_cast<uint8_t*>(data_ + used_);
+    s->WriteOneByte(start, 0, length, String::NO_NULL_TERMINATION);
+
+    bool has_line_break = false;
+    for (size_t i = 0; i < length; i++) {
+      if (start[i] & 0x80) {
+        // Non-ASCII headers are encoded differently depending on the body,
+        // leave them to the JS implementation.
+        error_ = kNotAscii;
+        return NULL;
+      }
+      if (start[i] == '\r' || start[i] == '\n')
+        has_line_break = true;
+    }
+
+    if (is_value && has_line_break)
+      length = StripLineBreaks(start, length);
+
+    used_ += length;
+    *len = length;
+    return reinterpret_cast<const char*>(start);
+  }
+
+
+  // Bytes written, 0 if the pool ran out of room or -1 if the header has
+  // to be serialized by the JS implementation.
+  int Result() const {
+    if (error_ == kNoRoom)
+      return 0;
+    if (error_ == kNotAscii)
+      return -1;
+    return used_;
+  }
+
+
+ private:
+  enum { kNoRoom = 1, kNotAscii = 2 };
+
+  // Same as value.replace(/[\r\n]+[ \t]*/g, '').
+  static size_t StripLineBreaks(uint8_t* s, size_t len) {
+    size_t i = 0;
+    size_t k = 0;
+    while (i < len) {
+      if (s[i] != '\r' && s[i] != '\n') {
+        s[k++] = s[i++];
+        continue;
+      }
+      while (i < len && (s[i] == '\r' || s[i] == '\n'))
+        i++;
+      while (i < len && (s[i] == ' ' || s[i] == '\t'))
+        i++;
+    }
+    return k;
+  }
+
+  char* data_;
+  size_t size_;
+  size_t used_;
+  int error_;
+};
+
+
+#define APPEND_LITERAL(w, s) (w).Append((s), sizeof(s) - 1)
+
+
+// var bytes = storeHeader(pool, offset, firstLine, fields, flags);
+//
+// Serializes a message header into |pool| at |offset|. |fields| is a flat
+// [name, value, name, value, ...] array. Returns the number of bytes
+// written, 0 if the header does not fit in the pool or -1 if it has to be
+// serialized in JS after all. The updated flags are left in headerState[0].
+static void StoreHeader(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  if (!Buffer::HasInstance(args[0]) ||
+      !args[2]->IsString() ||
+      !args[3]->IsArray()) {
+    return ThrowTypeError("Bad arguments");
+  }
+
+  Local<Object> pool = args[0].As<Object>();
+  size_t offset = args[1]->Uint32Value();
+  size_t pool_length = Buffer::Length(pool);
+  if (offset > pool_length)
+    return ThrowRangeError("offset out of range");
+
+  Local<String> first_line = args[2].As<String>();
+  Local<Array> fields = args[3].As<Array>();
+  uint32_t flags = args[4]->Uint32Value();
+
+  HeaderWriter w(Buffer::Data(pool) + offset, pool_length - offset);
+  size_t len;
+  w.Append(first_line, false, &len);
+
+  bool sent_connection = false;
+  bool sent_content_length = false;
+  bool sent_transfer_encoding = false;
+  bool sent_date = false;
+
+  uint32_t count = fields->Length() & ~1;
+  for (uint32_t i = 0; i < count; i += 2) {
+    Local<String> name = fields->Get(i)->ToString();
+    if (name.IsEmpty())
+      return;  // toString() threw.
+    Local<String> value = fields->Get(i + 1)->ToString();
+    if (value.IsEmpty())
+      return;
+
+    HeaderKind kind;
+    int common = FindCommonHeader(name);
+    if (common != -1) {
+      w.Append(common_headers[common].name, common_headers[common].len);
+      kind = common_headers[common].kind;
+    } else {
+      size_t name_len;
+      const char* n = w.Append(name, false, &name_len);
+      if (n == NULL)
+        continue;
+      kind = ClassifyHeader(n, name_len);
+    }
+
+    size_t value_len;
+    APPEND_LITERAL(w, ": ");
+    const char* v = w.Append(value, true, &value_len);
+    APPEND_LITERAL(w, "\r\n");
+
+    if (v == NULL)
+      continue;
+
+    switch (kind) {
+      case kConnectionHeader:
+        sent_connection = true;
+        if (ContainsToken(v, value_len, "close"))
+          flags |= kLast;
+        else
+          flags |= kShouldKeepAlive;
+        break;
+      case kTransferEncodingHeader:
+        sent_transfer_encoding = true;
+        if (ContainsToken(v, value_len, "chunk"))
+          flags |= kChunkedEncoding;
+        break;
+      case kContentLengthHeader:
+        sent_content_length = true;
+        break;
+      case kDateHeader:
+        sent_date = true;
+        break;
+      case kExpectHeader:
+        flags |= kSentExpect;
+        break;
+      case kOtherHeader:
+        break;
+    }
+  }
+
+  if ((flags & kSendDate) && !sent_date) {
+    const char* date = FormatDate(&len);
+    w.Append(date, len);
+  }
+
+  // 204 No Content and 304 Not Modified responses can't have a body, see
+  // the comment in _storeHeader().
+  if ((flags & kNoContent) && (flags & kChunkedEncoding)) {
+    flags &= ~(kChunkedEncoding | kShouldKeepAlive);
+  }
+
+  if (!sent_connection) {
+    bool send_keep_alive =
+        (flags & kShouldKeepAlive) &&
+        (sent_content_length ||
+         (flags & kUseChunkedEncodingByDefault) ||
+         (flags & kHasAgent));
+    if (send_keep_alive) {
+      APPEND_LITERAL(w, "Connection: keep-alive\r\n");
+    } else {
+      flags |= kLast;
+      APPEND_LITERAL(w, "Connection: close\r\n");
+    }
+  }
+
+  if (!sent_content_length && !sent_transfer_encoding) {
+    if (!(flags & kHasBody)) {
+      flags &= ~kChunkedEncoding;
+    } else if (flags & kUseChunkedEncodingByDefault) {
+      APPEND_LITERAL(w, "Transfer-Encoding: chunked\r\n");
+      flags |= kChunkedEncoding;
+    } else {
+      flags |= kLast;
+    }
+  }
+
+  APPEND_LITERAL(w, "\r\n");
+
+  header_state[0] = flags;
+  args.GetReturnValue().Set(w.Result());
+}
+
+#undef APPEND_LITERAL
+
+
 void InitHttpParser(Handle<Object> target) {
   HandleScope scope(node_isolate);
 
@@ -560,6 +1256,21 @@ void InitHttpParser(Handle<Object> target) {
 
   target->Set(String::NewSymbol("HTTPParser"), t->GetFunction());
 
+  NODE_SET_METHOD(target, "findHeader", FindHeader);
+  NODE_SET_METHOD(target, "unpackHeaders", UnpackHeaders);
+  NODE_SET_METHOD(target, "storeHeader", StoreHeader);
+
+  Local<Object> header_state_obj = Object::New();
+  header_state_obj->SetIndexedPropertiesToExternalArrayData(
+      header_state, kExternalUnsignedIntArray, ARRAY_SIZE(header_state));
+  target->Set(String::NewSymbol("headerState"), header_state_obj);
+
+  for (size_t i = 0; i < ARRAY_SIZE(common_headers); i++) {
+    common_header_syms[i].Reset(node_isolate,
+                                String::NewSymbol(common_headers[i].name,
+                                                  common_headers[i].len));
+  }
+
   on_headers_sym          = String::New("onHeaders");
   on_headers_complete_sym = String::New("onHeadersComplete");
   on_body_sym             = String::New("onBody");
@@ -578,6 +1289,7 @@ void InitHttpParser(Handle<Object> target) {
   should_keep_alive_sym = String::New("shouldKeepAlive");
   upgrade_sym = String::New("upgrade");
   headers_sym = String::New("headers");
+  raw_headers_sym = String::New("rawHeaders");
   url_sym = String::New("url");
 
   settings.on_message_begin    = Parser::on_message_begin;
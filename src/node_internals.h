@@ -79,6 +79,15 @@ inline v8::Local<TypeName> PersistentToLocal(
     v8::Isolate* isolate,
     const v8::Persistent<TypeName>& persistent);
 
+// Like MakeCallback() but for callbacks that tend to come in bunches, like
+// completed fs requests. The nextTick queue is processed once for the whole
+// bunch, see src/node.cc.
+v8::Handle<v8::Value> MakeBatchedCallback(
+    const v8::Handle<v8::Object> object,
+    const v8::Handle<v8::String> symbol,
+    int argc,
+    v8::Handle<v8::Value>* argv);
+
 template <typename TypeName>
 v8::Handle<v8::Value> MakeCallback(
     const v8::Persistent<v8::Object>& recv,
@@ -0,0 +1,544 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Binary message format for the child_process IPC channel, see setupChannel()
+// in lib/child_process.js. serialize() turns a message into a frame: a 32 bits
+// little endian length followed by the encoded value. Buffers are copied as
+// they are and strings in V8's own representation, so nothing needs to be
+// converted to and from UTF-8 or scanned for a delimiter. Both ends of the
+// channel run on the same machine, numbers and two-byte strings are in host
+// byte order.
+//
+// The encoding follows JSON.stringify(): toJSON() is called, functions and
+// undefined values are left out of objects and become null in arrays, and
+// only own enumerable properties are sent. Differences: buffers come out as
+// buffers and NaN and the infinities are preserved.
+
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "node_serializer.h"
+#include "v8.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+namespace node {
+namespace serializer {
+
+using v8::Array;
+using v8::Boolean;
+using v8::BooleanObject;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::Handle;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Null;
+using v8::Number;
+using v8::NumberObject;
+using v8::Object;
+using v8::String;
+using v8::StringObject;
+using v8::Value;
+
+enum Tag {
+  kNull = 0,
+  kTrue,
+  kFalse,
+  kInt32,
+  kDouble,
+  kOneByteString,
+  kTwoByteString,
+  kBuffer,
+  kArray,
+  kObject
+};
+
+static const size_t kHeaderSize = 4;
+static const int kMaxDepth = 1000;
+
+static Cached<String> to_json_sym;
+
+
+class Serializer {
+ public:
+  // The frame starts `offset` bytes into the block, see SerializeFrame().
+  explicit Serializer(size_t offset)
+      : data_(NULL), start_(offset), length_(offset), capacity_(0) {
+  }
+
+  ~Serializer() {
+    delete[] data_;
+  }
+
+  // Returns false if an exception has been thrown.
+  bool WriteFrame(Handle<Value> value) {
+    if (!Reserve(kHeaderSize))
+      return false;
+    length_ += kHeaderSize;
+    if (!WriteValue(value, 0))
+      return false;
+    size_t size = frame_length() - kHeaderSize;
+    if (size > Buffer::kMaxLength)
+      return Fail("Message too large");
+    // The header is read back from JS with readUInt32LE().
+    char* header = data_ + start_;
+    header[0] = size & 0xff;
+    header[1] = (size >> 8) & 0xff;
+    header[2] = (size >> 16) & 0xff;
+    header[3] = (size >> 24) & 0xff;
+    return true;
+  }
+
+  size_t frame_length() const {
+    return length_ - start_;
+  }
+
+  // Hands the block over to the caller.
+  char* Release() {
+    char* data = data_;
+    data_ = NULL;
+    return data;
+  }
+
+ private:
+  bool Fail(const char* message) {
+    ThrowTypeError(message);
+    return false;
+  }
+
+  // Grows the block the way realloc() would, it's allocated with new[] so
+  // that callers can free it together with what they put in front of it.
+  bool Reserve(size_t size) {
+    if (data_ != NULL && capacity_ - length_ >= size)
+      return true;
+    size_t capacity = capacity_ > 0 ? capacity_ : start_ + 256;
+    while (capacity - length_ < size)
+      capacity *= 2;
+    char* data = new(std::nothrow) char[capacity];
+    if (data == NULL)
+      return Fail("Out of memory");
+    if (data_ != NULL)
+      memcpy(data, data_, length_);
+    delete[] data_;
+    data_ = data;
+    capacity_ = capacity;
+    return true;
+  }
+
+  bool WriteTag(Tag tag) {
+    if (!Reserve(1))
+      return false;
+    data_[length_++] = static_cast<char>(tag);
+    return true;
+  }
+
+  bool WriteBytes(const void* data, size_t size) {
+    if (!Reserve(size))
+      return false;
+    memcpy(data_ + length_, data, size);
+    length_ += size;
+    return true;
+  }
+
+  bool WriteUint32(uint32_t value) {
+    return WriteBytes(&value, sizeof(value));
+  }
+
+  void PatchUint32(size_t offset, uint32_t value) {
+    memcpy(data_ + offset, &value, sizeof(value));
+  }
+
+  bool WriteString(Handle<String> string) {
+    int length = string->Length();
+    if (string->IsOneByte()) {
+      if (!WriteTag(kOneByteString) || !WriteUint32(length) ||
+          !Reserve(length)) {
+        return false;
+      }
+      string->WriteOneByte(reinterpret_cast<uint8_t*>(data_ + length_),
+                           0,
+                           length,
+                           String::NO_NULL_TERMINATION);
+      length_ += length;
+    } else {
+      size_t size = length * sizeof(uint16_t);
+      if (!WriteTag(kTwoByteString) || !WriteUint32(length) || !Reserve(size))
+        return false;
+      // The destination may not be aligned.
+      uint16_t stack[256];
+      uint16_t* chars = stack;
+      if (length > static_cast<int>(ARRAY_SIZE(stack)))
+        chars = new uint16_t[length];
+      string->Write(chars, 0, length, String::NO_NULL_TERMINATION);
+      memcpy(data_ + length_, chars, size);
+      length_ += size;
+      if (chars != stack)
+        delete[] chars;
+    }
+    return true;
+  }
+
+  // Whether JSON.stringify() would drop the value from an object.
+  static bool IsSkipped(Handle<Value> value) {
+    return value->IsUndefined() || value->IsFunction();
+  }
+
+  bool WriteValue(Handle<Value> value, int depth) {
+    if (value->IsString())
+      return WriteString(value.As<String>());
+
+    if (value->IsInt32()) {
+      int32_t n = value->Int32Value();
+      return WriteTag(kInt32) && WriteBytes(&n, sizeof(n));
+    }
+
+    if (value->IsNumber()) {
+      double n = value->NumberValue();
+      return WriteTag(kDouble) && WriteBytes(&n, sizeof(n));
+    }
+
+    if (value->IsTrue())
+      return WriteTag(kTrue);
+
+    if (value->IsFalse())
+      return WriteTag(kFalse);
+
+    if (!value->IsObject() || value->IsFunction())
+      return WriteTag(kNull);
+
+    if (++depth > kMaxDepth)
+      return Fail("Converting circular structure or nesting too deep");
+
+    HandleScope scope(node_isolate);
+    Local<Object> object = value.As<Object>();
+
+    if (Buffer::HasInstance(object)) {
+      size_t size = Buffer::Length(object);
+      return WriteTag(kBuffer) &&
+             WriteUint32(size) &&
+             WriteBytes(Buffer::Data(object), size);
+    }
+
+    Local<Value> to_json = object->Get(to_json_sym);
+    if (to_json->IsFunction()) {
+      Local<Value> result = to_json.As<Function>()->Call(object, 0, NULL);
+      if (result.IsEmpty())
+        return false;
+      return WriteValue(result, depth);
+    }
+
+    if (object->IsNumberObject())
+      return WriteValue(Number::New(object.As<NumberObject>()->NumberValue()),
+                        depth);
+    if (object->IsStringObject())
+      return WriteString(object.As<StringObject>()->StringValue());
+    if (object->IsBooleanObject())
+      return WriteTag(object.As<BooleanObject>()->BooleanValue() ? kTrue
+                                                                 : kFalse);
+
+    if (object->IsArray()) {
+      Local<Array> array = object.As<Array>();
+      uint32_t length = array->Length();
+      if (!WriteTag(kArray) || !WriteUint32(length))
+        return false;
+      for (uint32_t i = 0; i < length; i++) {
+        Local<Value> element = array->Get(i);
+        if (element.IsEmpty())
+          return false;
+        if (IsSkipped(element)) {
+          if (!WriteTag(kNull))
+            return false;
+        } else if (!WriteValue(element, depth)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    Local<Array> keys = object->GetOwnPropertyNames();
+    uint32_t length = keys->Length();
+    if (!WriteTag(kObject))
+      return false;
+    size_t count_offset = length_;
+    if (!WriteUint32(0))
+      return false;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> key = keys->Get(i);
+      Local<Value> property = object->Get(key);
+      if (property.IsEmpty())
+        return false;
+      if (IsSkipped(property))
+        continue;
+      if (!WriteString(key->ToString()) || !WriteValue(property, depth))
+        return false;
+      count++;
+    }
+    PatchUint32(count_offset, count);
+    return true;
+  }
+
+  char* data_;
+  size_t start_;
+  size_t length_;
+  size_t capacity_;
+};
+
+
+class Deserializer {
+ public:
+  Deserializer(const char* data, size_t length)
+      : data_(data), length_(length), offset_(0) {
+  }
+
+  // Returns an empty handle if the data is malformed. Nothing is thrown, the
+  // ring reads frames from a uv_poll callback where no JS is on the stack.
+  Local<Value> ReadValue(int depth) {
+    uint8_t tag;
+    if (!ReadBytes(&tag, sizeof(tag)))
+      return Local<Value>();
+
+    switch (tag) {
+      case kNull:
+        return Null(node_isolate);
+      case kTrue:
+        return True(node_isolate);
+      case kFalse:
+        return False(node_isolate);
+      case kInt32: {
+        int32_t n;
+        if (!ReadBytes(&n, sizeof(n)))
+          return Local<Value>();
+        return Integer::New(n, node_isolate);
+      }
+      case kDouble: {
+        double n;
+        if (!ReadBytes(&n, sizeof(n)))
+          return Local<Value>();
+        return Number::New(n);
+      }
+      case kOneByteString:
+      case kTwoByteString:
+        return ReadString(tag, String::kNormalString);
+      case kBuffer: {
+        uint32_t size;
+        if (!ReadUint32(&size) || !Available(size))
+          return Local<Value>();
+        Local<Object> buf = Buffer::New(data_ + offset_, size);
+        offset_ += size;
+        return buf;
+      }
+      case kArray:
+        return ReadArray(depth + 1);
+      case kObject:
+        return ReadObject(depth + 1);
+      default:
+        return Fail();
+    }
+  }
+
+  bool AtEnd() const {
+    return offset_ == length_;
+  }
+
+  Local<Value> Fail() {
+    return Local<Value>();
+  }
+
+ private:
+  bool Available(size_t size) {
+    return length_ - offset_ >= size;
+  }
+
+  bool ReadBytes(void* dest, size_t size) {
+    if (!Available(size))
+      return false;
+    memcpy(dest, data_ + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool ReadUint32(uint32_t* value) {
+    return ReadBytes(value, sizeof(*value));
+  }
+
+  Local<Value> ReadString(uint8_t tag, String::NewStringType type) {
+    uint32_t length;
+    if (!ReadUint32(&length))
+      return Local<Value>();
+
+    if (tag == kOneByteString) {
+      if (!Available(length))
+        return Local<Value>();
+      const uint8_t* chars = reinterpret_cast<const uint8_t*>(data_ + offset_);
+      offset_ += length;
+      return String::NewFromOneByte(node_isolate, chars, type, length);
+    }
+
+    size_t size = length * sizeof(uint16_t);
+    if (size / sizeof(uint16_t) != length || !Available(size))
+      return Local<Value>();
+    const char* start = data_ + offset_;
+    offset_ += size;
+
+    if (reinterpret_cast<uintptr_t>(start) % sizeof(uint16_t) == 0) {
+      const uint16_t* chars = reinterpret_cast<const uint16_t*>(start);
+      return String::NewFromTwoByte(node_isolate, chars, type, length);
+    }
+
+    uint16_t* chars = new uint16_t[length];
+    memcpy(chars, start, size);
+    Local<String> string =
+        String::NewFromTwoByte(node_isolate, chars, type, length);
+    delete[] chars;
+    return string;
+  }
+
+  Local<Value> ReadArray(int depth) {
+    uint32_t length;
+    if (depth > kMaxDepth || !ReadUint32(&length))
+      return Fail();
+    // Every element takes at least one byte.
+    if (!Available(length))
+      return Local<Value>();
+
+    Local<Array> array = Array::New(length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> element = ReadValue(depth);
+      if (element.IsEmpty())
+        return Local<Value>();
+      array->Set(i, element);
+    }
+    return array;
+  }
+
+  Local<Value> ReadObject(int depth) {
+    uint32_t count;
+    if (depth > kMaxDepth || !ReadUint32(&count))
+      return Fail();
+
+    Local<Object> object = Object::New();
+    for (uint32_t i = 0; i < count; i++) {
+      uint8_t tag;
+      if (!ReadBytes(&tag, sizeof(tag)))
+        return Local<Value>();
+      if (tag != kOneByteString && tag != kTwoByteString)
+        return Fail();
+      // Property names repeat from one message to the next.
+      Local<Value> key = ReadString(tag, String::kInternalizedString);
+      if (key.IsEmpty())
+        return Local<Value>();
+      Local<Value> value = ReadValue(depth);
+      if (value.IsEmpty())
+        return Local<Value>();
+      object->Set(key, value);
+    }
+    return object;
+  }
+
+  const char* data_;
+  size_t length_;
+  size_t offset_;
+};
+
+
+char* SerializeFrame(Handle<Value> value, size_t offset, size_t* length) {
+  // Callers from other modules may get here before Initialize() ran.
+  if (to_json_sym.IsEmpty())
+    to_json_sym = String::New("toJSON");
+
+  Serializer serializer(offset);
+  if (!serializer.WriteFrame(value))
+    return NULL;
+  *length = serializer.frame_length();
+  return serializer.Release();
+}
+
+
+Local<Value> DeserializeFrame(const char* data, size_t length) {
+  Deserializer deserializer(data, length);
+  Local<Value> value = deserializer.ReadValue(0);
+  if (value.IsEmpty())
+    return value;
+  if (!deserializer.AtEnd())
+    return deserializer.Fail();
+  return value;
+}
+
+
+// serialize(message) returns a buffer with the frame for `message`. The IPC
+// channel doesn't use it, it serializes straight into the write request with
+// StreamWrap::WriteMessage().
+static void Serialize(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  Serializer serializer(0);
+  if (serializer.WriteFrame(args[0])) {
+    const char* data = serializer.Release();
+    args.GetReturnValue().Set(
+        Buffer::New(data, serializer.frame_length()));
+    delete[] data;
+  }
+}
+
+
+// deserialize(buffer, offset, length) decodes the value of the frame whose
+// body starts at `offset`.
+static void Deserialize(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  if (!Buffer::HasInstance(args[0]))
+    return ThrowTypeError("Argument must be a buffer");
+
+  Local<Object> buf = args[0].As<Object>();
+  size_t buffer_length = Buffer::Length(buf);
+  size_t offset = args[1]->Uint32Value();
+  size_t length = args[2]->Uint32Value();
+  if (offset > buffer_length || length > buffer_length - offset)
+    return ThrowRangeError("Frame extends beyond buffer");
+
+  Local<Value> value = DeserializeFrame(Buffer::Data(buf) + offset, length);
+  if (value.IsEmpty())
+    return ThrowError("Malformed IPC message");
+  args.GetReturnValue().Set(value);
+}
+
+
+void Initialize(Handle<Object> target) {
+  HandleScope scope(node_isolate);
+
+  to_json_sym = String::New("toJSON");
+
+  target->Set(String::NewSymbol("headerSize"),
+              Integer::New(kHeaderSize, node_isolate));
+  NODE_SET_METHOD(target, "serialize", Serialize);
+  NODE_SET_METHOD(target, "deserialize", Deserialize);
+}
+
+
+}  // namespace serializer
+}  // namespace node
+
+NODE_MODULE(node_serializer, node::serializer::Initialize)
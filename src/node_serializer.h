@@ -0,0 +1,49 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_NODE_SERIALIZER_H_
+#define SRC_NODE_SERIALIZER_H_
+
+#include "v8.h"
+
+#include <stddef.h>
+
+namespace node {
+namespace serializer {
+
+// Encodes `value` as an IPC frame, see node_serializer.cc. The frame starts
+// `offset` bytes into a block allocated with new char[] that the caller
+// owns, so that e.g. a write request can be placed in front of it. Returns
+// NULL with an exception pending when `value` can't be serialized.
+char* SerializeFrame(v8::Handle<v8::Value> value,
+                     size_t offset,
+                     size_t* length);
+
+// Decodes the body of a frame, `length` bytes at `data`. Returns an empty
+// handle when the frame is malformed, without throwing.
+v8::Local<v8::Value> DeserializeFrame(const char* data, size_t length);
+
+void Initialize(v8::Handle<v8::Object> target);
+
+}  // namespace serializer
+}  // namespace node
+
+#endif  // SRC_NODE_SERIALIZER_H_
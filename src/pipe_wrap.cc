@@ -105,6 +105,12 @@ void PipeWrap::Initialize(Handle<Object> target) {
                             StreamWrap::WriteAsciiString);
   NODE_SET_PROTOTYPE_METHOD(t, "writeUtf8String", StreamWrap::WriteUtf8String);
   NODE_SET_PROTOTYPE_METHOD(t, "writeUcs2String", StreamWrap::WriteUcs2String);
+  NODE_SET_PROTOTYPE_METHOD(t, "writeMessage", StreamWrap::WriteMessage);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendFile", StreamWrap::SendFile);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "setCoalesceWrites",
+                            StreamWrap::SetCoalesceWrites);
+  NODE_SET_PROTOTYPE_METHOD(t, "flushWrites", StreamWrap::FlushWrites);
 
   NODE_SET_PROTOTYPE_METHOD(t, "bind", Bind);
   NODE_SET_PROTOTYPE_METHOD(t, "listen", Listen);
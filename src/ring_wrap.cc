@@ -0,0 +1,740 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Shared memory transport between the cluster master and a worker, see
+// setupRing() in lib/cluster.js. The master creates a segment with two
+// single producer, single consumer rings, one for each direction, and hands
+// it to the worker together with two wakeup file descriptors, eventfds on
+// Linux and pipes elsewhere. Messages are encoded by the IPC serializer
+// (node_serializer.cc) and copied straight into the ring. The consumer only
+// needs a wakeup when it ran out of messages and went back to its event loop,
+// it says so with a flag in the segment. As long as it is busy, messages
+// are passed without a system call on either side.
+//
+// Positions in a ring are free running 32 bits byte counters. A record is a
+// serializer frame, a 32 bits little endian length and the body, padded to a
+// multiple of 4 bytes. Records don't wrap around the end of the ring: when
+// one doesn't fit, the producer writes kWrapMarker and starts over at the
+// beginning, so that the consumer can decode messages where they are.
+
+#include "node.h"
+#include "node_internals.h"
+#include "node_serializer.h"
+#include "handle_wrap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#endif
+
+namespace node {
+
+using v8::Array;
+using v8::Exception;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Handle;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+static Cached<String> onmessage_sym;
+static Cached<String> onerror_sym;
+
+static const uint32_t kMagic = 0x676e6972;  // "ring"
+static const uint32_t kWrapMarker = 0xffffffff;
+static const uint32_t kMinCapacity = 4096;
+static const uint32_t kMaxCapacity = 1 << 30;
+// Upper bound on the number of messages passed to JS in one callback.
+static const uint32_t kMaxBatch = 1024;
+
+// The fields that the two sides write each get a cache line of their own.
+struct RingControl {
+  volatile uint32_t head;  // Advanced by the consumer.
+  char pad0[60];
+  volatile uint32_t tail;  // Advanced by the producer.
+  char pad1[60];
+  // Set by the consumer when it needs a wakeup for new messages.
+  volatile uint32_t consumer_waiting;
+  char pad2[60];
+  // Set by the producer when it needs a wakeup for free space.
+  volatile uint32_t producer_waiting;
+  char pad3[60];
+};
+
+// The rings' data follow the header, rings[0] is master to worker.
+struct Segment {
+  uint32_t magic;
+  uint32_t capacity;  // Of each ring, a power of two.
+  char pad[56];
+  RingControl rings[2];
+};
+
+// A message that didn't fit in the ring yet. The frame follows the struct.
+struct PendingFrame {
+  PendingFrame* next;
+  size_t length;
+};
+
+
+static inline uint32_t RecordSize(size_t frame_length) {
+  return (frame_length + 3) & ~3;
+}
+
+
+class RingWrap: public HandleWrap {
+ public:
+  static void Initialize(Handle<Object> target);
+
+ private:
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Create(const FunctionCallbackInfo<Value>& args);
+  static void Open(const FunctionCallbackInfo<Value>& args);
+  static void CloseChildFds(const FunctionCallbackInfo<Value>& args);
+  static void ReadStart(const FunctionCallbackInfo<Value>& args);
+  static void Drain(const FunctionCallbackInfo<Value>& args);
+  static void WriteMessage(const FunctionCallbackInfo<Value>& args);
+  static void Close(const FunctionCallbackInfo<Value>& args);
+
+  explicit RingWrap(Handle<Object> object);
+  virtual ~RingWrap();
+
+  int Map(int fd, size_t size);
+  void Attach(int side);
+  void Release();
+  int InitPoll();
+  bool Push(const char* frame, size_t length);
+  void Flush();
+  void Notify();
+  void Wake();
+  void Receive();
+  static void OnPoll(uv_poll_t* handle, int status, int events);
+
+  uv_poll_t handle_;
+  bool initialized_;
+  Segment* segment_;
+  size_t segment_size_;
+  RingControl* out_;
+  RingControl* in_;
+  char* out_data_;
+  char* in_data_;
+  uint32_t capacity_;
+  int wait_fd_;
+  int wake_fd_;
+  // File descriptors for the worker, closed once it has been spawned.
+  int child_fds_[3];
+  PendingFrame* pending_head_;
+  PendingFrame* pending_tail_;
+};
+
+
+RingWrap::RingWrap(Handle<Object> object)
+    : HandleWrap(object, reinterpret_cast<uv_handle_t*>(&handle_)),
+      initialized_(false),
+      segment_(NULL),
+      segment_size_(0),
+      out_(NULL),
+      in_(NULL),
+      out_data_(NULL),
+      in_data_(NULL),
+      capacity_(0),
+      wait_fd_(-1),
+      wake_fd_(-1),
+      pending_head_(NULL),
+      pending_tail_(NULL) {
+  for (size_t i = 0; i < ARRAY_SIZE(child_fds_); i++)
+    child_fds_[i] = -1;
+}
+
+
+RingWrap::~RingWrap() {
+  assert(initialized_ == false);
+  Release();
+}
+
+
+// Unmaps the segment and closes the file descriptors.
+void RingWrap::Release() {
+  while (pending_head_ != NULL) {
+    PendingFrame* pending = pending_head_;
+    pending_head_ = pending->next;
+    delete[] reinterpret_cast<char*>(pending);
+  }
+  pending_tail_ = NULL;
+#ifndef _WIN32
+  if (segment_ != NULL)
+    munmap(segment_, segment_size_);
+  segment_ = NULL;
+  if (wait_fd_ != -1)
+    close(wait_fd_);
+  if (wake_fd_ != -1)
+    close(wake_fd_);
+  wait_fd_ = wake_fd_ = -1;
+  for (size_t i = 0; i < ARRAY_SIZE(child_fds_); i++) {
+    if (child_fds_[i] != -1)
+      close(child_fds_[i]);
+    child_fds_[i] = -1;
+  }
+#endif
+}
+
+
+void RingWrap::Initialize(Handle<Object> target) {
+  HandleWrap::Initialize(target);
+
+  HandleScope scope(node_isolate);
+
+  Local<FunctionTemplate> t = FunctionTemplate::New(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(String::NewSymbol("Ring"));
+
+  NODE_SET_PROTOTYPE_METHOD(t, "create", Create);
+  NODE_SET_PROTOTYPE_METHOD(t, "open", Open);
+  NODE_SET_PROTOTYPE_METHOD(t, "closeChildFds", CloseChildFds);
+  NODE_SET_PROTOTYPE_METHOD(t, "readStart", ReadStart);
+  NODE_SET_PROTOTYPE_METHOD(t, "drain", Drain);
+  NODE_SET_PROTOTYPE_METHOD(t, "writeMessage", WriteMessage);
+  NODE_SET_PROTOTYPE_METHOD(t, "close", Close);
+  NODE_SET_PROTOTYPE_METHOD(t, "ref", HandleWrap::Ref);
+  NODE_SET_PROTOTYPE_METHOD(t, "unref", HandleWrap::Unref);
+
+  target->Set(String::New("Ring"), t->GetFunction());
+
+  onmessage_sym = String::New("onmessage");
+  onerror_sym = String::New("onerror");
+}
+
+
+void RingWrap::New(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+  assert(args.IsConstructCall());
+  new RingWrap(args.This());
+}
+
+
+#ifndef _WIN32
+
+static int SetCloexec(int fd) {
+  int flags = fcntl(fd, F_GETFD);
+  if (flags == -1 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1)
+    return -errno;
+  return 0;
+}
+
+
+static int SetNonblock(int fd) {
+  int flags = fcntl(fd, F_GETFL);
+  if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+    return -errno;
+  return 0;
+}
+
+
+// An anonymous memfd where available, an unlinked file on tmpfs otherwise.
+static int CreateSharedMemory(size_t size) {
+  int fd = -1;
+#if defined(__linux__) && defined(__NR_memfd_create)
+  fd = syscall(__NR_memfd_create, "node-ring", 1 /* MFD_CLOEXEC */);
+#endif
+  static const char* const dirs[] = { "/dev/shm", "/tmp" };
+  for (size_t i = 0; fd == -1 && i < ARRAY_SIZE(dirs); i++) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s/node-ring-XXXXXX", dirs[i]);
+    fd = mkstemp(path);
+    if (fd != -1) {
+      unlink(path);
+      SetCloexec(fd);
+    }
+  }
+  if (fd == -1)
+    return -errno;
+
+  if (ftruncate(fd, size)) {
+    int err = -errno;
+    close(fd);
+    return err;
+  }
+  return fd;
+}
+
+
+// A pair of wakeup file descriptors, the first one is polled and the second
+// one written to. They are the same eventfd on Linux.
+static int CreateWakeup(int fds[2]) {
+#if defined(__linux__)
+  int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fd != -1) {
+    fds[0] = fds[1] = fd;
+    return 0;
+  }
+#endif
+  if (pipe(fds))
+    return -errno;
+  SetCloexec(fds[0]);
+  SetCloexec(fds[1]);
+  SetNonblock(fds[0]);
+  SetNonblock(fds[1]);
+  return 0;
+}
+
+
+int RingWrap::Map(int fd, size_t size) {
+  void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED)
+    return -errno;
+  segment_ = static_cast<Segment*>(p);
+  segment_size_ = size;
+  return 0;
+}
+
+
+// Side 0 is the master, side 1 the worker.
+void RingWrap::Attach(int side) {
+  capacity_ = segment_->capacity;
+  char* data = reinterpret_cast<char*>(segment_ + 1);
+  out_ = &segment_->rings[side];
+  in_ = &segment_->rings[1 - side];
+  out_data_ = data + side * capacity_;
+  in_data_ = data + (1 - side) * capacity_;
+}
+
+
+int RingWrap::InitPoll() {
+  int err = uv_poll_init(uv_default_loop(), &handle_, wait_fd_);
+  if (err)
+    return err;
+  // The IPC channel decides how long the process stays alive.
+  uv_unref(reinterpret_cast<uv_handle_t*>(&handle_));
+  initialized_ = true;
+  return 0;
+}
+
+
+// Copies a frame into the ring. Returns false if there's no room for it.
+bool RingWrap::Push(const char* frame, size_t length) {
+  uint32_t record = RecordSize(length);
+  uint32_t tail = out_->tail;
+  uint32_t head = out_->head;
+  // Don't overwrite what the consumer may still be reading.
+  __sync_synchronize();
+
+  uint32_t offset = tail & (capacity_ - 1);
+  uint32_t contiguous = capacity_ - offset;
+  uint32_t needed = record <= contiguous ? record : contiguous + record;
+  if (capacity_ - (tail - head) < needed)
+    return false;
+
+  if (record > contiguous) {
+    memcpy(out_data_ + offset, &kWrapMarker, sizeof(kWrapMarker));
+    tail += contiguous;
+    offset = 0;
+  }
+  memcpy(out_data_ + offset, frame, length);
+
+  // The record has to be visible before the new tail.
+  __sync_synchronize();
+  out_->tail = tail + record;
+  return true;
+}
+
+
+// Moves queued frames into the ring, as far as they fit.
+void RingWrap::Flush() {
+  bool pushed = false;
+  while (pending_head_ != NULL) {
+    PendingFrame* pending = pending_head_;
+    if (!Push(reinterpret_cast<char*>(pending + 1), pending->length)) {
+      // Ask for a wakeup, then check again in case the consumer made room
+      // before it could see the flag.
+      out_->producer_waiting = 1;
+      __sync_synchronize();
+      if (!Push(reinterpret_cast<char*>(pending + 1), pending->length))
+        break;
+    }
+    pending_head_ = pending->next;
+    delete[] reinterpret_cast<char*>(pending);
+    pushed = true;
+  }
+  if (pending_head_ == NULL)
+    pending_tail_ = NULL;
+  if (pushed)
+    Notify();
+}
+
+
+// Wakes up the consumer if it's waiting for messages.
+void RingWrap::Notify() {
+  __sync_synchronize();
+  if (out_->consumer_waiting &&
+      __sync_bool_compare_and_swap(&out_->consumer_waiting, 1, 0)) {
+    Wake();
+  }
+}
+
+
+void RingWrap::Wake() {
+  // Eight bytes for an eventfd, a pipe takes anything.
+  uint64_t value = 1;
+  ssize_t r;
+  do
+    r = write(wake_fd_, &value, sizeof(value));
+  while (r == -1 && errno == EINTR);
+  // EAGAIN means that the peer has wakeups pending already, EPIPE that it
+  // is gone.
+}
+
+
+void RingWrap::Receive() {
+  HandleScope scope(node_isolate);
+
+  for (;;) {
+    in_->consumer_waiting = 0;
+
+    Local<Array> messages = Array::New();
+    Local<Value> error;
+    uint32_t count = 0;
+    uint32_t head = in_->head;
+    uint32_t tail = in_->tail;
+    // Don't read records before the tail that covers them.
+    __sync_synchronize();
+
+    while (head != tail && count < kMaxBatch) {
+      uint32_t offset = head & (capacity_ - 1);
+      const unsigned char* p =
+          reinterpret_cast<const unsigned char*>(in_data_ + offset);
+      uint32_t length = p[0] | (p[1] << 8) | (p[2] << 16) |
+                        (static_cast<uint32_t>(p[3]) << 24);
+      if (length == kWrapMarker) {
+        head += capacity_ - offset;
+        continue;
+      }
+      // A bad length leaves no telling where the next record starts, a bad
+      // frame is skipped.
+      Local<Value> message;
+      if (length <= capacity_ - offset - sizeof(length)) {
+        message = serializer::DeserializeFrame(
+            in_data_ + offset + sizeof(length), length);
+        head += RecordSize(sizeof(length) + length);
+      }
+      if (message.IsEmpty()) {
+        error = Exception::Error(String::New("Malformed IPC message"));
+        break;
+      }
+      messages->Set(count++, message);
+    }
+
+    // The messages have been copied out, the producer may reuse the space.
+    __sync_synchronize();
+    in_->head = head;
+    __sync_synchronize();
+    if (in_->producer_waiting &&
+        __sync_bool_compare_and_swap(&in_->producer_waiting, 1, 0)) {
+      Wake();
+    }
+
+    if (count > 0) {
+      Local<Value> argv[] = { messages };
+      MakeCallback(object(), onmessage_sym, ARRAY_SIZE(argv), argv);
+      if (!initialized_)
+        return;  // Closed by the callback.
+    }
+
+    // The messages before the bad one have been delivered. Stop reading, the
+    // ring can't be trusted anymore, and let JS fall back to the IPC channel.
+    if (!error.IsEmpty()) {
+      uv_poll_stop(&handle_);
+      Local<Value> argv[] = { error };
+      MakeCallback(object(), onerror_sym, ARRAY_SIZE(argv), argv);
+      return;
+    }
+
+    if (head != tail)
+      continue;  // The batch was full.
+
+    // Ask for a wakeup, then check for messages that came in before the
+    // producer could see the flag.
+    in_->consumer_waiting = 1;
+    __sync_synchronize();
+    if (in_->tail == head)
+      return;
+  }
+}
+
+
+void RingWrap::OnPoll(uv_poll_t* handle, int status, int events) {
+  RingWrap* wrap = static_cast<RingWrap*>(handle->data);
+  assert(wrap->persistent().IsEmpty() == false);
+
+  char buf[64];
+  ssize_t r;
+  do
+    r = read(wrap->wait_fd_, buf, sizeof(buf));
+  while (r > 0 || (r == -1 && errno == EINTR));
+
+  wrap->Flush();
+  wrap->Receive();
+}
+
+#endif  // !_WIN32
+
+
+// create(size, fds) sets up a new segment with rings of `size` bytes. The
+// file descriptors that the worker needs are stored in `fds`.
+void RingWrap::Create(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(RingWrap)
+
+  assert(wrap->segment_ == NULL);
+  assert(args[1]->IsArray());
+
+#ifdef _WIN32
+  args.GetReturnValue().Set(UV_ENOSYS);
+#else
+  uint32_t size = args[0]->Uint32Value();
+  uint32_t capacity = kMinCapacity;
+  while (capacity < size && capacity < kMaxCapacity)
+    capacity *= 2;
+
+  size_t segment_size = sizeof(Segment) + 2 * static_cast<size_t>(capacity);
+  int master_wakeup[2] = { -1, -1 };
+  int worker_wakeup[2] = { -1, -1 };
+  int shm_fd = CreateSharedMemory(segment_size);
+  int err = shm_fd < 0 ? shm_fd : 0;
+  if (err == 0)
+    err = CreateWakeup(master_wakeup);
+  if (err == 0)
+    err = CreateWakeup(worker_wakeup);
+
+  // The master polls its own wakeup descriptor and writes to the worker's.
+  // The other ends are closed after the spawn, unless they are the same
+  // eventfd.
+  wrap->wait_fd_ = master_wakeup[0];
+  wrap->wake_fd_ = worker_wakeup[1];
+  wrap->child_fds_[0] = shm_fd < 0 ? -1 : shm_fd;
+  if (worker_wakeup[0] != worker_wakeup[1])
+    wrap->child_fds_[1] = worker_wakeup[0];
+  if (master_wakeup[1] != master_wakeup[0])
+    wrap->child_fds_[2] = master_wakeup[1];
+
+  if (err == 0) {
+    err = wrap->Map(shm_fd, segment_size);
+    if (err == 0) {
+      Segment* segment = wrap->segment_;
+      segment->magic = kMagic;
+      segment->capacity = capacity;
+      // Nobody has read anything yet, the first message wakes the consumer.
+      segment->rings[0].consumer_waiting = 1;
+      segment->rings[1].consumer_waiting = 1;
+      wrap->Attach(0);
+    }
+  }
+  if (err == 0)
+    err = wrap->InitPoll();
+
+  if (err == 0) {
+    Local<Array> fds = args[1].As<Array>();
+    fds->Set(0, Integer::New(shm_fd, node_isolate));
+    fds->Set(1, Integer::New(worker_wakeup[0], node_isolate));
+    fds->Set(2, Integer::New(master_wakeup[1], node_isolate));
+  } else {
+    wrap->Release();
+  }
+
+  args.GetReturnValue().Set(err);
+#endif
+}
+
+
+// open(shmFd, waitFd, wakeFd) attaches to a segment made by create(), on the
+// worker side.
+void RingWrap::Open(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(RingWrap)
+
+  assert(wrap->segment_ == NULL);
+
+#ifdef _WIN32
+  args.GetReturnValue().Set(UV_ENOSYS);
+#else
+  int shm_fd = args[0]->Int32Value();
+  wrap->wait_fd_ = args[1]->Int32Value();
+  wrap->wake_fd_ = args[2]->Int32Value();
+  // Inherited without O_CLOEXEC, don't pass them on to our own children.
+  SetCloexec(wrap->wait_fd_);
+  SetCloexec(wrap->wake_fd_);
+
+  struct stat s;
+  int err = 0;
+  if (fstat(shm_fd, &s))
+    err = -errno;
+  else if (static_cast<size_t>(s.st_size) < sizeof(Segment))
+    err = UV_EINVAL;
+  if (err == 0)
+    err = wrap->Map(shm_fd, s.st_size);
+  close(shm_fd);
+
+  if (err == 0) {
+    Segment* segment = wrap->segment_;
+    uint32_t capacity = segment->capacity;
+    if (segment->magic != kMagic ||
+        capacity < kMinCapacity ||
+        (capacity & (capacity - 1)) != 0 ||
+        wrap->segment_size_ != sizeof(Segment) + 2 * static_cast<size_t>(
+            capacity)) {
+      err = UV_EINVAL;
+    } else {
+      wrap->Attach(1);
+    }
+  }
+  if (err == 0)
+    err = wrap->InitPoll();
+  if (err)
+    wrap->Release();
+
+  args.GetReturnValue().Set(err);
+#endif
+}
+
+
+void RingWrap::CloseChildFds(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(RingWrap)
+
+#ifndef _WIN32
+  for (size_t i = 0; i < ARRAY_SIZE(wrap->child_fds_); i++) {
+    if (wrap->child_fds_[i] != -1)
+      close(wrap->child_fds_[i]);
+    wrap->child_fds_[i] = -1;
+  }
+#endif
+}
+
+
+void RingWrap::ReadStart(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(RingWrap)
+
+  assert(wrap->initialized_);
+
+#ifndef _WIN32
+  int err = uv_poll_start(&wrap->handle_, UV_READABLE, OnPoll);
+  args.GetReturnValue().Set(err);
+#endif
+}
+
+
+// drain() delivers the messages that are in the ring right now, without
+// waiting for the poll handle.
+void RingWrap::Drain(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(RingWrap)
+
+  assert(wrap->initialized_);
+
+#ifndef _WIN32
+  wrap->Receive();
+#endif
+}
+
+
+// writeMessage(message) returns true when the message went into the ring
+// and false when it was queued because the ring is full.
+void RingWrap::WriteMessage(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(RingWrap)
+
+  assert(wrap->initialized_);
+
+#ifndef _WIN32
+  size_t length;
+  char* storage = serializer::SerializeFrame(args[0],
+                                             sizeof(PendingFrame),
+                                             &length);
+  if (storage == NULL)
+    return;  // Exception pending.
+
+  // Leave room for the wrap marker, see Push().
+  if (RecordSize(length) > wrap->capacity_ / 2) {
+    delete[] storage;
+    return ThrowRangeError("Message too large for the ring");
+  }
+
+  if (wrap->pending_head_ == NULL &&
+      wrap->Push(storage + sizeof(PendingFrame), length)) {
+    delete[] storage;
+    wrap->Notify();
+
+    return args.GetReturnValue().Set(true);
+  }
+
+  PendingFrame* pending = reinterpret_cast<PendingFrame*>(storage);
+  pending->next = NULL;
+  pending->length = length;
+  if (wrap->pending_tail_ == NULL)
+    wrap->pending_head_ = pending;
+  else
+    wrap->pending_tail_->next = pending;
+  wrap->pending_tail_ = pending;
+  wrap->Flush();
+  args.GetReturnValue().Set(false);
+#endif
+}
+
+
+void RingWrap::Close(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  // Unwrap manually, see FSEventWrap::Close().
+  assert(!args.This().IsEmpty());
+  assert(args.This()->InternalFieldCount() > 0);
+  void* ptr = args.This()->GetAlignedPointerFromInternalField(0);
+  RingWrap* wrap = static_cast<RingWrap*>(ptr);
+
+  if (wrap == NULL || wrap->initialized_ == false) return;
+  wrap->initialized_ = false;
+
+  HandleWrap::Close(args);
+}
+
+}  // namespace node
+
+NODE_MODULE(node_ring_wrap, node::RingWrap::Initialize)
@@ -0,0 +1,131 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "slab_allocator.h"
+#include "node.h"
+#include "node_internals.h"
+#include "smalloc.h"
+#include "v8.h"
+
+#include <assert.h>
+#include <stdio.h>  // snprintf()
+
+namespace node {
+
+using v8::Handle;
+using v8::HandleScope;
+using v8::Local;
+using v8::Null;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+
+SlabAllocator::SlabAllocator(unsigned int size) {
+  size_ = size;
+  initialized_ = false;
+  offset_ = 0;
+  last_ptr_ = NULL;
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  if (!initialized_) return;
+  slab_.Dispose();
+  slab_sym_.Dispose();
+}
+
+
+void SlabAllocator::Initialize() {
+  HandleScope scope(node_isolate);
+  char sym[256];
+  // Keyed on the allocator so that several allocators can share an object.
+  snprintf(sym, sizeof(sym), "slab_%p", this);
+  slab_sym_.Reset(node_isolate, String::New(sym));
+  initialized_ = true;
+}
+
+
+Local<Object> SlabAllocator::NewSlab(unsigned int size) {
+  HandleScope scope(node_isolate);
+  Local<Object> slab = Object::New();
+  smalloc::Alloc(slab, size);
+  return scope.Close(slab);
+}
+
+
+char* SlabAllocator::Allocate(Handle<Object> obj, unsigned int size) {
+  HandleScope scope(node_isolate);
+
+  assert(!obj.IsEmpty());
+
+  if (size == 0)
+    return NULL;
+
+  if (!initialized_)
+    Initialize();
+
+  // Requests that don't fit in a regular slab get a slab of their own.
+  if (size > size_) {
+    Local<Object> slab = NewSlab(size);
+    obj->SetHiddenValue(PersistentToLocal(slab_sym_), slab);
+    return static_cast<char*>(slab->GetIndexedPropertiesExternalArrayData());
+  }
+
+  if (slab_.IsEmpty() || offset_ + size > size_) {
+    slab_.Dispose();
+    slab_.Reset(node_isolate, NewSlab(size_));
+    offset_ = 0;
+  }
+
+  Local<Object> slab = PersistentToLocal(slab_);
+  char* data =
+      static_cast<char*>(slab->GetIndexedPropertiesExternalArrayData());
+  obj->SetHiddenValue(PersistentToLocal(slab_sym_), slab);
+
+  last_ptr_ = data + offset_;
+  offset_ += size;
+
+  return last_ptr_;
+}
+
+
+Local<Object> SlabAllocator::Shrink(Handle<Object> obj,
+                                    char* ptr,
+                                    unsigned int size) {
+  HandleScope scope(node_isolate);
+  Local<String> slab_sym = PersistentToLocal(slab_sym_);
+  Local<Value> slab_v = obj->GetHiddenValue(slab_sym);
+  obj->SetHiddenValue(slab_sym, Null(node_isolate));
+  assert(!slab_v.IsEmpty());
+  assert(slab_v->IsObject());
+  Local<Object> slab = slab_v->ToObject();
+  assert(ptr != NULL);
+  if (ptr == last_ptr_) {
+    char* data =
+        static_cast<char*>(slab->GetIndexedPropertiesExternalArrayData());
+    last_ptr_ = NULL;
+    offset_ = ptr - data + ROUND_UP(size, 16);
+  }
+  return scope.Close(slab);
+}
+
+}  // namespace node
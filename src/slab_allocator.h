@@ -0,0 +1,69 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#include "node.h"
+#include "v8.h"
+
+namespace node {
+
+/**
+ * Carves read buffers out of large smalloc-backed slabs.
+ *
+ * Allocate() reserves a chunk at the tail of the current slab, Shrink()
+ * hands back the part of the chunk that wasn't used. The Buffers that are
+ * given to JS land are slices that reference the slab through their `parent`
+ * property, so a slab is released by the GC once the last slice is gone.
+ * Shrinking the last chunk to 0 bytes makes its room available again, which
+ * is how a caller that copies the data out reuses the slab.
+ */
+class SlabAllocator {
+ public:
+  explicit SlabAllocator(unsigned int size = 1024 * 1024);
+  ~SlabAllocator();
+
+  // Reserve `size` bytes for `obj`. The current slab is attached to `obj`
+  // until the matching Shrink() call so it can't be collected in between.
+  char* Allocate(v8::Handle<v8::Object> obj, unsigned int size);
+
+  // Return everything past the first `size` bytes of `ptr` to the slab.
+  // Returns the slab `ptr` was allocated from.
+  v8::Local<v8::Object> Shrink(v8::Handle<v8::Object> obj,
+                               char* ptr,
+                               unsigned int size);
+
+ private:
+  void Initialize();
+  v8::Local<v8::Object> NewSlab(unsigned int size);
+
+  bool initialized_;
+  v8::Persistent<v8::Object> slab_;
+  v8::Persistent<v8::String> slab_sym_;
+  unsigned int offset_;
+  unsigned int size_;
+  char* last_ptr_;
+};
+
+}  // namespace node
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
@@ -23,15 +23,22 @@
 #include "node.h"
 #include "node_buffer.h"
 #include "node_counters.h"
+#include "node_serializer.h"
 #include "handle_wrap.h"
 #include "pipe_wrap.h"
 #include "req_wrap.h"
+#include "slab_allocator.h"
 #include "tcp_wrap.h"
 #include "udp_wrap.h"
 
 #include <stdlib.h>  // abort()
+#include <string.h>  // memcpy()
 #include <limits.h>  // INT_MAX
 
+#define SLAB_SIZE (1024 * 1024)
+// Reads smaller than this are copied out of the slab, see DoRead().
+#define SLAB_MIN_SLICE (16 * 1024)
+
 
 namespace node {
 
@@ -55,9 +62,25 @@ static Cached<String> write_queue_size_sym;
 static Cached<String> onread_sym;
 static Cached<String> oncomplete_sym;
 static Cached<String> handle_sym;
+static SlabAllocator* slab_allocator;
 static bool initialized;
 
 
+// A single uv_write() carrying the buffers of several coalesced writes.
+// The WriteWraps are completed together when it finishes.
+struct WriteBatch {
+  uv_write_t req_;
+  WriteWrap** reqs_;
+  size_t count_;
+};
+
+
+static void DeleteSlabAllocator(void* arg) {
+  delete slab_allocator;
+  slab_allocator = NULL;
+}
+
+
 void StreamWrap::Initialize(Handle<Object> target) {
   if (initialized) return;
   initialized = true;
@@ -66,6 +89,9 @@ void StreamWrap::Initialize(Handle<Object> target) {
 
   HandleWrap::Initialize(target);
 
+  slab_allocator = new SlabAllocator(SLAB_SIZE);
+  AtExit(DeleteSlabAllocator, NULL);
+
   buffer_sym = String::New("buffer");
   bytes_sym = String::New("bytes");
   write_queue_size_sym = String::New("writeQueueSize");
@@ -79,6 +105,24 @@ StreamWrap::StreamWrap(Handle<Object> object, uv_stream_t* stream)
       default_callbacks_(this) {
   stream_ = stream;
   callbacks_ = &default_callbacks_;
+  coalesce_writes_ = false;
+  queued_reqs_ = NULL;
+  queued_bufs_ = NULL;
+  queued_count_ = 0;
+  queued_capacity_ = 0;
+  queued_bytes_ = 0;
+}
+
+
+StreamWrap::~StreamWrap() {
+  DiscardWriteQueue();
+  delete[] queued_reqs_;
+  delete[] queued_bufs_;
+
+  if (callbacks_ != &default_callbacks_) {
+    delete callbacks_;
+    callbacks_ = NULL;
+  }
 }
 
 
@@ -93,10 +137,13 @@ void StreamWrap::GetFD(Local<String>, const PropertyCallbackInfo<Value>& args) {
 }
 
 
+// Coalesced writes that haven't been handed to libuv yet count as well, JS
+// only applies backpressure while writeQueueSize is non-zero.
 void StreamWrap::UpdateWriteQueueSize() {
   HandleScope scope(node_isolate);
+  size_t size = stream_->write_queue_size + queued_bytes_;
   object()->Set(write_queue_size_sym,
-                Integer::New(stream_->write_queue_size, node_isolate));
+                Integer::NewFromUnsigned(size, node_isolate));
 }
 
 
@@ -204,6 +251,29 @@ size_t StreamWrap::WriteBuffer(Handle<Value> val, uv_buf_t* buf) {
 }
 
 
+// The handle to send along with a write on an IPC pipe, or NULL when
+// `handle_v` isn't one.
+static uv_stream_t* SendHandle(WriteWrap* req_wrap, Handle<Value> handle_v) {
+  if (!handle_v->IsObject())
+    return NULL;
+
+  Local<Object> send_handle_obj = handle_v->ToObject();
+  assert(send_handle_obj->InternalFieldCount() > 0);
+  HandleWrap* send_handle_wrap = static_cast<HandleWrap*>(
+      send_handle_obj->GetAlignedPointerFromInternalField(0));
+
+  // Reference StreamWrap instance to prevent it from being garbage
+  // collected before `AfterWrite` is called.
+  if (handle_sym.IsEmpty()) {
+    handle_sym = String::New("handle");
+  }
+  assert(!req_wrap->persistent().IsEmpty());
+  req_wrap->object()->Set(handle_sym, send_handle_obj);
+
+  return reinterpret_cast<uv_stream_t*>(send_handle_wrap->GetHandle());
+}
+
+
 void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(node_isolate);
 
@@ -224,11 +294,14 @@ void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   uv_buf_t buf;
   WriteBuffer(buf_obj, &buf);
 
-  int err = wrap->callbacks_->DoWrite(req_wrap,
-                                      &buf,
-                                      1,
-                                      NULL,
-                                      StreamWrap::AfterWrite);
+  int err = 0;
+  if (!wrap->QueueWrite(req_wrap, buf)) {
+    err = wrap->callbacks_->DoWrite(req_wrap,
+                                    &buf,
+                                    1,
+                                    NULL,
+                                    StreamWrap::AfterWrite);
+  }
   req_wrap->Dispatched();
   req_wrap_obj->Set(bytes_sym, Integer::NewFromUnsigned(length, node_isolate));
 
@@ -288,34 +361,19 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
                   reinterpret_cast<uv_pipe_t*>(wrap->stream_)->ipc;
 
   if (!ipc_pipe) {
-    err = wrap->callbacks_->DoWrite(req_wrap,
-                                    &buf,
-                                    1,
-                                    NULL,
-                                    StreamWrap::AfterWrite);
-  } else {
-    uv_handle_t* send_handle = NULL;
-
-    if (args[2]->IsObject()) {
-      Local<Object> send_handle_obj = args[2]->ToObject();
-      assert(send_handle_obj->InternalFieldCount() > 0);
-      HandleWrap* send_handle_wrap = static_cast<HandleWrap*>(
-          send_handle_obj->GetAlignedPointerFromInternalField(0));
-      send_handle = send_handle_wrap->GetHandle();
-
-      // Reference StreamWrap instance to prevent it from being garbage
-      // collected before `AfterWrite` is called.
-      if (handle_sym.IsEmpty()) {
-        handle_sym = String::New("handle");
-      }
-      assert(!req_wrap->persistent().IsEmpty());
-      req_wrap->object()->Set(handle_sym, send_handle_obj);
+    err = 0;
+    if (!wrap->QueueWrite(req_wrap, buf)) {
+      err = wrap->callbacks_->DoWrite(req_wrap,
+                                      &buf,
+                                      1,
+                                      NULL,
+                                      StreamWrap::AfterWrite);
     }
-
+  } else {
     err = wrap->callbacks_->DoWrite(req_wrap,
                                     &buf,
                                     1,
-                                    reinterpret_cast<uv_stream_t*>(send_handle),
+                                    SendHandle(req_wrap, args[2]),
                                     StreamWrap::AfterWrite);
   }
 
@@ -331,6 +389,47 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Writes a message in the binary IPC format, see node_serializer.cc. The
+// frame is serialized directly behind the WriteWrap, so sending a message
+// costs one allocation and no intermediate buffer.
+void StreamWrap::WriteMessage(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(StreamWrap)
+
+  assert(args[0]->IsObject());
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+
+  size_t length;
+  char* storage = serializer::SerializeFrame(args[1],
+                                             sizeof(WriteWrap),
+                                             &length);
+  if (storage == NULL)
+    return;  // Exception pending.
+
+  WriteWrap* req_wrap = new(storage) WriteWrap(req_wrap_obj, wrap);
+
+  uv_buf_t buf;
+  buf.base = storage + sizeof(WriteWrap);
+  buf.len = length;
+
+  int err = wrap->callbacks_->DoWrite(req_wrap,
+                                      &buf,
+                                      1,
+                                      SendHandle(req_wrap, args[2]),
+                                      StreamWrap::AfterWrite);
+  req_wrap->Dispatched();
+  req_wrap_obj->Set(bytes_sym, Integer::NewFromUnsigned(length, node_isolate));
+
+  if (err) {
+    req_wrap->~WriteWrap();
+    delete[] storage;
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+
 void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope;
 
@@ -343,6 +442,13 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   Local<Array> chunks = args[1].As<Array>();
   size_t count = chunks->Length() >> 1;
 
+  // Keep the coalesced writes ahead of this one.
+  int err = wrap->FlushWriteQueue();
+  if (err) {
+    args.GetReturnValue().Set(err);
+    return;
+  }
+
   uv_buf_t bufs_[16];
   uv_buf_t* bufs = bufs_;
 
@@ -407,7 +513,7 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
     bytes += str_size;
   }
 
-  int err = wrap->callbacks_->DoWrite(req_wrap,
+  err = wrap->callbacks_->DoWrite(req_wrap,
                                       bufs,
                                       count,
                                       NULL,
@@ -444,6 +550,68 @@ void StreamWrap::WriteUcs2String(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Writes part of a file with uv_sendfile(), the data never enters the JS heap.
+// Completes through AfterWrite() like the other writes.
+void StreamWrap::SendFile(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(StreamWrap)
+
+  assert(args[0]->IsObject());
+  assert(args[1]->IsInt32());
+  assert(args[2]->IsNumber());
+  assert(args[3]->IsNumber());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  int fd = args[1]->Int32Value();
+  int64_t offset = args[2]->IntegerValue();
+  int64_t length = args[3]->IntegerValue();
+
+  // Data written through overridden callbacks (e.g. TLS) has to be
+  // transformed first, sendfile would bypass that.
+  if (wrap->callbacks_ != &wrap->default_callbacks_) {
+    args.GetReturnValue().Set(UV_ENOTSUP);
+    return;
+  }
+
+  if (offset < 0 || length <= 0 || length > INT_MAX) {
+    args.GetReturnValue().Set(UV_EINVAL);
+    return;
+  }
+
+  int err = wrap->FlushWriteQueue();
+  if (err) {
+    args.GetReturnValue().Set(err);
+    return;
+  }
+
+  char* storage = new char[sizeof(WriteWrap)];
+  WriteWrap* req_wrap = new(storage) WriteWrap(req_wrap_obj, wrap);
+
+  err = uv_sendfile(&req_wrap->req_,
+                        wrap->stream_,
+                        fd,
+                        offset,
+                        static_cast<size_t>(length),
+                        StreamWrap::AfterWrite);
+  req_wrap->Dispatched();
+  req_wrap_obj->Set(bytes_sym, Number::New(node_isolate, length));
+
+  if (err) {
+    req_wrap->~WriteWrap();
+    delete[] storage;
+  } else if (wrap->stream_->type == UV_TCP) {
+    NODE_COUNT_NET_BYTES_SENT(length);
+  } else if (wrap->stream_->type == UV_NAMED_PIPE) {
+    NODE_COUNT_PIPE_BYTES_SENT(length);
+  }
+
+  wrap->UpdateWriteQueueSize();
+
+  args.GetReturnValue().Set(err);
+}
+
+
 void StreamWrap::AfterWrite(uv_write_t* req, int status) {
   WriteWrap* req_wrap = container_of(req, WriteWrap, req_);
   StreamWrap* wrap = req_wrap->wrap_;
@@ -475,6 +643,130 @@ void StreamWrap::AfterWrite(uv_write_t* req, int status) {
 }
 
 
+bool StreamWrap::QueueWrite(WriteWrap* req_wrap, const uv_buf_t& buf) {
+  // Overridden callbacks (e.g. TLS) have to see every write.
+  if (!coalesce_writes_ || callbacks_ != &default_callbacks_)
+    return false;
+
+  if (queued_count_ == queued_capacity_) {
+    size_t capacity = queued_capacity_ == 0 ? 16 : queued_capacity_ * 2;
+    WriteWrap** reqs = new WriteWrap*[capacity];
+    uv_buf_t* bufs = new uv_buf_t[capacity];
+    if (queued_count_ > 0) {
+      memcpy(reqs, queued_reqs_, queued_count_ * sizeof(*reqs));
+      memcpy(bufs, queued_bufs_, queued_count_ * sizeof(*bufs));
+    }
+    delete[] queued_reqs_;
+    delete[] queued_bufs_;
+    queued_reqs_ = reqs;
+    queued_bufs_ = bufs;
+    queued_capacity_ = capacity;
+  }
+
+  queued_reqs_[queued_count_] = req_wrap;
+  queued_bufs_[queued_count_] = buf;
+  queued_count_++;
+  queued_bytes_ += buf.len;
+  UpdateWriteQueueSize();
+
+  return true;
+}
+
+
+int StreamWrap::FlushWriteQueue() {
+  if (queued_count_ == 0)
+    return 0;
+
+  if (GetHandle() == NULL) {
+    // Closed with writes still queued, they never reach the stream.
+    DiscardWriteQueue();
+    return UV_EBADF;
+  }
+
+  size_t count = queued_count_;
+  queued_count_ = 0;
+  queued_bytes_ = 0;
+
+  char* storage = new char[sizeof(WriteBatch) + count * sizeof(*queued_reqs_)];
+  WriteBatch* batch = reinterpret_cast<WriteBatch*>(storage);
+  batch->reqs_ = reinterpret_cast<WriteWrap**>(storage + sizeof(WriteBatch));
+  batch->count_ = count;
+  memcpy(batch->reqs_, queued_reqs_, count * sizeof(*batch->reqs_));
+
+  // uv_write() copies the buffer list, queued_bufs_ can be reused right away.
+  int err = uv_write(&batch->req_,
+                     stream_,
+                     queued_bufs_,
+                     count,
+                     StreamWrap::AfterWriteBatch);
+
+  if (err) {
+    for (size_t i = 0; i < count; i++) {
+      batch->reqs_[i]->~WriteWrap();
+      delete[] reinterpret_cast<char*>(batch->reqs_[i]);
+    }
+    delete[] storage;
+  } else {
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++)
+      bytes += queued_bufs_[i].len;
+    if (stream_->type == UV_TCP) {
+      NODE_COUNT_NET_BYTES_SENT(bytes);
+    } else if (stream_->type == UV_NAMED_PIPE) {
+      NODE_COUNT_PIPE_BYTES_SENT(bytes);
+    }
+  }
+
+  UpdateWriteQueueSize();
+
+  return err;
+}
+
+
+void StreamWrap::DiscardWriteQueue() {
+  for (size_t i = 0; i < queued_count_; i++) {
+    queued_reqs_[i]->~WriteWrap();
+    delete[] reinterpret_cast<char*>(queued_reqs_[i]);
+  }
+  queued_count_ = 0;
+  queued_bytes_ = 0;
+}
+
+
+void StreamWrap::AfterWriteBatch(uv_write_t* req, int status) {
+  WriteBatch* batch = container_of(req, WriteBatch, req_);
+
+  for (size_t i = 0; i < batch->count_; i++)
+    AfterWrite(&batch->reqs_[i]->req_, status);
+
+  delete[] reinterpret_cast<char*>(batch);
+}
+
+
+void StreamWrap::SetCoalesceWrites(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(StreamWrap)
+
+  wrap->coalesce_writes_ = args[0]->IsTrue();
+
+  int err = 0;
+  if (!wrap->coalesce_writes_)
+    err = wrap->FlushWriteQueue();
+
+  args.GetReturnValue().Set(err);
+}
+
+
+void StreamWrap::FlushWrites(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(StreamWrap)
+
+  args.GetReturnValue().Set(wrap->FlushWriteQueue());
+}
+
+
 void StreamWrap::Shutdown(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(node_isolate);
 
@@ -483,8 +775,14 @@ void StreamWrap::Shutdown(const FunctionCallbackInfo<Value>& args) {
   assert(args[0]->IsObject());
   Local<Object> req_wrap_obj = args[0].As<Object>();
 
+  int err = wrap->FlushWriteQueue();
+  if (err) {
+    args.GetReturnValue().Set(err);
+    return;
+  }
+
   ShutdownWrap* req_wrap = new ShutdownWrap(req_wrap_obj);
-  int err = wrap->callbacks_->DoShutdown(req_wrap, AfterShutdown);
+  err = wrap->callbacks_->DoShutdown(req_wrap, AfterShutdown);
   req_wrap->Dispatched();
   if (err) delete req_wrap;
   args.GetReturnValue().Set(err);
@@ -550,11 +848,8 @@ void StreamWrapCallbacks::AfterWrite(WriteWrap* w) {
 
 uv_buf_t StreamWrapCallbacks::DoAlloc(uv_handle_t* handle,
                                       size_t suggested_size) {
-  char* data = static_cast<char*>(malloc(suggested_size));
-  if (data == NULL && suggested_size > 0) {
-    FatalError("node::StreamWrapCallbacks::DoAlloc(uv_handle_t*, size_t)",
-               "Out Of Memory");
-  }
+  HandleScope scope(node_isolate);
+  char* data = slab_allocator->Allocate(Self(), suggested_size);
   return uv_buf_init(data, suggested_size);
 }
 
@@ -573,20 +868,32 @@ void StreamWrapCallbacks::DoRead(uv_stream_t* handle,
 
   if (nread < 0)  {
     if (buf.base != NULL)
-      free(buf.base);
+      slab_allocator->Shrink(Self(), buf.base, 0);
     MakeCallback(Self(), onread_sym, ARRAY_SIZE(argv), argv);
     return;
   }
 
   if (nread == 0) {
     if (buf.base != NULL)
-      free(buf.base);
+      slab_allocator->Shrink(Self(), buf.base, 0);
     return;
   }
 
-  buf.base = static_cast<char*>(realloc(buf.base, nread));
+  assert(buf.base != NULL);
   assert(static_cast<size_t>(nread) <= buf.len);
-  argv[1] = Buffer::Use(buf.base, nread);
+  // A slice keeps the whole slab alive for as long as JS holds on to it.
+  // Small reads are the ones that get kept around (a request line, a
+  // token), they are copied and their room goes back to the slab at once.
+  // A retained slice of a large read pins at most SLAB_SIZE / SLAB_MIN_SLICE
+  // times its own size.
+  if (nread < SLAB_MIN_SLICE) {
+    argv[1] = Buffer::New(buf.base, nread);
+    slab_allocator->Shrink(Self(), buf.base, 0);
+  } else {
+    Local<Object> slab = slab_allocator->Shrink(Self(), buf.base, nread);
+    size_t offset = buf.base - Buffer::Data(slab);
+    argv[1] = Buffer::Slice(slab, offset, offset + nread);
+  }
 
   Local<Object> pending_obj;
   if (pending == UV_TCP) {
@@ -118,6 +118,12 @@ class StreamWrap : public HandleWrap {
   static void WriteAsciiString(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteUtf8String(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteUcs2String(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void WriteMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendFile(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void SetCoalesceWrites(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FlushWrites(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Overridable callbacks
   StreamWrapCallbacks* callbacks_;
@@ -126,20 +132,25 @@ class StreamWrap : public HandleWrap {
   static size_t WriteBuffer(v8::Handle<v8::Value> val, uv_buf_t* buf);
 
   StreamWrap(v8::Handle<v8::Object> object, uv_stream_t* stream);
-  ~StreamWrap() {
-    if (callbacks_ != &default_callbacks_) {
-      delete callbacks_;
-      callbacks_ = NULL;
-    }
-  }
+  ~StreamWrap();
   void StateChange() { }
   void UpdateWriteQueueSize();
 
+  // With write coalescing enabled, buffer and string writes are held in a
+  // native queue and handed to libuv as a single uv_write() by
+  // FlushWriteQueue().  Returns 0 or a libuv error code.
+  int FlushWriteQueue();
+
  private:
   // Callbacks for libuv
   static void AfterWrite(uv_write_t* req, int status);
   static uv_buf_t OnAlloc(uv_handle_t* handle, size_t suggested_size);
   static void AfterShutdown(uv_shutdown_t* req, int status);
+  static void AfterWriteBatch(uv_write_t* req, int status);
+
+  // Returns true if `req_wrap` was queued instead of written.
+  bool QueueWrite(WriteWrap* req_wrap, const uv_buf_t& buf);
+  void DiscardWriteQueue();
 
   static void OnRead(uv_stream_t* handle, ssize_t nread, uv_buf_t buf);
   static void OnRead2(uv_pipe_t* handle, ssize_t nread, uv_buf_t buf,
@@ -152,6 +163,13 @@ class StreamWrap : public HandleWrap {
 
   uv_stream_t* stream_;
 
+  bool coalesce_writes_;
+  WriteWrap** queued_reqs_;
+  uv_buf_t* queued_bufs_;
+  size_t queued_count_;
+  size_t queued_capacity_;
+  size_t queued_bytes_;
+
   StreamWrapCallbacks default_callbacks_;
   friend class StreamWrapCallbacks;
 };
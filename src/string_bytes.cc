@@ -27,8 +27,29 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>  // getenv
 #include <string.h>  // memcpy
 
+#if defined(__x86_64__) && !defined(__clang__) && defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define STRING_BYTES_SIMD 1
+#elif defined(__x86_64__) && defined(__clang__) && \
+    (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8))
+#define STRING_BYTES_SIMD 1
+#elif defined(_M_X64) && defined(_MSC_VER) && _MSC_VER >= 1800
+#define STRING_BYTES_SIMD 1
+#endif
+
+#if defined(STRING_BYTES_SIMD)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
 // When creating strings >= this length v8's gc spins up and consumes
 // most of the execution time. For these cases it's more performant to
 // use external string resources.
@@ -101,6 +122,684 @@ typedef ExternString<String::ExternalStringResource,
                      uint16_t> ExternTwoByteString;
 
 
+//// SIMD ////
+
+// The base64, hex and ASCII loops below have SSE2/SSSE3 and AVX2 versions
+// on x86_64. The SSSE3 and AVX2 functions are compiled with per-function
+// target attributes and picked at runtime, so the binary still runs on CPUs
+// that don't have them. SSE2 is part of the x86_64 baseline.
+//
+// The kernels only ever handle whole blocks. Everything else, the tail of
+// the input and base64 input with padding, whitespace or junk in it, is
+// left to the scalar code.
+
+#if defined(STRING_BYTES_SIMD)
+
+#if defined(_MSC_VER)
+#define SIMD_TARGET(arch)
+#else
+#define SIMD_TARGET(arch) __attribute__((target(arch)))
+#endif
+
+enum CpuFeatures {
+  kSSSE3 = 1,
+  kAVX2 = 2,
+  kDetected = 0x80
+};
+
+
+static unsigned DetectCpuFeatures() {
+  unsigned features = kDetected;
+  unsigned regs[4];  // eax, ebx, ecx, edx
+
+#if defined(_MSC_VER)
+  __cpuid(reinterpret_cast<int*>(regs), 0);
+  unsigned max_leaf = regs[0];
+  __cpuid(reinterpret_cast<int*>(regs), 1);
+#else
+  unsigned max_leaf = __get_cpuid_max(0, NULL);
+  __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+  if (regs[2] & (1 << 9))
+    features |= kSSSE3;
+
+  // AVX2 also needs the OS to save the YMM registers on context switches.
+  const unsigned osxsave_avx = (1 << 27) | (1 << 28);
+  if ((regs[2] & osxsave_avx) != osxsave_avx || max_leaf < 7)
+    return features;
+
+#if defined(_MSC_VER)
+  uint64_t xcr0 = _xgetbv(0);
+  __cpuidex(reinterpret_cast<int*>(regs), 7, 0);
+#else
+  unsigned xcr0_lo;
+  unsigned xcr0_hi;
+  __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0"  // xgetbv
+                       : "=a" (xcr0_lo), "=d" (xcr0_hi)
+                       : "c" (0));
+  uint64_t xcr0 = xcr0_lo;
+  __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+  if ((xcr0 & 6) == 6 && (regs[1] & (1 << 5)))
+    features |= kAVX2;
+
+  return features;
+}
+
+
+// NODE_SIMD=ssse3 or NODE_SIMD=none leaves out the wider code paths, so the
+// others can be tested on machines that have them.
+static unsigned LimitCpuFeatures(unsigned features) {
+  const char* limit = getenv("NODE_SIMD");
+  if (limit == NULL)
+    return features;
+  if (strcmp(limit, "ssse3") == 0)
+    return features & ~kAVX2;
+  if (strcmp(limit, "none") == 0)
+    return features & ~(kAVX2 | kSSSE3);
+  return features;
+}
+
+
+// Racy but harmless, every thread computes the same value.
+static unsigned cpu_features;
+
+static inline bool HasCpuFeature(unsigned feature) {
+  if (cpu_features == 0)
+    cpu_features = LimitCpuFeatures(DetectCpuFeatures());
+  return (cpu_features & feature) != 0;
+}
+
+
+// Base64 encoding, 12 bytes in, 16 characters out. See
+// http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+SIMD_TARGET("ssse3")
+static inline __m128i base64_encode_block_ssse3(__m128i in) {
+  in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1,
+                                          4, 3, 5, 4,
+                                          7, 6, 8, 7,
+                                          10, 9, 11, 10));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // Map 0..25 to 13, 26..51 to 0, 52..61 to 1..10, 62 to 11 and 63 to 12,
+  // then look up the offset to the ASCII character for each range.
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '+' - 62,
+                                        '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+
+SIMD_TARGET("ssse3")
+static size_t base64_encode_ssse3(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  size_t k = 0;
+  // Loads 16 bytes, uses 12.
+  while (i + 16 <= slen) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     base64_encode_block_ssse3(in));
+    i += 12;
+    k += 16;
+  }
+  return i;
+}
+
+
+SIMD_TARGET("avx2")
+static size_t base64_encode_avx2(const char* src, size_t slen, char* dst) {
+  const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1,
+                                        4, 3, 5, 4,
+                                        7, 6, 8, 7,
+                                        10, 9, 11, 10);
+  const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '+' - 62,
+                                        '/' - 63, 'A', 0, 0);
+  const __m256i shuffle2 =
+      _mm256_inserti128_si256(_mm256_castsi128_si256(shuffle), shuffle, 1);
+  const __m256i offsets2 =
+      _mm256_inserti128_si256(_mm256_castsi128_si256(offsets), offsets, 1);
+
+  size_t i = 0;
+  size_t k = 0;
+  // Two 12 byte groups, one per lane. The second load reads 4 bytes past
+  // the group.
+  while (i + 28 <= slen) {
+    const __m128i lo =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12));
+    __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+    in = _mm256_shuffle_epi8(in, shuffle2);
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 =
+        _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 =
+        _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range = _mm256_or_si256(range,
+                            _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    const __m256i out =
+        _mm256_add_epi8(_mm256_shuffle_epi8(offsets2, range), indices);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), out);
+    i += 24;
+    k += 32;
+  }
+
+  return i + base64_encode_ssse3(src + i, slen - i, dst + k);
+}
+
+
+// Returns the number of source bytes encoded, always a multiple of 3. The
+// output is 4 characters for every 3 bytes.
+static size_t base64_encode_simd(const char* src, size_t slen, char* dst) {
+  if (HasCpuFeature(kAVX2))
+    return base64_encode_avx2(src, slen, dst);
+  if (HasCpuFeature(kSSSE3))
+    return base64_encode_ssse3(src, slen, dst);
+  return 0;
+}
+
+
+// Base64 decoding, 16 characters in, 12 bytes out. Accepts both the regular
+// and the URL-safe alphabet, like unbase64_table. Returns false if the block
+// contains anything else.
+SIMD_TARGET("ssse3")
+static inline bool base64_decode_block_ssse3(__m128i in, __m128i* out) {
+  const __m128i upper =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)),
+                    _mm_cmplt_epi8(in, _mm_set1_epi8('Z' + 1)));
+  const __m128i lower =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(in, _mm_set1_epi8('z' + 1)));
+  const __m128i digit =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                    _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+  const __m128i plus = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('+')),
+                                    _mm_cmpeq_epi8(in, _mm_set1_epi8('-')));
+  const __m128i slash = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')),
+                                     _mm_cmpeq_epi8(in, _mm_set1_epi8('_')));
+
+  const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                     _mm_or_si128(_mm_or_si128(digit, plus),
+                                                  slash));
+  if (_mm_movemask_epi8(valid) != 0xffff)
+    return false;
+
+  __m128i values =
+      _mm_and_si128(upper, _mm_sub_epi8(in, _mm_set1_epi8('A')));
+  values = _mm_or_si128(values,
+      _mm_and_si128(lower, _mm_sub_epi8(in, _mm_set1_epi8('a' - 26))));
+  values = _mm_or_si128(values,
+      _mm_and_si128(digit, _mm_add_epi8(in, _mm_set1_epi8(52 - '0'))));
+  values = _mm_or_si128(values, _mm_and_si128(plus, _mm_set1_epi8(62)));
+  values = _mm_or_si128(values, _mm_and_si128(slash, _mm_set1_epi8(63)));
+
+  // Merge pairs of 6 bit values into 12 bits, then pairs of those into the
+  // 24 bit groups, and move the 3 bytes of every group together.
+  const __m128i merged =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i groups = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  *out = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0,
+                                                6, 5, 4,
+                                                10, 9, 8,
+                                                14, 13, 12,
+                                                -1, -1, -1, -1));
+  return true;
+}
+
+
+SIMD_TARGET("ssse3")
+static size_t base64_decode_ssse3(char* dst,
+                                  size_t dlen,
+                                  const char* src,
+                                  size_t slen,
+                                  size_t* consumed) {
+  size_t i = 0;
+  size_t k = 0;
+  // Only the 12 bytes of output are stored, the bytes after the decoded
+  // data belong to the caller.
+  while (i + 16 <= slen && k + 12 <= dlen) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i out;
+    if (!base64_decode_block_ssse3(in, &out))
+      break;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k), out);
+    const uint32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+    memcpy(dst + k + 8, &tail, sizeof(tail));
+    i += 16;
+    k += 12;
+  }
+  *consumed = i;
+  return k;
+}
+
+
+SIMD_TARGET("avx2")
+static size_t base64_decode_avx2(char* dst,
+                                 size_t dlen,
+                                 const char* src,
+                                 size_t slen,
+                                 size_t* consumed) {
+  size_t i = 0;
+  size_t k = 0;
+  // Stores the 24 bytes of output only, see base64_decode_ssse3().
+  while (i + 32 <= slen && k + 24 <= dlen) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+    const __m256i upper =
+        _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('A' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), in));
+    const __m256i lower =
+        _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('a' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), in));
+    const __m256i digit =
+        _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('0' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), in));
+    const __m256i plus =
+        _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('+')),
+                        _mm256_cmpeq_epi8(in, _mm256_set1_epi8('-')));
+    const __m256i slash =
+        _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')),
+                        _mm256_cmpeq_epi8(in, _mm256_set1_epi8('_')));
+
+    const __m256i valid =
+        _mm256_or_si256(_mm256_or_si256(upper, lower),
+                        _mm256_or_si256(_mm256_or_si256(digit, plus), slash));
+    if (_mm256_movemask_epi8(valid) != -1)
+      break;
+
+    __m256i values =
+        _mm256_and_si256(upper, _mm256_sub_epi8(in, _mm256_set1_epi8('A')));
+    values = _mm256_or_si256(values,
+        _mm256_and_si256(lower,
+                         _mm256_sub_epi8(in, _mm256_set1_epi8('a' - 26))));
+    values = _mm256_or_si256(values,
+        _mm256_and_si256(digit,
+                         _mm256_add_epi8(in, _mm256_set1_epi8(52 - '0'))));
+    values = _mm256_or_si256(values,
+        _mm256_and_si256(plus, _mm256_set1_epi8(62)));
+    values = _mm256_or_si256(values,
+        _mm256_and_si256(slash, _mm256_set1_epi8(63)));
+
+    const __m256i merged =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const __m256i groups =
+        _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0,
+                                          6, 5, 4,
+                                          10, 9, 8,
+                                          14, 13, 12,
+                                          -1, -1, -1, -1);
+    __m256i out = _mm256_shuffle_epi8(groups,
+        _mm256_inserti128_si256(_mm256_castsi128_si256(shuffle), shuffle, 1));
+    // 12 bytes at the bottom of each lane, move them next to each other.
+    out = _mm256_permutevar8x32_epi32(out,
+                                      _mm256_setr_epi32(0, 1, 2, 4,
+                                                        5, 6, 3, 7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     _mm256_castsi256_si128(out));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k + 16),
+                     _mm256_extracti128_si256(out, 1));
+    i += 32;
+    k += 24;
+  }
+
+  size_t rest;
+  k += base64_decode_ssse3(dst + k, dlen - k, src + i, slen - i, &rest);
+  *consumed = i + rest;
+  return k;
+}
+
+
+// Returns the number of bytes written, *consumed is set to the number of
+// characters decoded. Always consumes whole 4 character groups.
+static size_t base64_decode_simd(char* dst,
+                                 size_t dlen,
+                                 const char* src,
+                                 size_t slen,
+                                 size_t* consumed) {
+  *consumed = 0;
+  if (HasCpuFeature(kAVX2))
+    return base64_decode_avx2(dst, dlen, src, slen, consumed);
+  if (HasCpuFeature(kSSSE3))
+    return base64_decode_ssse3(dst, dlen, src, slen, consumed);
+  return 0;
+}
+
+
+SIMD_TARGET("ssse3")
+static size_t hex_encode_ssse3(const char* src, size_t slen, char* dst) {
+  const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                       '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m128i mask = _mm_set1_epi8(0x0f);
+
+  size_t i = 0;
+  while (i + 16 <= slen) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi = _mm_shuffle_epi8(digits,
+        _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+    const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(in, mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i),
+                     _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16),
+                     _mm_unpackhi_epi8(hi, lo));
+    i += 16;
+  }
+  return i;
+}
+
+
+SIMD_TARGET("avx2")
+static size_t hex_encode_avx2(const char* src, size_t slen, char* dst) {
+  const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                       '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m256i digits2 =
+      _mm256_inserti128_si256(_mm256_castsi128_si256(digits), digits, 1);
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+
+  size_t i = 0;
+  while (i + 32 <= slen) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i hi = _mm256_shuffle_epi8(digits2,
+        _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+    const __m256i lo = _mm256_shuffle_epi8(digits2, _mm256_and_si256(in, mask));
+    // unpack works per lane, put the lanes back in order.
+    const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i),
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+    i += 32;
+  }
+
+  return i + hex_encode_ssse3(src + i, slen - i, dst + 2 * i);
+}
+
+
+// Returns the number of source bytes encoded.
+static size_t hex_encode_simd(const char* src, size_t slen, char* dst) {
+  if (HasCpuFeature(kAVX2))
+    return hex_encode_avx2(src, slen, dst);
+  if (HasCpuFeature(kSSSE3))
+    return hex_encode_ssse3(src, slen, dst);
+  return 0;
+}
+
+
+// Hex digit values of 16 characters, false if any of them isn't one.
+SIMD_TARGET("ssse3")
+static inline bool hex_nibbles_ssse3(__m128i in, __m128i* out) {
+  const __m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+  const __m128i is_digit =
+      _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+  const __m128i alpha = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)),
+                                     _mm_set1_epi8('a'));
+  const __m128i is_alpha =
+      _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+  if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xffff)
+    return false;
+
+  *out = _mm_or_si128(
+      _mm_and_si128(is_digit, digit),
+      _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+  return true;
+}
+
+
+SIMD_TARGET("ssse3")
+static size_t hex_decode_ssse3(char* dst,
+                               size_t dlen,
+                               const char* src,
+                               size_t slen) {
+  const __m128i weights = _mm_set1_epi16(0x0110);  // 16 * hi + lo
+
+  size_t i = 0;
+  while (i + 16 <= dlen && 2 * i + 32 <= slen) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+    __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16));
+    if (!hex_nibbles_ssse3(a, &a) || !hex_nibbles_ssse3(b, &b))
+      break;
+    a = _mm_maddubs_epi16(a, weights);
+    b = _mm_maddubs_epi16(b, weights);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(a, b));
+    i += 16;
+  }
+  return i;
+}
+
+
+SIMD_TARGET("avx2")
+static size_t hex_decode_avx2(char* dst,
+                              size_t dlen,
+                              const char* src,
+                              size_t slen) {
+  const __m256i weights = _mm256_set1_epi16(0x0110);  // 16 * hi + lo
+
+  size_t i = 0;
+  while (i + 32 <= dlen && 2 * i + 64 <= slen) {
+    __m256i in[2];
+    bool valid = true;
+    for (int n = 0; n < 2 && valid; n++) {
+      const char* s = src + 2 * i + 32 * n;
+      __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+      __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+      __m256i is_digit =
+          _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)),
+                            digit);
+      __m256i alpha =
+          _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)),
+                          _mm256_set1_epi8('a'));
+      __m256i is_alpha =
+          _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)),
+                            alpha);
+      if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) != -1) {
+        valid = false;
+        break;
+      }
+      __m256i nibbles = _mm256_or_si256(
+          _mm256_and_si256(is_digit, digit),
+          _mm256_and_si256(is_alpha,
+                           _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+      in[n] = _mm256_maddubs_epi16(nibbles, weights);
+    }
+    if (!valid)
+      break;
+    // packus works per lane, put the lanes back in order.
+    const __m256i out = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(in[0], in[1]), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    i += 32;
+  }
+
+  return i + hex_decode_ssse3(dst + i, dlen - i, src + 2 * i, slen - 2 * i);
+}
+
+
+// Returns the number of bytes decoded. Stops at the first block with a
+// character that isn't a hex digit.
+static size_t hex_decode_simd(char* dst,
+                              size_t dlen,
+                              const char* src,
+                              size_t slen) {
+  if (HasCpuFeature(kAVX2))
+    return hex_decode_avx2(dst, dlen, src, slen);
+  if (HasCpuFeature(kSSSE3))
+    return hex_decode_ssse3(dst, dlen, src, slen);
+  return 0;
+}
+
+
+SIMD_TARGET("avx2")
+static size_t count_non_ascii_avx2(const char* src, size_t len,
+                                   size_t* count) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i sums = zero;
+  size_t i = 0;
+  while (i + 32 <= len) {
+    // Count in bytes for up to 255 blocks, then add up into 64 bit lanes.
+    __m256i counts = zero;
+    for (int n = 0; n < 255 && i + 32 <= len; n++, i += 32) {
+      const __m256i in =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      counts = _mm256_sub_epi8(counts, _mm256_cmpgt_epi8(zero, in));
+    }
+    sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counts, zero));
+  }
+
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sums);
+  *count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  return i;
+}
+
+
+static size_t count_non_ascii_sse2(const char* src, size_t len,
+                                   size_t* count) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sums = zero;
+  size_t i = 0;
+  while (i + 16 <= len) {
+    __m128i counts = zero;
+    for (int n = 0; n < 255 && i + 16 <= len; n++, i += 16) {
+      const __m128i in =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      counts = _mm_sub_epi8(counts, _mm_cmplt_epi8(in, zero));
+    }
+    sums = _mm_add_epi64(sums, _mm_sad_epu8(counts, zero));
+  }
+
+  uint64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sums);
+  *count = lanes[0] + lanes[1];
+  return i;
+}
+
+
+// Counts the bytes with the high bit set in whole blocks. Returns the
+// number of bytes looked at.
+static size_t count_non_ascii_simd(const char* src, size_t len,
+                                   size_t* count) {
+  if (HasCpuFeature(kAVX2))
+    return count_non_ascii_avx2(src, len, count);
+  return count_non_ascii_sse2(src, len, count);
+}
+
+
+SIMD_TARGET("avx2")
+static size_t contains_non_ascii_avx2(const char* src, size_t len,
+                                      bool* found) {
+  size_t i = 0;
+  while (i + 64 <= len) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+    if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0) {
+      *found = true;
+      return i;
+    }
+    i += 64;
+  }
+  *found = false;
+  return i;
+}
+
+
+static size_t contains_non_ascii_sse2(const char* src, size_t len,
+                                      bool* found) {
+  size_t i = 0;
+  while (i + 32 <= len) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0) {
+      *found = true;
+      return i;
+    }
+    i += 32;
+  }
+  *found = false;
+  return i;
+}
+
+
+// Looks at whole blocks, sets *found if one of them has a byte with the
+// high bit set. Returns the number of bytes looked at.
+static size_t contains_non_ascii_simd(const char* src, size_t len,
+                                      bool* found) {
+  if (HasCpuFeature(kAVX2))
+    return contains_non_ascii_avx2(src, len, found);
+  return contains_non_ascii_sse2(src, len, found);
+}
+
+
+SIMD_TARGET("avx2")
+static size_t force_ascii_avx2(const char* src, char* dst, size_t len) {
+  const __m256i mask = _mm256_set1_epi8(0x7f);
+  size_t i = 0;
+  while (i + 32 <= len) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_and_si256(in, mask));
+    i += 32;
+  }
+  return i;
+}
+
+
+static size_t force_ascii_sse2(const char* src, char* dst, size_t len) {
+  const __m128i mask = _mm_set1_epi8(0x7f);
+  size_t i = 0;
+  while (i + 16 <= len) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_and_si128(in, mask));
+    i += 16;
+  }
+  return i;
+}
+
+
+// Returns the number of bytes processed.
+static size_t force_ascii_simd(const char* src, char* dst, size_t len) {
+  if (HasCpuFeature(kAVX2))
+    return force_ascii_avx2(src, dst, len);
+  return force_ascii_sse2(src, dst, len);
+}
+
+#endif  // defined(STRING_BYTES_SIMD)
+
+
 //// Base 64 ////
 
 #define base64_encoded_size(size) ((size + 2 - ((size + 2) % 3)) / 3 * 4)
@@ -124,19 +823,6 @@ static inline size_t base64_decoded_size_fast(size_t size) {
   return size;
 }
 
-template <typename TypeName>
-size_t base64_decoded_size(const TypeName* src, size_t size) {
-  if (size == 0)
-    return 0;
-
-  if (src[size - 1] == '=')
-    size--;
-  if (size > 0 && src[size - 1] == '=')
-    size--;
-
-  return base64_decoded_size_fast(size);
-}
-
 
 // supports regular and URL-safe base64
 static const int unbase64_table[] =
@@ -161,10 +847,10 @@ static const int unbase64_table[] =
 
 
 template <typename TypeName>
-size_t base64_decode(char* buf,
-                     size_t len,
-                     const TypeName* src,
-                     const size_t srcLen) {
+size_t base64_decode_slow(char* buf,
+                          size_t len,
+                          const TypeName* src,
+                          const size_t srcLen) {
   char a, b, c, d;
   char* dst = buf;
   char* dstEnd = buf + len;
@@ -202,6 +888,33 @@ size_t base64_decode(char* buf,
 }
 
 
+template <typename TypeName>
+size_t base64_decode(char* buf,
+                     size_t len,
+                     const TypeName* src,
+                     const size_t srcLen) {
+  return base64_decode_slow(buf, len, src, srcLen);
+}
+
+
+template <>
+size_t base64_decode(char* buf,
+                     size_t len,
+                     const char* src,
+                     const size_t srcLen) {
+#if defined(STRING_BYTES_SIMD)
+  size_t consumed;
+  size_t n = base64_decode_simd(buf, len, src, srcLen, &consumed);
+  return n + base64_decode_slow(buf + n,
+                                len - n,
+                                src + consumed,
+                                srcLen - consumed);
+#else
+  return base64_decode_slow(buf, len, src, srcLen);
+#endif
+}
+
+
 //// HEX ////
 
 template <typename TypeName>
@@ -230,6 +943,39 @@ size_t hex_decode(char* buf,
 }
 
 
+template <>
+size_t hex_decode(char* buf,
+                  size_t len,
+                  const char* src,
+                  const size_t srcLen) {
+  size_t i = 0;
+#if defined(STRING_BYTES_SIMD)
+  i = hex_decode_simd(buf, len, src, srcLen);
+#endif
+  for (; i < len && i * 2 + 1 < srcLen; ++i) {
+    unsigned a = hex2bin(src[i * 2 + 0]);
+    unsigned b = hex2bin(src[i * 2 + 1]);
+    if (!~a || !~b) return i;
+    buf[i] = a * 16 + b;
+  }
+
+  return i;
+}
+
+
+static size_t count_non_ascii(const char* src, size_t len) {
+  size_t count = 0;
+  size_t i = 0;
+#if defined(STRING_BYTES_SIMD)
+  i = count_non_ascii_simd(src, len, &count);
+#endif
+  for (; i < len; ++i) {
+    if (src[i] & 0x80) count++;
+  }
+  return count;
+}
+
+
 bool StringBytes::GetExternalParts(Handle<Value> val,
                                    const char** data,
                                    size_t* len) {
@@ -274,7 +1020,6 @@ size_t StringBytes::Write(char* buf,
   bool is_extern = GetExternalParts(val, &data, &len);
 
   Local<String> str = val->ToString();
-  len = len < buflen ? len : buflen;
 
   int flags = String::NO_NULL_TERMINATION |
               String::HINT_MANY_WRITES_EXPECTED;
@@ -284,7 +1029,7 @@ size_t StringBytes::Write(char* buf,
     case BINARY:
     case BUFFER:
       if (is_extern)
-        memcpy(buf, data, len);
+        memcpy(buf, data, len = len < buflen ? len : buflen);
       else
         len = str->WriteOneByte(reinterpret_cast<uint8_t*>(buf),
                                 0,
@@ -300,7 +1045,7 @@ size_t StringBytes::Write(char* buf,
 
     case UCS2:
       if (is_extern)
-        memcpy(buf, data, len * 2);
+        memcpy(buf, data, (len = len < buflen ? len : buflen) * 2);
       else
         len = str->Write(reinterpret_cast<uint16_t*>(buf), 0, buflen, flags);
       if (chars_written != NULL)
@@ -310,7 +1055,17 @@ size_t StringBytes::Write(char* buf,
 
     case BASE64:
       if (is_extern) {
-        base64_decode(buf, buflen, data, len);
+        len = base64_decode(buf, buflen, data, len);
+      } else if (str->IsOneByte()) {
+        // Decode from a one byte copy, that's half the size of a
+        // String::Value and can use the vectorized decoder.
+        char* value = new char[str->Length()];
+        int n = str->WriteOneByte(reinterpret_cast<uint8_t*>(value),
+                                  0,
+                                  -1,
+                                  flags);
+        len = base64_decode(buf, buflen, value, n);
+        delete[] value;
       } else {
         String::Value value(str);
         len = base64_decode(buf, buflen, *value, value.length());
@@ -322,7 +1077,15 @@ size_t StringBytes::Write(char* buf,
 
     case HEX:
       if (is_extern) {
-        hex_decode(buf, buflen, data, len);
+        len = hex_decode(buf, buflen, data, len);
+      } else if (str->IsOneByte()) {
+        char* value = new char[str->Length()];
+        int n = str->WriteOneByte(reinterpret_cast<uint8_t*>(value),
+                                  0,
+                                  -1,
+                                  flags);
+        len = hex_decode(buf, buflen, value, n);
+        delete[] value;
       } else {
         String::Value value(str);
         len = hex_decode(buf, buflen, *value, value.length());
@@ -417,7 +1180,15 @@ size_t StringBytes::Size(Handle<Value> val, enum encoding encoding) {
       break;
 
     case UTF8:
-      data_size = str->Utf8Length();
+      if (str->IsExternalAscii()) {
+        // Every byte with the high bit set takes up two bytes in UTF-8.
+        const String::ExternalAsciiStringResource* ext;
+        ext = str->GetExternalAsciiStringResource();
+        data_size = ext->length() + count_non_ascii(ext->data(),
+                                                    ext->length());
+      } else {
+        data_size = str->Utf8Length();
+      }
       break;
 
     case UCS2:
@@ -425,8 +1196,17 @@ size_t StringBytes::Size(Handle<Value> val, enum encoding encoding) {
       break;
 
     case BASE64: {
-      String::Value value(str);
-      data_size = base64_decoded_size(*value, value.length());
+      // Only the padding at the end matters, don't copy the whole string.
+      uint16_t tail[2];
+      int n = str->Length() < 2 ? str->Length() : 2;
+      str->Write(tail, str->Length() - n, n, String::NO_NULL_TERMINATION);
+      data_size = str->Length();
+      if (n > 0 && tail[n - 1] == '=') {
+        data_size--;
+        if (n > 1 && tail[0] == '=')
+          data_size--;
+      }
+      data_size = base64_decoded_size_fast(data_size);
       break;
     }
 
@@ -454,6 +1234,14 @@ static bool contains_non_ascii_slow(const char* buf, size_t len) {
 
 
 static bool contains_non_ascii(const char* src, size_t len) {
+#if defined(STRING_BYTES_SIMD)
+  bool found;
+  size_t n = contains_non_ascii_simd(src, len, &found);
+  if (found) return true;
+  src += n;
+  len -= n;
+#endif
+
   if (len < 16) {
     return contains_non_ascii_slow(src, len);
   }
@@ -500,6 +1288,13 @@ static void force_ascii_slow(const char* src, char* dst, size_t len) {
 
 
 static void force_ascii(const char* src, char* dst, size_t len) {
+#if defined(STRING_BYTES_SIMD)
+  size_t n = force_ascii_simd(src, dst, len);
+  src += n;
+  dst += n;
+  len -= n;
+#endif
+
   if (len < 16) {
     force_ascii_slow(src, dst, len);
     return;
@@ -569,6 +1364,11 @@ static size_t base64_encode(const char* src,
   k = 0;
   n = slen / 3 * 3;
 
+#if defined(STRING_BYTES_SIMD)
+  i = base64_encode_simd(src, slen, dst);
+  k = i / 3 * 4;
+#endif
+
   while (i < n) {
     a = src[i + 0] & 0xff;
     b = src[i + 1] & 0xff;
@@ -614,7 +1414,11 @@ static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  uint32_t i = 0;
+#if defined(STRING_BYTES_SIMD)
+  i = hex_encode_simd(src, slen, dst);
+#endif
+  for (uint32_t k = i * 2; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -665,10 +1469,21 @@ Local<Value> StringBytes::Encode(const char* buf,
       break;
 
     case UTF8:
-      val = String::NewFromUtf8(node_isolate,
-                                buf,
-                                String::kNormalString,
-                                buflen);
+      // Pure ASCII is the common case, it doesn't need to go through the
+      // UTF-8 decoder.
+      if (contains_non_ascii(buf, buflen)) {
+        val = String::NewFromUtf8(node_isolate,
+                                  buf,
+                                  String::kNormalString,
+                                  buflen);
+      } else if (buflen < EXTERN_APEX) {
+        val = String::NewFromOneByte(node_isolate,
+                                     reinterpret_cast<const uint8_t*>(buf),
+                                     String::kNormalString,
+                                     buflen);
+      } else {
+        val = ExternOneByteString::NewFromCopy(buf, buflen);
+      }
       break;
 
     case BINARY:
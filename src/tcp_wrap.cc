@@ -102,6 +102,11 @@ void TCPWrap::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "writeUtf8String", StreamWrap::WriteUtf8String);
   NODE_SET_PROTOTYPE_METHOD(t, "writeUcs2String", StreamWrap::WriteUcs2String);
   NODE_SET_PROTOTYPE_METHOD(t, "writev", StreamWrap::Writev);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendFile", StreamWrap::SendFile);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "setCoalesceWrites",
+                            StreamWrap::SetCoalesceWrites);
+  NODE_SET_PROTOTYPE_METHOD(t, "flushWrites", StreamWrap::FlushWrites);
 
   NODE_SET_PROTOTYPE_METHOD(t, "open", Open);
   NODE_SET_PROTOTYPE_METHOD(t, "bind", Bind);
@@ -113,6 +118,7 @@ void TCPWrap::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "getpeername", GetPeerName);
   NODE_SET_PROTOTYPE_METHOD(t, "setNoDelay", SetNoDelay);
   NODE_SET_PROTOTYPE_METHOD(t, "setKeepAlive", SetKeepAlive);
+  NODE_SET_PROTOTYPE_METHOD(t, "setReusePort", SetReusePort);
 
 #ifdef _WIN32
   NODE_SET_PROTOTYPE_METHOD(t,
@@ -221,6 +227,17 @@ void TCPWrap::SetNoDelay(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TCPWrap::SetReusePort(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(TCPWrap)
+
+  int enable = static_cast<int>(args[0]->BooleanValue());
+  int err = uv_tcp_reuseport(&wrap->handle_, enable);
+  args.GetReturnValue().Set(err);
+}
+
+
 void TCPWrap::SetKeepAlive(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(node_isolate);
 
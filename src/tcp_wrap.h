@@ -41,6 +41,7 @@ class TCPWrap : public StreamWrap {
   static void GetSockName(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetPeerName(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetNoDelay(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetReusePort(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetKeepAlive(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -0,0 +1,326 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "timer_wheel.h"
+#include "node.h"
+#include "node_internals.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace node {
+
+const uint64_t TimerWheel::kNever;
+
+
+static inline unsigned int LowestBit(uint64_t word) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  unsigned int n = 0;
+  while ((word & 1) == 0) {
+    word >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+
+// Index of the first set bit at or after `from` in the `nbits` long bitmap
+// `words`, or -1.
+static int NextSetBit(const uint64_t* words, unsigned int nbits,
+                      unsigned int from) {
+  if (from >= nbits)
+    return -1;
+
+  unsigned int i = from / 64;
+  uint64_t word = words[i] & (~static_cast<uint64_t>(0) << (from % 64));
+
+  for (;;) {
+    if (word != 0)
+      return i * 64 + LowestBit(word);
+    if (++i == nbits / 64)
+      return -1;
+    word = words[i];
+  }
+}
+
+
+TimerWheel::TimerWheel() : clock_(0),
+                           count_(0),
+                           entries_(NULL),
+                           entries_size_(0),
+                           free_(-1) {
+  for (unsigned int i = 0; i <= kSlots; i++)
+    head_[i] = tail_[i] = -1;
+  memset(bitmap_, 0, sizeof(bitmap_));
+}
+
+
+TimerWheel::~TimerWheel() {
+  free(entries_);
+}
+
+
+void TimerWheel::Grow() {
+  unsigned int size = entries_size_ == 0 ? 64 : entries_size_ * 2;
+  Entry* entries = static_cast<Entry*>(realloc(entries_,
+                                               size * sizeof(*entries)));
+  if (entries == NULL)
+    FatalError("node::TimerWheel::Grow()", "Out Of Memory");
+
+  // Thread the new entries onto the free list, lowest id first.
+  for (unsigned int i = size; i > entries_size_; i--) {
+    entries[i - 1].slot = -1;
+    entries[i - 1].next = free_;
+    free_ = i - 1;
+  }
+
+  entries_ = entries;
+  entries_size_ = size;
+}
+
+
+int TimerWheel::Add(uint64_t now, uint64_t timeout) {
+  if (free_ == -1)
+    Grow();
+
+  // Nothing is pending, so the clock can simply be moved to the present.
+  if (count_ == 0)
+    clock_ = now;
+
+  int id = free_;
+  free_ = entries_[id].next;
+  count_++;
+
+  entries_[id].expires = now + timeout;
+  Place(id);
+  return id;
+}
+
+
+void TimerWheel::Refresh(int id, uint64_t now, uint64_t timeout) {
+  assert(id >= 0 && static_cast<unsigned int>(id) < entries_size_);
+  assert(entries_[id].slot != -1);
+
+  Unlink(id);
+  entries_[id].expires = now + timeout;
+  Place(id);
+}
+
+
+void TimerWheel::Remove(int id) {
+  assert(id >= 0 && static_cast<unsigned int>(id) < entries_size_);
+  assert(entries_[id].slot != -1);
+
+  Unlink(id);
+  entries_[id].slot = -1;
+  entries_[id].next = free_;
+  free_ = id;
+  count_--;
+}
+
+
+int TimerWheel::Expire(uint64_t now) {
+  for (;;) {
+    int id = head_[kExpired];
+    if (id != -1) {
+      Remove(id);
+      return id;
+    }
+
+    uint64_t when = NextExpiry();
+    if (when > now)
+      break;
+    Advance(when);
+  }
+
+  // Everything up to and including `now` has been looked at. Nothing is
+  // due in between so the clock can skip ahead without visiting each slot.
+  if (clock_ <= now)
+    clock_ = now + 1;
+
+  return -1;
+}
+
+
+uint64_t TimerWheel::NextExpiry() const {
+  if (count_ == 0)
+    return kNever;
+
+  if (head_[kExpired] != -1)
+    return clock_;
+
+  // Root slots hold timeouts that expire within the next 256 ms. If one of
+  // them comes before the root level wraps around, no cascade can beat it.
+  uint64_t next = kNever;
+  unsigned int pos = clock_ & (kRootSlots - 1);
+  int index = NextSetBit(bitmap_, kRootSlots, pos);
+  if (index != -1) {
+    next = clock_ + (index - pos);
+    if (pos != 0)
+      return next;
+  } else {
+    index = NextSetBit(bitmap_, kRootSlots, 0);
+    if (index != -1)
+      next = clock_ + (kRootSlots - pos) + index;
+  }
+
+  // A slot in one of the upper levels needs attention when the clock reaches
+  // its start. Unless the clock sits right on that start, the slot the clock
+  // is in has been cascaded already and whatever is left in there belongs to
+  // the next turn of the level.
+  for (unsigned int level = 1; level < kLevels; level++) {
+    const uint64_t* word = bitmap_ + (SlotOf(level, 0) / 64);
+    if (*word == 0)
+      continue;
+
+    unsigned int shift = ShiftOf(level);
+    uint64_t base = clock_ >> (shift + kLevelBits) << (shift + kLevelBits);
+    pos = (clock_ >> shift) & (kLevelSlots - 1);
+    if ((clock_ & ((static_cast<uint64_t>(1) << shift) - 1)) != 0)
+      pos++;
+
+    uint64_t when;
+    index = NextSetBit(word, kLevelSlots, pos);
+    if (index != -1) {
+      when = base + (static_cast<uint64_t>(index) << shift);
+    } else {
+      index = NextSetBit(word, kLevelSlots, 0);
+      when = base + (static_cast<uint64_t>(kLevelSlots + index) << shift);
+    }
+
+    if (when < next)
+      next = when;
+  }
+
+  return next;
+}
+
+
+void TimerWheel::Place(int id) {
+  uint64_t expires = entries_[id].expires;
+
+  // Overdue timeouts go in the slot that is up next.
+  if (expires < clock_)
+    expires = clock_;
+
+  uint64_t delta = expires - clock_;
+  if (delta < kRootSlots) {
+    Link(id, SlotOf(0, expires & (kRootSlots - 1)));
+    return;
+  }
+
+  // Out of range timeouts are parked in the last level and placed again
+  // when their slot comes up.
+  uint64_t range = static_cast<uint64_t>(1) << ShiftOf(kLevels);
+  if (delta >= range)
+    expires = clock_ + range - 1;
+
+  unsigned int level = 1;
+  while (level < kLevels - 1 &&
+         delta >= static_cast<uint64_t>(1) << ShiftOf(level + 1)) {
+    level++;
+  }
+
+  unsigned int index = (expires >> ShiftOf(level)) & (kLevelSlots - 1);
+  Link(id, SlotOf(level, index));
+}
+
+
+void TimerWheel::Link(int id, int slot) {
+  Entry* entry = entries_ + id;
+  entry->slot = slot;
+  entry->next = -1;
+  entry->prev = tail_[slot];
+
+  if (tail_[slot] == -1)
+    head_[slot] = id;
+  else
+    entries_[tail_[slot]].next = id;
+  tail_[slot] = id;
+
+  if (slot != kExpired)
+    bitmap_[slot / 64] |= static_cast<uint64_t>(1) << (slot % 64);
+}
+
+
+void TimerWheel::Unlink(int id) {
+  Entry* entry = entries_ + id;
+  int slot = entry->slot;
+
+  if (entry->prev == -1)
+    head_[slot] = entry->next;
+  else
+    entries_[entry->prev].next = entry->next;
+
+  if (entry->next == -1)
+    tail_[slot] = entry->prev;
+  else
+    entries_[entry->next].prev = entry->prev;
+
+  if (head_[slot] == -1 && slot != kExpired)
+    bitmap_[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+}
+
+
+void TimerWheel::Cascade(int slot) {
+  int id = head_[slot];
+  head_[slot] = tail_[slot] = -1;
+  bitmap_[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+
+  while (id != -1) {
+    int next = entries_[id].next;
+    Place(id);
+    id = next;
+  }
+}
+
+
+void TimerWheel::Advance(uint64_t when) {
+  assert(when >= clock_);
+  clock_ = when;
+
+  // Crossing into a new slot of an upper level moves that slot's timeouts
+  // one or more levels down.
+  for (unsigned int level = 1; level < kLevels; level++) {
+    unsigned int shift = ShiftOf(level);
+    if ((when & ((static_cast<uint64_t>(1) << shift) - 1)) != 0)
+      break;
+    Cascade(SlotOf(level, (when >> shift) & (kLevelSlots - 1)));
+  }
+
+  // Everything in the root slot for `when` is due now.
+  int slot = SlotOf(0, when & (kRootSlots - 1));
+  int id = head_[slot];
+  while (id != -1) {
+    int next = entries_[id].next;
+    Unlink(id);
+    Link(id, kExpired);
+    id = next;
+  }
+
+  clock_ = when + 1;
+}
+
+}  // namespace node
@@ -0,0 +1,114 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_TIMER_WHEEL_H_
+#define SRC_TIMER_WHEEL_H_
+
+#include <stdint.h>
+
+namespace node {
+
+/**
+ * Hierarchical timing wheel with millisecond resolution.
+ *
+ * The first level has one slot per millisecond for the next 256 ms, each of
+ * the four levels above it has 64 slots that are 64 times coarser than the
+ * level below. Timeouts live in the slot of the coarsest level that still
+ * matches their distance from the wheel's clock and trickle down a level
+ * every time the clock crosses that slot's boundary, the way the classic
+ * BSD and Linux kernel timer wheels work. Add(), Refresh() and Remove() are
+ * O(1), and so is the amortized cost of expiring a timeout.
+ *
+ * The wheel doesn't own a clock or a uv timer. Callers feed it the loop
+ * time and arm a single uv timer for NextExpiry().
+ */
+class TimerWheel {
+ public:
+  TimerWheel();
+  ~TimerWheel();
+
+  // Start a timeout that expires `timeout` ms after `now`. Returns its id.
+  int Add(uint64_t now, uint64_t timeout);
+
+  // Restart timeout `id` so that it expires `timeout` ms after `now`.
+  void Refresh(int id, uint64_t now, uint64_t timeout);
+
+  // Cancel timeout `id`. The id may be handed out again by Add().
+  void Remove(int id);
+
+  // Returns the id of a timeout that has expired at `now` and releases it,
+  // or -1 when there are no more. Timeouts come out in expiration order.
+  int Expire(uint64_t now);
+
+  // When the wheel needs to be looked at again; kNever if it's empty. This
+  // is a lower bound, not every wake-up has an expired timeout to report.
+  uint64_t NextExpiry() const;
+
+  unsigned int count() const { return count_; }
+
+  static const uint64_t kNever = ~static_cast<uint64_t>(0);
+
+ private:
+  static const unsigned int kLevels = 5;
+  static const unsigned int kRootBits = 8;
+  static const unsigned int kRootSlots = 1 << kRootBits;
+  static const unsigned int kLevelBits = 6;
+  static const unsigned int kLevelSlots = 1 << kLevelBits;
+  static const unsigned int kSlots = kRootSlots + (kLevels - 1) * kLevelSlots;
+  // Pseudo-slot that holds expired timeouts until Expire() hands them out.
+  static const int kExpired = kSlots;
+
+  struct Entry {
+    uint64_t expires;
+    int prev;
+    int next;
+    int slot;  // -1 when the entry is free
+  };
+
+  void Place(int id);
+  void Link(int id, int slot);
+  void Unlink(int id);
+  void Cascade(int slot);
+  void Advance(uint64_t when);
+  void Grow();
+
+  static int SlotOf(unsigned int level, unsigned int index) {
+    return level == 0 ? index : kRootSlots + (level - 1) * kLevelSlots + index;
+  }
+
+  static unsigned int ShiftOf(unsigned int level) {
+    return level == 0 ? 0 : kRootBits + (level - 1) * kLevelBits;
+  }
+
+  uint64_t clock_;  // Next millisecond that hasn't been processed yet.
+  unsigned int count_;
+  Entry* entries_;
+  unsigned int entries_size_;
+  int free_;
+  int head_[kSlots + 1];
+  int tail_[kSlots + 1];
+  // One bit per non-empty slot, 4 words for the root level, 1 for the rest.
+  uint64_t bitmap_[kRootSlots / 64 + kLevels - 1];
+};
+
+}  // namespace node
+
+#endif  // SRC_TIMER_WHEEL_H_
@@ -19,11 +19,13 @@
 // OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include "timer_wheel.h"
 #include "node.h"
 #include "handle_wrap.h"
 
 namespace node {
 
+using v8::Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -147,6 +149,132 @@ class TimerWrap : public HandleWrap {
 };
 
 
+// Runs any number of timeouts off a single uv timer. Timeouts are known to
+// JS land by the id that add() returns, the ids of all timeouts that expire
+// in one go are passed to ontimeout() as an array.
+class TimerWheelWrap : public HandleWrap {
+ public:
+  static void Initialize(Handle<Object> target) {
+    HandleScope scope(node_isolate);
+
+    Local<FunctionTemplate> constructor = FunctionTemplate::New(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(String::NewSymbol("TimerWheel"));
+
+    NODE_SET_PROTOTYPE_METHOD(constructor, "close", HandleWrap::Close);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "ref", HandleWrap::Ref);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "unref", HandleWrap::Unref);
+
+    NODE_SET_PROTOTYPE_METHOD(constructor, "add", Add);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "refresh", Refresh);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "remove", Remove);
+
+    target->Set(String::NewSymbol("TimerWheel"),
+                constructor->GetFunction());
+  }
+
+ private:
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    assert(args.IsConstructCall());
+    HandleScope scope(node_isolate);
+    new TimerWheelWrap(args.This());
+  }
+
+  explicit TimerWheelWrap(Handle<Object> object)
+      : HandleWrap(object, reinterpret_cast<uv_handle_t*>(&handle_)),
+        armed_(TimerWheel::kNever) {
+    int r = uv_timer_init(uv_default_loop(), &handle_);
+    assert(r == 0);
+  }
+
+  ~TimerWheelWrap() {
+  }
+
+  // Make sure the uv timer goes off no later than the wheel's next expiry.
+  // Timeouts that get pushed back don't re-arm it, the wheel simply finds
+  // nothing to expire when it fires early.
+  void Arm(uint64_t when) {
+    if (when >= armed_)
+      return;
+    uint64_t now = uv_now(uv_default_loop());
+    int err = uv_timer_start(&handle_,
+                             OnTimeout,
+                             when > now ? when - now : 0,
+                             0);
+    assert(err == 0);
+    armed_ = when;
+  }
+
+  static void Add(const FunctionCallbackInfo<Value>& args) {
+    HandleScope scope(node_isolate);
+    UNWRAP(TimerWheelWrap)
+
+    uint64_t timeout = args[0]->IntegerValue();
+    uint64_t now = uv_now(uv_default_loop());
+    int id = wrap->wheel_.Add(now, timeout);
+    wrap->Arm(now + timeout);
+    args.GetReturnValue().Set(id);
+  }
+
+  static void Refresh(const FunctionCallbackInfo<Value>& args) {
+    HandleScope scope(node_isolate);
+    UNWRAP(TimerWheelWrap)
+
+    int id = args[0]->Int32Value();
+    uint64_t timeout = args[1]->IntegerValue();
+    uint64_t now = uv_now(uv_default_loop());
+    wrap->wheel_.Refresh(id, now, timeout);
+    wrap->Arm(now + timeout);
+  }
+
+  static void Remove(const FunctionCallbackInfo<Value>& args) {
+    HandleScope scope(node_isolate);
+    UNWRAP(TimerWheelWrap)
+
+    int id = args[0]->Int32Value();
+    wrap->wheel_.Remove(id);
+    if (wrap->wheel_.count() == 0) {
+      uv_timer_stop(&wrap->handle_);
+      wrap->armed_ = TimerWheel::kNever;
+    }
+  }
+
+  static void OnTimeout(uv_timer_t* handle, int status) {
+    HandleScope scope(node_isolate);
+
+    TimerWheelWrap* wrap = static_cast<TimerWheelWrap*>(handle->data);
+    assert(wrap);
+    wrap->armed_ = TimerWheel::kNever;
+
+    // Collect everything first, the callback is free to add timeouts that
+    // reuse the ids that were just released.
+    uint64_t now = uv_now(uv_default_loop());
+    Local<Array> ids = Array::New();
+    uint32_t count = 0;
+    int id;
+    while ((id = wrap->wheel_.Expire(now)) != -1)
+      ids->Set(count++, Integer::New(id, node_isolate));
+
+    if (count > 0) {
+      Local<Value> argv[1] = { ids };
+      MakeCallback(wrap->object(), ontimeout_sym, ARRAY_SIZE(argv), argv);
+    }
+
+    wrap->Arm(wrap->wheel_.NextExpiry());
+  }
+
+  uv_timer_t handle_;
+  TimerWheel wheel_;
+  uint64_t armed_;
+};
+
+
+static void InitTimers(Handle<Object> target) {
+  TimerWrap::Initialize(target);
+  TimerWheelWrap::Initialize(target);
+}
+
+
 }  // namespace node
 
-NODE_MODULE(node_timer_wrap, node::TimerWrap::Initialize)
+NODE_MODULE(node_timer_wrap, node::InitTimers)
@@ -89,7 +89,12 @@ TLSCallbacks::TLSCallbacks(Kind kind,
       established_(false),
       shutdown_(false),
       session_callbacks_(false),
-      next_sess_(NULL) {
+      next_sess_(NULL),
+      offload_threshold_(0),
+      encrypt_job_(NULL),
+      pending_eof_(0),
+      pending_shutdown_(NULL),
+      pending_shutdown_cb_(NULL) {
 
   // Persist SecureContext
   sc_ = ObjectWrap::Unwrap<SecureContext>(sc);
@@ -160,6 +165,12 @@ int TLSCallbacks::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
 
 
 TLSCallbacks::~TLSCallbacks() {
+  // Still encrypting, the job frees ssl_ when it's done.
+  if (encrypt_job_ != NULL) {
+    encrypt_job_->callbacks_ = NULL;
+    ssl_ = NULL;
+  }
+
   SSL_free(ssl_);
   ssl_ = NULL;
   enc_in_ = NULL;
@@ -374,12 +385,18 @@ void TLSCallbacks::EncOut() {
   if (hello_.state != kParseEnded)
     return;
 
+  // The threadpool is writing to enc_out_
+  if (encrypt_job_ != NULL)
+    return;
+
   // Write in progress
   if (write_size_ != 0)
     return;
 
-  // Split-off queue
-  if (established_ && !QUEUE_EMPTY(&write_item_queue_)) {
+  // Split-off queue, unless some of the data is yet to be encrypted off-loop
+  if (established_ &&
+      !QUEUE_EMPTY(&write_item_queue_) &&
+      (offload_threshold_ == 0 || clear_in_->Length() == 0)) {
     pending_write_item_ = container_of(QUEUE_NEXT(&write_item_queue_),
                                        WriteItem,
                                        member_);
@@ -435,6 +452,11 @@ void TLSCallbacks::EncOutCb(uv_write_t* req, int status) {
 
   // Try writing more data
   callbacks->write_size_ = 0;
+
+  // A large write may have been waiting for this one, see EncryptOffLoop()
+  if (callbacks->offload_threshold_ != 0)
+    callbacks->ClearIn();
+
   callbacks->EncOut();
 }
 
@@ -477,6 +499,10 @@ void TLSCallbacks::ClearOut() {
   if (hello_.state != kParseEnded)
     return;
 
+  // Wait for the threadpool to hand back ssl_
+  if (encrypt_job_ != NULL)
+    return;
+
   HandleScope scope(node_isolate);
 
   assert(ssl_ != NULL);
@@ -509,6 +535,10 @@ bool TLSCallbacks::ClearIn() {
   if (hello_.state != kParseEnded)
     return false;
 
+  // Large amounts of data are encrypted on the threadpool
+  if (encrypt_job_ != NULL || EncryptOffLoop())
+    return false;
+
   HandleScope scope(node_isolate);
 
   int written = 0;
@@ -538,6 +568,127 @@ bool TLSCallbacks::ClearIn() {
 }
 
 
+// Hands the queued clear data over to the threadpool once there is at least
+// offload_threshold_ bytes of it. Returns true when the data is taken care
+// of, either right away or once enc_out_ is drained (see EncOutCb()).
+bool TLSCallbacks::EncryptOffLoop() {
+  if (offload_threshold_ == 0 || clear_in_->Length() < offload_threshold_)
+    return false;
+
+  // SSL_write() must not run into a handshake, that calls back into JS
+  if (!established_ || shutdown_ || !SSL_is_init_finished(ssl_))
+    return false;
+
+  // EncOutCb() still has to consume enc_out_
+  if (write_size_ != 0 || BIO_pending(enc_out_) != 0)
+    return true;
+
+  // Data written in the meantime is queued up in a fresh clear_in_
+  encrypt_job_ = new EncryptJob(this, clear_in_);
+  clear_in_ = new NodeBIO();
+
+  uv_queue_work(uv_default_loop(),
+                &encrypt_job_->req_,
+                EncryptWork,
+                EncryptDone);
+  return true;
+}
+
+
+void TLSCallbacks::EncryptWork(uv_work_t* req) {
+  EncryptJob* job = container_of(req, EncryptJob, req_);
+
+  while (job->in_->Length() > 0) {
+    size_t avail = 0;
+    char* data = job->in_->Peek(&avail);
+    int written = SSL_write(job->ssl_, data, avail);
+    if (written <= 0) {
+      // OpenSSL's error queue is per thread, save the message for
+      // EncryptDone()
+      job->err_ = SSL_get_error(job->ssl_, written);
+      if (job->err_ == SSL_ERROR_SSL || job->err_ == SSL_ERROR_SYSCALL) {
+        BUF_MEM* mem;
+        BIO* bio = BIO_new(BIO_s_mem());
+        assert(bio != NULL);
+        ERR_print_errors(bio);
+        BIO_get_mem_ptr(bio, &mem);
+        job->error_ = new char[mem->length + 1];
+        memcpy(job->error_, mem->data, mem->length);
+        job->error_[mem->length] = '\0';
+        BIO_free_all(bio);
+      }
+      break;
+    }
+    assert(written == static_cast<int>(avail));
+    job->in_->Read(NULL, avail);
+  }
+}
+
+
+void TLSCallbacks::EncryptDone(uv_work_t* req, int status) {
+  EncryptJob* job = container_of(req, EncryptJob, req_);
+  TLSCallbacks* c = job->callbacks_;
+
+  // Closed while encrypting, see ~TLSCallbacks()
+  if (c == NULL) {
+    SSL_free(job->ssl_);
+    delete job->in_;
+    delete job;
+    return;
+  }
+
+  HandleScope scope(node_isolate);
+
+  c->encrypt_job_ = NULL;
+
+  // Whatever is left goes in front of the data that was queued meanwhile
+  if (job->in_->Length() > 0) {
+    while (c->clear_in_->Length() > 0) {
+      size_t avail = 0;
+      char* data = c->clear_in_->Peek(&avail);
+      job->in_->Write(data, avail);
+      c->clear_in_->Read(NULL, avail);
+    }
+    delete c->clear_in_;
+    c->clear_in_ = job->in_;
+  } else {
+    delete job->in_;
+  }
+
+  if (job->err_ == SSL_ERROR_ZERO_RETURN) {
+    Local<Value> arg = String::NewSymbol("ZERO_RETURN");
+    MakeCallback(c->object(), onerror_sym, 1, &arg);
+  } else if (job->error_ != NULL) {
+    Local<Value> arg = Exception::Error(String::New(job->error_));
+    MakeCallback(c->object(), onerror_sym, 1, &arg);
+  }
+  delete job;
+
+  // Write out the encrypted data and catch up on what came in meanwhile
+  c->Cycle();
+
+  // Cycle() may have started another job
+  if (c->encrypt_job_ != NULL)
+    return;
+
+  if (c->pending_eof_ != 0) {
+    Local<Value> arg = Integer::New(c->pending_eof_, node_isolate);
+    c->pending_eof_ = 0;
+    MakeCallback(c->Self(), onread_sym, 1, &arg);
+  }
+
+  if (c->pending_shutdown_ != NULL) {
+    ShutdownWrap* req_wrap = c->pending_shutdown_;
+    c->pending_shutdown_ = NULL;
+    int err = c->DoShutdown(req_wrap, c->pending_shutdown_cb_);
+    if (err) {
+      req_wrap->req_.handle = c->wrap_->GetStream();
+      c->pending_shutdown_cb_(&req_wrap->req_, err);
+    }
+  }
+}
+
+
 int TLSCallbacks::DoWrite(WriteWrap* w,
                           uv_buf_t* bufs,
                           size_t count,
@@ -582,6 +733,21 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
     return 0;
   }
 
+  // Large writes are encrypted on the threadpool
+  if (offload_threshold_ != 0) {
+    size_t size = 0;
+    for (i = 0; i < count; i++)
+      size += bufs[i].len;
+
+    if (size >= offload_threshold_) {
+      for (i = 0; i < count; i++)
+        clear_in_->Write(bufs[i].base, bufs[i].len);
+      ClearIn();
+      EncOut();
+      return 0;
+    }
+  }
+
   int written = 0;
   for (i = 0; i < count; i++) {
     written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
@@ -627,6 +793,12 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
                           uv_buf_t buf,
                           uv_handle_type pending) {
   if (nread < 0)  {
+    // The threadpool has ssl_, wait for it before decrypting the rest
+    if (encrypt_job_ != NULL) {
+      pending_eof_ = nread;
+      return;
+    }
+
     // Error should be emitted only after all data was read
     ClearOut();
     Local<Value> arg = Integer::New(nread, node_isolate);
@@ -650,6 +822,15 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
 
 
 int TLSCallbacks::DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) {
+  // The close_notify alert has to go after the data that is being encrypted
+  // on the threadpool, continued in EncryptDone()
+  if (encrypt_job_ != NULL || EncryptOffLoop()) {
+    pending_shutdown_ = req_wrap;
+    pending_shutdown_cb_ = cb;
+    EncOut();
+    return 0;
+  }
+
   if (SSL_shutdown(ssl_) == 0)
     SSL_shutdown(ssl_);
   shutdown_ = true;
@@ -947,7 +1128,11 @@ void TLSCallbacks::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
 void TLSCallbacks::IsSessionReused(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(node_isolate);
   UNWRAP(TLSCallbacks);
-  bool yes = SSL_session_reused(wrap->ssl_);
+  bool yes;
+  if (wrap->encrypt_job_ != NULL)
+    yes = wrap->encrypt_job_->session_reused_;
+  else
+    yes = SSL_session_reused(wrap->ssl_);
   args.GetReturnValue().Set(yes);
 }
 
@@ -965,13 +1150,33 @@ void TLSCallbacks::EnableSessionCallbacks(
 }
 
 
+void TLSCallbacks::SetOffloadThreshold(
+    const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(node_isolate);
+
+  UNWRAP(TLSCallbacks);
+
+  if (args.Length() < 1 || !args[0]->IsUint32())
+    return ThrowTypeError("Bad arguments, expected a size in bytes");
+
+  wrap->offload_threshold_ = args[0]->Uint32Value();
+}
+
+
 void TLSCallbacks::GetPeerCertificate(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(node_isolate);
 
   UNWRAP(TLSCallbacks);
 
   Local<Object> info = Object::New();
-  X509* peer_cert = SSL_get_peer_certificate(wrap->ssl_);
+  X509* peer_cert;
+  if (wrap->encrypt_job_ != NULL) {
+    peer_cert = wrap->encrypt_job_->peer_cert_;
+    if (peer_cert != NULL)
+      CRYPTO_add(&peer_cert->references, 1, CRYPTO_LOCK_X509);
+  } else {
+    peer_cert = SSL_get_peer_certificate(wrap->ssl_);
+  }
   if (peer_cert != NULL) {
     BIO* bio = BIO_new(BIO_s_mem());
     BUF_MEM* mem;
@@ -1095,7 +1300,11 @@ void TLSCallbacks::GetSession(const FunctionCallbackInfo<Value>& args) {
 
   UNWRAP(TLSCallbacks);
 
-  SSL_SESSION* sess = SSL_get_session(wrap->ssl_);
+  SSL_SESSION* sess;
+  if (wrap->encrypt_job_ != NULL)
+    sess = wrap->encrypt_job_->session_;
+  else
+    sess = SSL_get_session(wrap->ssl_);
   if (!sess) return;
 
   int slen = i2d_SSL_SESSION(sess, NULL);
@@ -1179,7 +1388,10 @@ void TLSCallbacks::GetCurrentCipher(const FunctionCallbackInfo<Value>& args) {
 
   const SSL_CIPHER* c;
 
-  c = SSL_get_current_cipher(wrap->ssl_);
+  if (wrap->encrypt_job_ != NULL)
+    c = wrap->encrypt_job_->cipher_;
+  else
+    c = SSL_get_current_cipher(wrap->ssl_);
   if (c == NULL)
     return;
 
@@ -1393,6 +1605,7 @@ void TLSCallbacks::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t,
                             "enableSessionCallbacks",
                             EnableSessionCallbacks);
+  NODE_SET_PROTOTYPE_METHOD(t, "setOffloadThreshold", SetOffloadThreshold);
 
 #ifdef OPENSSL_NPN_NEGOTIATED
   NODE_SET_PROTOTYPE_METHOD(t, "getNegotiatedProtocol", GetNegotiatedProto);
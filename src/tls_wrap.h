@@ -93,6 +93,43 @@ class TLSCallbacks : public StreamWrapCallbacks {
     QUEUE member_;
   };
 
+  // Encryption of queued clear data on the threadpool, see
+  // SetOffloadThreshold(). The job owns ssl_ and enc_out_ while it runs.
+  // getPeerCertificate() and friends are answered from the copies taken
+  // when the job was queued in the meantime.
+  class EncryptJob {
+   public:
+    EncryptJob(TLSCallbacks* callbacks, NodeBIO* in)
+        : callbacks_(callbacks),
+          ssl_(callbacks->ssl_),
+          in_(in),
+          err_(SSL_ERROR_NONE),
+          error_(NULL),
+          peer_cert_(SSL_get_peer_certificate(ssl_)),
+          session_(SSL_get1_session(ssl_)),
+          cipher_(SSL_get_current_cipher(ssl_)),
+          session_reused_(SSL_session_reused(ssl_)) {
+    }
+    ~EncryptJob() {
+      delete[] error_;
+      if (peer_cert_ != NULL)
+        X509_free(peer_cert_);
+      if (session_ != NULL)
+        SSL_SESSION_free(session_);
+    }
+
+    uv_work_t req_;
+    TLSCallbacks* callbacks_;  // NULL when the connection is gone.
+    SSL* ssl_;
+    NodeBIO* in_;
+    int err_;
+    char* error_;
+    X509* peer_cert_;
+    SSL_SESSION* session_;
+    const SSL_CIPHER* cipher_;
+    bool session_reused_;
+  };
+
   TLSCallbacks(Kind kind, v8::Handle<v8::Object> sc, StreamWrapCallbacks* old);
   ~TLSCallbacks();
 
@@ -102,6 +139,9 @@ class TLSCallbacks : public StreamWrapCallbacks {
   static void EncOutCb(uv_write_t* req, int status);
   bool ClearIn();
   void ClearOut();
+  bool EncryptOffLoop();
+  static void EncryptWork(uv_work_t* req);
+  static void EncryptDone(uv_work_t* req, int status);
   void InvokeQueued(int status);
   void ParseClientHello();
 
@@ -131,6 +171,8 @@ class TLSCallbacks : public StreamWrapCallbacks {
   static void IsSessionReused(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableSessionCallbacks(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetOffloadThreshold(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // TLS Session API
   static SSL_SESSION* GetSessionCallback(SSL* s,
@@ -189,6 +231,11 @@ class TLSCallbacks : public StreamWrapCallbacks {
   bool shutdown_;
   bool session_callbacks_;
   SSL_SESSION* next_sess_;
+  size_t offload_threshold_;
+  EncryptJob* encrypt_job_;
+  ssize_t pending_eof_;
+  ShutdownWrap* pending_shutdown_;
+  uv_shutdown_cb pending_shutdown_cb_;
 
 #ifdef OPENSSL_NPN_NEGOTIATED
   v8::Persistent<v8::Object> npn_protos_;
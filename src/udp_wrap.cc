@@ -26,10 +26,12 @@
 #include "req_wrap.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 
 namespace node {
 
+using v8::Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -48,20 +50,56 @@ using v8::Value;
 
 typedef ReqWrap<uv_udp_send_t> SendWrap;
 
+// Most datagrams libuv reads per batch (UV__MMSG_MAXWIDTH).
+static const unsigned int kMaxRecvBatch = 64;
+
+// A batch of datagrams for the same destination. req_ carries the first
+// datagram, the others get a request of their own. The JS callback runs
+// once all of them have completed.
+class SendBatchWrap : public ReqWrap<uv_udp_send_t> {
+ public:
+  SendBatchWrap(Local<Object> req_wrap_obj, unsigned int count)
+      : ReqWrap<uv_udp_send_t>(req_wrap_obj),
+        reqs_(count > 1 ? new uv_udp_send_t[count - 1] : NULL),
+        pending_(0),
+        status_(0) {
+  }
+
+  ~SendBatchWrap() {
+    delete[] reqs_;
+  }
+
+  uv_udp_send_t* req(unsigned int index) {
+    return index == 0 ? &req_ : &reqs_[index - 1];
+  }
+
+  uv_udp_send_t* reqs_;
+  unsigned int pending_;
+  int status_;
+};
+
 static Persistent<Function> constructor;
 static Cached<String> buffer_sym;
 static Cached<String> oncomplete_sym;
 static Cached<String> onmessage_sym;
+static Cached<String> onmessages_sym;
 
 
 UDPWrap::UDPWrap(Handle<Object> object)
-    : HandleWrap(object, reinterpret_cast<uv_handle_t*>(&handle_)) {
+    : HandleWrap(object, reinterpret_cast<uv_handle_t*>(&handle_)),
+      recv_batch_(0),
+      recv_arena_(NULL),
+      recv_arena_size_(0),
+      recv_entries_(NULL),
+      recv_count_(0) {
   int r = uv_udp_init(uv_default_loop(), &handle_);
   assert(r == 0);  // can't fail anyway
 }
 
 
 UDPWrap::~UDPWrap() {
+  free(recv_arena_);
+  free(recv_entries_);
 }
 
 
@@ -73,6 +111,7 @@ void UDPWrap::Initialize(Handle<Object> target) {
   buffer_sym = String::New("buffer");
   oncomplete_sym = String::New("oncomplete");
   onmessage_sym = String::New("onmessage");
+  onmessages_sym = String::New("onmessages");
 
   Local<FunctionTemplate> t = FunctionTemplate::New(New);
   t->InstanceTemplate()->SetInternalFieldCount(1);
@@ -91,6 +130,8 @@ void UDPWrap::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "send", Send);
   NODE_SET_PROTOTYPE_METHOD(t, "bind6", Bind6);
   NODE_SET_PROTOTYPE_METHOD(t, "send6", Send6);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendBatch", SendBatch);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendBatch6", SendBatch6);
   NODE_SET_PROTOTYPE_METHOD(t, "close", Close);
   NODE_SET_PROTOTYPE_METHOD(t, "recvStart", RecvStart);
   NODE_SET_PROTOTYPE_METHOD(t, "recvStop", RecvStop);
@@ -286,11 +327,138 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  HandleScope scope(node_isolate);
+  struct sockaddr_in addr;
+  struct sockaddr_in6 addr6;
+  unsigned int i;
+  int err;
+
+  UNWRAP(UDPWrap)
+
+  // sendBatch(req, buffers, port, address)
+  assert(args[0]->IsObject());
+  assert(args[1]->IsArray());
+  assert(args[2]->IsUint32());
+  assert(args[3]->IsString());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> buffers = args[1].As<Array>();
+  const unsigned short port = args[2]->Uint32Value();
+  String::Utf8Value address(args[3]);
+  const unsigned int count = buffers->Length();
+
+  assert(count > 0);
+
+  switch (family) {
+  case AF_INET:
+    addr = uv_ip4_addr(*address, port);
+    break;
+  case AF_INET6:
+    addr6 = uv_ip6_addr(*address, port);
+    break;
+  default:
+    assert(0 && "unexpected address family");
+    abort();
+  }
+
+  SendBatchWrap* req_wrap = new SendBatchWrap(req_wrap_obj, count);
+  req_wrap->object()->SetHiddenValue(buffer_sym, buffers);
+
+  // The datagrams are queued up here and written out by libuv with as few
+  // system calls as the platform allows.
+  for (err = 0, i = 0; i < count; i++) {
+    Local<Value> buffer_obj = buffers->Get(i);
+    assert(Buffer::HasInstance(buffer_obj));
+
+    uv_buf_t buf = uv_buf_init(Buffer::Data(buffer_obj),
+                               Buffer::Length(buffer_obj));
+    uv_udp_send_t* req = req_wrap->req(i);
+    req->data = req_wrap;
+
+    if (family == AF_INET)
+      err = uv_udp_send(req, &wrap->handle_, &buf, 1, addr, OnSendBatch);
+    else
+      err = uv_udp_send6(req, &wrap->handle_, &buf, 1, addr6, OnSendBatch);
+
+    if (err)
+      break;
+  }
+
+  req_wrap->Dispatched();
+  req_wrap->pending_ = i;
+
+  // Nothing was queued, report the error right away. Otherwise it's
+  // reported when the datagrams that did make it have been sent.
+  if (i == 0) {
+    delete req_wrap;
+  } else {
+    req_wrap->status_ = err;
+    err = 0;
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+
+// recvStart([nmsgs, slot_size])
+//
+// With nmsgs > 0, up to nmsgs datagrams are read per system call and handed
+// to onmessages() in one go, sharing a single buffer. Datagrams larger than
+// slot_size bytes are truncated.
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(node_isolate);
   UNWRAP(UDPWrap)
 
-  int err = uv_udp_recv_start(&wrap->handle_, OnAlloc, OnRecv);
+  unsigned int nmsgs = args[0]->Uint32Value();
+  size_t slot_size = args[1]->Uint32Value();
+  int err;
+
+  if (slot_size == 0)
+    slot_size = 64 * 1024;
+
+  // libuv splits the arena into as many slots as it reads datagrams per
+  // batch. Reading more than kMaxRecvBatch at once is capped, so a larger
+  // arena would only make the slots bigger than slot_size.
+  if (nmsgs > kMaxRecvBatch)
+    nmsgs = kMaxRecvBatch;
+
+  if (nmsgs == 0)
+    err = uv_udp_recv_start(&wrap->handle_, OnAlloc, OnRecv);
+  else
+    err = uv_udp_recv_batch_start(&wrap->handle_, nmsgs, OnAlloc, OnRecv);
+
+  // libuv doesn't read until the next tick of the event loop so it's safe
+  // to set up the arena after the fact. The arena is not in use here: if we
+  // are called from onmessages(), the batch has been handed off already.
+  if (err == 0 && nmsgs != 0) {
+    if (nmsgs * slot_size != wrap->recv_arena_size_) {
+      free(wrap->recv_arena_);
+      wrap->recv_arena_size_ = nmsgs * slot_size;
+      wrap->recv_arena_ = static_cast<char*>(malloc(wrap->recv_arena_size_));
+    }
+    wrap->recv_entries_ = static_cast<RecvBatchEntry*>(
+        realloc(wrap->recv_entries_, nmsgs * sizeof(*wrap->recv_entries_)));
+    if (wrap->recv_arena_ == NULL || wrap->recv_entries_ == NULL) {
+      FatalError("node::UDPWrap::RecvStart(const FunctionCallbackInfo&)",
+                 "Out Of Memory");
+    }
+  }
+
+  if (err == 0)
+    wrap->recv_batch_ = nmsgs;
+
   // UV_EALREADY means that the socket is already bound but that's okay
   if (err == UV_EALREADY) err = 0;
   args.GetReturnValue().Set(err);
@@ -347,7 +515,32 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 }
 
 
+void UDPWrap::OnSendBatch(uv_udp_send_t* req, int status) {
+  assert(req != NULL);
+
+  SendBatchWrap* req_wrap = static_cast<SendBatchWrap*>(req->data);
+
+  if (status < 0 && req_wrap->status_ == 0)
+    req_wrap->status_ = status;
+
+  assert(req_wrap->pending_ > 0);
+  if (--req_wrap->pending_ > 0)
+    return;
+
+  HandleScope scope(node_isolate);
+  Local<Object> req_wrap_obj = req_wrap->object();
+  Local<Value> arg = Integer::New(req_wrap->status_, node_isolate);
+  MakeCallback(req_wrap_obj, oncomplete_sym, 1, &arg);
+  delete req_wrap;
+}
+
+
 uv_buf_t UDPWrap::OnAlloc(uv_handle_t* handle, size_t suggested_size) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+
+  if (wrap->recv_batch_ != 0)
+    return uv_buf_init(wrap->recv_arena_, wrap->recv_arena_size_);
+
   char* data = static_cast<char*>(malloc(suggested_size));
   if (data == NULL && suggested_size > 0) {
     FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t)",
@@ -362,14 +555,32 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      uv_buf_t buf,
                      struct sockaddr* addr,
                      unsigned flags) {
+  UDPWrap* wrap = reinterpret_cast<UDPWrap*>(handle->data);
+
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    if (nread > 0)
+      wrap->AddToRecvBatch(uv_buf_init(buf.base, nread), addr);
+    return;
+  }
+
+  // The arena is owned by the wrap. Seeing it here means the batch is done,
+  // either because libuv hands it back or because this platform reads one
+  // datagram at a time, or that an error happened halfway.
+  if (buf.base != NULL && buf.base == wrap->recv_arena_) {
+    if (nread > 0)
+      wrap->AddToRecvBatch(uv_buf_init(buf.base, nread), addr);
+    wrap->FlushRecvBatch();
+    if (nread >= 0)
+      return;
+    buf = uv_buf_init(NULL, 0);
+  }
+
   if (nread == 0) {
     if (buf.base != NULL)
       free(buf.base);
     return;
   }
 
-  UDPWrap* wrap = reinterpret_cast<UDPWrap*>(handle->data);
-
   HandleScope scope(node_isolate);
   Local<Object> wrap_obj = wrap->object();
   Local<Value> argv[] = {
@@ -394,6 +605,62 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
 }
 
 
+void UDPWrap::AddToRecvBatch(const uv_buf_t& buf,
+                             const struct sockaddr* addr) {
+  assert(recv_count_ < recv_batch_);
+
+  RecvBatchEntry* entry = &recv_entries_[recv_count_++];
+  entry->base = buf.base;
+  entry->len = buf.len;
+
+  if (addr->sa_family == AF_INET6)
+    memcpy(&entry->addr, addr, sizeof(struct sockaddr_in6));
+  else
+    memcpy(&entry->addr, addr, sizeof(struct sockaddr_in));
+}
+
+
+void UDPWrap::FlushRecvBatch() {
+  const unsigned int count = recv_count_;
+
+  if (count == 0)
+    return;
+
+  // Reset first, onmessages() may restart the handle in a different mode.
+  recv_count_ = 0;
+
+  size_t size = 0;
+  for (unsigned int i = 0; i < count; i++)
+    size += recv_entries_[i].len;
+
+  char* data = static_cast<char*>(malloc(size));
+  if (data == NULL)
+    FatalError("node::UDPWrap::FlushRecvBatch()", "Out Of Memory");
+
+  HandleScope scope(node_isolate);
+  Local<Array> lengths = Array::New(count);
+  Local<Array> rinfos = Array::New(count);
+
+  for (size_t i = 0, offset = 0; i < count; i++) {
+    const RecvBatchEntry& entry = recv_entries_[i];
+    memcpy(data + offset, entry.base, entry.len);
+    offset += entry.len;
+    lengths->Set(i, Integer::NewFromUnsigned(entry.len, node_isolate));
+    rinfos->Set(i, AddressToJS(reinterpret_cast<const sockaddr*>(&entry.addr)));
+  }
+
+  Local<Object> wrap_obj = object();
+  Local<Value> argv[] = {
+    Integer::New(count, node_isolate),
+    wrap_obj,
+    Buffer::Use(data, size),
+    lengths,
+    rinfos
+  };
+  MakeCallback(wrap_obj, onmessages_sym, ARRAY_SIZE(argv), argv);
+}
+
+
 UDPWrap* UDPWrap::Unwrap(Local<Object> obj) {
   assert(!obj.IsEmpty());
   assert(obj->InternalFieldCount() > 0);
@@ -38,6 +38,8 @@ class UDPWrap: public HandleWrap {
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetSockName(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -61,18 +63,38 @@ class UDPWrap: public HandleWrap {
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
   static uv_buf_t OnAlloc(uv_handle_t* handle, size_t suggested_size);
   static void OnSend(uv_udp_send_t* req, int status);
+  static void OnSendBatch(uv_udp_send_t* req, int status);
   static void OnRecv(uv_udp_t* handle,
                      ssize_t nread,
                      uv_buf_t buf,
                      struct sockaddr* addr,
                      unsigned flags);
 
+  void AddToRecvBatch(const uv_buf_t& buf, const struct sockaddr* addr);
+  void FlushRecvBatch();
+
+  struct RecvBatchEntry {
+    char* base;
+    size_t len;
+    struct sockaddr_storage addr;
+  };
+
   uv_udp_t handle_;
+
+  // Batched receive mode, see RecvStart(). Datagrams are read into the
+  // arena and copied into one buffer for JS once the batch is complete.
+  unsigned int recv_batch_;
+  char* recv_arena_;
+  size_t recv_arena_size_;
+  RecvBatchEntry* recv_entries_;
+  unsigned int recv_count_;
 };
 
 }  // namespace node
@@ -0,0 +1,168 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// The base64, hex and ascii conversions work on blocks of 16 or 32 bytes
+// and leave the rest to a byte-at-a-time loop. Compare them against a
+// plain JS implementation for every length and alignment around the block
+// sizes, and for inputs that make the block loops bail out halfway.
+// The test runs again with NODE_SIMD set, once for every code path.
+
+var common = require('../common');
+var assert = require('assert');
+var spawn = require('child_process').spawn;
+
+var alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+function base64(buf) {
+  var s = '';
+  for (var i = 0; i < buf.length; i += 3) {
+    var n = buf[i] << 16 | (buf[i + 1] | 0) << 8 | (buf[i + 2] | 0);
+    s += alphabet[n >> 18] + alphabet[n >> 12 & 63];
+    s += i + 1 < buf.length ? alphabet[n >> 6 & 63] : '=';
+    s += i + 2 < buf.length ? alphabet[n & 63] : '=';
+  }
+  return s;
+}
+
+function hex(buf) {
+  var s = '';
+  for (var i = 0; i < buf.length; i++)
+    s += (buf[i] < 16 ? '0' : '') + buf[i].toString(16);
+  return s;
+}
+
+function ascii(buf) {
+  var s = '';
+  for (var i = 0; i < buf.length; i++)
+    s += String.fromCharCode(buf[i] & 0x7f);
+  return s;
+}
+
+var seed = 1;
+function random() {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return seed >> 16;
+}
+
+var pool = new Buffer(256);
+for (var i = 0; i < pool.length; i++)
+  pool[i] = random() & 0xff;
+
+for (var offset = 0; offset < 4; offset++) {
+  for (var len = 0; len <= 130; len++) {
+    var buf = pool.slice(offset, offset + len);
+    var b64 = base64(buf);
+    var hx = hex(buf);
+
+    assert.equal(buf.toString('base64'), b64);
+    assert.equal(buf.toString('hex'), hx);
+    assert.equal(buf.toString('ascii'), ascii(buf));
+    assert.equal(buf.toString('binary', 0), buf.toString('binary'));
+
+    assert.deepEqual(new Buffer(b64, 'base64'), buf);
+    assert.deepEqual(new Buffer(b64.replace(/=+$/, ''), 'base64'), buf);
+    assert.deepEqual(new Buffer(hx, 'hex'), buf);
+    assert.deepEqual(new Buffer(hx.toUpperCase(), 'hex'), buf);
+
+    // URL-safe alphabet.
+    var url = b64.replace(/\+/g, '-').replace(/\//g, '_');
+    assert.deepEqual(new Buffer(url, 'base64'), buf);
+
+    // Line breaks every 19 characters, so most blocks have one in them.
+    var wrapped = b64.replace(/.{19}/g, '$&\n');
+    assert.deepEqual(new Buffer(wrapped, 'base64'), buf);
+
+    // ASCII only input takes the fast path for utf8.
+    var text = ascii(buf);
+    assert.equal(new Buffer(text).toString('utf8'), text);
+    assert.equal(Buffer.byteLength(text, 'utf8'), len);
+  }
+}
+
+// Non-ASCII bytes at every position of a 64 byte block.
+for (var pos = 0; pos < 64; pos++) {
+  var text = new Buffer(64);
+  text.fill('a');
+  text[pos] = 0xe9;
+  var expected = new Array(pos + 1).join('a') + '�' +
+                 new Array(64 - pos).join('a');
+  assert.equal(text.toString('utf8'), expected);
+  assert.equal(text.toString('ascii'), expected.replace('�', 'i'));
+}
+
+// Hex decoding stops at the first invalid pair, wherever it is.
+var digits = new Array(65).join('0f');
+for (var pos = 0; pos < 128; pos += 5) {
+  var bad = digits.slice(0, pos) + 'x' + digits.slice(pos + 1);
+  var decoded = new Buffer(bad, 'hex');
+  assert.equal(decoded.length, pos >> 1);
+  for (var i = 0; i < decoded.length; i++)
+    assert.equal(decoded[i], 0x0f);
+}
+
+// Large buffers turn into external strings, decoding those goes through a
+// different path than heap strings.
+var big = new Buffer(4 * 1024 * 1024 + 4);
+for (var i = 0; i < big.length; i++)
+  big[i] = i * 7 & 0xff;
+var bigBase64 = big.toString('base64');
+assert.equal(bigBase64.slice(0, 64), base64(big.slice(0, 48)));
+assert.equal(bigBase64.slice(-8), base64(big.slice(-5)));
+assert.deepEqual(new Buffer(bigBase64, 'base64'), big);
+var bigHex = big.toString('hex');
+assert.equal(bigHex.slice(-10), hex(big.slice(-5)));
+assert.deepEqual(new Buffer(bigHex, 'hex'), big);
+var bigBinary = big.toString('binary');
+assert.equal(Buffer.byteLength(bigBinary, 'utf8'),
+             new Buffer(bigBinary, 'utf8').length);
+
+// Writing into a larger buffer leaves the bytes after the decoded data
+// alone. The vector decoders produce 12 or 24 bytes per block.
+var target = new Buffer(256);
+for (var len = 0; len <= 100; len++) {
+  var b64 = base64(pool.slice(0, len));
+  for (var offset = 0; offset < 4; offset++) {
+    target.fill(0xaa);
+    var written = target.write(b64, offset, 'base64');
+    assert.equal(written, len);
+    assert.deepEqual(target.slice(offset, offset + len), pool.slice(0, len));
+    for (var i = 0; i < target.length; i++) {
+      if (i < offset || i >= offset + len)
+        assert.equal(target[i], 0xaa);
+    }
+  }
+}
+
+if (process.argv[2] !== 'child') {
+  ['ssse3', 'none'].forEach(function(simd) {
+    var env = {};
+    for (var key in process.env)
+      env[key] = process.env[key];
+    env.NODE_SIMD = simd;
+    var child = spawn(process.execPath, [__filename, 'child'], {
+      env: env,
+      stdio: 'inherit'
+    });
+    child.on('exit', function(code) {
+      assert.equal(code, 0, 'NODE_SIMD=' + simd);
+    });
+  });
+}
@@ -0,0 +1,129 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// fork() with serialization: 'binary'. Messages have to round trip like they
+// do with JSON, except that buffers stay buffers, and handles have to arrive
+// with their message.
+
+var common = require('../common');
+var assert = require('assert');
+var fork = require('child_process').fork;
+var net = require('net');
+
+if (process.argv[2] === 'child') {
+  process.on('message', function(m, handle) {
+    if (handle) {
+      process.send({ cmd: 'server', port: handle.address().port });
+      handle.close();
+      return;
+    }
+    process.send(m);
+  });
+  return;
+}
+
+var big = new Buffer(3 * 1024 * 1024);
+for (var i = 0; i < big.length; i++)
+  big[i] = i % 251;
+
+var messages = [
+  { a: 1, b: 'str', c: [1, null, true, false, -2.5], d: { e: {} } },
+  'ünïcødé ☃',
+  [],
+  { buf: new Buffer([1, 2, 3]), empty: new Buffer(0) },
+  { big: big },
+  { deep: { deeper: { deepest: [[['x']]] } } }
+];
+
+// What JSON.stringify would make of it.
+var dropped = {
+  fn: function() {},
+  undef: undefined,
+  arr: [undefined, function() {}],
+  date: new Date(0),
+  num: new Number(3)
+};
+
+assert.throws(function() {
+  fork(__filename, ['child'], { serialization: 'xml' });
+}, TypeError);
+
+var child = fork(__filename, ['child'], { serialization: 'binary' });
+var received = [];
+
+var circular = {};
+circular.self = circular;
+assert.throws(function() {
+  child.send(circular);
+}, TypeError);
+
+messages.forEach(function(m) {
+  child.send(m);
+});
+child.send(dropped);
+
+var server = net.createServer();
+var gotServer = false;
+
+child.on('message', function(m) {
+  if (m && m.cmd === 'server') {
+    assert.equal(m.port, common.PORT);
+    gotServer = true;
+    server.close();
+    child.disconnect();
+    return;
+  }
+
+  received.push(m);
+  if (received.length !== messages.length + 1)
+    return;
+
+  messages.forEach(function(m, i) {
+    assert.deepEqual(received[i], m);
+  });
+  assert(Buffer.isBuffer(received[3].buf));
+  assert(Buffer.isBuffer(received[3].empty));
+  assert(Buffer.isBuffer(received[4].big));
+  assert.equal(received[4].big.length, big.length);
+  assert.equal(received[4].big.toString('hex', 1e6, 1e6 + 100),
+               big.toString('hex', 1e6, 1e6 + 100));
+  assert.deepEqual(received[6], JSON.parse(JSON.stringify(dropped)));
+
+  server.listen(common.PORT, function() {
+    child.send('server', server);
+  });
+});
+
+// The format is checked when it is decoded.
+var serializer = process.binding('serializer');
+var frame = serializer.serialize({ a: [1, 2, 3] });
+assert.equal(frame.readUInt32LE(0), frame.length - serializer.headerSize);
+assert.throws(function() {
+  serializer.deserialize(frame, serializer.headerSize, frame.length - 5);
+});
+assert.throws(function() {
+  serializer.deserialize(new Buffer([255]), 0, 1);
+});
+
+process.on('exit', function() {
+  assert.equal(received.length, messages.length + 1);
+  assert(gotServer);
+});
@@ -0,0 +1,81 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Commands are looked up in the PATH of the child's environment, not in the
+// one of the parent.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var spawn = require('child_process').spawn;
+
+if (process.platform === 'win32') {
+  console.error('Skipping: POSIX only.');
+  process.exit(0);
+}
+
+var dir = path.join(common.tmpDir, 'spawn-path');
+var tools = {
+  'spawn-path-tool': '#!/bin/sh\necho "$1 from tool"\n',
+  // No #! line, run by /bin/sh like execvp() does.
+  'spawn-path-script': 'echo "$1 from script"\n'
+};
+
+try {
+  fs.mkdirSync(dir);
+} catch (e) {}
+Object.keys(tools).forEach(function(name) {
+  fs.writeFileSync(path.join(dir, name), tools[name]);
+  fs.chmodSync(path.join(dir, name), '755');
+});
+
+var results = {};
+
+function run(name, env) {
+  var child = spawn(name, ['hello'], { env: env });
+  var output = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', function(chunk) {
+    output += chunk;
+  });
+  child.on('error', function(err) {
+    results[name] = err.code;
+  });
+  child.on('close', function(code) {
+    if (!(name in results))
+      results[name] = output;
+  });
+}
+
+var env = { PATH: '/nonexistent:' + dir };
+run('spawn-path-tool', env);
+run('spawn-path-script', env);
+
+process.on('exit', function() {
+  assert.equal(results['spawn-path-tool'], 'hello from tool\n');
+  assert.equal(results['spawn-path-script'], 'hello from script\n');
+  Object.keys(tools).forEach(function(name) {
+    fs.unlinkSync(path.join(dir, name));
+  });
+  fs.rmdirSync(dir);
+});
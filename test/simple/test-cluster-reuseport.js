@@ -0,0 +1,73 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var net = require('net');
+
+var NUM_WORKERS = 2;
+var NUM_CONNS = 32;
+
+if (cluster.isMaster) {
+  cluster.schedulingPolicy = cluster.SCHED_REUSEPORT;
+
+  var listening = 0;
+  var ports = {};
+  var served = 0;
+
+  for (var i = 0; i < NUM_WORKERS; i++)
+    cluster.fork();
+
+  cluster.on('listening', function(worker, address) {
+    // The port 0 server must end up on the same port in every worker.
+    if (address.port !== common.PORT)
+      ports[address.port] = true;
+    if (++listening < NUM_WORKERS * 2)
+      return;
+    assert.equal(Object.keys(ports).length, 1);
+    for (var i = 0; i < NUM_CONNS; i++)
+      connect(i % 2 ? common.PORT : +Object.keys(ports)[0]);
+  });
+
+  function connect(port) {
+    net.connect(port, function() {
+      this.end();
+    }).on('end', function() {
+      if (++served < NUM_CONNS)
+        return;
+      for (var id in cluster.workers)
+        cluster.workers[id].kill();
+    }).resume();
+  }
+
+  process.on('exit', function() {
+    assert.equal(served, NUM_CONNS);
+  });
+} else {
+  var server = net.createServer(function(conn) {
+    conn.end();
+  });
+  server.listen(common.PORT);
+  net.createServer(function(conn) {
+    conn.end();
+  }).listen(0);
+}
@@ -0,0 +1,89 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// worker.disconnect() doesn't overtake the messages that went through the
+// shared memory ring before it, including ones queued while the ring is full,
+// and the master emits what a worker put in the ring before 'disconnect'.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+
+var N = 5000;
+var M = 50;
+var ringSize = 4096;
+
+if (cluster.isWorker) {
+  var worker = cluster.worker;
+  assert(worker._ring !== null);
+
+  if (process.env.ROLE === 'receiver') {
+    var received = 0;
+    process.on('message', function(m) {
+      assert.equal(m.seq, received++);
+    });
+    process.on('exit', function() {
+      assert.equal(received, N);
+    });
+    return;
+  }
+
+  for (var i = 0; i < M; i++)
+    assert.equal(worker.send({ seq: i }), true);
+  worker.disconnect();
+  return;
+}
+
+cluster.setupMaster({ ringSize: ringSize });
+
+var queued = 0;
+var sent = 0;
+var exited = 0;
+
+var receiver = cluster.fork({ ROLE: 'receiver' });
+receiver.on('online', function() {
+  assert(receiver._ring !== null);
+  for (var i = 0; i < N; i++) {
+    if (receiver.send({ seq: i }) === false)
+      queued++;
+  }
+  receiver.disconnect();
+});
+
+var sender = cluster.fork({ ROLE: 'sender' });
+sender.on('message', function(m) {
+  assert.equal(m.seq, sent++);
+});
+sender.on('disconnect', function() {
+  assert.equal(sent, M);
+});
+
+cluster.on('exit', function(worker, code) {
+  assert.equal(code, 0);
+  exited++;
+});
+
+process.on('exit', function() {
+  assert(queued > 0);
+  assert.equal(sent, M);
+  assert.equal(exited, 2);
+});
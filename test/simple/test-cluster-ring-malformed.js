@@ -0,0 +1,84 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// A message in the ring that can't be decoded: the messages before it are
+// delivered, then onerror is called and nothing after it is read.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var Ring = process.binding('ring_wrap').Ring;
+
+if (process.platform === 'win32') {
+  console.error('Skipping: no shared memory rings on Windows.');
+  process.exit(0);
+}
+
+var capacity = 4096;
+var fds = [];
+var master = new Ring();
+assert.equal(master.create(capacity, fds), 0);
+
+master.writeMessage('first');
+master.writeMessage('second');
+master.writeMessage('third');
+
+// The data of the master to worker ring is at the start of the last two
+// rings' worth of the segment. Overwrite the body of the second message.
+var shm = fds[0];
+var base = fs.fstatSync(shm).size - 2 * capacity;
+var header = new Buffer(4);
+fs.readSync(shm, header, 0, 4, base);
+var second = base + ((4 + header.readUInt32LE(0) + 3) & ~3);
+fs.readSync(shm, header, 0, 4, second);
+var garbage = new Buffer(header.readUInt32LE(0));
+garbage.fill(0xff);
+fs.writeSync(shm, garbage, 0, garbage.length, second + 4);
+
+var worker = new Ring();
+assert.equal(worker.open(fds[0], fds[1], fds[2]), 0);
+
+var received = [];
+var error = null;
+var timer = setTimeout(assert.fail, 5000);
+
+worker.onmessage = function(messages) {
+  assert.equal(error, null);
+  for (var i = 0; i < messages.length; i++)
+    received.push(messages[i]);
+};
+worker.onerror = function(err) {
+  assert.equal(error, null);
+  error = err;
+  clearTimeout(timer);
+  // Give a stray read a chance to show up.
+  setTimeout(function() {
+    worker.close();
+    master.close();
+  }, 50);
+};
+worker.readStart();
+
+process.on('exit', function() {
+  assert.deepEqual(received, ['first']);
+  assert(error instanceof Error);
+});
@@ -0,0 +1,105 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Messages sent through the shared memory rings arrive complete and in
+// order in both directions, including ones that wrap around the end of a
+// ring and ones queued while the ring is full.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+
+var N = 20000;
+var ringSize = 4096;
+
+function message(i) {
+  var m = { seq: i, pad: new Array(i % 500).join('x') };
+  if (i % 7 === 0)
+    m.buf = new Buffer([i & 0xff, (i >> 8) & 0xff]);
+  return m;
+}
+
+function check(m, i) {
+  var expected = message(i);
+  assert.equal(m.seq, expected.seq);
+  assert.equal(m.pad, expected.pad);
+  if (expected.buf) {
+    assert(Buffer.isBuffer(m.buf));
+    assert.deepEqual(m.buf.toJSON(), expected.buf.toJSON());
+  }
+}
+
+if (cluster.isWorker) {
+  var worker = cluster.worker;
+  assert(worker._ring !== null);
+  var received = 0;
+  process.on('message', function(m) {
+    if (m === 'done')
+      return process.send({ received: received });
+    check(m, received++);
+    worker.send(m);
+  });
+  return;
+}
+
+cluster.setupMaster({ ringSize: ringSize });
+var worker = cluster.fork();
+var received = 0;
+var queued = 0;
+var tooLarge = false;
+var exited = false;
+
+worker.on('online', function() {
+  assert(worker._ring !== null);
+
+  assert.throws(function() {
+    worker.send({ big: new Array(ringSize).join('x') });
+  }, RangeError);
+  tooLarge = true;
+
+  for (var i = 0; i < N; i++) {
+    if (worker.send(message(i)) === false)
+      queued++;
+  }
+});
+
+worker.on('message', function(m) {
+  if (typeof m.received === 'number') {
+    assert.equal(m.received, N);
+    return worker.disconnect();
+  }
+  check(m, received++);
+  if (received === N)
+    worker.process.send('done');
+});
+
+worker.on('exit', function(code) {
+  assert.equal(code, 0);
+  exited = true;
+});
+
+process.on('exit', function() {
+  assert(tooLarge);
+  assert.equal(received, N);
+  assert(queued > 0);
+  assert(exited);
+});
@@ -0,0 +1,145 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Hash and Hmac updates with a callback run on the thread pool.  The
+// digests have to match the synchronous ones, no matter how the updates
+// and digests are interleaved.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+var chunks = ['abc', new Buffer(1024 * 1024), 'déjà vu', new Buffer(0)];
+chunks[1].fill(0x5a);
+
+function syncDigest(hash) {
+  hash.update(chunks[0]);
+  hash.update(chunks[1]);
+  hash.update(chunks[2], 'utf8');
+  hash.update(chunks[3]);
+  return hash.digest('hex');
+}
+
+var expectedHash = syncDigest(crypto.createHash('sha256'));
+var expectedHmac = syncDigest(crypto.createHmac('sha1', 'secret'));
+var done = 0;
+
+// Updates queued back to back, digest queued behind them.
+[
+  [crypto.createHash('sha256'), expectedHash],
+  [crypto.createHmac('sha1', 'secret'), expectedHmac]
+].forEach(function(test) {
+  var hash = test[0];
+  var updates = 0;
+  function updated(err) {
+    assert.equal(err, null);
+    updates++;
+  }
+  hash.update(chunks[0], updated);
+  hash.update(chunks[1], updated);
+  hash.update(chunks[2], 'utf8', updated);
+  hash.update(chunks[3], updated);
+
+  // The hash belongs to the thread pool now.
+  assert.throws(function() { hash.update('x'); }, /in progress/);
+  assert.throws(function() { hash.digest(); }, /in progress/);
+
+  hash.digest('hex', function(err, digest) {
+    assert.equal(err, null);
+    assert.equal(updates, 4);
+    assert.equal(digest, test[1]);
+    done++;
+  });
+});
+
+// Each update issued from the callback of the previous one, then a
+// synchronous digest once nothing is queued any more.
+(function() {
+  var hash = crypto.createHash('sha256');
+  var i = 0;
+  (function next() {
+    if (i === chunks.length) {
+      assert.equal(hash.digest('hex'), expectedHash);
+      done++;
+      return;
+    }
+    var chunk = chunks[i++];
+    hash.update(chunk, typeof chunk === 'string' ? 'utf8' : null, next);
+  })();
+})();
+
+// The stream interface in async mode.
+(function() {
+  var hash = crypto.createHash('sha256', { async: true });
+  hash.setEncoding('hex');
+  hash.write(chunks[0]);
+  hash.write(chunks[1]);
+  hash.write(new Buffer(chunks[2], 'utf8'));
+  hash.end(chunks[3]);
+  hash.on('data', function(digest) {
+    assert.equal(digest, expectedHash);
+    done++;
+  });
+})();
+
+// One-shot hashing of a list of buffers.
+crypto.hash('sha256',
+            [chunks[0], chunks[1], new Buffer(chunks[2], 'utf8'), chunks[3]],
+            'hex',
+            function(err, digest) {
+  assert.equal(err, null);
+  assert.equal(digest, expectedHash);
+  done++;
+});
+
+crypto.hash('md5', 'abc', function(err, digest) {
+  assert.equal(err, null);
+  assert(Buffer.isBuffer(digest));
+  assert.equal(digest.toString('hex'), '900150983cd24fb0d6963f7d28e17f72');
+  done++;
+});
+
+assert.throws(function() {
+  crypto.hash('sha256', 'abc');
+}, /callback/);
+
+// Updating after the digest fails like the synchronous version does.
+(function() {
+  var hash = crypto.createHash('sha1');
+  hash.digest('hex', function(err) {
+    assert.equal(err, null);
+    hash.update('abc', function(err) {
+      assert(err instanceof Error);
+      done++;
+    });
+  });
+})();
+
+process.on('exit', function() {
+  assert.equal(done, 7);
+});
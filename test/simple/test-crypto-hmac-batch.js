@@ -0,0 +1,85 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// crypto.hmacBatch() has to give the same digests as one Hmac per message,
+// with one shared key, with a key per message and for every output
+// encoding.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+function hmac(algorithm, key, message, encoding) {
+  return crypto.createHmac(algorithm, key).update(message).digest(encoding);
+}
+
+var messages = [];
+var keys = [];
+for (var i = 0; i < 100; i++) {
+  var message = new Buffer(i * 37 % 2000);
+  for (var j = 0; j < message.length; j++)
+    message[j] = i + j;
+  messages.push(i % 3 === 0 ? message.toString('binary') : message);
+  keys.push(i % 2 ? 'key ' + i : new Buffer(i * 13 % 200));
+}
+
+['sha1', 'sha256', 'sha512', 'md5'].forEach(function(algorithm) {
+  ['hex', 'base64', 'binary', 'buffer', undefined].forEach(function(enc) {
+    var shared = crypto.hmacBatch(algorithm, 'secret', messages, enc);
+    var perMessage = crypto.hmacBatch(algorithm, keys, messages, enc);
+    assert.equal(shared.length, messages.length);
+    assert.equal(perMessage.length, messages.length);
+
+    for (var i = 0; i < messages.length; i++) {
+      assert.deepEqual(shared[i], hmac(algorithm, 'secret', messages[i], enc));
+      assert.deepEqual(perMessage[i],
+                       hmac(algorithm, keys[i], messages[i], enc));
+    }
+  });
+});
+
+// Buffer digests are separate slices, not views of each other.
+var digests = crypto.hmacBatch('sha256', 'k', ['a', 'b']);
+assert(Buffer.isBuffer(digests[0]));
+assert.equal(digests[0].length, 32);
+assert.notEqual(digests[0].toString('hex'), digests[1].toString('hex'));
+assert.equal(digests[1].toString('hex'), hmac('sha256', 'k', 'b', 'hex'));
+
+assert.deepEqual(crypto.hmacBatch('sha256', 'k', []), []);
+
+assert.throws(function() {
+  crypto.hmacBatch('sha256', ['a'], ['a', 'b']);
+}, /one key per message/);
+
+assert.throws(function() {
+  crypto.hmacBatch('sha256', 'k', ['a', 1]);
+}, /Not a string or buffer/);
+
+assert.throws(function() {
+  crypto.hmacBatch('nope', 'k', ['a']);
+}, /Unknown message digest/);
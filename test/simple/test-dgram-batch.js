@@ -0,0 +1,101 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+var NUM_DGRAMS = 40;
+
+var server = dgram.createSocket('udp4');
+var client = dgram.createSocket('udp4');
+var buffers = [];
+var received = [];
+var batches = 0;
+var batched = 0;
+var sendCallbacks = 0;
+var totalBytes = 100;
+
+for (var i = 0; i < NUM_DGRAMS; i++) {
+  buffers.push(new Buffer('datagram ' + i));
+  totalBytes += buffers[i].length;
+}
+
+// A datagram that doesn't fit in a 32 byte slot.
+buffers.push(new Buffer(100));
+buffers[NUM_DGRAMS].fill('x');
+
+assert.throws(function() { server.setRecvBatch(-1); }, RangeError);
+assert.throws(function() { server.setRecvBatch(65); }, RangeError);
+assert.throws(function() { server.setRecvBatch(8, 0); }, RangeError);
+assert.throws(function() { client.sendBatch('foo', common.PORT); }, TypeError);
+assert.throws(function() { client.sendBatch(['foo'], common.PORT); },
+              TypeError);
+
+// The largest batch libuv reads, the slots must still be 32 bytes each.
+server.setRecvBatch(64, 32);
+
+server.on('messages', function(msgs, rinfos) {
+  assert.equal(msgs.length, rinfos.length);
+  batches++;
+  batched += msgs.length;
+});
+
+server.on('message', function(msg, rinfo) {
+  assert.equal(rinfo.address, '127.0.0.1');
+  assert.equal(rinfo.size, msg.length);
+  received.push(msg);
+
+  if (received.length === NUM_DGRAMS + 1) {
+    server.close();
+    client.close();
+  }
+});
+
+server.on('listening', function() {
+  client.sendBatch(buffers, common.PORT, '127.0.0.1', function(err, bytes) {
+    assert.equal(err, null);
+    assert.equal(bytes, totalBytes);
+    sendCallbacks++;
+  });
+
+  // Empty batches complete without sending anything.
+  client.sendBatch([], common.PORT, '127.0.0.1', function(err, bytes) {
+    assert.equal(err, null);
+    assert.equal(bytes, 0);
+    sendCallbacks++;
+  });
+});
+
+server.bind(common.PORT);
+
+process.on('exit', function() {
+  assert.equal(sendCallbacks, 2);
+  assert.equal(received.length, NUM_DGRAMS + 1);
+  assert.equal(batched, NUM_DGRAMS + 1);
+  assert.ok(batches < NUM_DGRAMS);
+
+  for (var i = 0; i < NUM_DGRAMS; i++)
+    assert.equal(received[i].toString(), 'datagram ' + i);
+
+  // Truncated to the slot size.
+  assert.equal(received[NUM_DGRAMS].length, 32);
+});
@@ -0,0 +1,68 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+
+// fs callbacks that complete together are dispatched as one batch, with a
+// single pass over the nextTick queue at the end. nextTick callbacks must
+// still run before anything else gets a turn.
+
+var N = 200;
+var batchInfo = process._batchInfoBox;
+var batchesBefore = batchInfo[0];
+var callbacksBefore = batchInfo[1];
+
+var stats = 0;
+var ticks = 0;
+var immediates = 0;
+
+for (var i = 0; i < N; i++) {
+  fs.stat(__filename, function(er, st) {
+    assert.ifError(er);
+    assert.ok(st.isFile());
+    stats++;
+
+    var ticked = false;
+    process.nextTick(function() {
+      ticked = true;
+      ticks++;
+    });
+
+    setImmediate(function() {
+      assert.ok(ticked);
+      immediates++;
+    });
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(stats, N);
+  assert.equal(ticks, N);
+  assert.equal(immediates, N);
+
+  var batches = batchInfo[0] - batchesBefore;
+  var callbacks = batchInfo[1] - callbacksBefore;
+  assert.equal(callbacks, N);
+  assert.ok(batches > 0 && batches <= N);
+  assert.ok(batchInfo[3] >= 1);
+});
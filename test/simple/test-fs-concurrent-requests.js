@@ -0,0 +1,114 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Many fs requests in flight at once. On Linux they go through io_uring,
+// past the size of its completion queue some fall back to the thread pool.
+// Either way the results must match the synchronous calls.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+
+var N = 5000;
+var file = path.join(common.tmpDir, 'concurrent-requests.txt');
+var missing = path.join(common.tmpDir, 'does-not-exist.txt');
+var content = new Buffer(4096 + 7);
+for (var i = 0; i < content.length; i++)
+  content[i] = i & 0xff;
+fs.writeFileSync(file, content);
+
+var expected = fs.statSync(file);
+var lexpected = fs.lstatSync(file);
+var done = 0;
+
+function sameStats(a, b) {
+  assert.equal(a.ino, b.ino);
+  assert.equal(a.size, b.size);
+  assert.equal(a.mode, b.mode);
+  assert.equal(a.dev, b.dev);
+  assert.equal(a.nlink, b.nlink);
+  assert.equal(a.mtime.getTime(), b.mtime.getTime());
+  assert.equal(a.ctime.getTime(), b.ctime.getTime());
+}
+
+for (var i = 0; i < N; i++) {
+  switch (i % 5) {
+    case 0:
+      fs.stat(file, function(err, stats) {
+        assert.ifError(err);
+        sameStats(stats, expected);
+        done++;
+      });
+      break;
+    case 1:
+      fs.lstat(file, function(err, stats) {
+        assert.ifError(err);
+        sameStats(stats, lexpected);
+        done++;
+      });
+      break;
+    case 2:
+      fs.readFile(file, function(err, data) {
+        assert.ifError(err);
+        assert.equal(data.toString('hex'), content.toString('hex'));
+        done++;
+      });
+      break;
+    case 3:
+      fs.stat(missing, function(err) {
+        assert.equal(err.code, 'ENOENT');
+        done++;
+      });
+      break;
+    case 4:
+      // Positional and sequential reads on the same descriptor.
+      fs.open(file, 'r', function(err, fd) {
+        assert.ifError(err);
+        var buf = new Buffer(16);
+        fs.read(fd, buf, 0, 16, 4096, function(err, bytesRead) {
+          assert.ifError(err);
+          assert.equal(bytesRead, content.length - 4096);
+          assert.equal(buf[0], 4096 & 0xff);
+          fs.read(fd, buf, 0, 16, null, function(err, bytesRead) {
+            assert.ifError(err);
+            assert.equal(bytesRead, 16);
+            assert.equal(buf[15], 15);
+            fs.fstat(fd, function(err, stats) {
+              assert.ifError(err);
+              sameStats(stats, expected);
+              fs.close(fd, function(err) {
+                assert.ifError(err);
+                done++;
+              });
+            });
+          });
+        });
+      });
+      break;
+  }
+}
+
+process.on('exit', function() {
+  assert.equal(done, N);
+  fs.unlinkSync(file);
+});
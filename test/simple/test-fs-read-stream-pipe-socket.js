@@ -0,0 +1,96 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// fs.ReadStream#pipe() into a socket goes through sendfile(2). Check that
+// the data arrives intact and in order with the regular writes.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+
+var filename = path.join(common.tmpDir, 'sendfile.bin');
+var data = new Buffer(3 * 1024 * 1024 + 17);
+for (var i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(filename, data);
+
+var tests = [
+  // Whole file.
+  { options: {}, sendfile: true, expected: data },
+  // Part of it.
+  { options: { start: 1000, end: 1999 },
+    sendfile: true,
+    expected: data.slice(1000, 2000) },
+  // Decoded data can't skip the JS heap.
+  { options: { encoding: 'hex', start: 10, end: 19 },
+    sendfile: false,
+    expected: new Buffer(data.slice(10, 20).toString('hex')) }
+];
+var closed = 0;
+
+var server = net.createServer(function(conn) {
+  var test = tests[0];
+  var rs = fs.createReadStream(filename, test.options);
+  var piped = false;
+
+  conn.on('pipe', function(src) {
+    assert.equal(src, rs);
+    piped = true;
+  });
+
+  conn.write('head');
+  rs.pipe(conn);
+  assert.equal(!!rs._sendFile, test.sendfile);
+
+  rs.on('close', function() {
+    assert.ok(piped);
+    closed++;
+  });
+});
+
+server.listen(common.PORT, next);
+
+function next() {
+  if (tests.length === 0)
+    return server.close();
+
+  var chunks = [];
+  var conn = net.connect(common.PORT);
+  conn.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  conn.on('end', function() {
+    var received = Buffer.concat(chunks);
+    var expected = Buffer.concat([new Buffer('head'), tests[0].expected]);
+    assert.equal(received.length, expected.length);
+    assert.equal(received.toString('hex'), expected.toString('hex'));
+    tests.shift();
+    next();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(tests.length, 0);
+  assert.equal(closed, 3);
+  fs.unlinkSync(filename);
+});
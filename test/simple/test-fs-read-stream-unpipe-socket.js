@@ -0,0 +1,86 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Unpiping a fs.ReadStream that is being sent with sendfile(2) stops it
+// after the chunk in flight. The rest of the file can be read as usual.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+
+var filename = path.join(common.tmpDir, 'unpipe-sendfile.bin');
+var data = new Buffer(5 * 1024 * 1024);
+for (var i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(filename, data);
+
+var sent = null;
+var rest = [];
+var unpiped = false;
+
+var server = net.createServer(function(conn) {
+  var rs = fs.createReadStream(filename);
+
+  conn.on('pipe', function() {
+    setImmediate(function() {
+      rs.unpipe(conn);
+      rs.on('data', function(chunk) {
+        rest.push(chunk);
+      });
+    });
+  });
+  conn.on('unpipe', function(src) {
+    assert.equal(src, rs);
+    unpiped = true;
+  });
+
+  rs.pipe(conn);
+  assert.ok(rs._sendFile);
+
+  rs.on('end', function() {
+    conn.end();
+    server.close();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var chunks = [];
+  var conn = net.connect(common.PORT);
+  conn.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  conn.on('end', function() {
+    sent = Buffer.concat(chunks);
+  });
+});
+
+process.on('exit', function() {
+  assert.ok(unpiped);
+  assert.ok(sent.length > 0);
+  assert.ok(sent.length < data.length);
+  var received = Buffer.concat([sent].concat(rest));
+  assert.equal(received.length, data.length);
+  assert.equal(received.toString('hex'), data.toString('hex'));
+  fs.unlinkSync(filename);
+});
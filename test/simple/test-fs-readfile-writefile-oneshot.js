@@ -0,0 +1,151 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// fs.readFile() and fs.writeFile() do the whole job in one request on most
+// platforms. Check the cases the JS implementation used to handle step by
+// step: empty files, files that report a size of zero, encodings, append
+// mode, errors and files too big for a Buffer.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+
+var filename = path.join(common.tmpDir, 'readfile-writefile-oneshot.txt');
+try { fs.unlinkSync(filename); } catch (e) {}
+
+var big = new Buffer(3 * 1024 * 1024 + 7);
+for (var i = 0; i < big.length; i++)
+  big[i] = i % 251;
+
+var steps = [
+  function() {
+    fs.writeFile(filename, '', function(er) {
+      assert.ifError(er);
+      fs.readFile(filename, function(er, data) {
+        assert.ifError(er);
+        assert(Buffer.isBuffer(data));
+        assert.equal(data.length, 0);
+        next();
+      });
+    });
+  },
+  function() {
+    fs.writeFile(filename, big, function(er) {
+      assert.ifError(er);
+      fs.readFile(filename, function(er, data) {
+        assert.ifError(er);
+        assert.equal(data.length, big.length);
+        assert.equal(data.toString('hex', 0, 1024),
+                     big.toString('hex', 0, 1024));
+        assert.equal(data.toString('base64'), big.toString('base64'));
+        next();
+      });
+    });
+  },
+  function() {
+    // Overwrites the big file, so it gets truncated.
+    fs.writeFile(filename, 'aGVsbG8g', 'base64', function(er) {
+      assert.ifError(er);
+      fs.appendFile(filename, 'wörld', function(er) {
+        assert.ifError(er);
+        fs.readFile(filename, 'utf8', function(er, data) {
+          assert.ifError(er);
+          assert.equal(data, 'hello wörld');
+          fs.readFile(filename, { encoding: 'hex' }, function(er, data) {
+            assert.ifError(er);
+            assert.equal(data, new Buffer('hello wörld').toString('hex'));
+            next();
+          });
+        });
+      });
+    });
+  },
+  function() {
+    // The mode only applies to new files.
+    fs.unlinkSync(filename);
+    fs.writeFile(filename, 42, { mode: 0600 }, function(er) {
+      assert.ifError(er);
+      assert.equal(fs.readFileSync(filename, 'utf8'), '42');
+      if (process.platform !== 'win32')
+        assert.equal(fs.statSync(filename).mode & 0777, 0600);
+      next();
+    });
+  },
+  function() {
+    // /proc files report a size of zero.
+    if (process.platform !== 'linux')
+      return next();
+    fs.readFile('/proc/self/status', 'utf8', function(er, data) {
+      assert.ifError(er);
+      assert(/^Name:/.test(data));
+      next();
+    });
+  },
+  function() {
+    var missing = path.join(common.tmpDir, 'does-not-exist.txt');
+    fs.readFile(missing, function(er, data) {
+      assert(er);
+      assert.equal(er.code, 'ENOENT');
+      assert.equal(er.path, missing);
+      assert.equal(er.message, 'ENOENT, open \'' + missing + '\'');
+      assert.equal(data, undefined);
+      fs.writeFile(path.join(missing, 'x'), 'x', function(er) {
+        assert(er);
+        assert.equal(er.code, 'ENOENT');
+        next();
+      });
+    });
+  },
+  function() {
+    fs.readFile(common.tmpDir, function(er) {
+      assert(er);
+      assert.equal(er.code, 'EISDIR');
+      next();
+    });
+  },
+  function() {
+    // A sparse file, nothing is actually read.
+    fs.truncateSync(filename, require('smalloc').kMaxLength + 1);
+    process.once('uncaughtException', function(er) {
+      assert(er instanceof RangeError);
+      next();
+    });
+    fs.readFile(filename, function() {
+      assert(false, 'callback called');
+    });
+  }
+];
+
+var done = 0;
+function next() {
+  var step = steps[done++];
+  if (step)
+    step();
+}
+
+process.on('exit', function() {
+  assert.equal(done, steps.length + 1);
+  fs.unlinkSync(filename);
+});
+
+next();
@@ -0,0 +1,93 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// fs.watchFile() follows a file that is replaced by a rename and then
+// modified in place. On Linux the change is reported by inotify, i.e. well
+// before the next poll would have seen it. The interval is still the minimum
+// time between two stat() calls, hence the long waits.
+
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+var filename = path.join(common.tmpDir, 'watch-file-inotify');
+var tmpname = filename + '.tmp';
+var interval = 1000;
+var isLinux = process.platform === 'linux';
+
+try { fs.unlinkSync(tmpname); } catch (e) {}
+fs.writeFileSync(filename, 'one');
+var firstIno = fs.statSync(filename).ino;
+
+var changes = 0;
+var changedAt;
+
+fs.watchFile(filename, { interval: interval }, function(curr, prev) {
+  var latency = Date.now() - changedAt;
+  switch (++changes) {
+    case 1:
+      // Replaced by another file.
+      assert.equal(prev.ino, firstIno);
+      assert.notEqual(curr.ino, firstIno);
+      assert.equal(curr.size, 5);
+      setTimeout(modify, interval * 2.25);
+      break;
+    case 2:
+      // Modified in place, in between two polls.
+      assert.equal(curr.ino, prev.ino);
+      assert.equal(curr.size, 9);
+      if (isLinux)
+        assert(latency < interval / 2, 'reported after ' + latency + ' ms');
+      setTimeout(remove, interval * 1.25);
+      break;
+    case 3:
+      assert.equal(prev.size, 9);
+      assert.equal(curr.nlink, 0);
+      fs.unwatchFile(filename);
+      break;
+    default:
+      assert(false);
+  }
+});
+
+setTimeout(replace, interval * 1.25);
+
+function replace() {
+  fs.writeFileSync(tmpname, 'three');
+  fs.renameSync(tmpname, filename);
+  changedAt = Date.now();
+}
+
+function modify() {
+  fs.appendFileSync(filename, ' and');
+  changedAt = Date.now();
+}
+
+function remove() {
+  fs.unlinkSync(filename);
+  changedAt = Date.now();
+}
+
+process.on('exit', function() {
+  assert.equal(changes, 3);
+});
@@ -0,0 +1,158 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// fs.watch(dir, { recursive: true }) watches the directories that are added
+// to the tree, follows the ones that are moved around in it and forgets the
+// ones that are moved out. The changes come in batches, one entry per path.
+
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+var root = path.join(common.tmpDir, 'watch-recursive');
+var outside = path.join(common.tmpDir, 'watch-recursive-out');
+
+function rm(p) {
+  try {
+    var s = fs.lstatSync(p);
+  } catch (e) {
+    return;
+  }
+  if (s.isDirectory()) {
+    fs.readdirSync(p).forEach(function(name) {
+      rm(path.join(p, name));
+    });
+    fs.rmdirSync(p);
+  } else {
+    fs.unlinkSync(p);
+  }
+}
+
+rm(root);
+rm(outside);
+fs.mkdirSync(root);
+fs.mkdirSync(path.join(root, 'a'));
+fs.mkdirSync(path.join(root, 'a', 'b'));
+fs.writeFileSync(path.join(root, 'a', 'b', 'f'), '');
+fs.writeFileSync(path.join(root, 'a', 'c'), '');
+
+if (process.platform !== 'linux') {
+  assert.throws(function() {
+    fs.watch(root, { recursive: true });
+  }, /ENOSYS/);
+  return;
+}
+
+assert.throws(function() {
+  fs.watch(path.join(root, 'a', 'c'), { recursive: true });
+}, /ENOTDIR/);
+
+var steps = [
+  {
+    run: function() {
+      // Interleaved, so that the kernel can't merge the events.
+      for (var i = 0; i < 50; i++) {
+        fs.appendFileSync(path.join(root, 'a', 'b', 'f'), 'x');
+        fs.appendFileSync(path.join(root, 'a', 'c'), 'x');
+      }
+    },
+    check: function(changes) {
+      assert.deepEqual(changes, [
+        { event: 'change', filename: 'a/b/f' },
+        { event: 'change', filename: 'a/c' }
+      ]);
+      return true;
+    }
+  },
+  {
+    run: function() {
+      fs.mkdirSync(path.join(root, 'new'));
+      fs.mkdirSync(path.join(root, 'new', 'deep'));
+      fs.writeFileSync(path.join(root, 'new', 'deep', 'g'), '');
+    },
+    until: 'new/deep/g'
+  },
+  {
+    run: function() {
+      fs.writeFileSync(path.join(root, 'new', 'deep', 'h'), '');
+    },
+    until: 'new/deep/h'
+  },
+  {
+    run: function() {
+      fs.renameSync(path.join(root, 'new'), path.join(root, 'a', 'moved'));
+      fs.writeFileSync(path.join(root, 'a', 'moved', 'deep', 'i'), '');
+    },
+    until: 'a/moved/deep/i'
+  },
+  {
+    run: function() {
+      fs.renameSync(path.join(root, 'a', 'moved'), outside);
+      fs.writeFileSync(path.join(outside, 'deep', 'j'), '');
+      fs.appendFileSync(path.join(root, 'a', 'c'), 'x');
+    },
+    until: 'a/c'
+  }
+];
+
+var batches = 0;
+var changeEvents = 0;
+var seen = {};
+var step = 0;
+
+var watcher = fs.watch(root, { recursive: true }, function(event, filename) {
+  changeEvents++;
+});
+
+watcher.on('changes', function(changes) {
+  batches++;
+
+  var filenames = changes.map(function(change) {
+    return change.filename;
+  });
+  filenames.forEach(function(filename, i) {
+    assert.equal(filenames.indexOf(filename), i, 'duplicate ' + filename);
+    assert(!/\/j$/.test(filename), 'outside of the tree: ' + filename);
+    seen[filename] = true;
+  });
+
+  var current = steps[step];
+  var done = current.check ? current.check(changes) : seen[current.until];
+  if (!done)
+    return;
+
+  seen = {};
+  if (++step === steps.length)
+    return watcher.close();
+  setTimeout(steps[step].run, 20);
+});
+
+setTimeout(steps[0].run, 20);
+
+process.on('exit', function() {
+  assert.equal(step, steps.length);
+  assert(batches >= steps.length);
+  assert(changeEvents >= batches);
+  rm(root);
+  rm(outside);
+});
@@ -0,0 +1,112 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+
+var filename = path.join(common.tmpDir, 'writev-readv.txt');
+try { fs.unlinkSync(filename); } catch (e) {}
+
+function makeBuffers(count, size) {
+  var buffers = [];
+  for (var i = 0; i < count; i++) {
+    var b = new Buffer(size);
+    b.fill(String.fromCharCode(97 + i % 26));
+    buffers.push(b);
+  }
+  return buffers;
+}
+
+// Sync, with and without a position.
+var fd = fs.openSync(filename, 'w+');
+assert.equal(fs.writevSync(fd, [new Buffer('hello '), new Buffer('world')]),
+             11);
+assert.equal(fs.writevSync(fd, [new Buffer('W'), new Buffer('!')], 6), 2);
+assert.equal(fs.writevSync(fd, []), 0);
+var a = new Buffer(3), b = new Buffer(20);
+assert.equal(fs.readvSync(fd, [a, b], 0), 11);
+assert.equal(a.toString(), 'hel');
+assert.equal(b.toString('utf8', 0, 8), 'lo W!rld');
+assert.throws(function() {
+  fs.writevSync(fd, ['not a buffer']);
+}, TypeError);
+fs.closeSync(fd);
+
+assert.throws(function() {
+  fs.readvSync(-1, [new Buffer(1)]);
+}, /EBADF/);
+
+// More buffers than fit in one system call.
+var buffers = makeBuffers(3000, 7);
+var expected = Buffer.concat(buffers).toString();
+
+var asyncDone = false;
+fs.open(filename, 'w+', function(er, fd) {
+  assert.ifError(er);
+  fs.writev(fd, buffers, 0, function(er, written, bufs) {
+    assert.ifError(er);
+    assert.equal(written, 3000 * 7);
+    assert.strictEqual(bufs, buffers);
+    var into = makeBuffers(1000, 21);
+    fs.readv(fd, into, 0, function(er, bytesRead) {
+      assert.ifError(er);
+      assert.equal(bytesRead, 3000 * 7);
+      assert.equal(Buffer.concat(into).toString(), expected);
+      // Reading past the end of the file.
+      fs.readv(fd, [new Buffer(4)], 3000 * 7, function(er, bytesRead) {
+        assert.ifError(er);
+        assert.equal(bytesRead, 0);
+        fs.close(fd, function(er) {
+          assert.ifError(er);
+          asyncDone = true;
+          writeStream();
+        });
+      });
+    });
+  });
+});
+
+// Small writes pile up while the first one is in progress and get written
+// with writev. They must end up in order.
+var streamDone = false;
+function writeStream() {
+  var stream = fs.createWriteStream(filename);
+  var chunks = makeBuffers(500, 3);
+  chunks.forEach(function(chunk) {
+    stream.write(chunk);
+  });
+  stream.end(new Buffer('end'));
+  stream.on('close', function() {
+    assert.equal(stream.bytesWritten, 500 * 3 + 3);
+    assert.equal(fs.readFileSync(filename, 'utf8'),
+                 Buffer.concat(chunks).toString() + 'end');
+    streamDone = true;
+  });
+}
+
+process.on('exit', function() {
+  assert(asyncDone);
+  assert(streamDone);
+  fs.unlinkSync(filename);
+});
@@ -35,7 +35,7 @@ var image = fs.readFileSync(common.fixturesDir + '/person.jpg');
 console.log('image.length = ' + image.length);
 
 var total = 100;
-var requests = 0, responses = 0;
+var requests = 0, responses = 0, closed = 0;
 
 var server = http.Server(function(req, res) {
   if (++requests == total) {
@@ -68,13 +68,15 @@ server.listen(common.PORT, function() {
         var s = fs.createWriteStream(common.tmpDir + '/' + x + '.jpg');
         res.pipe(s);
 
-        // TODO there should be a callback to pipe() that will allow
-        // us to get a callback when the pipe is finished.
+        // The writes of the other streams can still be in flight when the
+        // last response ends, so wait until every file has been closed.
         res.on('end', function() {
           console.error('done ' + x);
-          if (++responses == total) {
-            s.on('close', checkFiles);
-          }
+          responses++;
+        });
+        s.on('close', function() {
+          if (++closed == total)
+            checkFiles();
         });
       }).on('error', function(e) {
         console.error('error! ', e.message);
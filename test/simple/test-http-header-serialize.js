@@ -0,0 +1,148 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Check the exact bytes of the serialized response headers, both for the
+// native serializer and for the cases that fall back to the JS one.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+var bigValue = new Array(20 * 1024).join('x');
+
+var tests = [
+  {
+    handler: function(req, res) {
+      res.writeHead(200, { 'Content-Type': 'text/plain',
+                           'Content-Length': 5 });
+      res.end('hello');
+    },
+    expect: 'HTTP/1.1 200 OK\r\n' +
+            'Content-Type: text/plain\r\n' +
+            'Content-Length: 5\r\n' +
+            'Connection: keep-alive\r\n' +
+            '\r\n' +
+            'hello'
+  },
+  {
+    handler: function(req, res) {
+      res.writeHead(404, 'Nope', { 'Set-Cookie': ['a=1', 'b=2'],
+                                   'X-Split': 'foo\r\n bar' });
+      res.end(new Buffer('buf'));
+    },
+    expect: 'HTTP/1.1 404 Nope\r\n' +
+            'Set-Cookie: a=1\r\n' +
+            'Set-Cookie: b=2\r\n' +
+            'X-Split: foobar\r\n' +
+            'Connection: keep-alive\r\n' +
+            'Transfer-Encoding: chunked\r\n' +
+            '\r\n' +
+            '3\r\nbuf\r\n0\r\n\r\n'
+  },
+  {
+    handler: function(req, res) {
+      res.writeHead(204, { 'Transfer-Encoding': 'chunked' });
+      res.end();
+    },
+    expect: 'HTTP/1.1 204 No Content\r\n' +
+            'Transfer-Encoding: chunked\r\n' +
+            'Connection: close\r\n' +
+            '\r\n'
+  },
+  {
+    // Non-ASCII header values take the JS serializer.
+    handler: function(req, res) {
+      res.writeHead(200, { 'X-Name': 'café', 'Content-Length': 2 });
+      res.end('ok');
+    },
+    expect: 'HTTP/1.1 200 OK\r\n' +
+            'X-Name: café\r\n' +
+            'Content-Length: 2\r\n' +
+            'Connection: keep-alive\r\n' +
+            '\r\n' +
+            'ok'
+  },
+  {
+    // So do headers that don't fit in the header pool.
+    handler: function(req, res) {
+      res.writeHead(200, { 'X-Big': bigValue, 'Connection': 'close' });
+      res.end();
+    },
+    expect: 'HTTP/1.1 200 OK\r\n' +
+            'X-Big: ' + bigValue + '\r\n' +
+            'Connection: close\r\n' +
+            'Transfer-Encoding: chunked\r\n' +
+            '\r\n' +
+            '0\r\n\r\n'
+  }
+];
+
+var current = 0;
+var server = http.createServer(function(req, res) {
+  res.sendDate = false;
+  tests[current].handler(req, res);
+});
+
+function next() {
+  if (current === tests.length)
+    return server.close();
+
+  var received = '';
+  var client = net.connect(common.PORT, function() {
+    client.write('GET / HTTP/1.1\r\n\r\n');
+  });
+  client.setEncoding('utf8');
+  client.on('data', function(d) {
+    received += d;
+    if (received.length >= tests[current].expect.length)
+      client.end();
+  });
+  client.on('end', function() {
+    assert.equal(received, tests[current].expect);
+    current++;
+    next();
+  });
+}
+
+server.listen(common.PORT, next);
+
+// The Date header is generated natively and cached per second.
+var dateServer = http.createServer(function(req, res) {
+  res.end();
+});
+
+var gotDate = false;
+dateServer.listen(common.PORT + 1, function() {
+  http.get({ port: common.PORT + 1 }, function(res) {
+    var date = new Date(res.headers.date);
+    assert(Math.abs(date - Date.now()) < 5000);
+    assert.equal(res.headers.date, date.toUTCString());
+    gotDate = true;
+    res.resume();
+    dateServer.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(current, tests.length);
+  assert(gotDate);
+});
@@ -0,0 +1,173 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// server.lazyHeaders: getHeader() and .headers must give the same results as
+// the eager mode, including for pipelined requests and repeated headers.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+var request = 'GET /a HTTP/1.1\r\n' +
+              'Host: example.com\r\n' +
+              'X-Route: one\r\n' +
+              'X-Route: two\r\n' +
+              'Cookie: a=1\r\n' +
+              'Cookie: b=2\r\n' +
+              'Content-Type: text/plain\r\n' +
+              'Content-Type: text/html\r\n' +
+              '\r\n';
+
+var expected = {
+  host: 'example.com',
+  'x-route': 'one, two',
+  cookie: 'a=1, b=2',
+  'content-type': 'text/plain'
+};
+
+function runServer(lazy, port, cb) {
+  var requests = 0;
+  var server = http.createServer(function(req, res) {
+    requests++;
+    if (lazy)
+      assert(req instanceof http.IncomingMessage);
+
+    // Look up single headers first, then build the whole object.
+    assert.equal(req.getHeader('HOST'), 'example.com');
+    assert.equal(req.getHeader('x-route'), 'one, two');
+    assert.equal(req.getHeader('Content-Type'), 'text/plain');
+    assert.equal(req.getHeader('x-missing'), undefined);
+    assert.deepEqual(req.headers, expected);
+    assert.equal(req.getHeader('cookie'), 'a=1, b=2');
+
+    res.end(req.url);
+  });
+  server.lazyHeaders = lazy;
+
+  server.listen(port, function() {
+    // Three pipelined requests in one write, so the parser moves on to the
+    // next message before the previous one has been looked at.
+    var client = net.connect(port, function() {
+      client.end(request + request.replace('/a', '/b') +
+                 request.replace('/a', '/c'));
+    });
+    var received = '';
+    client.setEncoding('utf8');
+    client.on('data', function(d) {
+      received += d;
+    });
+    client.on('end', function() {
+      assert.equal(requests, 3);
+      assert(/\/a[\s\S]*\/b[\s\S]*\/c/.test(received));
+      server.close();
+      cb();
+    });
+  });
+}
+
+// Headers that are only looked at after the request is complete, and
+// assigning to .headers.
+function runLateServer(port, cb) {
+  var server = http.createServer(function(req, res) {
+    req.resume();
+    req.on('end', function() {
+      assert.equal(req.getHeader('host'), 'example.com');
+      req.headers = { foo: 'bar' };
+      assert.equal(req.getHeader('foo'), 'bar');
+      assert.equal(req.getHeader('host'), undefined);
+      res.end();
+      server.close();
+      cb();
+    });
+  });
+  server.lazyHeaders = true;
+  server.listen(port, function() {
+    http.get({ port: port, headers: { host: 'example.com' } }, function(res) {
+      res.resume();
+    });
+  });
+}
+
+// The binding checks that every entry of a packed headers buffer points into
+// the buffer before it reads any of them.
+(function() {
+  var binding = process.binding('http_parser');
+
+  function pack(entries, body) {
+    var table = 4 + 16 * entries.length;
+    var buf = new Buffer(table + body.length);
+    buf.writeUInt32LE(entries.length, 0);
+    entries.forEach(function(entry, i) {
+      for (var j = 0; j < 4; j++)
+        buf.writeUInt32LE(entry[j], 4 + 16 * i + 4 * j);
+    });
+    buf.write(body, table, 'binary');
+    return buf;
+  }
+
+  // 'Host: a', the body starts at offset 20.
+  var good = pack([[20, 4, 24, 1]], 'Hosta');
+  assert.equal(binding.findHeader(good, 'host', 0), 'a');
+  assert.deepEqual(binding.unpackHeaders(good, 0), ['Host', 'a']);
+
+  [
+    [[20, 4, 24, 2]],           // Value runs past the end.
+    [[20, 4, 25, 0xffffffff]],  // Offset plus length wraps around.
+    [[0xffffffff, 4, 24, 1]],   // Name starts past the end.
+    [[20, 4, 24, 1], [20, 4, 100, 1]]  // Only the second entry is bad.
+  ].forEach(function(entries) {
+    var buf = pack(entries, 'Hosta');
+    assert.throws(function() {
+      binding.findHeader(buf, 'host', 0);
+    }, TypeError);
+    assert.throws(function() {
+      binding.unpackHeaders(buf, 0);
+    }, TypeError);
+  });
+
+  // Entries beyond the limit aren't looked at. Two entries, the body starts
+  // at offset 36.
+  var limited = pack([[36, 4, 40, 1], [36, 4, 100, 1]], 'Hosta');
+  assert.deepEqual(binding.unpackHeaders(limited, 2), ['Host', 'a']);
+
+  // A count that would need a table larger than the buffer.
+  var huge = pack([[20, 4, 24, 1]], 'Hosta');
+  huge.writeUInt32LE(0x40000000, 0);
+  assert.throws(function() {
+    binding.unpackHeaders(huge, 0);
+  }, TypeError);
+})();
+
+var done = 0;
+runServer(false, common.PORT, function() {
+  done++;
+  runServer(true, common.PORT + 1, function() {
+    done++;
+    runLateServer(common.PORT + 2, function() {
+      done++;
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(done, 3);
+});
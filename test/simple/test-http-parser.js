@@ -547,3 +547,41 @@ function expectBody(expected) {
   parser.onHeadersComplete = onHeadersComplete2;
   parser.execute(req2, 0, req2.length);
 })();
+
+
+//
+// Test dribbled keep-alive requests. Headers that are split across many
+// buffers are accumulated in the parser until the message is complete.
+//
+(function() {
+  var req = Buffer(
+      'GET /first/path/that/is/quite/long HTTP/1.1' + CRLF +
+      'Host: example.com' + CRLF +
+      'X-Filler: ' + Array(512).join('x') + CRLF +
+      CRLF +
+      'GET /second HTTP/1.1' + CRLF +
+      'Host: example.org' + CRLF +
+      'Connection: close' + CRLF +
+      CRLF);
+
+  var expected = [
+    { url: '/first/path/that/is/quite/long',
+      headers: ['Host', 'example.com', 'X-Filler', Array(512).join('x')] },
+    { url: '/second',
+      headers: ['Host', 'example.org', 'Connection', 'close'] }
+  ];
+
+  var parser = newParser(REQUEST);
+
+  parser.onHeadersComplete = mustCall(function(info) {
+    var e = expected.shift();
+    assert.equal(info.url || parser.url, e.url);
+    assert.deepEqual(info.headers || parser.headers, e.headers);
+  }, 2);
+
+  for (var i = 0; i < req.length; ++i) {
+    parser.execute(req.slice(i, i + 1));
+  }
+
+  assert.equal(expected.length, 0);
+})();
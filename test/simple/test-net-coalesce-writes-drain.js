@@ -0,0 +1,75 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Coalesced writes that are still queued count towards the write queue, so
+// write() returns false once the high water mark is reached and 'drain' is
+// emitted when the queue has been flushed.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var chunk = new Buffer(1024);
+chunk.fill('x');
+
+var written = 0;
+var received = 0;
+var drains = 0;
+
+var server = net.createServer(function(socket) {
+  socket.on('data', function(d) {
+    received += d.length;
+  });
+  socket.on('end', function() {
+    socket.end();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = net.connect(common.PORT, function() {
+    client.setCoalesceWrites(true);
+    fill();
+  });
+
+  function fill() {
+    do {
+      written += chunk.length;
+      assert(written < 1024 * 1024, 'write() never returned false');
+    } while (client.write(chunk));
+  }
+
+  client.on('drain', function() {
+    if (++drains < 3)
+      return fill();
+    client.end();
+  });
+
+  client.on('close', function() {
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(drains, 3);
+  assert.equal(received, written);
+});
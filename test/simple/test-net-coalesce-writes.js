@@ -0,0 +1,107 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// socket.setCoalesceWrites(): writes issued in the same tick are held in a
+// native queue and flushed together.  Check that the bytes arrive in order
+// across mixed buffer/string writes, writev, end() and destroy(), and that
+// every write callback fires.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var N = 1000;
+var expected = '';
+var pieces = [];
+for (var i = 0; i < N; i++) {
+  var piece = i + (i % 7 === 0 ? 'é€' : ':');
+  pieces.push(piece);
+  expected += piece;
+}
+expected += 'corked1corked2' + 'done';
+
+var callbacks = 0;
+var serverDone = false;
+var destroyDone = false;
+
+var server = net.createServer(function(socket) {
+  socket.setCoalesceWrites();
+  pieces.forEach(function(piece, i) {
+    var data = i % 2 ? new Buffer(piece) : piece;
+    socket.write(data, function() {
+      callbacks++;
+    });
+  });
+  // Corked writes go out through writev, after the queued ones.
+  socket.cork();
+  socket.write('corked1');
+  socket.write('corked2');
+  socket.uncork();
+  socket.end('done');
+});
+
+server.listen(common.PORT, function() {
+  // Enabled before the connection exists.
+  var client = net.connect(common.PORT).setCoalesceWrites(true);
+  var received = '';
+  client.setEncoding('utf8');
+  client.on('data', function(d) {
+    received += d;
+  });
+  client.on('end', function() {
+    assert.equal(received, expected);
+    serverDone = true;
+    server.close();
+    testDestroy();
+  });
+});
+
+// destroy() in the same tick still sends what was written before it.
+function testDestroy() {
+  var server = net.createServer(function(socket) {
+    var received = '';
+    socket.setEncoding('utf8');
+    socket.on('data', function(d) {
+      received += d;
+    });
+    socket.on('end', function() {
+      assert.equal(received, 'abc');
+      destroyDone = true;
+      server.close();
+    });
+  });
+  server.listen(common.PORT + 1, function() {
+    var client = net.connect(common.PORT + 1, function() {
+      client.setCoalesceWrites(true);
+      client.write('a');
+      client.write('b');
+      client.write('c');
+      client.destroy();
+    });
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(callbacks, N);
+  assert(serverDone);
+  assert(destroyDone);
+});
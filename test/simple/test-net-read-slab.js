@@ -0,0 +1,90 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Reads are carved out of a shared slab. Make sure that buffers handed out
+// earlier are not clobbered by later reads on the same or other sockets.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var N = 20;
+var ROUNDS = 50;
+var received = [];
+var closed = 0;
+
+var server = net.createServer(function(socket) {
+  socket.on('data', function(data) {
+    // Small reads are copied out of the slab so keeping them around doesn't
+    // keep the slab alive.
+    if (data.length < 16 * 1024)
+      assert.equal(data.parent, undefined);
+    // Keep every chunk alive until the end of the test.
+    received.push(data);
+    socket.write(data);
+  });
+});
+
+server.listen(common.PORT, function() {
+  for (var i = 0; i < N; i++)
+    connect(i);
+});
+
+function connect(id) {
+  var socket = net.connect(common.PORT);
+  var chunks = [];
+  var round = 0;
+  var expected = '';
+
+  socket.on('connect', send);
+
+  socket.on('data', function(data) {
+    chunks.push(data);
+    if (Buffer.concat(chunks).length < expected.length)
+      return;
+    if (++round < ROUNDS)
+      return send();
+    socket.end();
+  });
+
+  socket.on('close', function() {
+    assert.equal(Buffer.concat(chunks).toString(), expected);
+    if (++closed === N)
+      server.close();
+  });
+
+  function send() {
+    var msg = 'socket ' + id + ' round ' + round + ';';
+    expected += msg;
+    socket.write(msg);
+  }
+}
+
+process.on('exit', function() {
+  assert.equal(closed, N);
+  var total = received.reduce(function(sum, b) { return sum + b.length; }, 0);
+  var all = received.map(String).join('');
+  assert.equal(all.length, total);
+  for (var i = 0; i < N; i++)
+    for (var r = 0; r < ROUNDS; r++)
+      assert.notEqual(all.indexOf('socket ' + i + ' round ' + r + ';'), -1);
+});
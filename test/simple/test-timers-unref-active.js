@@ -0,0 +1,106 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var timers = require('timers');
+var Timer = process.binding('timer_wrap').Timer;
+
+var fired = [];
+var late = 0;
+
+function item(msecs) {
+  var o = {
+    _onTimeout: function() {
+      var elapsed = Timer.now() - o._idleStart;
+      if (elapsed < msecs) late++;
+      fired.push(o);
+    }
+  };
+  timers.enroll(o, msecs);
+  return o;
+}
+
+// Mixed timeouts, both below and above the 256 ms the first level of the
+// wheel spans.
+var items = [];
+for (var i = 0; i < 300; i++) {
+  var o = item(1 + (i * 37) % 600);
+  timers._unrefActive(o);
+  items.push(o);
+}
+
+// Refreshed for a while before it is allowed to time out.
+var refreshed = item(200);
+var refreshes = 0;
+var refreshesAtTimeout = -1;
+refreshed._onTimeout = function() {
+  refreshesAtTimeout = refreshes;
+  fired.push(refreshed);
+};
+timers._unrefActive(refreshed);
+var refresher = setInterval(function() {
+  timers._unrefActive(refreshed);
+  if (++refreshes === 10) clearInterval(refresher);
+}, 20);
+
+// Cancelled, must never fire.
+var cancelled = item(30);
+timers._unrefActive(cancelled);
+timers.unenroll(cancelled);
+
+// Expire in the same batch. The first one pushes back the second and
+// cancels the third before they get their turn.
+var second = item(100);
+var third = item(100);
+var first = item(100);
+first._onTimeout = function() {
+  fired.push(first);
+  timers._unrefActive(second);
+  timers.unenroll(third);
+};
+timers._unrefActive(first);
+timers._unrefActive(second);
+timers._unrefActive(third);
+
+// The unref'd timeouts alone don't keep the process alive.
+setTimeout(function() {}, 1000);
+
+process.on('exit', function() {
+  assert.equal(late, 0);
+
+  items.forEach(function(o) {
+    assert.equal(fired.indexOf(o) !== -1, true);
+  });
+  for (var i = 1; i < items.length; i++) {
+    var a = fired.indexOf(items[i - 1]);
+    var b = fired.indexOf(items[i]);
+    if (items[i - 1]._idleTimeout < items[i]._idleTimeout)
+      assert.ok(a < b);
+  }
+
+  assert.equal(refreshes, 10);
+  assert.equal(refreshesAtTimeout, 10);
+
+  assert.equal(fired.indexOf(cancelled), -1);
+  assert.equal(fired.indexOf(third), -1);
+  assert.ok(fired.indexOf(first) < fired.indexOf(second));
+});
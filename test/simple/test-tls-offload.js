@@ -0,0 +1,135 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Large writes are encrypted on the thread pool when offloadThreshold is
+// set.  Check that the data still arrives intact and in order when big and
+// small writes are interleaved in both directions, that end() waits for
+// the pending encryption and that the connection can be inspected meanwhile.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var tls = require('tls');
+var fs = require('fs');
+
+var THRESHOLD = 64 * 1024;
+
+var options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  offloadThreshold: THRESHOLD
+};
+
+function makePayload() {
+  var chunks = [];
+  var sizes = [10, 4 * 1024 * 1024, 100, THRESHOLD, 1, 1024 * 1024 + 7, 5];
+  var seq = 0;
+  sizes.forEach(function(size) {
+    var buf = new Buffer(size);
+    for (var i = 0; i < size; i++)
+      buf[i] = seq++ & 0xff;
+    chunks.push(buf);
+  });
+  return chunks;
+}
+
+function verify(received, expected) {
+  var total = 0;
+  expected.forEach(function(chunk) { total += chunk.length; });
+  var got = Buffer.concat(received);
+  assert.equal(got.length, total);
+  for (var i = 0; i < got.length; i++) {
+    if (got[i] !== (i & 0xff))
+      assert.fail(got[i], i & 0xff, 'byte ' + i + ' out of order');
+  }
+}
+
+function inspect(socket) {
+  return {
+    cert: socket.getPeerCertificate(),
+    session: socket.getSession().toString('hex'),
+    cipher: socket.getCipher(),
+    reused: socket.isSessionReused()
+  };
+}
+
+var payload = makePayload();
+var serverWrites = 0;
+var clientWrites = 0;
+var serverVerified = false;
+var clientVerified = false;
+
+var server = tls.createServer(options, function(socket) {
+  var received = [];
+  socket.on('data', function(d) {
+    received.push(d);
+  });
+  socket.on('end', function() {
+    verify(received, payload);
+    serverVerified = true;
+  });
+
+  payload.forEach(function(chunk) {
+    socket.write(chunk, function() {
+      serverWrites++;
+    });
+  });
+  socket.end();
+});
+
+server.listen(common.PORT, function() {
+  var client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false,
+    offloadThreshold: THRESHOLD
+  }, function() {
+    var info = inspect(client);
+    payload.forEach(function(chunk) {
+      client.write(chunk, function() {
+        clientWrites++;
+      });
+    });
+    // The 4 MB write is being encrypted on the thread pool.
+    assert.deepEqual(inspect(client), info);
+    client.end();
+  });
+
+  var received = [];
+  client.on('data', function(d) {
+    received.push(d);
+  });
+  client.on('end', function() {
+    verify(received, payload);
+    clientVerified = true;
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(serverWrites, payload.length);
+  assert.equal(clientWrites, payload.length);
+  assert(serverVerified);
+  assert(clientVerified);
+});